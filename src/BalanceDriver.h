@@ -6,6 +6,8 @@
 #include <Adafruit_SSD1306.h> 
 #include <Adafruit_GFX.h>     
 #include <cmath>              
+#include "modules/System/EventLog.h"
+#include "modules/System/ConfigStore.h"
 
 // --- GLOBALE VARIABLEN DEFINITIONEN (WICHTIG: Hier definiert, nicht extern!) ---
 byte MPU_ADDR = 0x68; 
@@ -18,10 +20,15 @@ float targetAngle = -2150.0; // <-- DEIN LETZTER STABILER WERT!
 float deadzone = 50.0; 
 
 // --- TIMING & LIMITS ---
-#define MIN_MOTOR_SPEED 80   
-#define MAX_MOTOR_SPEED 255  
+// Motorgrenzen, PID-Werte, Sollwinkel und Deadzone kommen nach dem Start aus dem
+// ConfigStore (loadRobotConfig()), die Werte hier gelten nur bis dahin.
+int minMotorSpeed = 80;
+int maxMotorSpeed = 255;
 #define EMERGENCY_ANGLE 30.0 
+#define EMERGENCY_LOG_BAND 5.0      // erst unter EMERGENCY_ANGLE - Band gilt "wieder aufrecht"
+#define EMERGENCY_LOG_HOLD_MS 300   // so lange muss ein neuer Zustand anhalten, bevor er ins Log kommt
 #define BALANCE_LOOP_TIME_MS 10  
+#define FILTER_ALPHA 0.98           // Komplementärfilter: Anteil des integrierten Gyro-Winkels
 #define SCREEN_WIDTH 128
 #define SCREEN_HEIGHT 64
 
@@ -37,6 +44,9 @@ bool mpuInitialized = false;
 bool displayLinksInitialized = false; 
 bool displayRechtsInitialized = false; 
 bool motorsEnabled = true;          
+bool emergencyLogged = false;       // zuletzt protokollierter Not-Aus-Zustand
+bool emergencyPending = false;      // Wechsel gesehen, Haltezeit läuft
+unsigned long emergencyPendingSince = 0;
 
 // --- BEWEGUNGSBEFEHLE VON WEB ---
 int webMoveX = 0; 
@@ -60,6 +70,10 @@ Adafruit_SSD1306 displayRechts(SCREEN_WIDTH, SCREEN_HEIGHT, &I2C_Rechts, -1);
 // FUNKTIONEN IMPLEMENTIERUNG
 // ====================================================================
 
+// Vorwärtsdeklarationen (werden vor ihrer Definition aufgerufen)
+void calibrateMPU();
+void setMotorSpeed(int speedLeft, int speedRight);
+
 // --- NEUE FUNKTION: I2C BUS & MPU initialisieren (robust) ---
 bool initializeI2cAndMpu() {
     Serial.println("\n--- I2C & MPU ROBUSTER START ---");
@@ -179,6 +193,28 @@ void calibrateMPU() {
     delay(1000);
 }
 
+// Übernimmt einen Wert aus dem ConfigStore in die Regelung (ConfigStore::onChange)
+void applyRobotConfig(ConfigKey key) {
+    switch (key) {
+        case CFG_KP:           Kp = configStore.getFloat(CFG_KP); break;
+        case CFG_KI:           Ki = configStore.getFloat(CFG_KI); break;
+        case CFG_KD:           Kd = configStore.getFloat(CFG_KD); break;
+        case CFG_TARGET_ANGLE: targetAngle = configStore.getFloat(CFG_TARGET_ANGLE); break;
+        case CFG_DEADZONE:     deadzone = configStore.getFloat(CFG_DEADZONE); break;
+        case CFG_MOTOR_MIN:    minMotorSpeed = configStore.getInt(CFG_MOTOR_MIN); break;
+        case CFG_MOTOR_MAX:    maxMotorSpeed = configStore.getInt(CFG_MOTOR_MAX); break;
+        default: break; // WLAN-Daten betreffen die Regelung nicht
+    }
+}
+
+// Lädt die gespeicherten Regler-Einstellungen (nach der Kalibrierung, die targetAngle zurücksetzt)
+void loadRobotConfig() {
+    for (uint8_t k = 0; k < CFG_COUNT; k++) applyRobotConfig((ConfigKey)k);
+    configStore.onChange(applyRobotConfig);
+    Serial.print("Config: Kp="); Serial.print(Kp); Serial.print(", Ki="); Serial.print(Ki, 4);
+    Serial.print(", Kd="); Serial.print(Kd); Serial.print(", Soll="); Serial.println(targetAngle);
+}
+
 // Initialisiert alle Balancer-Hardware
 void setupBalancer() {
     Serial.println("\n=== BALANCE ROBOTER INITIALISIERUNG ===");
@@ -193,6 +229,7 @@ void setupBalancer() {
         // Wenn MPU gefunden, dann kalibrieren
         calibrateMPU();  // WICHTIG: Kalibrierung der Offsets!
     }
+    loadRobotConfig(); // Gespeicherte PID-Werte, Sollwinkel und Motorgrenzen
     
     delay(2000); // Lange Pause am Ende der Initialisierung
     if (displayLinksInitialized) displayLinks.clearDisplay(); displayLinks.display();
@@ -235,13 +272,13 @@ void setMotorSpeed(int speedLeft, int speedRight) {
     if (abs(speedLeft) < 10) { speedLeft = 0; } 
     if (abs(speedRight) < 10) { speedRight = 0; }
 
-    if (speedLeft > 0 && speedLeft < MIN_MOTOR_SPEED) { speedLeft = MIN_MOTOR_SPEED; }
-    if (speedLeft < 0 && speedLeft > -MIN_MOTOR_SPEED) { speedLeft = -MIN_MOTOR_SPEED; }
-    if (speedRight > 0 && speedRight < MIN_MOTOR_SPEED) { speedRight = MIN_MOTOR_SPEED; }
-    if (speedRight < 0 && speedRight > -MIN_MOTOR_SPEED) { speedRight = -MIN_MOTOR_SPEED; }
+    if (speedLeft > 0 && speedLeft < minMotorSpeed) { speedLeft = minMotorSpeed; }
+    if (speedLeft < 0 && speedLeft > -minMotorSpeed) { speedLeft = -minMotorSpeed; }
+    if (speedRight > 0 && speedRight < minMotorSpeed) { speedRight = minMotorSpeed; }
+    if (speedRight < 0 && speedRight > -minMotorSpeed) { speedRight = -minMotorSpeed; }
     
-    speedLeft = constrain(speedLeft, -MAX_MOTOR_SPEED, MAX_MOTOR_SPEED);
-    speedRight = constrain(speedRight, -MAX_MOTOR_SPEED, MAX_MOTOR_SPEED);
+    speedLeft = constrain(speedLeft, -maxMotorSpeed, maxMotorSpeed);
+    speedRight = constrain(speedRight, -maxMotorSpeed, maxMotorSpeed);
     
     // Motorrichtung linken Motor
     if (speedLeft > 0) { 
@@ -274,6 +311,7 @@ void setRobotMovement(int moveX, int moveY) {
 // Aktiviert/Deaktiviert die Motoren
 void toggleMotors(bool enable) {
     motorsEnabled = enable;
+    eventLog.log(EVENT_INFO, EVT_MOTORS, {enable ? 1 : 0});
     if (enable) Serial.println("Motoren AKTIVIERT!");
     else {
         Serial.println("Motoren DEAKTIVIERT!");
@@ -281,12 +319,23 @@ void toggleMotors(bool enable) {
     }
 }
 
-// Setzt neue PID-Werte von der Webseite
-void updatePidValues(float Kp_new, float Ki_new, float Kd_new) {
-    Kp = Kp_new;
-    Ki = Ki_new;
-    Kd = Kd_new;
+// Setzt neue PID-Werte von der Webseite. Der ConfigStore prüft die Grenzen,
+// übernimmt die Werte per applyRobotConfig() und speichert sie verzögert im NVS.
+// Bei false wurde nichts übernommen; key und error nennen den abgelehnten Wert.
+bool updatePidValues(float Kp_new, float Ki_new, float Kd_new, const char*& key, const char*& error) {
+    ConfigValue values[3] = {
+        { CFG_KP, Kp_new, 0, false, nullptr },
+        { CFG_KI, Ki_new, 0, false, nullptr },
+        { CFG_KD, Kd_new, 0, false, nullptr }
+    };
+    size_t errorIndex;
+    if (configStore.setMany(values, 3, errorIndex, error) < 0) {
+        key = ConfigStore::def(values[errorIndex].key).name;
+        Serial.printf("PID abgelehnt (%s: %s)\n", key, error);
+        return false;
+    }
     Serial.print("PID Updated: Kp="); Serial.print(Kp); Serial.print(", Ki="); Serial.print(Ki); Serial.print(", Kd="); Serial.println(Kd);
+    return true;
 }
 
 // Gibt den aktuellen Status des Roboters zurück
@@ -310,6 +359,29 @@ void getCurrentRobotStatus(float& angle, float& error, float& gyroRate, int& mot
 }
 
 
+// Protokolliert Not-Aus und Wiederaufnahme entprellt: mit Hysterese-Band und
+// Mindest-Haltezeit, damit ein Roboter an der Grenze das Log nicht flutet.
+// Unabhängig von motorsEnabled, daher auch kein "wieder aufrecht" nach toggleMotors().
+void logEmergencyState(float angleError, unsigned long now) {
+    float limit = emergencyLogged ? EMERGENCY_ANGLE - EMERGENCY_LOG_BAND : EMERGENCY_ANGLE;
+    bool tilted = abs(angleError) > limit;
+    if (tilted == emergencyLogged) {
+        emergencyPending = false;
+        return;
+    }
+    if (!emergencyPending) {
+        emergencyPending = true;
+        emergencyPendingSince = now;
+        return;
+    }
+    if (now - emergencyPendingSince < EMERGENCY_LOG_HOLD_MS) return;
+
+    emergencyPending = false;
+    emergencyLogged = tilted;
+    if (tilted) eventLog.log(EVENT_WARN, EVT_EMERGENCY_STOP, {(int32_t)(angleError * 10)});
+    else eventLog.log(EVENT_INFO, EVT_BALANCE_RESUMED);
+}
+
 // Haupt-Balancier-Logik
 void runBalanceLoop() {
     if (!mpuInitialized) { 
@@ -365,6 +437,7 @@ void runBalanceLoop() {
     }
     
     // Not-Aus bei zu starker Neigung 
+    logEmergencyState(filteredAngle - targetAngle, now);
     if (abs(filteredAngle - targetAngle) > EMERGENCY_ANGLE) {
         setMotorSpeed(0, 0);
         motorsEnabled = false;
@@ -393,8 +466,8 @@ void runBalanceLoop() {
     float output = (Kp * error) + (Ki * errorSum) + (Kd * dError);
     
     // Bewegung basierend auf Web-Befehlen
-    float movementBias = webMoveX / 100.0 * MAX_MOTOR_SPEED; // Vor/Zurück
-    float rotationBias = webMoveY / 100.0 * MAX_MOTOR_SPEED; // Drehen
+    float movementBias = webMoveX / 100.0 * maxMotorSpeed; // Vor/Zurück
+    float rotationBias = webMoveY / 100.0 * maxMotorSpeed; // Drehen
     
     int motorSpeedLeft = (int)(output + movementBias + rotationBias);
     int motorSpeedRight = (int)(output + movementBias - rotationBias);
@@ -14,11 +14,18 @@
 #include "config.h"
 #include "modules/WiFi/WifiManager.h"
 #include "modules/System/SystemAPI.h"
+#include "modules/System/EventLog.h"
+#include "modules/System/ConfigStore.h"
+#include "modules/System/TaskProfiler.h"
+#include "modules/System/HeapTrace.h"
 #include "modules/Server/WebServer.h"
 #include "services/TimeService.h"
 #include "modules/System/SystemApiHandler.h"
 #include "modules/WiFi/WifiApiHandler.h" 
 #include "modules/Server/OtaApiHandler.h"
+#include "modules/Server/FileSyncApiHandler.h"
+#include "modules/Robot/CommandBatch.h"
+#include "modules/Robot/TelemetryHistory.h"
 
 // UNSER ROBOTER TREIBER (Header einbinden)
 #include "BalanceDriver.h"
@@ -30,17 +37,26 @@ SystemAPI systemApi(wifiManager, timeService);
 SystemApiHandler systemApiHandler(systemApi);
 WifiApiHandler wifiApiHandler(wifiManager);
 OtaApiHandler otaApiHandler;
-WebServer WebServer(wifiManager, systemApiHandler, wifiApiHandler, otaApiHandler);
+CommandBatch commandBatch;
+FileSyncApiHandler fileSyncApiHandler;
+TelemetryHistory telemetryHistory;
+WebServer WebServer(wifiManager, systemApiHandler, wifiApiHandler, otaApiHandler, commandBatch, fileSyncApiHandler,
+                    telemetryHistory);
 
 void setup() {
+    HeapScope heapScope(HEAP_SETUP); // Allokationen beim Start (/api/system/heap)
     Serial.begin(115200);
     Serial.println("\n--- ROBOTER START ---");
+    eventLog.begin(); // Ereignis-Log aus dem RTC-Speicher übernehmen, Neustart-Grund eintragen
+    configStore.begin(); // Einstellungen aus dem NVS in den RAM (vor Balancer und WLAN)
+    taskProfiler.begin(); // CPU- und Stack-Profil aller Tasks (/api/system/tasks)
     
     // 1. Roboter Hardware starten (Balancer, Displays, MPU, Kalibrierung!)
     setupBalancer(); 
 
     // 2. Uni-Framework starten (WLAN, Webserver, etc.)
     wifiManager.setup(); 
+    systemApi.begin();   // Health-Sampler (feste Werte einmalig, dann im Hintergrund)
     WebServer.setup();   
     timeService.setup();
 
@@ -49,9 +65,23 @@ void setup() {
 
 void loop() {
     // 1. Die Balance-Schleife muss zuerst und sehr oft laufen!
-    runBalanceLoop(); 
+    // Gebündelte Web-Befehle (/api/batch) werden direkt davor übernommen,
+    // also immer komplett zwischen zwei Regelzyklen.
+    // Die HeapScopes ordnen Allokationen für /api/system/heap dem Subsystem zu.
+    {
+        HeapScope heapScope(HEAP_BALANCE);
+        commandBatch.loop();
+        runBalanceLoop(); 
+        telemetryHistory.loop(); // Verlauf für /api/robot/history (alle 20 ms)
+    }
 
-    // 2. Uni-Framework Hintergrund-Aufgaben
-    wifiManager.loop();  
-    timeService.loop();
+    // 2. Uni-Framework Hintergrund-Aufgaben (das WLAN läuft im eigenen Task)
+    {
+        HeapScope heapScope(HEAP_TIME);
+        timeService.loop();
+    }
+    {
+        HeapScope heapScope(HEAP_EVENTS);
+        systemApiHandler.loop(); // Live-Events (SSE) für die Diagnose-Seite
+    }
 }
\ No newline at end of file
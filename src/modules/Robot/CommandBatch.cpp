@@ -0,0 +1,299 @@
+//================================================================================
+//| DATEI: CommandBatch.cpp                                                      |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Implementiert Parser, Übergabe an die Hauptschleife und die JSON-Antwort für |
+//| /api/batch. Die Übergabe läuft über einen einzigen Zeiger (_pending) und ein |
+//| Semaphore, auf das der Request-Handler wartet.                               |
+//================================================================================
+
+#include "CommandBatch.h"
+#include "../Server/JsonWriter.h"
+#include "../System/ConfigStore.h"
+#include <esp_timer.h>
+
+// Aus BalanceDriver.h. Der Header definiert seine Variablen selbst und darf daher
+// nur einmal (in main.cpp) eingebunden werden - hier genügen die Deklarationen.
+bool updatePidValues(float Kp_new, float Ki_new, float Kd_new, const char*& key, const char*& error);
+void toggleMotors(bool enable);
+void setRobotMovement(int moveX, int moveY);
+void getCurrentRobotStatus(float& angle, float& error, float& gyroRate, int& motorSpeed, bool& enabled,
+                           float& currentKp, float& currentKi, float& currentKd);
+
+static const char* const OP_NAMES[] = {"pid", "target", "enable", "disable", "move", "status"};
+
+CommandBatch::CommandBatch()
+    : _lock(nullptr), _done(nullptr), _pending(nullptr), _applied(0), _timeouts(0) {}
+
+void CommandBatch::registerRoutes(AsyncWebServer& server) {
+    if (!_lock) {
+        _lock = xSemaphoreCreateMutex();
+        _done = xSemaphoreCreateBinary();
+    }
+    server.on("/api/batch", HTTP_POST, std::bind(&CommandBatch::handleBatch, this, std::placeholders::_1));
+}
+
+static char* trim(char* s) {
+    while (*s == ' ' || *s == '\t' || *s == '\r') s++;
+    char* end = s + strlen(s);
+    while (end > s && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r')) *--end = '\0';
+    return s;
+}
+
+/**
+ * @brief Liest bis zu 3 durch Komma getrennte Zahlen. Leere Felder sind erlaubt.
+ * @return false bei ungültiger Zahl oder zu vielen Feldern.
+ */
+static bool parseArgs(char* text, BatchOp& op, uint8_t maxArgs) {
+    op.argMask = 0;
+    if (!text) return true;
+    uint8_t index = 0;
+    char* p = text;
+    while (true) {
+        char* comma = strchr(p, ',');
+        if (comma) *comma = '\0';
+        if (index >= maxArgs) return false;
+        char* field = trim(p);
+        if (*field) {
+            char* end;
+            float value = strtof(field, &end);
+            if (*trim(end) != '\0' || !isfinite(value)) return false;
+            op.args[index] = value;
+            op.argMask |= 1 << index;
+        }
+        index++;
+        if (!comma) break;
+        p = comma + 1;
+    }
+    return true;
+}
+
+/**
+ * @brief Prüft die angegebenen Argumente gegen die Grenzen aus dem ConfigStore,
+ * damit ein unzulässiger Wert schon beim Parsen (nichts angewendet) auffällt.
+ */
+static bool argsInRange(const BatchOp& op, const ConfigKey* keys, uint8_t count) {
+    for (uint8_t i = 0; i < count; i++) {
+        if (!(op.argMask & (1 << i))) continue;
+        const ConfigDef& d = ConfigStore::def(keys[i]);
+        if (op.args[i] < d.min || op.args[i] > d.max) return false;
+    }
+    return true;
+}
+
+bool CommandBatch::parse(char* text, Batch& batch, uint8_t& errorIndex) {
+    batch.count = 0;
+    char* p = text;
+    while (p && *p) {
+        char* sep = strpbrk(p, ";\n");
+        if (sep) *sep = '\0';
+        char* item = trim(p);
+        p = sep ? sep + 1 : nullptr;
+        if (!*item) continue;
+
+        errorIndex = batch.count;
+        if (batch.count >= BATCH_MAX_OPS) return false;
+        BatchOp& op = batch.ops[batch.count];
+        memset(&op, 0, sizeof(op));
+
+        char* args = strchr(item, ':');
+        if (args) *args++ = '\0';
+        item = trim(item);
+
+        bool ok;
+        if (strcmp(item, "pid") == 0) {
+            op.type = BATCH_OP_PID;
+            static const ConfigKey keys[] = {CFG_KP, CFG_KI, CFG_KD};
+            ok = parseArgs(args, op, 3) && op.argMask != 0 && argsInRange(op, keys, 3);
+        } else if (strcmp(item, "target") == 0) {
+            op.type = BATCH_OP_TARGET;
+            static const ConfigKey keys[] = {CFG_TARGET_ANGLE};
+            ok = parseArgs(args, op, 1) && op.argMask == 1 && argsInRange(op, keys, 1);
+        } else if (strcmp(item, "move") == 0) {
+            op.type = BATCH_OP_MOVE;
+            ok = parseArgs(args, op, 2);
+        } else if (strcmp(item, "enable") == 0 || strcmp(item, "disable") == 0 || strcmp(item, "status") == 0) {
+            op.type = item[0] == 'e' ? BATCH_OP_ENABLE : item[0] == 'd' ? BATCH_OP_DISABLE : BATCH_OP_STATUS;
+            ok = args == nullptr || *trim(args) == '\0';
+        } else {
+            ok = false;
+        }
+        if (!ok) return false;
+        batch.count++;
+    }
+    return true;
+}
+
+/**
+ * @brief Übergibt den Batch an die Hauptschleife und wartet auf die Anwendung.
+ * @return false, wenn die Hauptschleife nicht rechtzeitig reagiert hat (nichts angewendet).
+ */
+bool CommandBatch::submit(Batch& batch) {
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    if (_pending) {
+        xSemaphoreGive(_lock);
+        return false;
+    }
+    xSemaphoreTake(_done, 0); // Evtl. verwaistes Signal eines abgebrochenen Batches verwerfen
+    batch.submittedUs = esp_timer_get_time();
+    _pending = &batch;
+    xSemaphoreGive(_lock);
+
+    if (xSemaphoreTake(_done, pdMS_TO_TICKS(BATCH_APPLY_TIMEOUT_MS)) == pdTRUE) return true;
+
+    // Timeout: Zurückziehen, falls die Hauptschleife den Batch noch nicht übernommen hat.
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    bool cancelled = (_pending == &batch);
+    if (cancelled) _pending = nullptr;
+    xSemaphoreGive(_lock);
+    if (cancelled) {
+        _timeouts++;
+        return false;
+    }
+    // Wird gerade angewendet - der Batch liegt auf unserem Stack, also unbedingt abwarten.
+    xSemaphoreTake(_done, portMAX_DELAY);
+    return true;
+}
+
+void CommandBatch::loop() {
+    if (!_pending) return; // Schneller Pfad ohne Lock
+
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    Batch* batch = _pending;
+    _pending = nullptr;
+    xSemaphoreGive(_lock);
+    if (!batch) return;
+
+    apply(*batch);
+    _applied++;
+    xSemaphoreGive(_done);
+}
+
+/**
+ * @brief Wendet alle Operationen nacheinander an (läuft im Task der Regelung).
+ */
+void CommandBatch::apply(Batch& batch) {
+    int64_t start = esp_timer_get_time();
+    batch.waitUs = (uint32_t)(start - batch.submittedUs);
+
+    for (uint8_t i = 0; i < batch.count; i++) {
+        BatchOp& op = batch.ops[i];
+        int64_t opStart = esp_timer_get_time();
+        switch (op.type) {
+            case BATCH_OP_PID: {
+                BatchStatus& s = op.status;
+                getCurrentRobotStatus(s.angle, s.error, s.gyro, s.motor, s.enabled, s.kp, s.ki, s.kd);
+                // Die Grenzen hat parse() schon geprüft (argsInRange)
+                const char* key;
+                const char* error;
+                updatePidValues((op.argMask & 1) ? op.args[0] : s.kp,
+                                (op.argMask & 2) ? op.args[1] : s.ki,
+                                (op.argMask & 4) ? op.args[2] : s.kd, key, error);
+                break;
+            }
+            case BATCH_OP_TARGET:
+                // Übernimmt den Wert über applyRobotConfig() und speichert ihn verzögert
+                configStore.setFloat(CFG_TARGET_ANGLE, op.args[0]);
+                break;
+            case BATCH_OP_ENABLE:
+                toggleMotors(true);
+                break;
+            case BATCH_OP_DISABLE:
+                toggleMotors(false);
+                break;
+            case BATCH_OP_MOVE:
+                setRobotMovement((op.argMask & 1) ? (int)op.args[0] : 0, (op.argMask & 2) ? (int)op.args[1] : 0);
+                break;
+            case BATCH_OP_STATUS: {
+                BatchStatus& s = op.status;
+                getCurrentRobotStatus(s.angle, s.error, s.gyro, s.motor, s.enabled, s.kp, s.ki, s.kd);
+                break;
+            }
+        }
+        op.durationUs = (uint32_t)(esp_timer_get_time() - opStart);
+    }
+    batch.applyUs = (uint32_t)(esp_timer_get_time() - start);
+}
+
+void CommandBatch::handleBatch(AsyncWebServerRequest* request) {
+    // Variante 1: Formular-/Query-Parameter "ops". Variante 2: roher Body (text/plain).
+    char text[BATCH_MAX_BODY + 1];
+    const char* ops = request->argPtr("ops");
+    if (ops) {
+        strncpy(text, ops, BATCH_MAX_BODY);
+        text[BATCH_MAX_BODY] = '\0';
+    } else {
+        httpd_req_t* req = request->getNativeRequest();
+        if (req->content_len > BATCH_MAX_BODY) {
+            request->send(400, "application/json", "{\"ok\":false,\"error\":\"batch too large\"}");
+            return;
+        }
+        size_t received = 0;
+        while (received < req->content_len) {
+            int ret = request->receive(text + received, req->content_len - received);
+            if (ret <= 0) break;
+            received += ret;
+        }
+        request->markBodyConsumed();
+        // Abgeschnittene Befehle nie ausführen ("pid:3.25" darf nicht zu "pid:3" werden)
+        if (received != req->content_len) {
+            request->send(400, "application/json", "{\"ok\":false,\"error\":\"incomplete body\"}");
+            return;
+        }
+        text[received] = '\0';
+    }
+
+    Batch batch;
+    uint8_t errorIndex = 0;
+    if (!parse(text, batch, errorIndex)) {
+        char msg[64];
+        snprintf(msg, sizeof(msg), "{\"ok\":false,\"error\":\"invalid op\",\"index\":%u}", (unsigned)errorIndex);
+        request->send(400, "application/json", msg);
+        return;
+    }
+    if (batch.count == 0) {
+        request->send(400, "application/json", "{\"ok\":false,\"error\":\"empty batch\"}");
+        return;
+    }
+
+    if (!submit(batch)) {
+        request->send(503, "application/json", "{\"ok\":false,\"error\":\"control loop busy\"}");
+        return;
+    }
+    sendResult(request, batch);
+}
+
+void CommandBatch::sendResult(AsyncWebServerRequest* request, const Batch& batch) {
+    char buffer[512];
+    ResponseWriter out(request, 200, "application/json", buffer, sizeof(buffer));
+    JsonWriter json(out);
+    json.beginObject();
+    json.field("ok", true);
+    json.field("wait_us", batch.waitUs);
+    json.field("apply_us", batch.applyUs);
+    json.key("results");
+    json.beginArray();
+    for (uint8_t i = 0; i < batch.count; i++) {
+        const BatchOp& op = batch.ops[i];
+        json.beginObject();
+        json.field("op", OP_NAMES[op.type]);
+        json.field("us", op.durationUs);
+        if (op.type == BATCH_OP_STATUS) {
+            const BatchStatus& s = op.status;
+            json.field("angle", s.angle, 2);
+            json.field("error", s.error, 2);
+            json.field("gyro", s.gyro, 2);
+            json.field("motor", s.motor);
+            json.field("enabled", s.enabled);
+            json.field("kp", s.kp, 2);
+            json.field("ki", s.ki, 3);
+            json.field("kd", s.kd, 2);
+        }
+        json.endObject();
+    }
+    json.endArray();
+    json.endObject();
+    out.end();
+}
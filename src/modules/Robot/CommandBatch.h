@@ -0,0 +1,111 @@
+//================================================================================
+//| DATEI: CommandBatch.h                                                        |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Mehrere Roboter-Befehle in einem einzigen HTTP-Request (/api/batch).         |
+//| Statt einzelner POSTs für PID, Sollwert, Motoren und Bewegung schickt das    |
+//| Frontend eine kompakte Liste, z.B.:                                          |
+//|                                                                              |
+//|   pid:3.2,0.005,0.4;target:-1.5;enable;move:40,0;status                      |
+//|                                                                              |
+//| ATOMAR: Der Webserver-Task parst die Liste nur. Angewendet wird sie komplett |
+//| von der Hauptschleife zwischen zwei Regelzyklen (loop() vor                  |
+//| runBalanceLoop()). Die Regelung sieht also nie einen halb übernommenen       |
+//| Parametersatz.                                                               |
+//================================================================================
+
+#pragma once
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "../Server/AsyncWebServer.h"
+
+// Maximale Anzahl Befehle pro Batch.
+#define BATCH_MAX_OPS         16
+// Maximale Länge der Befehlsliste (roher Body oder Parameter "ops").
+#define BATCH_MAX_BODY        512
+// So lange wartet der Request auf den nächsten Regelzyklus.
+#define BATCH_APPLY_TIMEOUT_MS 250
+
+enum BatchOpType : uint8_t {
+    BATCH_OP_PID,       // pid:kp,ki,kd  (leere Felder behalten den Wert)
+    BATCH_OP_TARGET,    // target:winkel
+    BATCH_OP_ENABLE,    // enable
+    BATCH_OP_DISABLE,   // disable
+    BATCH_OP_MOVE,      // move:x,y
+    BATCH_OP_STATUS     // status (Momentaufnahme an dieser Stelle des Batches)
+};
+
+/**
+ * @brief Momentaufnahme des Roboterzustands (für die Operation "status").
+ */
+struct BatchStatus {
+    float angle, error, gyro;
+    int motor;
+    bool enabled;
+    float kp, ki, kd;
+};
+
+/**
+ * @brief Eine geparste Operation inkl. Ergebnis.
+ */
+struct BatchOp {
+    BatchOpType type;
+    float args[3];
+    uint8_t argMask;        // Bit i = args[i] wurde angegeben
+    uint32_t durationUs;    // Ausführungszeit dieser Operation
+    BatchStatus status;     // nur für BATCH_OP_STATUS
+};
+
+/**
+ * @brief Ein kompletter Batch (liegt auf dem Stack des Request-Handlers).
+ */
+struct Batch {
+    BatchOp ops[BATCH_MAX_OPS];
+    uint8_t count;
+    int64_t submittedUs;
+    uint32_t waitUs;        // Wartezeit bis zum Regelzyklus
+    uint32_t applyUs;       // Gesamtdauer der Anwendung
+};
+
+/**
+ * @class CommandBatch
+ * @brief Parst Befehlslisten und übergibt sie an die Hauptschleife.
+ */
+class CommandBatch {
+public:
+    CommandBatch();
+
+    /**
+     * @brief Registriert POST /api/batch.
+     */
+    void registerRoutes(AsyncWebServer& server);
+
+    /**
+     * @brief Wendet einen wartenden Batch an. Muss in der Hauptschleife direkt
+     * vor runBalanceLoop() aufgerufen werden (gleicher Task wie die Regelung).
+     */
+    void loop();
+
+    /**
+     * @brief Zerlegt die Befehlsliste. Bei einem Fehler wird nichts angewendet.
+     * @param text Nullterminierte Liste, Trennzeichen ';' oder Zeilenumbruch.
+     * @param errorIndex Index der fehlerhaften Operation (bei Rückgabe false).
+     */
+    static bool parse(char* text, Batch& batch, uint8_t& errorIndex);
+
+private:
+    SemaphoreHandle_t _lock;
+    SemaphoreHandle_t _done;
+    Batch* volatile _pending;       // wartet auf den nächsten Regelzyklus
+    uint32_t _applied;
+    uint32_t _timeouts;
+
+    void handleBatch(AsyncWebServerRequest* request);
+    bool submit(Batch& batch);
+    void apply(Batch& batch);
+    void sendResult(AsyncWebServerRequest* request, const Batch& batch);
+};
@@ -0,0 +1,472 @@
+//================================================================================
+//| DATEI: TelemetryHistory.cpp                                                  |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Implementiert Aufnahme, Verdichtung (1s/10s/1m) und Abfrage des Telemetrie-  |
+//| Verlaufs. Werte werden als Festkomma (int16) gespeichert: Winkel, Fehler und |
+//| Gyro in 1/100, der Motorwert unverändert.                                    |
+//|                                                                              |
+//| BLOCK IM RING: [Länge u16][Startzeit u32][Zeilen u8], danach Spalte für      |
+//| Spalte die Zigzag-Varint-Deltas (erster Wert als Delta zu 0).                |
+//================================================================================
+
+#include "TelemetryHistory.h"
+#include "../Server/JsonWriter.h"
+
+// Aus BalanceDriver.h (nur in main.cpp eingebunden, siehe CommandBatch.cpp).
+void getCurrentRobotStatus(float& angle, float& error, float& gyroRate, int& motorSpeed, bool& enabled,
+                           float& currentKp, float& currentKi, float& currentKd);
+
+static const char* const kChannelNames[TELEMETRY_CHANNELS] = {"angle", "error", "gyro", "motor"};
+static const int16_t kChannelScale[TELEMETRY_CHANNELS] = {100, 100, 100, 1};
+static const char* const kRollupSuffix[3] = {"_min", "_max", "_mean"};
+static const char* const kTierNames[TELEMETRY_TIERS] = {"raw", "1s", "10s", "1m"};
+
+static_assert(TELEMETRY_ROLLUP_BLOCK_ROWS * TELEMETRY_MAX_FIELDS <= TELEMETRY_MAX_BLOCK_ROWS * TELEMETRY_CHANNELS,
+              "TelemetryChunk::rows zu klein für einen Rollup-Block");
+static_assert(TELEMETRY_BLOCK_HEADER + 3 * TELEMETRY_ROLLUP_BLOCK_ROWS * TELEMETRY_MAX_FIELDS <= TELEMETRY_MAX_BLOCK_BYTES,
+              "TELEMETRY_MAX_BLOCK_BYTES zu klein für einen Rollup-Block");
+
+// --- Kodierung ---
+
+static size_t putVarint(uint8_t* out, uint32_t value) {
+    size_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = (uint8_t)value;
+    return n;
+}
+
+static uint32_t getVarint(const uint8_t*& p, const uint8_t* end) {
+    uint32_t value = 0;
+    for (uint8_t shift = 0; p < end && shift < 35; shift += 7) {
+        uint8_t b = *p++;
+        value |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) break;
+    }
+    return value;
+}
+
+static inline uint32_t zigzag(int32_t v) { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+static inline int32_t unzigzag(uint32_t v) { return (int32_t)(v >> 1) ^ -(int32_t)(v & 1); }
+
+static int16_t quantize(float value, int16_t scale) {
+    float v = value * scale;
+    if (!(v > -32767.0f)) return -32767; // auch NaN
+    if (v > 32767.0f) return 32767;
+    return (int16_t)(v < 0 ? v - 0.5f : v + 0.5f);
+}
+
+// --- Ring-Hilfen (nur mit gehaltenem Lock) ---
+
+static void ringRead(const uint8_t* ring, uint32_t size, uint32_t pos, uint8_t* out, size_t len) {
+    for (size_t i = 0; i < len; i++) out[i] = ring[(pos + i) % size];
+}
+
+static void ringWrite(uint8_t* ring, uint32_t size, uint32_t pos, const uint8_t* data, size_t len) {
+    for (size_t i = 0; i < len; i++) ring[(pos + i) % size] = data[i];
+}
+
+struct BlockHeader {
+    uint16_t len;
+    uint32_t start;
+    uint8_t count;
+};
+
+static BlockHeader parseHeader(const uint8_t* h) {
+    BlockHeader header;
+    header.len = (uint16_t)(h[0] | (h[1] << 8));
+    header.start = (uint32_t)h[2] | ((uint32_t)h[3] << 8) | ((uint32_t)h[4] << 16) | ((uint32_t)h[5] << 24);
+    header.count = h[6];
+    return header;
+}
+
+// --- Aufnahme ---
+
+TelemetryHistory::TelemetryHistory() : _lock(nullptr), _lastSlot(UINT32_MAX), _samples(0), _skipped(0) {
+    static const uint32_t intervals[TELEMETRY_TIERS] = {TELEMETRY_RAW_INTERVAL_MS, 1000, 10000, 60000};
+    uint8_t* rings[TELEMETRY_TIERS] = {_rawRing, _ring1s, _ring10s, _ring1m};
+    static const uint32_t sizes[TELEMETRY_TIERS] = {TELEMETRY_RAW_BYTES, TELEMETRY_1S_BYTES, TELEMETRY_10S_BYTES, TELEMETRY_1M_BYTES};
+
+    for (uint8_t i = 0; i < TELEMETRY_TIERS; i++) {
+        Tier& tier = _tiers[i];
+        memset(&tier, 0, sizeof(tier));
+        tier.interval = intervals[i];
+        tier.fields = i == 0 ? TELEMETRY_CHANNELS : TELEMETRY_MAX_FIELDS;
+        tier.blockRows = i == 0 ? TELEMETRY_RAW_BLOCK_ROWS : TELEMETRY_ROLLUP_BLOCK_ROWS;
+        tier.ring = rings[i];
+        tier.size = sizes[i];
+        tier.open = i == 0 ? _rawOpen : _rollupOpen[i - 1];
+    }
+    memset(_acc, 0, sizeof(_acc));
+}
+
+void TelemetryHistory::registerRoutes(AsyncWebServer& server) {
+    if (!_lock) _lock = xSemaphoreCreateMutex();
+    server.on("/api/robot/history", HTTP_GET, std::bind(&TelemetryHistory::handleHistory, this, std::placeholders::_1));
+    server.on("/api/robot/history/stats", HTTP_GET, std::bind(&TelemetryHistory::handleStats, this, std::placeholders::_1));
+}
+
+void TelemetryHistory::loop() {
+    // Ein Messwert pro Rasterzeitpunkt. Läuft die Schleife seltener als das Raster,
+    // entstehen Lücken; die Blöcke werden dort geteilt.
+    uint32_t slot = millis() / TELEMETRY_RAW_INTERVAL_MS;
+    if (slot == _lastSlot) return;
+    _lastSlot = slot;
+
+    float angle, error, gyro, kp, ki, kd;
+    int motor;
+    bool enabled;
+    getCurrentRobotStatus(angle, error, gyro, motor, enabled, kp, ki, kd);
+    record(slot * TELEMETRY_RAW_INTERVAL_MS, angle, error, gyro, motor);
+}
+
+void TelemetryHistory::record(uint32_t timeMs, float angle, float error, float gyro, int motor) {
+    int16_t row[TELEMETRY_CHANNELS] = {
+        quantize(angle, kChannelScale[0]),
+        quantize(error, kChannelScale[1]),
+        quantize(gyro, kChannelScale[2]),
+        quantize((float)motor, kChannelScale[3])
+    };
+    int32_t sum[TELEMETRY_CHANNELS];
+    for (uint8_t c = 0; c < TELEMETRY_CHANNELS; c++) sum[c] = row[c];
+
+    // Die Regelung wartet nie auf einen lesenden Request.
+    if (!_lock || xSemaphoreTake(_lock, 0) != pdTRUE) {
+        _skipped++;
+        return;
+    }
+    append(_tiers[0], timeMs, row);
+    feed(0, timeMs, row, row, sum, 1);
+    _samples++;
+    xSemaphoreGive(_lock);
+}
+
+void TelemetryHistory::append(Tier& tier, uint32_t timeMs, const int16_t* row) {
+    if (tier.openCount > 0 &&
+        (tier.openCount == tier.blockRows || timeMs != tier.openStart + tier.openCount * tier.interval)) {
+        seal(tier);
+    }
+    if (tier.openCount == 0) tier.openStart = timeMs;
+    memcpy(tier.open + tier.openCount * tier.fields, row, tier.fields * sizeof(int16_t));
+    tier.openCount++;
+}
+
+/**
+ * @brief Komprimiert den offenen Block spaltenweise in den Ring der Stufe.
+ */
+void TelemetryHistory::seal(Tier& tier) {
+    uint8_t block[TELEMETRY_MAX_BLOCK_BYTES];
+    size_t n = TELEMETRY_BLOCK_HEADER;
+    for (uint8_t f = 0; f < tier.fields; f++) {
+        int32_t prev = 0;
+        for (uint8_t r = 0; r < tier.openCount; r++) {
+            int32_t value = tier.open[r * tier.fields + f];
+            n += putVarint(block + n, zigzag(value - prev));
+            prev = value;
+        }
+    }
+    block[0] = (uint8_t)n;
+    block[1] = (uint8_t)(n >> 8);
+    block[2] = (uint8_t)tier.openStart;
+    block[3] = (uint8_t)(tier.openStart >> 8);
+    block[4] = (uint8_t)(tier.openStart >> 16);
+    block[5] = (uint8_t)(tier.openStart >> 24);
+    block[6] = tier.openCount;
+
+    // Platz schaffen: die ältesten Blöcke fallen heraus
+    while (tier.size - tier.used < n && tier.blocks > 0) {
+        uint8_t h[TELEMETRY_BLOCK_HEADER];
+        ringRead(tier.ring, tier.size, tier.tail, h, sizeof(h));
+        BlockHeader old = parseHeader(h);
+        tier.tail = (tier.tail + old.len) % tier.size;
+        tier.used -= old.len;
+        tier.rows -= old.count;
+        tier.blocks--;
+        tier.evicted++;
+    }
+    ringWrite(tier.ring, tier.size, (tier.tail + tier.used) % tier.size, block, n);
+    tier.used += n;
+    tier.rows += tier.openCount;
+    tier.blocks++;
+    tier.sealedRows += tier.openCount;
+    tier.sealedBytes += n;
+    tier.openCount = 0;
+}
+
+/**
+ * @brief Übergibt Minimum, Maximum und Summe eines Zeitraums an die Rollup-Stufe
+ * `level` (0 = 1s). Beginnt ein neuer Zeitraum, wird der alte abgeschlossen.
+ */
+void TelemetryHistory::feed(uint8_t level, uint32_t timeMs, const int16_t* min, const int16_t* max,
+                            const int32_t* sum, uint32_t n) {
+    Accumulator& acc = _acc[level];
+    uint32_t period = timeMs / _tiers[level + 1].interval;
+    if (acc.n > 0 && period != acc.period) close(level);
+
+    if (acc.n == 0) {
+        acc.period = period;
+        memcpy(acc.min, min, sizeof(acc.min));
+        memcpy(acc.max, max, sizeof(acc.max));
+        memcpy(acc.sum, sum, sizeof(acc.sum));
+        acc.n = n;
+        return;
+    }
+    for (uint8_t c = 0; c < TELEMETRY_CHANNELS; c++) {
+        if (min[c] < acc.min[c]) acc.min[c] = min[c];
+        if (max[c] > acc.max[c]) acc.max[c] = max[c];
+        acc.sum[c] += sum[c];
+    }
+    acc.n += n;
+}
+
+void TelemetryHistory::close(uint8_t level) {
+    Accumulator& acc = _acc[level];
+    Tier& tier = _tiers[level + 1];
+    uint32_t timeMs = acc.period * tier.interval;
+
+    int16_t row[TELEMETRY_MAX_FIELDS];
+    int32_t half = (int32_t)(acc.n / 2);
+    for (uint8_t c = 0; c < TELEMETRY_CHANNELS; c++) {
+        row[3 * c] = acc.min[c];
+        row[3 * c + 1] = acc.max[c];
+        // Mittelwert über alle Rohwerte des Zeitraums (nicht Mittel der Mittel)
+        row[3 * c + 2] = (int16_t)((acc.sum[c] >= 0 ? acc.sum[c] + half : acc.sum[c] - half) / (int32_t)acc.n);
+    }
+    append(tier, timeMs, row);
+    if (level + 2 < TELEMETRY_TIERS) feed(level + 1, timeMs, acc.min, acc.max, acc.sum, acc.n);
+    acc.n = 0;
+}
+
+// --- Abfrage ---
+
+void TelemetryHistory::decode(const uint8_t* block, uint8_t fields, TelemetryChunk& chunk) {
+    BlockHeader header = parseHeader(block);
+    chunk.start = header.start;
+    chunk.count = header.count;
+    const uint8_t* p = block + TELEMETRY_BLOCK_HEADER;
+    const uint8_t* end = block + header.len;
+    for (uint8_t f = 0; f < fields; f++) {
+        int32_t value = 0;
+        for (uint8_t r = 0; r < header.count; r++) {
+            value += unzigzag(getVarint(p, end));
+            chunk.rows[r * fields + f] = (int16_t)value;
+        }
+    }
+}
+
+bool TelemetryHistory::fetch(uint8_t index, uint32_t from, TelemetryChunk& chunk) {
+    if (!_lock || index >= TELEMETRY_TIERS) return false;
+    Tier& tier = _tiers[index];
+    chunk.interval = tier.interval;
+    chunk.fields = tier.fields;
+
+    uint8_t block[TELEMETRY_MAX_BLOCK_BYTES];
+    bool sealed = false;
+    bool open = false;
+
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    uint32_t pos = tier.tail;
+    for (uint16_t b = 0; b < tier.blocks; b++) {
+        uint8_t h[TELEMETRY_BLOCK_HEADER];
+        ringRead(tier.ring, tier.size, pos, h, sizeof(h));
+        BlockHeader header = parseHeader(h);
+        if (header.start + header.count * tier.interval > from) {
+            ringRead(tier.ring, tier.size, pos, block, header.len);
+            sealed = true;
+            break;
+        }
+        pos = (pos + header.len) % tier.size;
+    }
+    if (!sealed && tier.openCount > 0 && tier.openStart + tier.openCount * tier.interval > from) {
+        chunk.start = tier.openStart;
+        chunk.count = tier.openCount;
+        memcpy(chunk.rows, tier.open, tier.openCount * tier.fields * sizeof(int16_t));
+        open = true;
+    }
+    xSemaphoreGive(_lock);
+
+    // Dekodieren erst nach dem Freigeben, die Regelung soll nicht warten.
+    if (sealed) decode(block, tier.fields, chunk);
+    return sealed || open;
+}
+
+bool TelemetryHistory::oldest(uint8_t index, uint32_t& timeMs) {
+    if (!_lock || index >= TELEMETRY_TIERS) return false;
+    Tier& tier = _tiers[index];
+    bool found = true;
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    if (tier.blocks > 0) {
+        uint8_t h[TELEMETRY_BLOCK_HEADER];
+        ringRead(tier.ring, tier.size, tier.tail, h, sizeof(h));
+        timeMs = parseHeader(h).start;
+    } else if (tier.openCount > 0) {
+        timeMs = tier.openStart;
+    } else {
+        found = false;
+    }
+    xSemaphoreGive(_lock);
+    return found;
+}
+
+static void writeFieldNames(JsonWriter& json, bool raw) {
+    char name[16];
+    json.beginArray();
+    json.value("t");
+    for (uint8_t c = 0; c < TELEMETRY_CHANNELS; c++) {
+        if (raw) {
+            json.value(kChannelNames[c]);
+            continue;
+        }
+        for (uint8_t s = 0; s < 3; s++) {
+            snprintf(name, sizeof(name), "%s%s", kChannelNames[c], kRollupSuffix[s]);
+            json.value(name);
+        }
+    }
+    json.endArray();
+}
+
+/**
+ * @brief GET /api/robot/history
+ *
+ * Parameter: `res` = raw|1s|10s|1m (Standard: die feinste Stufe, die bis `from`
+ * zurückreicht), `from` = ms seit Start (negativ = relativ zu jetzt, z.B. -600000
+ * für die letzten 10 Minuten), `limit` = Zeilen pro Antwort. Jede Zeile ist
+ * [t, Werte...] in der Reihenfolge von "fields"; "next" ist das `from` für die
+ * nächste Seite.
+ */
+void TelemetryHistory::handleHistory(AsyncWebServerRequest* request) {
+    uint32_t now = millis();
+    uint32_t from = 0;
+    const char* arg = request->argPtr("from");
+    if (arg && *arg == '-') {
+        uint32_t back = strtoul(arg + 1, nullptr, 10);
+        from = back < now ? now - back : 0;
+    } else if (arg) {
+        from = strtoul(arg, nullptr, 10);
+    }
+
+    arg = request->argPtr("limit");
+    uint32_t limit = arg ? strtoul(arg, nullptr, 10) : TELEMETRY_PAGE_DEFAULT;
+    if (limit == 0 || limit > TELEMETRY_PAGE_MAX) limit = TELEMETRY_PAGE_MAX;
+
+    int8_t index = -1;
+    arg = request->argPtr("res");
+    if (arg && *arg && strcmp(arg, "auto") != 0) {
+        uint32_t ms = strtoul(arg, nullptr, 10);
+        for (uint8_t i = 0; i < TELEMETRY_TIERS; i++) {
+            if (strcmp(arg, kTierNames[i]) == 0 || ms == _tiers[i].interval) index = i;
+        }
+        if (index < 0) {
+            request->send(400, "application/json", "{\"ok\":false,\"error\":\"res must be raw, 1s, 10s or 1m\"}");
+            return;
+        }
+    } else {
+        // Feinste Stufe, die den Anfang noch enthält; sonst die gröbste
+        index = TELEMETRY_TIERS - 1;
+        for (uint8_t i = 0; i < TELEMETRY_TIERS; i++) {
+            uint32_t first;
+            if (oldest(i, first) && first <= from) {
+                index = i;
+                break;
+            }
+        }
+    }
+
+    char buffer[512];
+    ResponseWriter out(request, 200, "application/json", buffer, sizeof(buffer));
+    JsonWriter json(out);
+    json.beginObject();
+    json.field("res", _tiers[index].interval);
+    json.field("now", now);
+    json.key("fields");
+    writeFieldNames(json, index == 0);
+    json.key("rows");
+    json.beginArray();
+
+    TelemetryChunk chunk;
+    uint32_t cursor = from;
+    uint32_t emitted = 0;
+    bool more = false;
+    while (!more && fetch(index, cursor, chunk)) {
+        for (uint8_t r = 0; r < chunk.count; r++) {
+            // Eine Zeile steht für [t, t + interval); sie zählt, wenn sie `from` noch überdeckt.
+            uint32_t t = chunk.start + r * chunk.interval;
+            if (t + chunk.interval <= cursor) continue;
+            if (emitted == limit) {
+                more = true;
+                break;
+            }
+            const int16_t* row = chunk.rows + r * chunk.fields;
+            json.beginArray();
+            json.value(t);
+            for (uint8_t f = 0; f < chunk.fields; f++) {
+                int16_t scale = kChannelScale[index == 0 ? f : f / 3];
+                if (scale == 1) json.value((int)row[f]);
+                else json.value((float)row[f] / scale, 2);
+            }
+            json.endArray();
+            emitted++;
+            cursor = t + chunk.interval;
+        }
+        if (!more) cursor = chunk.start + chunk.count * chunk.interval;
+    }
+    json.endArray();
+    json.field("next", cursor);
+    json.field("more", more);
+    json.endObject();
+    out.end();
+}
+
+void TelemetryHistory::handleStats(AsyncWebServerRequest* request) {
+    char buffer[512];
+    ResponseWriter out(request, 200, "application/json", buffer, sizeof(buffer));
+    JsonWriter json(out);
+    writeStatsJson(json);
+    out.end();
+}
+
+void TelemetryHistory::writeStatsJson(JsonWriter& json) {
+    json.beginObject();
+    json.field("samples", _samples);
+    json.field("skipped", _skipped);
+    json.field("ram", (uint32_t)sizeof(*this));
+    json.key("tiers");
+    json.beginArray();
+    for (uint8_t i = 0; i < TELEMETRY_TIERS; i++) {
+        Tier& tier = _tiers[i];
+        uint32_t first = 0;
+        bool any = oldest(i, first);
+
+        xSemaphoreTake(_lock, portMAX_DELAY);
+        uint32_t rows = tier.rows + tier.openCount;
+        uint32_t end = tier.openCount > 0 ? tier.openStart + tier.openCount * tier.interval : 0;
+        uint32_t used = tier.used;
+        uint32_t blocks = tier.blocks;
+        uint32_t evicted = tier.evicted;
+        uint32_t sealedRows = tier.sealedRows;
+        uint32_t sealedBytes = tier.sealedBytes;
+        xSemaphoreGive(_lock);
+
+        json.beginObject();
+        json.field("res", kTierNames[i]);
+        json.field("interval_ms", tier.interval);
+        json.field("rows", rows);
+        json.field("blocks", blocks);
+        json.field("bytes", used);
+        json.field("capacity", tier.size);
+        json.field("oldest", first);
+        json.field("span_ms", any && end > first ? end - first : 0);
+        // Unkomprimiert wären es fields * 2 Bytes pro Zeile
+        json.field("bytes_per_row", sealedRows ? (float)sealedBytes / sealedRows : 0.0f, 2);
+        json.field("raw_bytes_per_row", (uint32_t)(tier.fields * sizeof(int16_t)));
+        json.field("evicted_blocks", evicted);
+        json.endObject();
+    }
+    json.endArray();
+    json.endObject();
+}
@@ -0,0 +1,164 @@
+//================================================================================
+//| DATEI: TelemetryHistory.h                                                    |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Verlauf der Roboter-Telemetrie (Winkel, Fehler, Gyro, Motor) in festem RAM.  |
+//| Die Hauptschleife liest alle 20 ms getCurrentRobotStatus() und legt die      |
+//| Werte in vier Auflösungen ab:                                                |
+//|                                                                              |
+//|   raw  alle 20 ms        die letzten Sekunden                                |
+//|   1s   min/max/mittel    einige Minuten                                      |
+//|   10s  min/max/mittel    rund eine Stunde                                    |
+//|   1m   min/max/mittel    mehrere Stunden                                     |
+//|                                                                              |
+//| KOMPRESSION: Zeilen sammeln sich unkomprimiert in einem offenen Block. Ist   |
+//| er voll, wird er spaltenweise gespeichert (je Spalte Delta zur Vorzeile als  |
+//| Zigzag-Varint) und in den Ringpuffer der Stufe geschrieben. Ist der voll,    |
+//| fallen die ältesten Blöcke heraus. Die Zeit steht nur im Blockkopf, weil     |
+//| die Zeilen eines Blocks lückenlos im Raster der Stufe liegen.                |
+//|                                                                              |
+//| GET /api/robot/history?from=&res= liefert einen Zeitbereich. Gelesen wird    |
+//| blockweise: unter dem Lock wird nur ein Block kopiert, dekodiert wird danach.|
+//================================================================================
+
+#pragma once
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "../Server/AsyncWebServer.h"
+
+class JsonWriter;
+
+#define TELEMETRY_CHANNELS          4      // angle, error, gyro, motor
+#define TELEMETRY_RAW_INTERVAL_MS   20
+#define TELEMETRY_RAW_BLOCK_ROWS    50     // 1 s pro Block
+#define TELEMETRY_ROLLUP_BLOCK_ROWS 16
+#define TELEMETRY_TIERS             4
+
+// RAM für die komprimierten Blöcke je Stufe (fest, wird beim Start nicht allokiert).
+#define TELEMETRY_RAW_BYTES         3072
+#define TELEMETRY_1S_BYTES          8192
+#define TELEMETRY_10S_BYTES         6144
+#define TELEMETRY_1M_BYTES          6144
+
+// Zeilen pro Antwort von /api/robot/history (weiter mit `from=<next>`).
+#define TELEMETRY_PAGE_DEFAULT      300
+#define TELEMETRY_PAGE_MAX          1000
+
+// Spalten einer Zeile: raw = ein Wert je Kanal, Rollup = min/max/mittel je Kanal.
+#define TELEMETRY_MAX_FIELDS        (3 * TELEMETRY_CHANNELS)
+#define TELEMETRY_MAX_BLOCK_ROWS    TELEMETRY_RAW_BLOCK_ROWS
+// Kopf (Länge, Startzeit, Zeilen) plus höchstens 3 Varint-Bytes je int16-Delta
+// (der größte Block ist ein Rohdaten-Block).
+#define TELEMETRY_BLOCK_HEADER      7
+#define TELEMETRY_MAX_BLOCK_BYTES   (TELEMETRY_BLOCK_HEADER + 3 * TELEMETRY_RAW_BLOCK_ROWS * TELEMETRY_CHANNELS)
+
+/**
+ * @brief Ein zusammenhängendes Stück Verlauf (ein Block), bereits dekodiert.
+ */
+struct TelemetryChunk {
+    uint32_t start;             // Zeit der ersten Zeile (ms seit Start)
+    uint32_t interval;          // Abstand der Zeilen
+    uint8_t count;
+    uint8_t fields;
+    int16_t rows[TELEMETRY_MAX_BLOCK_ROWS * TELEMETRY_CHANNELS]; // reicht auch für 16 x 12 Rollup-Werte
+};
+
+/**
+ * @class TelemetryHistory
+ * @brief Mehrstufiger Telemetrie-Verlauf mit festem Speicherbedarf.
+ *
+ * loop() läuft im Task der Regelung und nimmt den Lock nur, wenn er frei ist
+ * (sonst entfällt dieser eine Messwert). Lesende Requests halten den Lock nur
+ * für das Kopieren eines Blocks.
+ */
+class TelemetryHistory {
+public:
+    TelemetryHistory();
+
+    /**
+     * @brief Registriert GET /api/robot/history und /api/robot/history/stats.
+     */
+    void registerRoutes(AsyncWebServer& server);
+
+    /**
+     * @brief Nimmt alle TELEMETRY_RAW_INTERVAL_MS einen Messwert auf. In der
+     * Hauptschleife direkt nach runBalanceLoop() aufrufen.
+     */
+    void loop();
+
+    /**
+     * @brief Legt eine Zeile Rohwerte ab (Zeit im Raster von TELEMETRY_RAW_INTERVAL_MS).
+     * loop() ruft das mit den Werten aus getCurrentRobotStatus() auf.
+     */
+    void record(uint32_t timeMs, float angle, float error, float gyro, int motor);
+
+    /**
+     * @brief Kopiert den ersten Block der Stufe, der Zeilen ab `from` enthält.
+     * @return false, wenn es keine solchen Zeilen gibt.
+     */
+    bool fetch(uint8_t tier, uint32_t from, TelemetryChunk& chunk);
+
+    /**
+     * @brief Zeit der ältesten gespeicherten Zeile einer Stufe.
+     * @return false, wenn die Stufe noch leer ist.
+     */
+    bool oldest(uint8_t tier, uint32_t& timeMs);
+
+    void writeStatsJson(JsonWriter& json);
+
+private:
+    // Eine Auflösungsstufe: Ringpuffer aus komprimierten Blöcken plus offener Block.
+    struct Tier {
+        uint32_t interval;
+        uint8_t fields;
+        uint8_t blockRows;
+        uint8_t* ring;
+        uint32_t size;
+        uint32_t tail;          // Position des ältesten Blocks
+        uint32_t used;
+        uint16_t blocks;
+        uint32_t rows;          // Zeilen in den Blöcken
+        int16_t* open;          // unkomprimierte Zeilen des offenen Blocks
+        uint32_t openStart;
+        uint8_t openCount;
+        uint32_t sealedRows;    // Zähler für die Statistik
+        uint32_t sealedBytes;
+        uint32_t evicted;
+    };
+
+    // Zwischenstand einer Rollup-Stufe (nur im Task von loop()).
+    struct Accumulator {
+        uint32_t period;
+        uint32_t n;
+        int16_t min[TELEMETRY_CHANNELS];
+        int16_t max[TELEMETRY_CHANNELS];
+        int32_t sum[TELEMETRY_CHANNELS];
+    };
+
+    Tier _tiers[TELEMETRY_TIERS];
+    Accumulator _acc[TELEMETRY_TIERS - 1];
+    SemaphoreHandle_t _lock;
+    uint32_t _lastSlot;
+    uint32_t _samples;
+    uint32_t _skipped;          // Lock belegt, Messwert ausgelassen
+
+    uint8_t _rawRing[TELEMETRY_RAW_BYTES];
+    uint8_t _ring1s[TELEMETRY_1S_BYTES];
+    uint8_t _ring10s[TELEMETRY_10S_BYTES];
+    uint8_t _ring1m[TELEMETRY_1M_BYTES];
+    int16_t _rawOpen[TELEMETRY_RAW_BLOCK_ROWS * TELEMETRY_CHANNELS];
+    int16_t _rollupOpen[TELEMETRY_TIERS - 1][TELEMETRY_ROLLUP_BLOCK_ROWS * TELEMETRY_MAX_FIELDS];
+
+    void append(Tier& tier, uint32_t timeMs, const int16_t* row);
+    void seal(Tier& tier);
+    void feed(uint8_t level, uint32_t timeMs, const int16_t* min, const int16_t* max, const int32_t* sum, uint32_t n);
+    void close(uint8_t level);
+    static void decode(const uint8_t* block, uint8_t fields, TelemetryChunk& chunk);
+
+    void handleHistory(AsyncWebServerRequest* request);
+    void handleStats(AsyncWebServerRequest* request);
+};
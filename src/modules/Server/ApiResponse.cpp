@@ -0,0 +1,65 @@
+//================================================================================
+//| DATEI: ApiResponse.cpp                                                       |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Implementiert die Formatauswahl. Alle drei Writer liegen als Member im       |
+//| Objekt (wenige Bytes), aktiv ist nur der ausgewählte - kein Heap.            |
+//================================================================================
+
+#include "ApiResponse.h"
+#include "AsyncWebServer.h"
+
+ApiResponse::ApiResponse(AsyncWebServerRequest* request, char* buffer, size_t capacity, int code)
+    : _format(negotiate(request)),
+      _out(request, code, contentType(_format), buffer, capacity),
+      _json(_out),
+      _cbor(_out),
+      _msgpack(_out) {
+    switch (_format) {
+        case API_FORMAT_CBOR:    _writer = &_cbor; break;
+        case API_FORMAT_MSGPACK: _writer = &_msgpack; break;
+        default:                 _writer = &_json; break;
+    }
+    // Caches und Proxies dürfen die Antwort nur für denselben Accept-Header wiederverwenden.
+    request->addHeader("Vary", "Accept");
+}
+
+const char* ApiResponse::contentType(ApiFormat format) {
+    switch (format) {
+        case API_FORMAT_CBOR:    return "application/cbor";
+        case API_FORMAT_MSGPACK: return "application/msgpack";
+        default:                 return "application/json";
+    }
+}
+
+ApiFormat ApiResponse::negotiate(AsyncWebServerRequest* request) {
+    const char* format = request->argPtr("format");
+    if (format) {
+        if (strcmp(format, "cbor") == 0) return API_FORMAT_CBOR;
+        if (strcmp(format, "msgpack") == 0) return API_FORMAT_MSGPACK;
+        return API_FORMAT_JSON;
+    }
+
+    char accept[128];
+    esp_err_t err = httpd_req_get_hdr_value_str(request->getNativeRequest(), "Accept", accept, sizeof(accept));
+    if (err != ESP_OK && err != ESP_ERR_HTTPD_RESULT_TRUNC) return API_FORMAT_JSON;
+
+    // Der zuerst genannte Typ gewinnt. "msgpack" deckt application/msgpack,
+    // application/x-msgpack und application/vnd.msgpack ab.
+    const char* json = strcasestr(accept, "application/json");
+    const char* cbor = strcasestr(accept, "application/cbor");
+    const char* msgpack = strcasestr(accept, "msgpack");
+
+    ApiFormat best = API_FORMAT_JSON;
+    const char* bestPos = json;
+    if (cbor && (!bestPos || cbor < bestPos)) {
+        best = API_FORMAT_CBOR;
+        bestPos = cbor;
+    }
+    if (msgpack && (!bestPos || msgpack < bestPos)) {
+        best = API_FORMAT_MSGPACK;
+    }
+    return best;
+}
@@ -0,0 +1,65 @@
+//================================================================================
+//| DATEI: ApiResponse.h                                                         |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Antwort einer API-Route im vom Client gewünschten Format. Der Accept-Header  |
+//| (oder ?format=...) entscheidet zwischen JSON, CBOR und MessagePack; der      |
+//| Handler schreibt seine Felder nur einmal gegen die ValueWriter-Schnittstelle.|
+//================================================================================
+
+#pragma once
+
+#include "ResponseWriter.h"
+#include "JsonWriter.h"
+#include "CborWriter.h"
+#include "MsgPackWriter.h"
+
+enum ApiFormat : uint8_t {
+    API_FORMAT_JSON,
+    API_FORMAT_CBOR,
+    API_FORMAT_MSGPACK
+};
+
+/**
+ * @class ApiResponse
+ * @brief ResponseWriter plus passender Serializer, ausgewählt per Content Negotiation.
+ *
+ * Beispiel:
+ *   char buffer[256];
+ *   ApiResponse res(request, buffer, sizeof(buffer));
+ *   ValueWriter& out = res.writer();
+ *   out.beginObject(2);
+ *   out.field("angle", angle, 2);
+ *   out.field("enabled", enabled);
+ *   out.endObject();
+ *   res.end();
+ */
+class ApiResponse {
+public:
+    ApiResponse(AsyncWebServerRequest* request, char* buffer, size_t capacity, int code = 200);
+
+    ValueWriter& writer() { return *_writer; }
+    ApiFormat format() const { return _format; }
+
+    /**
+     * @brief Schließt die Antwort ab und sendet sie.
+     */
+    void end() { _out.end(); }
+
+    /**
+     * @brief Wählt das Format: ?format=json|cbor|msgpack hat Vorrang, sonst gewinnt
+     * der zuerst genannte bekannte Typ im Accept-Header (q-Werte werden ignoriert).
+     */
+    static ApiFormat negotiate(AsyncWebServerRequest* request);
+    static const char* contentType(ApiFormat format);
+
+private:
+    ApiFormat _format;
+    ResponseWriter _out;
+    JsonWriter _json;
+    CborWriter _cbor;
+    MsgPackWriter _msgpack;
+    ValueWriter* _writer;
+};
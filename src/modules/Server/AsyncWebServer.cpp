@@ -17,31 +17,72 @@
 //================================================================================
 
 #include "AsyncWebServer.h"
+#include "ResponseWriter.h"
+#include "MultipartParser.h"
 #include <SPIFFS.h>
+#include <esp_timer.h>
+#include <unistd.h>
 
 // =============================================================
 // === AsyncWebServerRequest Implementation                  ===
 // =============================================================
 
+// Globale Parser-Zähler (siehe getStats()).
+RequestStats AsyncWebServerRequest::_stats = {};
+
 /**
  * @brief Sendet eine einfache Text/HTML Antwort.
  * Konvertiert C++ Strings in die C-Strukturen der ESP-IDF.
  */
 void AsyncWebServerRequest::send(int code, const String& contentType, const String& content) {
-    httpd_resp_set_type(_req, contentType.c_str());
-    
-    // Status Code setzen (String-Konvertierung nötig für native API)
-    char statusStr[16];
-    sprintf(statusStr, "%d", code);
+    sendBuffer(code, contentType.c_str(), content.c_str(), content.length());
+}
+
+void AsyncWebServerRequest::send(int code, const char* contentType, const char* content) {
+    sendBuffer(code, contentType, content, strlen(content));
+}
+
+/**
+ * @brief Gemeinsamer Sendepfad für alle send()-Varianten ohne Datei.
+ */
+void AsyncWebServerRequest::sendBuffer(int code, const char* contentType, const char* data, size_t len) {
+    beginResponse(code, contentType);
+    if (httpd_resp_send(_req, data, len) == ESP_OK) _bytesSent += len;
+    else _sendFailed = true;
+}
+
+/**
+ * @brief Setzt MIME-Type und Status Code der Antwort.
+ */
+void AsyncWebServerRequest::beginResponse(int code, const char* contentType) {
+    httpd_resp_set_type(_req, contentType);
+    _status = code;
     
-    // Gängige Statuscodes mappen
+    // Gängige Statuscodes mappen, alle anderen als Zahl senden.
+    // Der Puffer ist ein Member, da die native API nur den Zeiger speichert.
     if(code == 200) httpd_resp_set_status(_req, "200 OK");
     else if(code == 400) httpd_resp_set_status(_req, "400 Bad Request");
     else if(code == 404) httpd_resp_set_status(_req, "404 Not Found");
+    else if(code == 408) httpd_resp_set_status(_req, "408 Request Timeout");
     else if(code == 500) httpd_resp_set_status(_req, "500 Internal Server Error");
-    else httpd_resp_set_status(_req, statusStr);
+    else {
+        snprintf(_statusStr, sizeof(_statusStr), "%d", code);
+        httpd_resp_set_status(_req, _statusStr);
+    }
+}
 
-    httpd_resp_send(_req, content.c_str(), content.length());
+bool AsyncWebServerRequest::sendChunk(const char* data, size_t len) {
+    if (len == 0) return true; // Ein leerer Chunk würde die Antwort beenden
+    if (httpd_resp_send_chunk(_req, data, len) != ESP_OK) {
+        _sendFailed = true;
+        return false;
+    }
+    _bytesSent += len;
+    return true;
+}
+
+void AsyncWebServerRequest::endResponse() {
+    httpd_resp_send_chunk(_req, NULL, 0);
 }
 
 /**
@@ -67,50 +108,285 @@ void AsyncWebServerRequest::send(fs::FS &fs, const String& path, const String& c
     }
 
     // Chunked Response Loop
+    // Bricht der Client ab, wird nicht weiter gelesen (spart Flash-Zugriffe).
     char buf[1024];
     while(file.available()) {
         size_t len = file.readBytes(buf, sizeof(buf));
-        httpd_resp_send_chunk(_req, buf, len);
+        if (!sendChunk(buf, len)) break;
     }
-    httpd_resp_send_chunk(_req, NULL, 0); // Ende signalisieren (0-Byte Chunk)
+    if (!_sendFailed) endResponse(); // Ende signalisieren (0-Byte Chunk)
     file.close();
 }
 
+// --- Parse-Once Parameter-Zugriff ---
+
+static inline uint8_t hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return c - 'A' + 10;
+}
+
 /**
- * @brief Liest einen GET-Parameter aus der URL.
- * Beispiel: /save?ssid=Test -> arg("ssid") gibt "Test" zurück.
- * Hinweis: Funktioniert aktuell nur für URL-Parameter, nicht für POST-Body-Formulare.
+ * @brief Dekodiert einen URL-codierten, nullterminierten String in-place.
+ * '+' wird zu Leerzeichen, "%XX" zum entsprechenden Byte. Das Ergebnis ist nie
+ * länger als die Eingabe, daher wird kein zusätzlicher Speicher benötigt.
+ * @return Länge des dekodierten Strings.
  */
-String AsyncWebServerRequest::arg(const String& name) {
-    size_t len = httpd_req_get_url_query_len(_req) + 1;
-    if (len > 1) {
-        char* buf = (char*)malloc(len);
-        if (buf) {
-            if (httpd_req_get_url_query_str(_req, buf, len) == ESP_OK) {
-                char val[128];
-                if (httpd_query_key_value(buf, name.c_str(), val, sizeof(val)) == ESP_OK) {
-                    free(buf); 
-                    return String(val);
-                }
+static size_t urlDecodeInPlace(char* s) {
+    char* out = s;
+    for (char* in = s; *in; in++) {
+        if (*in == '+') {
+            *out++ = ' ';
+        } else if (*in == '%' && isxdigit((unsigned char)in[1]) && isxdigit((unsigned char)in[2])) {
+            *out++ = (char)((hexValue(in[1]) << 4) | hexValue(in[2]));
+            in += 2;
+        } else {
+            *out++ = *in;
+        }
+    }
+    *out = '\0';
+    return out - s;
+}
+
+/**
+ * @brief Zerlegt "a=1&b=2" (nullterminiert, liegt im Arena) in Parameter.
+ * Die Trennzeichen werden durch '\0' ersetzt, Name und Wert danach in-place dekodiert.
+ */
+void AsyncWebServerRequest::parseInto(char* buf, size_t len, bool isPost) {
+    char* p = buf;
+    char* end = buf + len;
+    while (p < end) {
+        char* amp = (char*)memchr(p, '&', end - p);
+        char* pairEnd = amp ? amp : end;
+        *pairEnd = '\0';
+
+        if (pairEnd > p) {
+            if (_paramCount >= REQUEST_MAX_PARAMS) {
+                _stats.overflows++;
+                return;
+            }
+            char* eq = (char*)memchr(p, '=', pairEnd - p);
+            char* value = pairEnd; // Ohne '=' ist der Wert leer
+            if (eq) {
+                *eq = '\0';
+                value = eq + 1;
             }
-            free(buf);
+            urlDecodeInPlace(p);
+
+            RequestParam& param = _params[_paramCount++];
+            param.name = p;
+            param.value = value;
+            param.valueLen = (uint16_t)urlDecodeInPlace(value);
+            param.isPost = isPost;
+            _stats.params++;
         }
+        p = pairEnd + 1;
     }
-    return "";
 }
 
-bool AsyncWebServerRequest::hasParam(const String& name, bool post) { 
-    return arg(name) != ""; 
+/**
+ * @brief Liest Query-String und URL-codierten POST-Body genau einmal ins Arena.
+ * Wird beim ersten Parameter-Zugriff automatisch aufgerufen. Passt etwas nicht
+ * ins Arena, wird es verworfen (und gezählt) statt auf den Heap auszuweichen.
+ */
+void AsyncWebServerRequest::parseParams() {
+    if (_parsed) return;
+    _parsed = true;
+    _stats.requests++;
+
+    // 1. Query-String (?x=1&y=2)
+    size_t queryLen = httpd_req_get_url_query_len(_req);
+    if (queryLen > 0) {
+        if (queryLen + 1 > sizeof(_arena) - _arenaUsed) {
+            _stats.overflows++;
+        } else {
+            char* buf = _arena + _arenaUsed;
+            if (httpd_req_get_url_query_str(_req, buf, queryLen + 1) == ESP_OK) {
+                _arenaUsed += queryLen + 1;
+                parseInto(buf, queryLen, false);
+            }
+        }
+    }
+
+    // 2. URL-codierter POST-Body (z.B. kp=1.2&ki=0.01 aus control.html)
+    if (_bodyConsumed || _req->method != HTTP_POST || _req->content_len == 0) return;
+
+    char contentType[64];
+    esp_err_t err = httpd_req_get_hdr_value_str(_req, "Content-Type", contentType, sizeof(contentType));
+    if (err != ESP_OK && err != ESP_ERR_HTTPD_RESULT_TRUNC) return;
+    if (strncasecmp(contentType, "application/x-www-form-urlencoded", 33) != 0) return;
+
+    size_t total = _req->content_len;
+    if (total + 1 > sizeof(_arena) - _arenaUsed) {
+        _stats.overflows++;
+        return;
+    }
+
+    char* buf = _arena + _arenaUsed;
+    size_t received = 0;
+    while (received < total) {
+        int ret = receive(buf + received, total - received);
+        if (ret <= 0) break;
+        received += ret;
+    }
+    _bodyConsumed = true;
+    if (_bodyIncomplete) return; // halbe Formulare nicht auswerten (Dispatcher: 408)
+    buf[received] = '\0';
+    _arenaUsed += received + 1;
+    parseInto(buf, received, true);
+}
+
+int AsyncWebServerRequest::receive(char* buf, size_t len) {
+    int ret = HTTPD_SOCK_ERR_TIMEOUT;
+    for (int tries = 0; tries < REQUEST_RECV_TIMEOUTS && ret == HTTPD_SOCK_ERR_TIMEOUT; tries++) {
+        ret = httpd_req_recv(_req, buf, len);
+    }
+    if (ret <= 0 && !_bodyIncomplete) {
+        _bodyIncomplete = true;
+        if (ret == HTTPD_SOCK_ERR_TIMEOUT) _stats.timeouts++;
+    }
+    return ret;
+}
+
+void AsyncWebServerRequest::beginFormField(const char* name) {
+    parseParams(); // Query-String zuerst, damit er nicht hinter den Feldern landet
+    _formField = -1;
+    size_t nameLen = strlen(name);
+    if (_paramCount >= REQUEST_MAX_PARAMS || nameLen + 2 > sizeof(_arena) - _arenaUsed) {
+        _stats.overflows++;
+        return;
+    }
+    _formMark = _arenaUsed;
+    char* buf = _arena + _arenaUsed;
+    memcpy(buf, name, nameLen + 1);
+    _arenaUsed += nameLen + 1;
+
+    RequestParam& param = _params[_paramCount];
+    param.name = buf;
+    param.value = _arena + _arenaUsed;
+    param.valueLen = 0;
+    param.isPost = true;
+    _formField = (int8_t)_paramCount++;
+}
+
+void AsyncWebServerRequest::appendFormField(const uint8_t* data, size_t len) {
+    if (_formField < 0) return;
+    if (len + 1 > sizeof(_arena) - _arenaUsed) {
+        // Feld zu groß: komplett verwerfen statt abgeschnitten weiterzugeben
+        _paramCount--;
+        _arenaUsed = _formMark;
+        _formField = -1;
+        _stats.overflows++;
+        return;
+    }
+    memcpy(_arena + _arenaUsed, data, len);
+    _arenaUsed += len;
+    _params[_formField].valueLen += len;
+}
+
+void AsyncWebServerRequest::endFormField() {
+    if (_formField < 0) return;
+    _arena[_arenaUsed++] = '\0';
+    _formField = -1;
+    _stats.params++;
+}
+
+/**
+ * @brief Sucht einen Parameter im Arena.
+ * @param postFilter -1 = egal, 0 = nur Query, 1 = nur POST-Body.
+ */
+const RequestParam* AsyncWebServerRequest::findParam(const char* name, int postFilter) {
+    parseParams();
+    for (uint8_t i = 0; i < _paramCount; i++) {
+        if (postFilter >= 0 && _params[i].isPost != (postFilter == 1)) continue;
+        if (strcmp(_params[i].name, name) == 0) return &_params[i];
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Liest einen GET- oder POST-Parameter.
+ * Beispiel: /save?ssid=Test -> arg("ssid") gibt "Test" zurück.
+ */
+String AsyncWebServerRequest::arg(const char* name) {
+    _stats.stringArgs++;
+    const RequestParam* param = findParam(name);
+    return param ? String(param->value) : String();
+}
+
+const char* AsyncWebServerRequest::argPtr(const char* name) {
+    const RequestParam* param = findParam(name);
+    return param ? param->value : nullptr;
+}
+
+long AsyncWebServerRequest::argInt(const char* name, long fallback) {
+    const RequestParam* param = findParam(name);
+    if (!param || param->valueLen == 0) return fallback;
+    return strtol(param->value, nullptr, 10);
+}
+
+float AsyncWebServerRequest::argFloat(const char* name, float fallback) {
+    const RequestParam* param = findParam(name);
+    if (!param || param->valueLen == 0) return fallback;
+    return strtof(param->value, nullptr);
+}
+
+bool AsyncWebServerRequest::argEquals(const char* name, const char* expected) {
+    const RequestParam* param = findParam(name);
+    return param && strcmp(param->value, expected) == 0;
+}
+
+bool AsyncWebServerRequest::hasParam(const char* name, bool post) { 
+    const RequestParam* param = findParam(name, post ? 1 : 0);
+    return param && param->valueLen > 0;
+}
+
+size_t AsyncWebServerRequest::params() {
+    parseParams();
+    return _paramCount;
+}
+
+const RequestParam* AsyncWebServerRequest::getParam(size_t index) {
+    parseParams();
+    return index < _paramCount ? &_params[index] : nullptr;
 }
 
 void AsyncWebServerRequest::addHeader(const String& name, const String& value) {
-    httpd_resp_set_hdr(_req, name.c_str(), value.c_str());
+    size_t nameLen = name.length() + 1;
+    size_t valueLen = value.length() + 1;
+    if (nameLen + valueLen > sizeof(_arena) - _arenaUsed) {
+        _stats.overflows++;
+        return;
+    }
+    char* copy = _arena + _arenaUsed;
+    memcpy(copy, name.c_str(), nameLen);
+    memcpy(copy + nameLen, value.c_str(), valueLen);
+    _arenaUsed += nameLen + valueLen;
+    httpd_resp_set_hdr(_req, copy, copy + nameLen);
+}
+
+void AsyncWebServerRequest::addHeader(const char* name, const char* value) {
+    httpd_resp_set_hdr(_req, name, value);
 }
 
 String AsyncWebServerRequest::url() {
+    _stats.stringArgs++;
     return String(_req->uri);
 }
 
+AsyncWebServer* AsyncWebServerRequest::server() {
+    return (AsyncWebServer*)httpd_get_global_user_ctx(_req->handle);
+}
+
+void AsyncWebServerRequest::defer(std::function<void()> job, uint32_t delayMs) {
+    AsyncWebServer* srv = server();
+    if (srv && srv->defer(job, delayMs)) return;
+
+    // Fallback: Pool voll oder nicht gestartet -> altes, blockierendes Verhalten.
+    if (delayMs > 0) delay(delayMs);
+    job();
+}
+
 // =============================================================
 // === AsyncWebServer Implementation                         ===
 // =============================================================
@@ -119,6 +395,8 @@ AsyncWebServer::AsyncWebServer(int port) : _port(port) {}
 
 AsyncWebServer::~AsyncWebServer() { 
     if(_server) httpd_stop(_server); 
+    // Erst nach httpd_stop(): Danach greift kein Handler mehr auf die Kontexte zu.
+    for (size_t i = 0; i < _routes.size(); i++) delete _routes[i];
 }
 
 /**
@@ -128,7 +406,7 @@ AsyncWebServer::~AsyncWebServer() {
 void AsyncWebServer::begin() {
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
     config.server_port = _port;
-    config.stack_size = 8192; // Erhöhter Stack für JSON/String Operationen
+    config.stack_size = HTTPD_STACK_SIZE; // Erhöhter Stack für JSON/String Operationen
     config.lru_purge_enable = true;
     
     // WICHTIG: Standard ist 8. Das reicht nicht für API + Statische Dateien!
@@ -138,6 +416,17 @@ void AsyncWebServer::begin() {
     // Erlaubt Wildcards wie /api/* oder /*
     config.uri_match_fn = httpd_uri_match_wildcard;
 
+    // Damit Handler über request->server() an den Worker-Pool kommen.
+    // Der Server gehört nicht dem httpd, daher darf httpd_stop() ihn nicht freigeben.
+    config.global_user_ctx = this;
+    config.global_user_ctx_free_fn = noopFree;
+
+    // Zählen offener Sockets für /api/metrics
+    config.open_fn = onOpen;
+    config.close_fn = onClose;
+
+    _workers.begin();
+
     if (httpd_start(&_server, &config) == ESP_OK) {
         Serial.printf("HTTP Server gestartet auf Port %d\n", _port);
     } else {
@@ -153,6 +442,35 @@ void AsyncWebServer::begin() {
  */
 esp_err_t AsyncWebServer::_dispatcher(httpd_req_t *req) {
     RouteContext* ctx = (RouteContext*)req->user_ctx;
+    int64_t startUs = esp_timer_get_time();
+    HeapScope heapScope(ctx->heap);
+
+#if ASYNC_WEB_SERVER_OFFLOAD
+    // --- BULK-Routen (statische Dateien) im Worker-Pool bedienen ---
+    // Der httpd-Task ist danach sofort wieder frei für Steuerbefehle. Nur wenn ein
+    // Slot frei ist, wird der Request kopiert; sonst wird er wie bisher inline bedient.
+    if (ctx->priority == ROUTE_PRIORITY_BULK && ctx->handler && !ctx->uploadHandler && !ctx->bodyHandler) {
+        AsyncWebServer* self = (AsyncWebServer*)httpd_get_global_user_ctx(req->handle);
+        httpd_req_t* asyncReq = nullptr;
+        if (self && self->_workers.freeSlots() > 0 &&
+            httpd_req_async_handler_begin(req, &asyncReq) == ESP_OK) {
+            // Die gemessene Latenz enthält die Wartezeit in der Queue (wie beim Client).
+            bool queued = self->_workers.submit([ctx, asyncReq, startUs]() {
+                runHandler(ctx, asyncReq, startUs);
+                httpd_req_async_handler_complete(asyncReq);
+            }, ROUTE_PRIORITY_BULK);
+            if (!queued) {
+                // Slot wurde zwischenzeitlich belegt: mit der Kopie direkt antworten.
+                runHandler(ctx, asyncReq, startUs);
+                httpd_req_async_handler_complete(asyncReq);
+            } else {
+                self->_workers.asyncRequests++;
+            }
+            return ESP_OK;
+        }
+    }
+#endif
+
     AsyncWebServerRequest wrappedReq(req);
     
     // --- Upload / Body Handling ---
@@ -163,40 +481,191 @@ esp_err_t AsyncWebServer::_dispatcher(httpd_req_t *req) {
         const size_t bufSize = 4096; 
         char* buf = (char*)malloc(bufSize);
         
-        if (!buf) return ESP_ERR_NO_MEM;
+        if (!buf) {
+            AsyncWebServer* self = (AsyncWebServer*)httpd_get_global_user_ctx(req->handle);
+            if (self) self->_metrics.errors.fetch_add(1, std::memory_order_relaxed);
+            return ESP_ERR_NO_MEM;
+        }
+        AsyncWebServerRequest::countHeapAlloc(bufSize);
 
         int ret;
         
         // Upload Loop: Liest Daten in Chunks vom Netzwerk
         if (ctx->uploadHandler && total > 0) {
-             while ((ret = httpd_req_recv(req, buf, bufSize)) > 0) {
-                if (ret == HTTPD_SOCK_ERR_TIMEOUT) continue;
-                
-                // WICHTIG: Wir simulieren hier einen "Raw Upload".
-                // Multipart-Parsing ist komplex und fehleranfällig.
-                // Durch das Senden als "application/octet-stream" im Frontend
-                // landen die reinen Binärdaten hier.
-                ctx->uploadHandler(&wrappedReq, "upload.bin", cur, (uint8_t*)buf, ret, (cur + ret) >= total);
-                cur += ret;
+            char contentType[128];
+            if (httpd_req_get_hdr_value_str(req, "Content-Type", contentType, sizeof(contentType)) == ESP_OK &&
+                MultipartParser::isMultipart(contentType)) {
+                // HTML-Formulare und curl -F: Teile werden direkt aus dem Puffer zerlegt
+                if (!receiveMultipart(ctx, wrappedReq, contentType, buf, bufSize)) {
+                    free(buf);
+                    if (wrappedReq.bodyIncomplete()) wrappedReq.send(408, "text/plain", "Upload incomplete");
+                    else wrappedReq.send(400, "text/plain", "Invalid multipart body");
+                    finishRequest(ctx, wrappedReq, startUs);
+                    return ESP_OK;
+                }
+            } else {
+                // Raw Upload ("application/octet-stream"): der ganze Body ist eine Datei
+                while ((ret = httpd_req_recv(req, buf, bufSize)) > 0) {
+                    ctx->uploadHandler(&wrappedReq, "upload.bin", cur, (uint8_t*)buf, ret, (cur + ret) >= total);
+                    cur += ret;
+                }
+                wrappedReq.markBodyConsumed();
             }
         }
         free(buf);
         
         // Nach dem Upload den Request-Handler aufrufen (z.B. "Update Success" senden)
         if (ctx->handler) ctx->handler(&wrappedReq);
+        finishRequest(ctx, wrappedReq, startUs);
         return ESP_OK;
     }
 
-    // --- Normaler Request (GET/POST ohne Body) ---
+    // --- Normaler Request (GET oder POST mit Formular) ---
     if (ctx->handler) {
-        ctx->handler(&wrappedReq);
+        // Ein Formular-Body, der nicht vollständig ankommt, erreicht den Handler nicht.
+        if (req->method == HTTP_POST && req->content_len > 0 && !wrappedReq.readParams()) {
+            wrappedReq.send(408, "text/plain", "Request body incomplete");
+        } else {
+            ctx->handler(&wrappedReq);
+        }
+        finishRequest(ctx, wrappedReq, startUs);
         return ESP_OK;
     }
+    AsyncWebServer* self = (AsyncWebServer*)httpd_get_global_user_ctx(req->handle);
+    if (self) self->_metrics.errors.fetch_add(1, std::memory_order_relaxed);
     return ESP_FAIL;
 }
 
-void AsyncWebServer::on(const char* uri, int method, std::function<void(AsyncWebServerRequest*)> handler) {
-    on(uri, method, handler, nullptr, nullptr);
+/**
+ * @brief Zerlegt einen multipart/form-data Body, während er vom Socket kommt.
+ * Jede Datei geht mit ihrem echten Dateinamen an den Upload-Handler (index beginnt
+ * pro Datei bei 0, das Ende wird mit len = 0 und final = true gemeldet). Textfelder
+ * landen als POST-Parameter im Arena des Requests.
+ * @return false bei ungültigem Format oder abgebrochener Übertragung (dann ist
+ * bodyIncomplete() gesetzt).
+ */
+bool AsyncWebServer::receiveMultipart(RouteContext* ctx, AsyncWebServerRequest& request, const char* contentType,
+                                      char* buf, size_t bufSize) {
+    MultipartParser parser;
+    if (!parser.begin(contentType)) return false;
+
+    String filename;
+    bool isFile = false;
+    size_t index = 0;
+    parser.onPartBegin([&](const char* name, const char* file, const char*) {
+        isFile = *file != '\0';
+        index = 0;
+        if (isFile) filename = file;
+        else request.beginFormField(name);
+    });
+    parser.onPartData([&](const uint8_t* data, size_t len) {
+        if (isFile) {
+            ctx->uploadHandler(&request, filename, index, (uint8_t*)data, len, false);
+            index += len;
+        } else {
+            request.appendFormField(data, len);
+        }
+    });
+    parser.onPartEnd([&]() {
+        if (isFile) ctx->uploadHandler(&request, filename, index, nullptr, 0, true);
+        else request.endFormField();
+    });
+
+    httpd_req_t* req = request.getNativeRequest();
+    size_t remaining = req->content_len;
+    while (remaining > 0 && !parser.isDone()) {
+        int ret = request.receive(buf, remaining < bufSize ? remaining : bufSize);
+        if (ret <= 0) break; // Client hängt oder ist weg: Upload unvollständig
+        remaining -= ret;
+        if (!parser.feed((const uint8_t*)buf, ret)) break;
+    }
+    // Den Rest (Epilog) verwirft httpd beim Abschluss des Requests selbst.
+    request.markBodyConsumed();
+    return parser.isDone();
+}
+
+/**
+ * @brief Führt den Handler einer Route für einen (ggf. kopierten) Request aus.
+ */
+void AsyncWebServer::runHandler(RouteContext* ctx, httpd_req_t* req, int64_t startUs) {
+    HeapScope heapScope(ctx->heap);
+    AsyncWebServerRequest wrappedReq(req);
+    ctx->handler(&wrappedReq);
+    finishRequest(ctx, wrappedReq, startUs);
+}
+
+/**
+ * @brief Verbucht Status, Bytes und Dauer eines abgeschlossenen Requests.
+ */
+void AsyncWebServer::finishRequest(RouteContext* ctx, AsyncWebServerRequest& request, int64_t startUs) {
+    httpd_req_t* req = request.getNativeRequest();
+    uint32_t durationUs = (uint32_t)(esp_timer_get_time() - startUs);
+    ctx->metrics.record(request.responseStatus(), req->content_len, request.bytesSent(), durationUs);
+    if (request.sendFailed()) {
+        AsyncWebServer* self = (AsyncWebServer*)httpd_get_global_user_ctx(req->handle);
+        if (self) self->_metrics.errors.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+esp_err_t AsyncWebServer::onOpen(httpd_handle_t hd, int sockfd) {
+    AsyncWebServer* self = (AsyncWebServer*)httpd_get_global_user_ctx(hd);
+    if (self) {
+        self->_metrics.openSockets.fetch_add(1, std::memory_order_relaxed);
+        self->_metrics.connections.fetch_add(1, std::memory_order_relaxed);
+    }
+    return ESP_OK;
+}
+
+void AsyncWebServer::onClose(httpd_handle_t hd, int sockfd) {
+    AsyncWebServer* self = (AsyncWebServer*)httpd_get_global_user_ctx(hd);
+    if (self) self->_metrics.openSockets.fetch_sub(1, std::memory_order_relaxed);
+    // Mit gesetztem close_fn schließt httpd den Socket nicht mehr selbst.
+    close(sockfd);
+}
+
+/**
+ * @brief Gibt alle Metriken im Prometheus-Textformat aus.
+ * Jede Metrik-Familie bekommt einmal HELP/TYPE, danach folgen die Zeilen aller Routen.
+ */
+void AsyncWebServer::writeMetrics(ResponseWriter& out) {
+    static const char* const names[ROUTE_METRIC_FAMILIES] = {
+        "http_requests_total", "http_request_bytes_total",
+        "http_response_bytes_total", "http_request_duration_seconds"
+    };
+    static const char* const types[ROUTE_METRIC_FAMILIES] = {"counter", "counter", "counter", "histogram"};
+    static const char* const help[ROUTE_METRIC_FAMILIES] = {
+        "Bearbeitete Requests nach Route und Statusklasse.",
+        "Empfangene Body-Bytes nach Route.",
+        "Gesendete Antwort-Bytes nach Route.",
+        "Bearbeitungsdauer nach Route (inkl. Wartezeit im Worker-Pool)."
+    };
+
+    for (uint8_t family = 0; family < ROUTE_METRIC_FAMILIES; family++) {
+        writeMetricHeader(out, names[family], types[family], help[family]);
+        for (size_t i = 0; i < _routes.size(); i++) {
+            const RouteContext* ctx = _routes[i];
+            writeRouteMetrics(out, family, ctx->uri, http_method_str((enum http_method)ctx->method), ctx->metrics);
+        }
+    }
+
+    writeMetricHeader(out, "http_open_sockets", "gauge", "Aktuell offene Client-Sockets.");
+    out.print("http_open_sockets ");
+    out.print(_metrics.openSockets.load(std::memory_order_relaxed));
+    out.write('\n');
+    writeMetricHeader(out, "http_connections_total", "counter", "Angenommene Verbindungen seit dem Start.");
+    out.print("http_connections_total ");
+    out.print(_metrics.connections.load(std::memory_order_relaxed));
+    out.write('\n');
+    writeMetricHeader(out, "http_errors_total", "counter", "Dispatcher-Fehler und abgebrochene Antworten.");
+    out.print("http_errors_total ");
+    out.print(_metrics.errors.load(std::memory_order_relaxed));
+    out.write('\n');
+}
+
+void AsyncWebServer::on(const char* uri, int method, std::function<void(AsyncWebServerRequest*)> handler,
+        RoutePriority priority) {
+    if (!_server) return;
+    addRoute(uri, method, new RouteContext{handler, nullptr, nullptr, priority});
 }
 
 /**
@@ -210,9 +679,19 @@ void AsyncWebServer::on(const char* uri, int method,
     if (!_server) return;
     
     // Context muss auf dem Heap bleiben, da der Server asynchron darauf zugreift.
-    // (Wird aktuell nicht gelöscht -> Memory Leak bei Server-Neustart, aber okay für Embedded Dauerlauf)
-    RouteContext* ctx = new RouteContext{onRequest, onBody, onUpload};
-    
+    // Er gehört danach dem Server (_routes) und wird im Destruktor freigegeben.
+    // Uploads lesen den Socket selbst und laufen daher immer im httpd-Task.
+    addRoute(uri, method, new RouteContext{onRequest, onBody, onUpload, ROUTE_PRIORITY_CONTROL});
+}
+
+void AsyncWebServer::addRoute(const char* uri, int method, RouteContext* ctx) {
+    // Workaround: HTTP_ANY mappen wir auf GET, da native API explizit sein will.
+    if (method == HTTP_ANY) method = HTTP_GET;
+    ctx->uri = uri;
+    ctx->method = method;
+    ctx->heap.name = uri;
+    ctx->heap.method = method;
+
     httpd_uri_t route = {
         .uri = uri,
         .method = (httpd_method_t)method,
@@ -220,15 +699,14 @@ void AsyncWebServer::on(const char* uri, int method,
         .user_ctx = ctx
     };
     
-    // Workaround: HTTP_ANY mappen wir auf GET, da native API explizit sein will.
-    if (method == HTTP_ANY) route.method = HTTP_GET;
-    
     // WICHTIG: Rückgabewert prüfen! Hilft beim Debuggen von "URI does not exist".
     esp_err_t err = httpd_register_uri_handler(_server, &route);
     if (err != ESP_OK) {
         Serial.printf("FEHLER: Konnte Route '%s' nicht registrieren! Fehlercode: %d\n", uri, err);
         delete ctx; 
     } else {
+        _routes.push_back(ctx);
+        HeapTrace::addRoute(ctx->heap);
         Serial.printf("Route registriert: %s\n", uri);
     }
 }
@@ -244,7 +722,7 @@ void AsyncWebServer::onNotFound(std::function<void(AsyncWebServerRequest*)> hand
  */
 void AsyncWebServer::serveStatic(const char* uri, fs::FS& fs, const char* path) {
     // 1. Der Handler-Code (wird für beide Routen verwendet)
-    auto handlerFunc = [path](AsyncWebServerRequest* req) {
+    auto handlerFunc = [this, path](AsyncWebServerRequest* req) {
         String url = req->url();
         
         // --- FIX: Query-Parameter (alles ab ?) entfernen ---
@@ -271,31 +749,38 @@ void AsyncWebServer::serveStatic(const char* uri, fs::FS& fs, const char* path)
             else if(filePath.endsWith(".ico")) contentType = "image/x-icon";
             else if(filePath.endsWith(".json")) contentType = "application/json";
             
+            // HTML-Dateien laufen über die Template-Engine, sofern ein Prozessor gesetzt ist.
+            if (_templateProcessor && contentType == "text/html") {
+                HtmlTemplate* tpl = _templates.get(SPIFFS, filePath);
+                if (tpl && tpl->hasPlaceholders()) {
+                    tpl->send(req, SPIFFS, contentType.c_str(), _templateProcessor);
+                    return;
+                }
+            }
             req->send(SPIFFS, filePath, contentType);
         } else {
             req->send(404, "text/plain", "File not found");
         }
     };
 
-    // 2. Context erstellen
-    RouteContext* ctx = new RouteContext();
-    ctx->handler = handlerFunc;
+    // Templates schon beim Start kompilieren, damit der erste Abruf nicht scannen muss.
+    if (_templateProcessor) {
+        File root = fs.open(path);
+        File entry = root ? root.openNextFile() : File();
+        while (entry) {
+            String entryPath = entry.path();
+            if (!entry.isDirectory() && entryPath.endsWith(".html")) {
+                _templates.get(fs, entryPath);
+            }
+            entry = root.openNextFile();
+        }
+    }
 
-    // 3. Route für GENAU "/" registrieren (Wichtig für Root-Aufruf)
-    httpd_uri_t rootRoute = {
-        .uri = "/",
-        .method = HTTP_GET,
-        .handler = _dispatcher,
-        .user_ctx = ctx
-    };
-    httpd_register_uri_handler(_server, &rootRoute);
+    // 2. Route für GENAU "/" registrieren (Wichtig für Root-Aufruf)
+    // Dateien sind BULK: Sie werden (ab IDF 5.1) im Worker-Pool gestreamt.
+    // Jede Route bekommt einen eigenen Kontext, damit die Metriken getrennt bleiben.
+    on("/", HTTP_GET, handlerFunc, ROUTE_PRIORITY_BULK);
 
-    // 4. Route für ALLES ANDERE "/*" registrieren (Catch-All)
-    httpd_uri_t wildcardRoute = {
-        .uri = "/*",
-        .method = HTTP_GET,
-        .handler = _dispatcher,
-        .user_ctx = ctx
-    };
-    httpd_register_uri_handler(_server, &wildcardRoute);
+    // 3. Route für ALLES ANDERE "/*" registrieren (Catch-All)
+    on("/*", HTTP_GET, handlerFunc, ROUTE_PRIORITY_BULK);
 }
\ No newline at end of file
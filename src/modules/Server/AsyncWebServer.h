@@ -20,24 +20,82 @@
 
 #include <Arduino.h>
 #include <esp_http_server.h>
+#include <esp_idf_version.h>
 #include <FS.h>
 #include <functional>
+#include <vector>
+#include "TemplateEngine.h"
+#include "WorkerPool.h"
+#include "RouteMetrics.h"
+#include "../System/HeapTrace.h"
 
 // Mapping der HTTP Methoden für Kompatibilität zur Arduino-Welt
 #define HTTP_ANY    -1
 
+// Größe des Request-Arenas (liegt auf dem Stack des httpd-Tasks, nicht auf dem Heap).
+// Nimmt Query-String, URL-codierten POST-Body und die dekodierten Parameter auf.
+#define REQUEST_ARENA_SIZE  768
+// Maximale Anzahl an Parametern (Query + POST) pro Request.
+#define REQUEST_MAX_PARAMS  16
+// Timeouts in Folge (je recv_wait_timeout), nach denen ein Body als unvollständig gilt.
+#define REQUEST_RECV_TIMEOUTS 3
+// Stack des httpd-Tasks (Reserve zeigt GET /api/system/tasks).
+#define HTTPD_STACK_SIZE    8192
+
+// Echte Auslagerung von Requests in den Worker-Pool gibt es erst ab ESP-IDF 5.1
+// (httpd_req_async_handler_begin). Ältere Cores bedienen BULK-Routen weiter im httpd-Task.
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 1, 0)
+#define ASYNC_WEB_SERVER_OFFLOAD  1
+#else
+#define ASYNC_WEB_SERVER_OFFLOAD  0
+#endif
+
+class AsyncWebServer;
 class AsyncWebServerRequest;
+class ResponseWriter;
+
+/**
+ * @brief Ein einzelner, bereits dekodierter Request-Parameter.
+ * Name und Wert zeigen direkt in das Arena des Requests (keine Kopie, kein Heap).
+ */
+struct RequestParam {
+    const char* name;
+    const char* value;
+    uint16_t valueLen;
+    bool isPost;        // true = stammt aus dem URL-codierten POST-Body
+};
+
+/**
+ * @brief Globale Zähler für die Parameter-Verarbeitung.
+ * Damit lässt sich nachweisen, dass die heißen API-Routen keinen Heap anfassen.
+ */
+struct RequestStats {
+    uint32_t requests;      // Anzahl geparster Requests
+    uint32_t params;        // Anzahl dekodierter Parameter
+    uint32_t heapAllocs;    // malloc()-Aufrufe des Wrappers (z.B. Upload-Puffer)
+    uint32_t heapBytes;     // Summe der dabei angeforderten Bytes
+    uint32_t stringArgs;    // Aufrufe von arg()/url(), die einen Heap-String erzeugen können
+    uint32_t overflows;     // Parameter/Body, die nicht mehr ins Arena gepasst haben
+    uint32_t timeouts;      // Bodys, die nach REQUEST_RECV_TIMEOUTS abgebrochen wurden
+};
 
 /**
  * @brief Kontext-Struktur für die Callbacks.
  * Da die native C-API (esp_http_server) keine C++ Lambda-Funktionen mit Capture
  * speichern kann, nutzen wir diese Struktur als "User Context".
  * Der statische Dispatcher holt sich diese Struktur und ruft die C++ Funktionen auf.
+ * Nebenbei trägt sie die Messwerte der Route (siehe /api/metrics) und ihre
+ * Heap-Zähler.
  */
 struct RouteContext {
     std::function<void(AsyncWebServerRequest*)> handler;
     std::function<void(AsyncWebServerRequest*, uint8_t*, size_t, size_t, size_t)> bodyHandler;
     std::function<void(AsyncWebServerRequest*, String, size_t, uint8_t*, size_t, bool)> uploadHandler;
+    RoutePriority priority;
+    const char* uri;        // wird von addRoute() gesetzt
+    int method;
+    RouteMetrics metrics;
+    HeapCounters heap;      // Allokationen während der Handler läuft (/api/system/heap)
 };
 
 /**
@@ -60,6 +118,33 @@ public:
      * @param content Der eigentliche Inhalt als String.
      */
     void send(int code, const String& contentType, const String& content);
+
+    /**
+     * @brief Allokationsfreie Variante für konstante Texte (z.B. send(200, "text/plain", "OK")).
+     */
+    void send(int code, const char* contentType, const char* content);
+
+    /**
+     * @brief Sendet einen fertigen Puffer mit bekannter Länge (kein String nötig).
+     */
+    void sendBuffer(int code, const char* contentType, const char* data, size_t len);
+
+    /**
+     * @brief Setzt Status und MIME-Type für eine Antwort, die in Chunks gesendet wird.
+     * Muss vor dem ersten sendChunk() aufgerufen werden.
+     */
+    void beginResponse(int code, const char* contentType);
+
+    /**
+     * @brief Sendet einen Teil der Antwort (Chunked Transfer Encoding).
+     * @return false, wenn der Client die Verbindung getrennt hat.
+     */
+    bool sendChunk(const char* data, size_t len);
+
+    /**
+     * @brief Schließt eine Chunked-Antwort ab (0-Byte Chunk).
+     */
+    void endResponse();
     
     /**
      * @brief Sendet eine Datei aus dem Dateisystem (SPIFFS/LittleFS).
@@ -72,21 +157,58 @@ public:
     void send(fs::FS &fs, const String& path, const String& contentType, bool download = false);
 
     /**
-     * @brief Ruft einen URL-Parameter ab (z.B. ?id=123).
+     * @brief Ruft einen URL- oder POST-Parameter ab (z.B. ?id=123).
+     * Erzeugt einen Arduino-String. Für heiße Pfade besser argPtr()/argInt() nutzen.
      * @param name Name des Parameters.
      * @return Wert des Parameters oder leerer String.
      */
-    String arg(const String& name);
+    String arg(const char* name);
+    String arg(const String& name) { return arg(name.c_str()); }
+
+    /**
+     * @brief Gibt den dekodierten Wert als nullterminierten C-String zurück.
+     * Der Zeiger zeigt in das Arena und ist bis zum Ende des Requests gültig.
+     * @return Wert oder nullptr, wenn der Parameter fehlt.
+     */
+    const char* argPtr(const char* name);
+
+    /**
+     * @brief Liest einen Parameter als Ganzzahl.
+     * @param fallback Rückgabewert, wenn der Parameter fehlt oder leer ist.
+     */
+    long argInt(const char* name, long fallback = 0);
+
+    /**
+     * @brief Liest einen Parameter als Fließkommazahl.
+     * @param fallback Rückgabewert, wenn der Parameter fehlt oder leer ist.
+     */
+    float argFloat(const char* name, float fallback = 0.0f);
 
     /**
-     * @brief Prüft, ob ein Parameter existiert.
+     * @brief Vergleicht einen Parameter ohne String-Kopie (z.B. argEquals("cmd", "enable")).
      */
-    bool hasParam(const String& name, bool post = false);
+    bool argEquals(const char* name, const char* expected);
+
+    /**
+     * @brief Prüft, ob ein (nicht leerer) Parameter existiert.
+     * @param post true = nur im POST-Body suchen, false = nur im Query-String.
+     */
+    bool hasParam(const char* name, bool post = false);
+    bool hasParam(const String& name, bool post = false) { return hasParam(name.c_str(), post); }
+
+    /**
+     * @brief Anzahl und Zugriff auf alle geparsten Parameter.
+     */
+    size_t params();
+    const RequestParam* getParam(size_t index);
 
     /**
      * @brief Fügt einen HTTP-Header zur Antwort hinzu.
+     * httpd merkt sich nur die Zeiger bis zum Senden. Die String-Variante kopiert
+     * daher ins Arena, die const char*-Variante ist für Literale gedacht.
      */
     void addHeader(const String& name, const String& value);
+    void addHeader(const char* name, const char* value);
 
     /**
      * @brief Gibt die angeforderte URL zurück.
@@ -98,8 +220,98 @@ public:
      */
     httpd_req_t* getNativeRequest() { return _req; }
 
+    /**
+     * @brief Liefert den Server, zu dem dieser Request gehört (oder nullptr).
+     */
+    AsyncWebServer* server();
+
+    /**
+     * @brief Führt eine Aktion erst nach der Antwort aus, ohne den httpd-Task zu blockieren.
+     * Ersetzt das Muster "send(); delay(1000); ESP.restart();". Ist der Worker-Pool
+     * nicht verfügbar, wird die Aktion wie bisher direkt (mit delay) ausgeführt.
+     * @param delayMs Wartezeit, damit die Antwort den Browser sicher erreicht.
+     */
+    void defer(std::function<void()> job, uint32_t delayMs = 0);
+
+    /**
+     * @brief Liest den nächsten Teil des Bodys wie httpd_req_recv(). Ein Timeout wird
+     * höchstens REQUEST_RECV_TIMEOUTS-mal in Folge wiederholt; danach (oder bei
+     * geschlossener Verbindung) gilt der Body als unvollständig.
+     * @return Gelesene Bytes oder <= 0, wenn nichts mehr kommt.
+     */
+    int receive(char* buf, size_t len);
+
+    /**
+     * @brief true, wenn der Body nicht vollständig angekommen ist (siehe receive()).
+     */
+    bool bodyIncomplete() const { return _bodyIncomplete; }
+
+    /**
+     * @brief Liest Query-String und URL-codierten POST-Body sofort statt beim ersten
+     * Parameterzugriff (der Dispatcher kann so mit 408 antworten, bevor der Handler läuft).
+     * @return false, wenn der Body nicht vollständig angekommen ist.
+     */
+    bool readParams() {
+        parseParams();
+        return !_bodyIncomplete;
+    }
+
+    /**
+     * @brief Markiert den Body als bereits gelesen (z.B. durch den Upload-Loop).
+     * Danach wird er beim Parsen nicht mehr vom Socket gelesen.
+     */
+    void markBodyConsumed() { _bodyConsumed = true; }
+
+    /**
+     * @brief Legt ein Textfeld aus einem multipart/form-data Body als POST-Parameter
+     * ins Arena (wird vom Upload-Loop aufgerufen). Passt es nicht, wird es verworfen.
+     */
+    void beginFormField(const char* name);
+    void appendFormField(const uint8_t* data, size_t len);
+    void endFormField();
+
+    /**
+     * @brief Gesendeter Statuscode, Anzahl gesendeter Bytes und Sendefehler (für die Metriken).
+     */
+    int responseStatus() const { return _status; }
+    size_t bytesSent() const { return _bytesSent; }
+    bool sendFailed() const { return _sendFailed; }
+
+    /**
+     * @brief Liefert die globalen Parser-Zähler.
+     */
+    static const RequestStats& getStats() { return _stats; }
+    static void countHeapAlloc(size_t bytes) { _stats.heapAllocs++; _stats.heapBytes += bytes; }
+
 private:
     httpd_req_t* _req;
+
+    // Puffer für nicht gemappte Statuscodes (httpd speichert nur den Zeiger).
+    char _statusStr[16];
+
+    // Antwort-Buchhaltung für RouteMetrics
+    int _status = 200;
+    size_t _bytesSent = 0;
+    bool _sendFailed = false;
+
+    // --- Parse-Once Zustand ---
+    // Query-String und POST-Body werden genau einmal (beim ersten Zugriff) gelesen
+    // und in-place dekodiert. Alle Parameter zeigen danach in dieses Arena.
+    char _arena[REQUEST_ARENA_SIZE];
+    size_t _arenaUsed = 0;
+    RequestParam _params[REQUEST_MAX_PARAMS];
+    uint8_t _paramCount = 0;
+    bool _parsed = false;
+    bool _bodyConsumed = false;
+    bool _bodyIncomplete = false;
+    int8_t _formField = -1;     // Index des gerade empfangenen Formularfelds
+    size_t _formMark = 0;       // Arena-Stand vor diesem Feld (für das Verwerfen)
+
+    static RequestStats _stats;
+
+    void parseParams();
+    void parseInto(char* buf, size_t len, bool isPost);
+    const RequestParam* findParam(const char* name, int postFilter = -1);
 };
 
 /**
@@ -125,8 +337,10 @@ public:
      * @param uri Der Pfad (z.B. "/api/status").
      * @param method HTTP Methode (HTTP_GET, HTTP_POST, HTTP_ANY).
      * @param handler Die Funktion, die aufgerufen wird.
+     * @param priority CONTROL = direkt im httpd-Task, BULK = im Worker-Pool (sofern möglich).
      */
-    void on(const char* uri, int method, std::function<void(AsyncWebServerRequest*)> handler);
+    void on(const char* uri, int method, std::function<void(AsyncWebServerRequest*)> handler,
+            RoutePriority priority = ROUTE_PRIORITY_CONTROL);
 
     /**
      * @brief Registriert einen erweiterten Handler für Datei-Uploads.
@@ -150,6 +364,36 @@ public:
      */
     void serveStatic(const char* uri, fs::FS& fs, const char* path);
 
+    /**
+     * @brief Aktiviert Platzhalter (%NAME%) für alle statisch ausgelieferten HTML-Dateien.
+     * Jede Datei wird beim ersten Abruf einmalig kompiliert und danach gestreamt.
+     * @param processor Liefert den Wert zu einem Platzhalter-Namen.
+     */
+    void setTemplateProcessor(TemplateProcessor processor) { _templateProcessor = processor; }
+
+    /**
+     * @brief Verwirft alle kompilierten Templates (nach Änderungen im Dateisystem).
+     */
+    void invalidateTemplates() { _templates.invalidate(); }
+
+    /**
+     * @brief Reiht eine Aktion in den Worker-Pool ein.
+     * @return false, wenn kein Slot frei ist (Aufrufer entscheidet über den Fallback).
+     */
+    bool defer(std::function<void()> job, uint32_t delayMs = 0, RoutePriority priority = ROUTE_PRIORITY_CONTROL) {
+        return _workers.submit(job, priority, delayMs);
+    }
+
+    /**
+     * @brief Zugriff auf den Worker-Pool (z.B. für die Statistik).
+     */
+    WorkerPool& workers() { return _workers; }
+
+    /**
+     * @brief Schreibt alle Routen- und Server-Metriken im Prometheus-Textformat.
+     */
+    void writeMetrics(ResponseWriter& out);
+
     /**
      * @brief Handler für nicht gefundene Seiten (404).
      * Hinweis: In der nativen API oft durch Wildcard-Routen gelöst.
@@ -159,6 +403,17 @@ public:
 private:
     int _port;
     httpd_handle_t _server = nullptr;
+
+    // Platzhalter-Templates für statische HTML-Dateien
+    TemplateProcessor _templateProcessor;
+    TemplateCache _templates;
+
+    // Worker-Tasks für verzögerte Aktionen und ausgelagerte BULK-Requests
+    WorkerPool _workers;
+
+    // Alle registrierten Routen (besitzt die Kontexte, Quelle für /api/metrics)
+    std::vector<RouteContext*> _routes;
+    ServerMetrics _metrics;
     
     /**
      * @brief Statische Dispatcher-Funktion.
@@ -166,4 +421,12 @@ private:
      * und den C++ Member-Funktionen/Lambdas.
      */
     static esp_err_t _dispatcher(httpd_req_t *req);
+    static void runHandler(RouteContext* ctx, httpd_req_t* req, int64_t startUs);
+    static void finishRequest(RouteContext* ctx, AsyncWebServerRequest& request, int64_t startUs);
+    static bool receiveMultipart(RouteContext* ctx, AsyncWebServerRequest& request, const char* contentType,
+                                 char* buf, size_t bufSize);
+    static esp_err_t onOpen(httpd_handle_t hd, int sockfd);
+    static void onClose(httpd_handle_t hd, int sockfd);
+    void addRoute(const char* uri, int method, RouteContext* ctx);
+    static void noopFree(void*) {}
 };
\ No newline at end of file
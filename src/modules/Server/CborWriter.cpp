@@ -0,0 +1,105 @@
+//================================================================================
+//| DATEI: CborWriter.cpp                                                        |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Implementiert den CBOR-Writer. Jedes Element beginnt mit einem Header-Byte   |
+//| (Major-Type in den oberen 3 Bit), gefolgt von 0, 1, 2, 4 oder 8 Bytes Länge  |
+//| bzw. Wert in Big-Endian - es wird immer die kürzeste Form gewählt.           |
+//================================================================================
+
+#include "CborWriter.h"
+
+static const uint8_t CBOR_UNSIGNED = 0;
+static const uint8_t CBOR_NEGATIVE = 1;
+static const uint8_t CBOR_TEXT = 3;
+static const uint8_t CBOR_ARRAY = 4;
+static const uint8_t CBOR_MAP = 5;
+
+void CborWriter::writeHead(uint8_t major, unsigned long long value) {
+    char head[9];
+    uint8_t extra;
+    uint8_t type = major << 5;
+    if (value < 24) {
+        _out.write((char)(type | value));
+        return;
+    } else if (value <= 0xFF) {
+        head[0] = type | 24;
+        extra = 1;
+    } else if (value <= 0xFFFF) {
+        head[0] = type | 25;
+        extra = 2;
+    } else if (value <= 0xFFFFFFFFULL) {
+        head[0] = type | 26;
+        extra = 4;
+    } else {
+        head[0] = type | 27;
+        extra = 8;
+    }
+    for (uint8_t i = 0; i < extra; i++) {
+        head[extra - i] = (char)(value >> (8 * i));
+    }
+    _out.write(head, extra + 1);
+}
+
+void CborWriter::begin(uint8_t major, size_t count) {
+    if (_depth < 31) _depth++;
+    uint32_t bit = 1UL << _depth;
+    if (count == VALUE_COUNT_UNKNOWN) {
+        _out.write((char)((major << 5) | 31));
+        _indefinite |= bit;
+    } else {
+        writeHead(major, count);
+        _indefinite &= ~bit;
+    }
+}
+
+void CborWriter::end() {
+    if (_indefinite & (1UL << _depth)) _out.write((char)0xFF);
+    if (_depth > 0) _depth--;
+}
+
+void CborWriter::beginObject(size_t count) { begin(CBOR_MAP, count); }
+void CborWriter::endObject() { end(); }
+void CborWriter::beginArray(size_t count) { begin(CBOR_ARRAY, count); }
+void CborWriter::endArray() { end(); }
+
+void CborWriter::key(const char* name) {
+    value(name);
+}
+
+void CborWriter::value(const char* text) {
+    if (!text) {
+        nullValue();
+        return;
+    }
+    size_t len = strlen(text);
+    writeHead(CBOR_TEXT, len);
+    _out.write(text, len);
+}
+
+void CborWriter::value(bool flag) {
+    _out.write((char)(flag ? 0xF5 : 0xF4));
+}
+
+void CborWriter::value(long long number) {
+    // Negative Zahlen werden als (-1 - n) gespeichert, damit kein Wert doppelt belegt ist.
+    if (number < 0) writeHead(CBOR_NEGATIVE, (unsigned long long)(-(number + 1)));
+    else writeHead(CBOR_UNSIGNED, (unsigned long long)number);
+}
+
+void CborWriter::value(unsigned long long number) {
+    writeHead(CBOR_UNSIGNED, number);
+}
+
+void CborWriter::value(float number, uint8_t) {
+    uint32_t bits;
+    memcpy(&bits, &number, sizeof(bits));
+    char buf[5] = {(char)0xFA, (char)(bits >> 24), (char)(bits >> 16), (char)(bits >> 8), (char)bits};
+    _out.write(buf, sizeof(buf));
+}
+
+void CborWriter::nullValue() {
+    _out.write((char)0xF6);
+}
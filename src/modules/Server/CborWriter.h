@@ -0,0 +1,55 @@
+//================================================================================
+//| DATEI: CborWriter.h                                                          |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Streaming-Writer für CBOR (RFC 8949, "application/cbor"). Zahlen werden      |
+//| binär statt als Text übertragen, Schlüssel und Strings mit Längenpräfix -    |
+//| der Client muss weder Ziffern noch Escapes parsen.                           |
+//================================================================================
+
+#pragma once
+
+#include "ResponseWriter.h"
+#include "ValueWriter.h"
+
+/**
+ * @class CborWriter
+ * @brief Schreibt CBOR direkt in einen ResponseWriter (kein Dokument im RAM).
+ *
+ * Ist die Anzahl bei beginObject()/beginArray() bekannt, wird ein Header mit
+ * Länge geschrieben, sonst die "indefinite length"-Form mit Abschluss-Byte 0xFF.
+ * Fließkommazahlen werden als float32 übertragen.
+ */
+class CborWriter : public ValueWriter {
+public:
+    explicit CborWriter(ResponseWriter& out) : _out(out), _depth(0), _indefinite(0) {}
+
+    using ValueWriter::value;
+
+    void beginObject(size_t count = VALUE_COUNT_UNKNOWN) override;
+    void endObject() override;
+    void beginArray(size_t count = VALUE_COUNT_UNKNOWN) override;
+    void endArray() override;
+    void key(const char* name) override;
+
+    void value(const char* text) override;
+    void value(bool flag) override;
+    void value(long number) override { value((long long)number); }
+    void value(unsigned long number) override { value((unsigned long long)number); }
+    void value(long long number) override;
+    void value(unsigned long long number) override;
+    void value(float number, uint8_t decimals = 2) override;
+    void nullValue() override;
+
+private:
+    ResponseWriter& _out;
+    uint8_t _depth;
+    // Bit n = Ebene n wurde ohne Länge begonnen und braucht ein 0xFF am Ende.
+    uint32_t _indefinite;
+
+    void writeHead(uint8_t major, unsigned long long value);
+    void begin(uint8_t major, size_t count);
+    void end();
+};
@@ -0,0 +1,242 @@
+//================================================================================
+//| DATEI: DeltaPatcher.cpp                                                      |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Implementiert den Patch-Parser als Zustandsmaschine. Neue Bytes (ADD und     |
+//| Korrekturen) gehen direkt aus dem Empfangspuffer an Update.write(), alte     |
+//| Bytes werden in 512-Byte-Stücken aus der laufenden Partition gelesen. Der    |
+//| RAM-Bedarf ist damit unabhängig von der Größe des Images.                    |
+//================================================================================
+
+#include "DeltaPatcher.h"
+#include <Update.h>
+#include <esp_ota_ops.h>
+
+DeltaPatcher::DeltaPatcher()
+    : _state(STATE_HEADER), _error(nullptr), _updateStarted(false), _headerLen(0), _varint(0), _shift(0),
+      _oldSize(0), _newSize(0), _written(0), _remaining(0), _copyOffset(0), _copyLeft(0), _oldPartition(nullptr) {
+    mbedtls_sha256_init(&_sha);
+}
+
+DeltaPatcher::~DeltaPatcher() {
+    mbedtls_sha256_free(&_sha);
+}
+
+void DeltaPatcher::begin() {
+    abort();
+    _state = STATE_HEADER;
+    _error = nullptr;
+    _headerLen = 0;
+    _varint = 0;
+    _shift = 0;
+    _oldSize = _newSize = _written = 0;
+    _remaining = _copyOffset = _copyLeft = 0;
+    _oldPartition = nullptr;
+}
+
+void DeltaPatcher::abort() {
+    if (_updateStarted) {
+        Update.abort();
+        _updateStarted = false;
+    }
+}
+
+bool DeltaPatcher::fail(const char* reason) {
+    if (!_error) {
+        _error = reason;
+        Serial.printf("Delta-Update abgebrochen: %s\n", reason);
+    }
+    abort();
+    return false;
+}
+
+static uint32_t readLE32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/**
+ * @brief Sammelt ein Varint (7 Bit pro Byte, niedrigste Bits zuerst).
+ * @return true, sobald der Wert vollständig in _varint steht.
+ */
+bool DeltaPatcher::readVarint(uint8_t byte) {
+    if (_shift > 28) {
+        fail("invalid varint");
+        return false;
+    }
+    _varint |= (uint32_t)(byte & 0x7F) << _shift;
+    _shift += 7;
+    return (byte & 0x80) == 0;
+}
+
+/**
+ * @brief Prüft den Header und den Hash der laufenden Firmware, startet dann das Update.
+ */
+bool DeltaPatcher::parseHeader() {
+    if (memcmp(_header, DELTA_MAGIC, 4) != 0) return fail("not a delta patch");
+    if (_header[4] != DELTA_VERSION) return fail("unsupported patch version");
+    if (_header[5] != 0) return fail("unsupported patch flags");
+
+    _oldSize = readLE32(_header + 8);
+    _newSize = readLE32(_header + 12);
+
+    _oldPartition = esp_ota_get_running_partition();
+    if (!_oldPartition || _oldSize == 0 || _oldSize > _oldPartition->size) return fail("invalid base size");
+
+    // Passt der Patch zur laufenden Firmware? Sonst entstünde ein unbrauchbares Image.
+    uint8_t digest[32];
+    mbedtls_sha256_starts(&_sha, 0);
+    for (uint32_t offset = 0; offset < _oldSize; offset += DELTA_COPY_BUFFER) {
+        uint32_t n = _oldSize - offset;
+        if (n > DELTA_COPY_BUFFER) n = DELTA_COPY_BUFFER;
+        if (esp_partition_read(_oldPartition, offset, _copyBuf, n) != ESP_OK) return fail("base read failed");
+        mbedtls_sha256_update(&_sha, _copyBuf, n);
+    }
+    mbedtls_sha256_finish(&_sha, digest);
+    if (memcmp(digest, _header + 16, sizeof(digest)) != 0) return fail("patch does not match running firmware");
+
+    Serial.printf("Delta-Update: Basis %u Bytes (%s) -> %u Bytes\n", (unsigned)_oldSize, _oldPartition->label, (unsigned)_newSize);
+    if (!Update.begin(_newSize, U_FLASH)) return fail(Update.errorString());
+    _updateStarted = true;
+    mbedtls_sha256_starts(&_sha, 0);
+    return true;
+}
+
+/**
+ * @brief Schreibt Bytes des neuen Images und führt den Hash mit.
+ */
+bool DeltaPatcher::emit(const uint8_t* data, size_t len) {
+    if (_written + len > _newSize) return fail("patch exceeds image size");
+    if (Update.write((uint8_t*)data, len) != len) return fail(Update.errorString());
+    mbedtls_sha256_update(&_sha, data, len);
+    _written += len;
+    return true;
+}
+
+/**
+ * @brief Kopiert `len` Bytes ab _copyOffset aus der laufenden Partition.
+ */
+bool DeltaPatcher::copyFromOld(uint32_t len) {
+    if (_copyOffset > _oldSize || len > _oldSize - _copyOffset) return fail("copy outside base image");
+    while (len > 0) {
+        uint32_t n = len > DELTA_COPY_BUFFER ? DELTA_COPY_BUFFER : len;
+        if (esp_partition_read(_oldPartition, _copyOffset, _copyBuf, n) != ESP_OK) return fail("base read failed");
+        if (!emit(_copyBuf, n)) return false;
+        _copyOffset += n;
+        len -= n;
+    }
+    return true;
+}
+
+bool DeltaPatcher::write(const uint8_t* data, size_t len) {
+    size_t i = 0;
+    while (i < len && !_error) {
+        switch (_state) {
+            case STATE_HEADER: {
+                size_t n = DELTA_HEADER_SIZE - _headerLen;
+                if (n > len - i) n = len - i;
+                memcpy(_header + _headerLen, data + i, n);
+                _headerLen += n;
+                i += n;
+                if (_headerLen == DELTA_HEADER_SIZE) {
+                    if (!parseHeader()) return false;
+                    _state = STATE_OP;
+                }
+                break;
+            }
+
+            case STATE_OP: {
+                uint8_t op = data[i++];
+                _varint = 0;
+                _shift = 0;
+                if (op == 0x00) _state = STATE_END;
+                else if (op == 0x01) _state = STATE_ADD_LEN;
+                else if (op == 0x02) _state = STATE_COPY_OFFSET;
+                else return fail("unknown patch operation");
+                break;
+            }
+
+            case STATE_ADD_LEN:
+                if (!readVarint(data[i++])) break;
+                _remaining = _varint;
+                _state = _remaining ? STATE_ADD_DATA : STATE_OP;
+                break;
+
+            case STATE_ADD_DATA:
+            case STATE_COPY_FIX_DATA: {
+                // Neue Bytes direkt aus dem Empfangspuffer schreiben
+                size_t n = _remaining;
+                if (n > len - i) n = len - i;
+                if (!emit(data + i, n)) return false;
+                i += n;
+                _remaining -= n;
+                if (_remaining == 0) {
+                    _state = (_state == STATE_ADD_DATA || _copyLeft == 0) ? STATE_OP : STATE_COPY_GAP;
+                    _varint = 0;
+                    _shift = 0;
+                }
+                break;
+            }
+
+            case STATE_COPY_OFFSET:
+                if (!readVarint(data[i++])) break;
+                _copyOffset = _varint;
+                _varint = 0;
+                _shift = 0;
+                _state = STATE_COPY_LEN;
+                break;
+
+            case STATE_COPY_LEN:
+                if (!readVarint(data[i++])) break;
+                _copyLeft = _varint;
+                _varint = 0;
+                _shift = 0;
+                _state = _copyLeft ? STATE_COPY_GAP : STATE_OP;
+                break;
+
+            case STATE_COPY_GAP:
+                if (!readVarint(data[i++])) break;
+                if (_varint > _copyLeft) return fail("invalid copy gap");
+                if (!copyFromOld(_varint)) return false;
+                _copyLeft -= _varint;
+                _varint = 0;
+                _shift = 0;
+                _state = _copyLeft ? STATE_COPY_FIX_LEN : STATE_OP;
+                break;
+
+            case STATE_COPY_FIX_LEN:
+                if (!readVarint(data[i++])) break;
+                if (_varint > _copyLeft) return fail("invalid copy fix");
+                // Die ersetzten Bytes des alten Images werden übersprungen.
+                _remaining = _varint;
+                _copyLeft -= _varint;
+                _copyOffset += _varint;
+                _varint = 0;
+                _shift = 0;
+                if (_remaining) _state = STATE_COPY_FIX_DATA;
+                else _state = _copyLeft ? STATE_COPY_GAP : STATE_OP;
+                break;
+
+            case STATE_END:
+                return fail("data after end of patch");
+        }
+    }
+    return !_error;
+}
+
+bool DeltaPatcher::finish() {
+    if (_error) return false;
+    if (_state != STATE_END) return fail("patch incomplete");
+    if (_written != _newSize) return fail("image size mismatch");
+
+    uint8_t digest[32];
+    mbedtls_sha256_finish(&_sha, digest);
+    if (memcmp(digest, _header + 48, sizeof(digest)) != 0) return fail("image hash mismatch");
+
+    // Erst jetzt wird die neue Partition als Boot-Partition eingetragen.
+    if (!Update.end()) return fail(Update.errorString());
+    _updateStarted = false;
+    Serial.printf("Delta-Update erfolgreich: %u Bytes erzeugt\n", (unsigned)_written);
+    return true;
+}
@@ -0,0 +1,120 @@
+//================================================================================
+//| DATEI: DeltaPatcher.h                                                        |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Wendet einen Delta-Patch (erzeugt mit tools/ota_delta.py) auf die laufende   |
+//| Firmware an. Statt ~1 MB wird nur der Unterschied übertragen; das neue Image |
+//| entsteht beim Empfang aus Teilen der alten App-Partition plus neuen Bytes    |
+//| und wird über die Update-Bibliothek in die andere OTA-Partition geschrieben. |
+//|                                                                              |
+//| PATCH-FORMAT (Little Endian, Version 1):                                     |
+//|   Header (80 Bytes): "BBDP", Version, Flags, 2x reserviert,                  |
+//|                      alte Größe (u32), neue Größe (u32),                     |
+//|                      SHA-256 altes Image, SHA-256 neues Image                |
+//|   Operationen (Längen/Offsets als Varint, 7 Bit pro Byte):                   |
+//|     0x01 ADD  len, <len Bytes>          neue Bytes                           |
+//|     0x02 COPY offset, len, Korrekturen  Bytes aus dem alten Image, wobei     |
+//|          einzelne Stellen ersetzt werden: abwechselnd "gap" (unverändert     |
+//|          kopieren) und "n" + <n Bytes> (ersetzen), bis len erreicht ist.     |
+//|     0x00 END                                                                 |
+//|                                                                              |
+//| SICHERHEIT: Vor dem ersten Schreibzugriff wird der Hash der laufenden        |
+//| Firmware geprüft (Patch passt zur Basis). Umgeschaltet wird die Boot-        |
+//| Partition erst, wenn der Hash des erzeugten Images stimmt.                   |
+//================================================================================
+
+#pragma once
+
+#include <Arduino.h>
+#include <esp_partition.h>
+#include <mbedtls/sha256.h>
+
+#define DELTA_MAGIC          "BBDP"
+#define DELTA_VERSION        1
+#define DELTA_HEADER_SIZE    80
+// Puffer für das Lesen aus der alten Partition (begrenzt den RAM-Bedarf).
+#define DELTA_COPY_BUFFER    512
+
+/**
+ * @class DeltaPatcher
+ * @brief Streaming-Anwendung eines Delta-Patches mit festem Speicherbedarf.
+ *
+ * Ablauf: begin(), dann write() für jedes empfangene Stück, am Ende finish().
+ * Bei einem Fehler liefert write() false; error() enthält den Grund.
+ */
+class DeltaPatcher {
+public:
+    DeltaPatcher();
+    ~DeltaPatcher();
+
+    /**
+     * @brief Setzt den Zustand zurück. Ein noch laufendes Update wird abgebrochen.
+     */
+    void begin();
+
+    /**
+     * @brief Verarbeitet das nächste Stück des Patches.
+     */
+    bool write(const uint8_t* data, size_t len);
+
+    /**
+     * @brief Prüft Größe und Hash des neuen Images und aktiviert es für den nächsten Boot.
+     * @return false bei Fehler (das Update wird dann verworfen).
+     */
+    bool finish();
+
+    /**
+     * @brief Verwirft ein begonnenes Update.
+     */
+    void abort();
+
+    const char* error() const { return _error; }
+    bool hasError() const { return _error != nullptr; }
+    size_t written() const { return _written; }
+    size_t newSize() const { return _newSize; }
+
+private:
+    enum State : uint8_t {
+        STATE_HEADER,
+        STATE_OP,
+        STATE_ADD_LEN,
+        STATE_ADD_DATA,
+        STATE_COPY_OFFSET,
+        STATE_COPY_LEN,
+        STATE_COPY_GAP,
+        STATE_COPY_FIX_LEN,
+        STATE_COPY_FIX_DATA,
+        STATE_END
+    };
+
+    State _state;
+    const char* _error;
+    bool _updateStarted;
+
+    uint8_t _header[DELTA_HEADER_SIZE];
+    size_t _headerLen;
+
+    // Varint, das gerade gelesen wird
+    uint32_t _varint;
+    uint8_t _shift;
+
+    uint32_t _oldSize;
+    uint32_t _newSize;
+    uint32_t _written;
+
+    uint32_t _remaining;    // Rest der aktuellen ADD-Daten bzw. der Korrektur
+    uint32_t _copyOffset;   // Leseposition im alten Image
+    uint32_t _copyLeft;     // Rest der aktuellen COPY-Operation
+
+    const esp_partition_t* _oldPartition;
+    mbedtls_sha256_context _sha;
+    uint8_t _copyBuf[DELTA_COPY_BUFFER];
+
+    bool readVarint(uint8_t byte);
+    bool parseHeader();
+    bool emit(const uint8_t* data, size_t len);
+    bool copyFromOld(uint32_t len);
+    bool fail(const char* reason);
+};
@@ -0,0 +1,235 @@
+//================================================================================
+//| DATEI: EventStream.cpp                                                       |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Implementiert den SSE-Endpunkt. Der Handler schreibt die HTTP-Header selbst  |
+//| auf den Socket und kehrt dann zurück; die Verbindung bleibt offen. Weitere   |
+//| Ereignisse werden später über httpd_socket_send() direkt gesendet. Über den  |
+//| Session-Kontext (free_ctx) erfahren wir, wenn der Browser die Verbindung     |
+//| schließt, damit der Socket nicht versehentlich weiterbenutzt wird.           |
+//================================================================================
+
+#include "EventStream.h"
+#include <sys/socket.h>
+
+static const char SSE_HEADERS[] =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: text/event-stream\r\n"
+    "Cache-Control: no-cache\r\n"
+    "Connection: keep-alive\r\n"
+    "\r\n"
+    "retry: 3000\n\n"; // Browser soll nach 3 s neu verbinden
+
+EventStream::EventStream()
+    : _head(0), _lock(nullptr), _hd(nullptr), _flushPending(false), _lastActivity(0),
+      _eventsSent(0), _clientsDropped(0), _connectsRejected(0) {
+    for (uint8_t i = 0; i < EVENT_STREAM_MAX_CLIENTS; i++) {
+        _clients[i].owner = this;
+        _clients[i].fd = -1;
+        _clients[i].cursor = 0;
+        _clients[i].maxDepth = 0;
+        _clients[i].closing = false;
+    }
+}
+
+void EventStream::attach(AsyncWebServer& server, const char* uri) {
+    if (!_lock) _lock = xSemaphoreCreateMutex();
+    server.on(uri, HTTP_GET, std::bind(&EventStream::handleConnect, this, std::placeholders::_1));
+}
+
+/**
+ * @brief Nimmt eine neue SSE-Verbindung an.
+ * Der Client startet am aktuellen Ende des Ringpuffers (bekommt nur neue Ereignisse).
+ */
+void EventStream::handleConnect(AsyncWebServerRequest* request) {
+    httpd_req_t* req = request->getNativeRequest();
+    int fd = httpd_req_to_sockfd(req);
+
+    Client* client = nullptr;
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    for (uint8_t i = 0; i < EVENT_STREAM_MAX_CLIENTS; i++) {
+        if (_clients[i].fd < 0) {
+            client = &_clients[i];
+            client->fd = fd;
+            client->cursor = _head;
+            client->maxDepth = 0;
+            client->closing = false;
+            break;
+        }
+    }
+    xSemaphoreGive(_lock);
+
+    if (!client) {
+        _connectsRejected++;
+        request->send(503, "text/plain", "Zu viele Event-Verbindungen.");
+        return;
+    }
+
+    _hd = req->handle;
+    httpd_socket_send(_hd, fd, SSE_HEADERS, sizeof(SSE_HEADERS) - 1, 0);
+
+    // Wird vom Server beim Schließen des Sockets aufgerufen -> Slot freigeben.
+    req->sess_ctx = client;
+    req->free_ctx = freeClientCtx;
+    _lastActivity = millis();
+}
+
+void EventStream::freeClientCtx(void* ctx) {
+    Client* client = (Client*)ctx;
+    EventStream* self = client->owner;
+    xSemaphoreTake(self->_lock, portMAX_DELAY);
+    client->fd = -1;
+    client->closing = false;
+    xSemaphoreGive(self->_lock);
+}
+
+/**
+ * @brief Schreibt Bytes in den Ringpuffer (Lock muss gehalten werden).
+ */
+void EventStream::append(const char* data, size_t len) {
+    while (len > 0) {
+        size_t pos = _head % EVENT_STREAM_RING_SIZE;
+        size_t n = EVENT_STREAM_RING_SIZE - pos;
+        if (n > len) n = len;
+        memcpy(_ring + pos, data, n);
+        _head += n;
+        data += n;
+        len -= n;
+    }
+}
+
+void EventStream::send(const char* event, const char* data, size_t len) {
+    if (!_lock || clientCount() == 0) return;
+
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    if (event) {
+        append("event: ", 7);
+        append(event, strlen(event));
+        append("\n", 1);
+    }
+    // SSE erlaubt keine Zeilenumbrüche in "data:", daher pro Zeile ein Feld.
+    const char* end = data + len;
+    do {
+        const char* nl = (const char*)memchr(data, '\n', end - data);
+        const char* lineEnd = nl ? nl : end;
+        append("data: ", 6);
+        append(data, lineEnd - data);
+        append("\n", 1);
+        data = nl ? nl + 1 : end;
+    } while (data < end);
+    append("\n", 1);
+    _eventsSent++;
+
+    // Queue-Tiefe prüfen: Wer mehr als den Ringpuffer hinterherhängt, wird getrennt.
+    for (uint8_t i = 0; i < EVENT_STREAM_MAX_CLIENTS; i++) {
+        Client& c = _clients[i];
+        if (c.fd < 0 || c.closing) continue;
+        uint32_t depth = _head - c.cursor;
+        if (depth > c.maxDepth) c.maxDepth = depth;
+        if (depth > EVENT_STREAM_RING_SIZE) {
+            c.closing = true;
+            _clientsDropped++;
+            httpd_sess_trigger_close(_hd, c.fd);
+        }
+    }
+    xSemaphoreGive(_lock);
+
+    _lastActivity = millis();
+    scheduleFlush();
+}
+
+void EventStream::loop() {
+    if (!_lock) return;
+    if (millis() - _lastActivity > EVENT_STREAM_HEARTBEAT_MS && clientCount() > 0) {
+        // Kommentarzeile: wird vom Browser ignoriert, hält aber NAT/AP-Verbindung offen.
+        xSemaphoreTake(_lock, portMAX_DELAY);
+        append(": ping\n\n", 8);
+        xSemaphoreGive(_lock);
+        _lastActivity = millis();
+        scheduleFlush();
+        return;
+    }
+
+    // Reste, die wegen eines vollen TCP-Puffers nicht gesendet wurden, erneut anstoßen.
+    for (uint8_t i = 0; i < EVENT_STREAM_MAX_CLIENTS; i++) {
+        if (_clients[i].fd >= 0 && !_clients[i].closing && _clients[i].cursor != _head) {
+            scheduleFlush();
+            return;
+        }
+    }
+}
+
+void EventStream::scheduleFlush() {
+    if (_flushPending || !_hd) return;
+    _flushPending = true;
+    if (httpd_queue_work(_hd, flushWork, this) != ESP_OK) {
+        _flushPending = false;
+    }
+}
+
+void EventStream::flushWork(void* arg) {
+    EventStream* self = (EventStream*)arg;
+    self->_flushPending = false;
+    self->flushAll();
+}
+
+/**
+ * @brief Sendet allen Clients ihre ausstehenden Bytes (läuft im httpd-Task).
+ * MSG_DONTWAIT: Ist der TCP-Puffer eines Clients voll, wird er übersprungen und
+ * beim nächsten Flush weiterbedient, statt den httpd-Task zu blockieren.
+ */
+void EventStream::flushAll() {
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    for (uint8_t i = 0; i < EVENT_STREAM_MAX_CLIENTS; i++) {
+        Client& c = _clients[i];
+        while (c.fd >= 0 && !c.closing && c.cursor != _head) {
+            size_t pos = c.cursor % EVENT_STREAM_RING_SIZE;
+            size_t len = _head - c.cursor;
+            if (len > EVENT_STREAM_RING_SIZE - pos) len = EVENT_STREAM_RING_SIZE - pos;
+
+            int ret = httpd_socket_send(_hd, c.fd, _ring + pos, len, MSG_DONTWAIT);
+            if (ret > 0) {
+                c.cursor += ret;
+            } else if (ret == HTTPD_SOCK_ERR_TIMEOUT) {
+                break; // Socket-Puffer voll - später erneut versuchen
+            } else {
+                c.closing = true;
+                httpd_sess_trigger_close(_hd, c.fd);
+            }
+        }
+    }
+    xSemaphoreGive(_lock);
+}
+
+uint8_t EventStream::clientCount() {
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < EVENT_STREAM_MAX_CLIENTS; i++) {
+        if (_clients[i].fd >= 0 && !_clients[i].closing) count++;
+    }
+    return count;
+}
+
+void EventStream::writeStatsJson(JsonWriter& json) {
+    json.beginObject();
+    json.field("clients", clientCount());
+    json.field("max_clients", EVENT_STREAM_MAX_CLIENTS);
+    json.field("ring_size", EVENT_STREAM_RING_SIZE);
+    json.field("events_sent", _eventsSent);
+    json.field("clients_dropped", _clientsDropped);
+    json.field("connects_rejected", _connectsRejected);
+    json.key("queues");
+    json.beginArray();
+    for (uint8_t i = 0; i < EVENT_STREAM_MAX_CLIENTS; i++) {
+        const Client& c = _clients[i];
+        if (c.fd < 0) continue;
+        json.beginObject();
+        json.field("fd", c.fd);
+        json.field("depth", _head - c.cursor);
+        json.field("max_depth", c.maxDepth);
+        json.endObject();
+    }
+    json.endArray();
+    json.endObject();
+}
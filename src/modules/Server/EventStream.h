@@ -0,0 +1,101 @@
+//================================================================================
+//| DATEI: EventStream.h                                                         |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Server-Sent Events (SSE, "text/event-stream") auf Basis von esp_http_server. |
+//| Der Browser hält eine Verbindung offen und bekommt neue Ereignisse (z.B.     |
+//| geänderte Health-Werte oder neue Log-Zeilen) sofort gepusht, statt alle      |
+//| paar Sekunden zu pollen.                                                     |
+//|                                                                              |
+//| SPEICHER: Alle Clients teilen sich einen festen Ringpuffer. Jeder Client hat |
+//| nur einen Lesezeiger. Hängt ein Browser so weit hinterher, dass seine Daten  |
+//| überschrieben würden, wird er getrennt (er verbindet sich selbst neu).       |
+//================================================================================
+
+#pragma once
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "AsyncWebServer.h"
+#include "JsonWriter.h"
+
+// Maximale Anzahl gleichzeitiger SSE-Verbindungen (jede belegt einen httpd-Socket).
+#define EVENT_STREAM_MAX_CLIENTS   2
+// Größe des gemeinsamen Ringpuffers in Bytes (= maximale Queue-Tiefe pro Client).
+#define EVENT_STREAM_RING_SIZE     2048
+// Nach dieser Zeit ohne Ereignis wird ein Kommentar als Keep-Alive gesendet.
+#define EVENT_STREAM_HEARTBEAT_MS  15000
+
+/**
+ * @class EventStream
+ * @brief Verwaltet SSE-Clients und verteilt Ereignisse an alle Verbindungen.
+ *
+ * send() darf aus jedem Task aufgerufen werden (z.B. aus loop()). Das eigentliche
+ * Senden auf die Sockets passiert immer im httpd-Task (über httpd_queue_work) und
+ * nicht-blockierend, damit ein langsamer Browser den Server nicht aufhält.
+ */
+class EventStream {
+public:
+    EventStream();
+
+    /**
+     * @brief Registriert den SSE-Endpunkt am Webserver.
+     * @param uri Pfad des Endpunkts (z.B. "/api/events").
+     */
+    void attach(AsyncWebServer& server, const char* uri);
+
+    /**
+     * @brief Verteilt ein Ereignis an alle verbundenen Clients.
+     * @param event Name des Ereignisses (im Browser: addEventListener(event, ...)).
+     * @param data Nutzdaten. Zeilenumbrüche werden auf mehrere "data:"-Zeilen verteilt.
+     */
+    void send(const char* event, const char* data, size_t len);
+
+    /**
+     * @brief Sendet bei Bedarf den Heartbeat. Wird in der Hauptschleife aufgerufen.
+     */
+    void loop();
+
+    /**
+     * @brief Anzahl aktuell verbundener Clients.
+     */
+    uint8_t clientCount();
+
+    /**
+     * @brief Schreibt Client-Anzahl, Queue-Tiefen und Zähler als JSON-Objekt.
+     */
+    void writeStatsJson(JsonWriter& json);
+
+private:
+    struct Client {
+        EventStream* owner;
+        int fd;             // Socket oder -1, wenn der Slot frei ist
+        uint32_t cursor;    // Lese-Position im (fortlaufend gezählten) Ringpuffer
+        uint32_t maxDepth;  // Größte beobachtete Queue-Tiefe in Bytes
+        bool closing;       // Trennung angefordert, wartet auf free_ctx
+    };
+
+    char _ring[EVENT_STREAM_RING_SIZE];
+    uint32_t _head;         // Gesamtzahl je geschriebener Bytes (Position = _head % Größe)
+    Client _clients[EVENT_STREAM_MAX_CLIENTS];
+    SemaphoreHandle_t _lock;
+    httpd_handle_t _hd;
+    volatile bool _flushPending;
+    unsigned long _lastActivity;
+
+    // Statistik
+    uint32_t _eventsSent;
+    uint32_t _clientsDropped;
+    uint32_t _connectsRejected;
+
+    void handleConnect(AsyncWebServerRequest* request);
+    void append(const char* data, size_t len);
+    void scheduleFlush();
+    void flushAll();
+
+    static void flushWork(void* arg);
+    static void freeClientCtx(void* ctx);
+};
@@ -0,0 +1,332 @@
+//================================================================================
+//| DATEI: FileSyncApiHandler.cpp                                                |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Implementiert den Datei-Abgleich für das SPIFFS. Hashes werden nur für       |
+//| Dateien gebildet, deren Größe mit dem Manifest übereinstimmt; abweichende    |
+//| Größen gelten sofort als geändert.                                           |
+//|                                                                              |
+//| ATOMARITÄT: SPIFFS kann beim Umbenennen keine Datei überschreiben. Die alte  |
+//| Datei wird deshalb erst gelöscht, wenn die neue vollständig und geprüft in   |
+//| der Temp-Datei liegt; dazwischen liegt nur das Umbenennen.                   |
+//================================================================================
+
+#include "FileSyncApiHandler.h"
+#include "JsonWriter.h"
+#include "ResponseWriter.h"
+#include <SPIFFS.h>
+#include <mbedtls/sha256.h>
+
+// Maximale Anzahl Einträge im Manifest
+#define FS_SYNC_MAX_FILES  48
+
+struct ManifestEntry {
+    const char* hash;
+    uint32_t size;
+    const char* path;
+};
+
+FileSyncApiHandler::FileSyncApiHandler()
+    : _server(nullptr), _written(0), _complete(false), _error(nullptr) {
+    _path[0] = '\0';
+}
+
+void FileSyncApiHandler::registerRoutes(AsyncWebServer& server) {
+    _server = &server;
+
+    server.on("/api/fs/manifest", HTTP_POST, std::bind(&FileSyncApiHandler::handleManifest, this, std::placeholders::_1));
+
+    server.on("/api/fs/file", HTTP_POST,
+        std::bind(&FileSyncApiHandler::handleFileDone, this, std::placeholders::_1),
+        [this](AsyncWebServerRequest* request, String filename, size_t index, uint8_t* data, size_t len, bool final) {
+            handleFileUpload(request, filename, index, data, len, final);
+        }
+    );
+
+    server.on("/api/fs/delete", HTTP_POST, std::bind(&FileSyncApiHandler::handleDelete, this, std::placeholders::_1));
+}
+
+static void sendError(AsyncWebServerRequest* request, int code, const char* error) {
+    char buffer[128];
+    ResponseWriter out(request, code, "application/json", buffer, sizeof(buffer));
+    JsonWriter json(out);
+    json.beginObject();
+    json.field("ok", false);
+    json.field("error", error);
+    json.endObject();
+    out.end();
+}
+
+bool FileSyncApiHandler::validPath(const char* path) {
+    if (!path || path[0] != '/' || path[1] == '\0') return false;
+    if (strlen(path) > FS_SYNC_MAX_PATH || strstr(path, "..") || strcmp(path, FS_SYNC_TEMP_PATH) == 0) return false;
+    for (const char* p = path; *p; p++) {
+        if ((uint8_t)*p < 0x20 || *p == '\\') return false;
+    }
+    return true;
+}
+
+bool FileSyncApiHandler::hashFile(const char* path, char* hexOut) {
+    File file = SPIFFS.open(path, "r");
+    if (!file) return false;
+
+    mbedtls_sha256_context sha;
+    mbedtls_sha256_init(&sha);
+    mbedtls_sha256_starts(&sha, 0);
+    uint8_t buf[512];
+    size_t got;
+    while ((got = file.read(buf, sizeof(buf))) > 0) {
+        mbedtls_sha256_update(&sha, buf, got);
+    }
+    file.close();
+
+    uint8_t digest[IMAGE_DIGEST_SIZE];
+    mbedtls_sha256_finish(&sha, digest);
+    mbedtls_sha256_free(&sha);
+    for (uint8_t i = 0; i < IMAGE_DIGEST_SIZE; i++) snprintf(hexOut + 2 * i, 3, "%02x", digest[i]);
+    return true;
+}
+
+/**
+ * @brief Zerlegt das Manifest in Einträge (zeigen in den Text, der dafür verändert wird).
+ * @return Anzahl der Einträge oder -(Zeilennummer) bei einer ungültigen Zeile.
+ */
+static int parseManifest(char* text, ManifestEntry* entries, int maxEntries) {
+    int count = 0;
+    int line = 0;
+    char* p = text;
+    while (*p) {
+        char* end = strchr(p, '\n');
+        if (end) *end = '\0';
+        line++;
+        size_t len = strlen(p);
+        if (len && p[len - 1] == '\r') p[--len] = '\0';
+
+        if (len > 0 && p[0] != '#') {
+            // "<sha256> <größe> <pfad>"
+            char* hash = p;
+            char* sizeText = strchr(hash, ' ');
+            if (!sizeText) return -line;
+            *sizeText++ = '\0';
+            char* path = strchr(sizeText, ' ');
+            if (!path) return -line;
+            *path++ = '\0';
+            char* sizeEnd;
+            unsigned long size = strtoul(sizeText, &sizeEnd, 10);
+            if (strlen(hash) != IMAGE_DIGEST_SIZE * 2 || *sizeEnd != '\0' || count >= maxEntries) return -line;
+
+            entries[count].hash = hash;
+            entries[count].size = (uint32_t)size;
+            entries[count].path = path;
+            count++;
+        }
+
+        if (!end) break;
+        p = end + 1;
+    }
+    return count;
+}
+
+void FileSyncApiHandler::handleManifest(AsyncWebServerRequest* request) {
+    httpd_req_t* req = request->getNativeRequest();
+    if (req->content_len == 0 || req->content_len > FS_SYNC_MAX_MANIFEST) {
+        sendError(request, 400, "manifest empty or too large");
+        return;
+    }
+
+    char* text = (char*)malloc(req->content_len + 1);
+    if (!text) {
+        sendError(request, 503, "out of memory");
+        return;
+    }
+    AsyncWebServerRequest::countHeapAlloc(req->content_len + 1);
+
+    size_t received = 0;
+    while (received < req->content_len) {
+        int ret = request->receive(text + received, req->content_len - received);
+        if (ret <= 0) break;
+        received += ret;
+    }
+    request->markBodyConsumed();
+    // Ein abgeschnittenes Manifest würde alle Dateien nach dem Schnitt als "extra" melden.
+    if (received != req->content_len) {
+        free(text);
+        sendError(request, 400, "incomplete manifest");
+        return;
+    }
+    text[received] = '\0';
+
+    ManifestEntry entries[FS_SYNC_MAX_FILES];
+    int count = parseManifest(text, entries, FS_SYNC_MAX_FILES);
+    if (count < 0) {
+        free(text);
+        char msg[48];
+        snprintf(msg, sizeof(msg), "invalid manifest line %d", -count);
+        sendError(request, 400, msg);
+        return;
+    }
+
+    unsigned long startMs = millis();
+    uint32_t changedBytes = 0;
+    uint8_t changedCount = 0;
+    uint8_t hashed = 0;
+
+    char buffer[512];
+    ResponseWriter out(request, 200, "application/json", buffer, sizeof(buffer));
+    JsonWriter json(out);
+    json.beginObject();
+    json.field("ok", true);
+
+    // Fehlende Dateien und Dateien mit anderem Inhalt
+    json.key("changed");
+    json.beginArray();
+    for (int i = 0; i < count; i++) {
+        const ManifestEntry& e = entries[i];
+        bool changed = true;
+        if (validPath(e.path) && SPIFFS.exists(e.path)) {
+            File file = SPIFFS.open(e.path, "r");
+            uint32_t size = file ? (uint32_t)file.size() : 0;
+            file.close();
+            if (size == e.size) {
+                char hex[IMAGE_DIGEST_SIZE * 2 + 1];
+                hashed++;
+                changed = !hashFile(e.path, hex) || strcasecmp(hex, e.hash) != 0;
+            }
+        }
+        if (changed) {
+            json.value(e.path);
+            changedBytes += e.size;
+            changedCount++;
+        }
+    }
+    json.endArray();
+
+    // Dateien, die nur auf dem Gerät liegen (Kandidaten für /api/fs/delete)
+    json.key("extra");
+    json.beginArray();
+    File root = SPIFFS.open("/");
+    File entry = root ? root.openNextFile() : File();
+    while (entry) {
+        String entryPath = entry.path();
+        entry.close();
+        bool listed = entryPath == FS_SYNC_TEMP_PATH;
+        for (int i = 0; i < count && !listed; i++) listed = entryPath == entries[i].path;
+        if (!listed) json.value(entryPath);
+        entry = root.openNextFile();
+    }
+    json.endArray();
+
+    json.field("files", count);
+    json.field("changed_files", changedCount);
+    json.field("changed_bytes", changedBytes);
+    json.field("hashed", hashed);
+    json.field("hash_ms", (uint32_t)(millis() - startMs));
+    json.field("free_bytes", (uint32_t)(SPIFFS.totalBytes() - SPIFFS.usedBytes()));
+    json.endObject();
+    out.end();
+    free(text);
+}
+
+void FileSyncApiHandler::handleFileUpload(AsyncWebServerRequest* request, String filename, size_t index, uint8_t* data, size_t len, bool final) {
+    if (index == 0) {
+        _error = nullptr;
+        _written = 0;
+        _complete = false;
+        _path[0] = '\0';
+        if (_temp) _temp.close();
+
+        const char* path = request->argPtr("path");
+        if (!validPath(path)) {
+            _error = "invalid path";
+            return;
+        }
+        strcpy(_path, path);
+        if (!_digest.begin(request->argPtr("sha256"))) {
+            _error = "invalid sha256";
+            return;
+        }
+        SPIFFS.remove(FS_SYNC_TEMP_PATH);
+        _temp = SPIFFS.open(FS_SYNC_TEMP_PATH, "w");
+        if (!_temp) {
+            _error = "cannot create temp file";
+            return;
+        }
+    }
+    if (_error || !_temp) return;
+
+    if (len > 0) {
+        _digest.update(data, len);
+        if (_temp.write(data, len) != len) {
+            _error = "filesystem full";
+            _temp.close();
+            SPIFFS.remove(FS_SYNC_TEMP_PATH);
+            return;
+        }
+        _written += len;
+    }
+
+    if (final) {
+        _temp.close();
+        if (!_digest.finish()) {
+            _error = "sha256 mismatch";
+        } else {
+            // Erst jetzt wird die alte Datei ersetzt.
+            if (SPIFFS.exists(_path)) SPIFFS.remove(_path);
+            if (!SPIFFS.rename(FS_SYNC_TEMP_PATH, _path)) _error = "rename failed";
+        }
+        if (_error) {
+            SPIFFS.remove(FS_SYNC_TEMP_PATH);
+            return;
+        }
+        _complete = true;
+        if (_server) _server->invalidateTemplates();
+        Serial.printf("Datei aktualisiert: %s (%u Bytes)\n", _path, (unsigned)_written);
+    }
+}
+
+void FileSyncApiHandler::handleFileDone(AsyncWebServerRequest* request) {
+    // Abgebrochener Upload: Temp-Datei verwerfen, die alte Datei bleibt unverändert.
+    if (_temp) {
+        _temp.close();
+        SPIFFS.remove(FS_SYNC_TEMP_PATH);
+        if (!_error) _error = "upload incomplete";
+    }
+    if (!_complete) {
+        sendError(request, _error && strcmp(_error, "filesystem full") == 0 ? 507 : 400, _error ? _error : "no file received");
+        _error = nullptr;
+        return;
+    }
+    _complete = false;
+
+    char buffer[192];
+    ResponseWriter out(request, 200, "application/json", buffer, sizeof(buffer));
+    JsonWriter json(out);
+    json.beginObject();
+    json.field("ok", true);
+    json.field("path", _path);
+    json.field("bytes", (uint32_t)_written);
+    json.field("sha256", _digest.hex());
+    json.endObject();
+    out.end();
+}
+
+void FileSyncApiHandler::handleDelete(AsyncWebServerRequest* request) {
+    const char* path = request->argPtr("path");
+    if (!validPath(path)) {
+        sendError(request, 400, "invalid path");
+        return;
+    }
+    if (!SPIFFS.exists(path)) {
+        sendError(request, 404, "not found");
+        return;
+    }
+    if (!SPIFFS.remove(path)) {
+        sendError(request, 500, "remove failed");
+        return;
+    }
+    if (_server) _server->invalidateTemplates();
+    Serial.printf("Datei gelöscht: %s\n", path);
+    request->send(200, "application/json", "{\"ok\":true}");
+}
@@ -0,0 +1,68 @@
+//================================================================================
+//| DATEI: FileSyncApiHandler.h                                                  |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Aktualisiert einzelne Dateien im SPIFFS, ohne das ganze Image neu zu         |
+//| flashen und ohne Neustart (Gegenstück: tools/spiffs_sync.py).                |
+//|                                                                              |
+//| ABLAUF:                                                                      |
+//|   1. POST /api/fs/manifest  Body: je Zeile "<sha256> <größe> <pfad>".        |
+//|      Antwort: welche Dateien fehlen/abweichen und welche nur auf dem Gerät   |
+//|      liegen.                                                                 |
+//|   2. POST /api/fs/file?path=/x.css&sha256=...  (roh oder multipart)          |
+//|      Die Datei wird in eine Temp-Datei geschrieben, der Hash geprüft und     |
+//|      erst dann gegen die alte Datei getauscht.                               |
+//|   3. POST /api/fs/delete?path=/alt.html  (optional, für --prune)             |
+//| Nach jeder Änderung wird der Template-Cache des Servers verworfen.           |
+//================================================================================
+
+#pragma once
+
+#include "AsyncWebServer.h"
+#include "ImageDigest.h"
+#include <FS.h>
+
+// Maximale Größe des Manifests (eine Zeile pro Datei, ~100 Bytes).
+#define FS_SYNC_MAX_MANIFEST   4096
+// Temp-Datei für laufende Uploads (SPIFFS: max. 31 Zeichen pro Pfad).
+#define FS_SYNC_TEMP_PATH      "/.sync.tmp"
+#define FS_SYNC_MAX_PATH       31
+
+class FileSyncApiHandler {
+public:
+    FileSyncApiHandler();
+
+    /**
+     * @brief Registriert /api/fs/manifest, /api/fs/file und /api/fs/delete.
+     * Das Server-Objekt wird gemerkt, um den Template-Cache zu invalidieren.
+     */
+    void registerRoutes(AsyncWebServer& server);
+
+private:
+    void handleManifest(AsyncWebServerRequest* request);
+    void handleFileUpload(AsyncWebServerRequest* request, String filename, size_t index, uint8_t* data, size_t len, bool final);
+    void handleFileDone(AsyncWebServerRequest* request);
+    void handleDelete(AsyncWebServerRequest* request);
+
+    /**
+     * @brief Erlaubt nur "/name" ohne "..", passend zur SPIFFS-Pfadlänge.
+     */
+    static bool validPath(const char* path);
+
+    /**
+     * @brief SHA-256 einer Datei im SPIFFS als Hex-String.
+     */
+    static bool hashFile(const char* path, char* hexOut);
+
+    AsyncWebServer* _server;
+
+    // Zustand des laufenden Datei-Uploads
+    File _temp;
+    ImageDigest _digest;
+    char _path[FS_SYNC_MAX_PATH + 1];
+    size_t _written;
+    bool _complete;
+    const char* _error;
+};
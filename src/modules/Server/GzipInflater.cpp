@@ -0,0 +1,209 @@
+//================================================================================
+//| DATEI: GzipInflater.cpp                                                      |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Implementiert den gzip-Rahmen (Header, Trailer, CRC32) um den ROM-tinfl.     |
+//| tinfl schreibt im "wrapping"-Modus in einen Ringpuffer, dessen Größe eine    |
+//| Zweierpotenz sein muss und mindestens dem Fenster des Kompressors entspricht.|
+//================================================================================
+
+#include "GzipInflater.h"
+#include <rom/miniz.h>
+#include <esp_rom_crc.h>
+
+// gzip-Header-Flags (RFC 1952)
+static const uint8_t GZIP_FHCRC = 0x02;
+static const uint8_t GZIP_FEXTRA = 0x04;
+static const uint8_t GZIP_FNAME = 0x08;
+static const uint8_t GZIP_FCOMMENT = 0x10;
+
+GzipInflater::GzipInflater()
+    : _state(STATE_ERROR), _error(nullptr), _headLen(0), _flags(0), _extraLen(0), _extraPos(0),
+      _windowBits(GZIP_MAX_WINDOW_BITS), _decomp(nullptr), _ring(nullptr), _window(0), _ringPos(0),
+      _crc(0), _bytesIn(0), _bytesOut(0), _trailerLen(0) {}
+
+GzipInflater::~GzipInflater() {
+    end();
+}
+
+bool GzipInflater::isGzip(const String& filename, const uint8_t* data, size_t len) {
+    if (filename.endsWith(".gz")) return true;
+    return len >= 2 && data[0] == 0x1F && data[1] == 0x8B;
+}
+
+void GzipInflater::begin(OutputHandler output) {
+    end();
+    _output = output;
+    _state = STATE_HEADER;
+    _error = nullptr;
+    _headLen = 0;
+    _extraPos = 0;
+    _windowBits = GZIP_MAX_WINDOW_BITS;
+    _crc = 0;
+    _bytesIn = _bytesOut = 0;
+    _trailerLen = 0;
+}
+
+void GzipInflater::end() {
+    free(_decomp);
+    free(_ring);
+    _decomp = nullptr;
+    _ring = nullptr;
+}
+
+bool GzipInflater::fail(const char* reason) {
+    if (_state != STATE_ERROR) {
+        _error = reason;
+        _state = STATE_ERROR;
+    }
+    end();
+    return false;
+}
+
+/**
+ * @brief Belegt Decoder und Ringpuffer, sobald die Fenstergröße feststeht.
+ */
+bool GzipInflater::startInflate() {
+    _window = (size_t)1 << _windowBits;
+    _decomp = (tinfl_decompressor*)malloc(sizeof(tinfl_decompressor));
+    _ring = (uint8_t*)malloc(_window);
+    if (!_decomp || !_ring) return fail("out of memory");
+    tinfl_init(_decomp);
+    _ringPos = 0;
+    _state = STATE_DATA;
+    return true;
+}
+
+/**
+ * @brief Füttert tinfl und reicht die Ausgabe direkt aus dem Ringpuffer weiter.
+ * @return Anzahl verbrauchter Eingabe-Bytes.
+ */
+size_t GzipInflater::inflate(const uint8_t* data, size_t len) {
+    size_t used = 0;
+    while (true) {
+        size_t inBytes = len - used;
+        size_t outBytes = _window - _ringPos;
+        tinfl_status status = tinfl_decompress(_decomp, data + used, &inBytes, _ring, _ring + _ringPos, &outBytes,
+                                               TINFL_FLAG_HAS_MORE_INPUT);
+        used += inBytes;
+        if (outBytes > 0) {
+            _crc = esp_rom_crc32_le(_crc, _ring + _ringPos, outBytes);
+            _bytesOut += outBytes;
+            if (!_output(_ring + _ringPos, outBytes)) {
+                fail("output aborted");
+                return used;
+            }
+            _ringPos = (_ringPos + outBytes) & (_window - 1);
+        }
+        if (status == TINFL_STATUS_DONE) {
+            _state = STATE_TRAILER;
+            return used;
+        }
+        if (status < 0) {
+            // Auch ein zu kleines Fenster fällt spätestens hier oder bei der CRC auf.
+            fail("corrupt deflate stream");
+            return used;
+        }
+        if (status == TINFL_STATUS_NEEDS_MORE_INPUT && used == len) return used;
+    }
+}
+
+bool GzipInflater::write(const uint8_t* data, size_t len) {
+    _bytesIn += len;
+    size_t i = 0;
+    while (i < len) {
+        switch (_state) {
+            case STATE_HEADER:
+                _head[_headLen++] = data[i++];
+                if (_headLen < sizeof(_head)) break;
+                if (_head[0] != 0x1F || _head[1] != 0x8B || _head[2] != 8) return fail("not a gzip stream");
+                _flags = _head[3];
+                _state = (_flags & GZIP_FEXTRA) ? STATE_EXTRA_LEN : STATE_NAME;
+                _headLen = 0;
+                break;
+
+            case STATE_EXTRA_LEN:
+                _head[_headLen++] = data[i++];
+                if (_headLen < 2) break;
+                _extraLen = _head[0] | (_head[1] << 8);
+                _extraPos = 0;
+                _state = STATE_EXTRA;
+                break;
+
+            case STATE_EXTRA:
+                if (_extraPos >= _extraLen) {
+                    // Subfeld "WB" (Länge 1): Fensterbits des Kompressors
+                    if (_extraLen >= 5 && _extra[0] == 'W' && _extra[1] == 'B' && _extra[2] == 1 && _extra[3] == 0) {
+                        if (_extra[4] < GZIP_MIN_WINDOW_BITS || _extra[4] > GZIP_MAX_WINDOW_BITS) {
+                            return fail("unsupported window size");
+                        }
+                        _windowBits = _extra[4];
+                    }
+                    _state = STATE_NAME;
+                    break;
+                }
+                if (_extraPos < sizeof(_extra)) _extra[_extraPos] = data[i];
+                _extraPos++;
+                i++;
+                break;
+
+            case STATE_NAME:
+                if (!(_flags & GZIP_FNAME)) {
+                    _state = STATE_COMMENT;
+                    break;
+                }
+                if (data[i++] == 0) _flags &= ~GZIP_FNAME;
+                break;
+
+            case STATE_COMMENT:
+                if (!(_flags & GZIP_FCOMMENT)) {
+                    _headLen = 0;
+                    _state = STATE_HEADER_CRC;
+                    break;
+                }
+                if (data[i++] == 0) _flags &= ~GZIP_FCOMMENT;
+                break;
+
+            case STATE_HEADER_CRC:
+                if (_flags & GZIP_FHCRC) {
+                    i++;
+                    if (++_headLen < 2) break;
+                }
+                if (!startInflate()) return false;
+                break;
+
+            case STATE_DATA:
+                i += inflate(data + i, len - i);
+                if (_state == STATE_ERROR) return false;
+                break;
+
+            case STATE_TRAILER:
+                _trailer[_trailerLen++] = data[i++];
+                if (_trailerLen == sizeof(_trailer)) _state = STATE_DONE;
+                break;
+
+            case STATE_DONE:
+                // Weitere gzip-Member werden nicht unterstützt, Rest ignorieren.
+                return true;
+
+            case STATE_ERROR:
+                return false;
+        }
+    }
+
+    return _state != STATE_ERROR;
+}
+
+bool GzipInflater::finish() {
+    if (_state == STATE_ERROR) return false;
+    if (_state != STATE_DONE) return fail("gzip stream incomplete");
+    end();
+
+    uint32_t crc = _trailer[0] | (_trailer[1] << 8) | (_trailer[2] << 16) | ((uint32_t)_trailer[3] << 24);
+    uint32_t size = _trailer[4] | (_trailer[5] << 8) | (_trailer[6] << 16) | ((uint32_t)_trailer[7] << 24);
+    if (crc != _crc) return fail("gzip crc mismatch");
+    if (size != (uint32_t)_bytesOut) return fail("gzip size mismatch");
+    return true;
+}
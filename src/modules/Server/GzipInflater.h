@@ -0,0 +1,117 @@
+//================================================================================
+//| DATEI: GzipInflater.h                                                        |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Entpackt gzip-komprimierte Uploads (Firmware, SPIFFS-Image, Delta-Patch)     |
+//| Stück für Stück, während sie empfangen werden. Der eigentliche Inflate-      |
+//| Algorithmus ist der "tinfl" aus dem ROM des ESP32 (kein zusätzlicher Code).  |
+//|                                                                              |
+//| FENSTER: Deflate darf bis zu 32 KB zurückgreifen, der Ringpuffer muss also   |
+//| so groß sein wie das Fenster des Kompressors. tools/ota_compress.py legt     |
+//| die Fenstergröße im gzip-Extra-Feld ab ("WB" = Window Bits); dann genügen    |
+//| z.B. 4 KB. Normale .gz-Dateien (gzip -9) werden mit 32 KB entpackt.          |
+//================================================================================
+
+#pragma once
+
+#include <Arduino.h>
+#include <functional>
+
+// Kleinstes/größtes unterstütztes Fenster (2^9 .. 2^15 Bytes).
+#define GZIP_MIN_WINDOW_BITS  9
+#define GZIP_MAX_WINDOW_BITS  15
+
+struct tinfl_decompressor_tag;
+
+/**
+ * @class GzipInflater
+ * @brief Streaming-Entpacker für gzip (RFC 1952) mit festem Ringpuffer.
+ *
+ * Die entpackten Daten gehen direkt aus dem Ringpuffer an den Output-Handler,
+ * es wird nichts zusätzlich zwischengespeichert. CRC32 und Länge aus dem
+ * gzip-Trailer werden am Ende geprüft.
+ */
+class GzipInflater {
+public:
+    // Liefert false, um das Entpacken abzubrechen (z.B. Schreibfehler im Flash).
+    typedef std::function<bool(const uint8_t* data, size_t len)> OutputHandler;
+
+    GzipInflater();
+    ~GzipInflater();
+
+    /**
+     * @brief Erkennt gzip am Magic (1F 8B) oder an der Dateiendung ".gz".
+     */
+    static bool isGzip(const String& filename, const uint8_t* data, size_t len);
+
+    /**
+     * @brief Startet einen neuen Stream. Speicher wird erst mit dem Header belegt.
+     */
+    void begin(OutputHandler output);
+
+    /**
+     * @brief Verarbeitet das nächste komprimierte Stück.
+     * @return false bei Formatfehler, Speichermangel oder Abbruch durch den Handler.
+     */
+    bool write(const uint8_t* data, size_t len);
+
+    /**
+     * @brief Prüft, ob der Stream vollständig war (Trailer gelesen, CRC und Länge stimmen).
+     * Gibt den Speicher in jedem Fall frei.
+     */
+    bool finish();
+
+    /**
+     * @brief Gibt Ringpuffer und Decoder-Zustand frei.
+     */
+    void end();
+
+    const char* error() const { return _error; }
+    size_t bytesIn() const { return _bytesIn; }
+    size_t bytesOut() const { return _bytesOut; }
+    size_t windowSize() const { return _window; }
+
+private:
+    enum State : uint8_t {
+        STATE_HEADER,       // 10 Bytes fester Header
+        STATE_EXTRA_LEN,
+        STATE_EXTRA,        // FEXTRA (hier steht ggf. die Fenstergröße)
+        STATE_NAME,         // FNAME, nullterminiert
+        STATE_COMMENT,      // FCOMMENT, nullterminiert
+        STATE_HEADER_CRC,   // FHCRC
+        STATE_DATA,         // Deflate-Daten
+        STATE_TRAILER,      // CRC32 + ISIZE
+        STATE_DONE,
+        STATE_ERROR
+    };
+
+    OutputHandler _output;
+    State _state;
+    const char* _error;
+
+    uint8_t _head[10];
+    uint8_t _headLen;
+    uint8_t _flags;
+    uint16_t _extraLen;
+    uint16_t _extraPos;
+    uint8_t _extra[5];      // Anfang des Extra-Felds (Subfeld-ID, Länge, Wert)
+    uint8_t _windowBits;
+
+    tinfl_decompressor_tag* _decomp;
+    uint8_t* _ring;
+    size_t _window;
+    size_t _ringPos;
+
+    uint32_t _crc;
+    size_t _bytesIn;
+    size_t _bytesOut;
+
+    uint8_t _trailer[8];
+    uint8_t _trailerLen;
+
+    bool startInflate();
+    size_t inflate(const uint8_t* data, size_t len);
+    bool fail(const char* reason);
+};
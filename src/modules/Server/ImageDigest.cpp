@@ -0,0 +1,107 @@
+//================================================================================
+//| DATEI: ImageDigest.cpp                                                       |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Implementiert den mitlaufenden SHA-256 für OTA-Uploads inkl. Messung der     |
+//| Zeit, die das Hashen pro geschriebenem Puffer kostet.                        |
+//================================================================================
+
+#include "ImageDigest.h"
+#include "JsonWriter.h"
+#include <esp_timer.h>
+
+ImageDigest::ImageDigest()
+    : _hasExpected(false), _matched(false), _finished(false),
+      _bytes(0), _chunks(0), _hashUs(0), _maxChunkUs(0) {
+    _hex[0] = '\0';
+    mbedtls_sha256_init(&_sha);
+}
+
+ImageDigest::~ImageDigest() {
+    mbedtls_sha256_free(&_sha);
+}
+
+static int hexNibble(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+bool ImageDigest::begin(const char* expectedHex) {
+    _hasExpected = false;
+    _matched = false;
+    _finished = false;
+    _hex[0] = '\0';
+    _bytes = _chunks = _hashUs = _maxChunkUs = 0;
+
+    // Startet den Hash in jedem Fall, damit der Ist-Wert gemeldet werden kann.
+    mbedtls_sha256_free(&_sha);
+    mbedtls_sha256_init(&_sha);
+    mbedtls_sha256_starts(&_sha, 0);
+
+    if (!expectedHex || !*expectedHex) return true;
+    if (strlen(expectedHex) != IMAGE_DIGEST_SIZE * 2) return false;
+    for (uint8_t i = 0; i < IMAGE_DIGEST_SIZE; i++) {
+        int hi = hexNibble(expectedHex[2 * i]);
+        int lo = hexNibble(expectedHex[2 * i + 1]);
+        if (hi < 0 || lo < 0) return false;
+        _expected[i] = (uint8_t)((hi << 4) | lo);
+    }
+    _hasExpected = true;
+    return true;
+}
+
+void ImageDigest::update(const uint8_t* data, size_t len) {
+    int64_t t0 = esp_timer_get_time();
+    mbedtls_sha256_update(&_sha, data, len);
+    uint32_t us = (uint32_t)(esp_timer_get_time() - t0);
+
+    _bytes += len;
+    _chunks++;
+    _hashUs += us;
+    if (us > _maxChunkUs) _maxChunkUs = us;
+}
+
+void ImageDigest::prefix(uint8_t out[IMAGE_DIGEST_SIZE]) {
+    mbedtls_sha256_context copy;
+    mbedtls_sha256_init(&copy);
+    mbedtls_sha256_clone(&copy, &_sha);
+    mbedtls_sha256_finish(&copy, out);
+    mbedtls_sha256_free(&copy);
+}
+
+bool ImageDigest::finish() {
+    if (!_finished) {
+        uint8_t digest[IMAGE_DIGEST_SIZE];
+        mbedtls_sha256_finish(&_sha, digest);
+        for (uint8_t i = 0; i < IMAGE_DIGEST_SIZE; i++) {
+            snprintf(_hex + 2 * i, 3, "%02x", digest[i]);
+        }
+        _matched = _hasExpected && memcmp(digest, _expected, IMAGE_DIGEST_SIZE) == 0;
+        _finished = true;
+
+        Serial.printf("SHA-256 %s (%s), %u Bytes in %u us (%u KB/s)\n", _hex,
+                      !_hasExpected ? "nicht geprüft" : (_matched ? "OK" : "ABWEICHUNG"),
+                      (unsigned)_bytes, (unsigned)_hashUs,
+                      (unsigned)(_hashUs ? (uint64_t)_bytes * 1000 / _hashUs : 0));
+    }
+    return !_hasExpected || _matched;
+}
+
+void ImageDigest::writeStatsJson(JsonWriter& json, uint32_t writeBusyUs) const {
+    json.beginObject();
+    json.field("digest", _finished ? _hex : "");
+    json.field("verified", _hasExpected);
+    json.field("matched", _matched);
+    json.field("bytes", _bytes);
+    json.field("hash_us", _hashUs);
+    json.field("kb_per_s", _hashUs ? (uint32_t)((uint64_t)_bytes * 1000 / _hashUs) : 0u);
+    json.field("chunk_avg_us", _chunks ? _hashUs / _chunks : 0u);
+    json.field("chunk_max_us", _maxChunkUs);
+    // Anteil an der Zeit, die der Writer-Task ohnehin mit dem Flash beschäftigt ist
+    json.field("share_of_write_pct", writeBusyUs ? (float)_hashUs * 100.0f / writeBusyUs : 0.0f, 1);
+    json.endObject();
+}
@@ -0,0 +1,88 @@
+//================================================================================
+//| DATEI: ImageDigest.h                                                         |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Bildet beim OTA-Update den SHA-256 des Images, während es geschrieben wird   |
+//| (kein zweites Lesen des Flashs). mbedtls nutzt dafür auf dem ESP32 den       |
+//| SHA-Beschleuniger (CONFIG_MBEDTLS_HARDWARE_SHA).                             |
+//|                                                                              |
+//| Der erwartete Wert kommt aus dem Header "X-Image-SHA256" oder dem Parameter  |
+//| "sha256" (Query-String oder Formularfeld vor der Datei) und bezieht sich     |
+//| auf das geschriebene Image, bei gzip-Uploads also auf die entpackten Daten.  |
+//================================================================================
+
+#pragma once
+
+#include <Arduino.h>
+#include <mbedtls/sha256.h>
+
+class JsonWriter;
+
+#define IMAGE_DIGEST_SIZE  32
+
+/**
+ * @class ImageDigest
+ * @brief Inkrementeller SHA-256 mit Soll-Vergleich und Zeitmessung.
+ *
+ * begin() im httpd-Task, update() im Writer-Task der OtaPipeline, finish()
+ * wieder im httpd-Task, nachdem die Pipeline geleert ist.
+ */
+class ImageDigest {
+public:
+    ImageDigest();
+    ~ImageDigest();
+
+    /**
+     * @brief Startet einen neuen Hash.
+     * @param expectedHex Soll-Wert (64 Hex-Zeichen) oder nullptr/leer für "nicht prüfen".
+     * @return false, wenn der Soll-Wert angegeben, aber kein gültiger SHA-256 ist.
+     */
+    bool begin(const char* expectedHex);
+
+    /**
+     * @brief Nimmt die nächsten geschriebenen Bytes in den Hash auf.
+     */
+    void update(const uint8_t* data, size_t len);
+
+    /**
+     * @brief Schließt den Hash ab und vergleicht mit dem Soll-Wert.
+     * @return true, wenn der Wert stimmt oder keiner vorgegeben war.
+     */
+    bool finish();
+
+    /**
+     * @brief Hash der bisher aufgenommenen Bytes, ohne den laufenden Hash abzuschließen
+     * (Zwischenstand für fortsetzbare Uploads).
+     */
+    void prefix(uint8_t out[IMAGE_DIGEST_SIZE]);
+
+    /**
+     * @brief Soll-Wert als Bytes (nur gültig, wenn hasExpected()).
+     */
+    const uint8_t* expected() const { return _expected; }
+
+    bool hasExpected() const { return _hasExpected; }
+    bool matched() const { return _matched; }
+    const char* hex() const { return _hex; }   // Ist-Wert nach finish()
+
+    /**
+     * @brief Kosten des Hashens: Durchsatz, Mittel und Maximum pro Chunk.
+     * @param writeBusyUs Schreibzeit der Pipeline, um den Anteil des Hashens anzugeben.
+     */
+    void writeStatsJson(JsonWriter& json, uint32_t writeBusyUs) const;
+
+private:
+    mbedtls_sha256_context _sha;
+    uint8_t _expected[IMAGE_DIGEST_SIZE];
+    bool _hasExpected;
+    bool _matched;
+    bool _finished;
+    char _hex[IMAGE_DIGEST_SIZE * 2 + 1];
+
+    uint32_t _bytes;
+    uint32_t _chunks;
+    uint32_t _hashUs;
+    uint32_t _maxChunkUs;
+};
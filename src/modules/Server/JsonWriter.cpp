@@ -0,0 +1,133 @@
+//================================================================================
+//| DATEI: JsonWriter.cpp                                                        |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Implementiert den Streaming-JSON-Writer. Die Verschachtelungstiefe wird in   |
+//| einer Bitmaske verwaltet (max. 32 Ebenen), sodass kein Stack oder Heap für   |
+//| den Dokumentbaum benötigt wird.                                              |
+//================================================================================
+
+#include "JsonWriter.h"
+
+/**
+ * @brief Setzt vor jedem Element (außer dem ersten einer Ebene) ein Komma.
+ * Direkt nach einem Schlüssel wird kein Komma benötigt.
+ */
+void JsonWriter::separator() {
+    if (_afterKey) {
+        _afterKey = false;
+        return;
+    }
+    uint32_t bit = 1UL << _depth;
+    if (_needComma & bit) _out.write(',');
+    _needComma |= bit;
+}
+
+void JsonWriter::beginObject(size_t) {
+    separator();
+    _out.write('{');
+    if (_depth < 31) _depth++;
+    _needComma &= ~(1UL << _depth);
+}
+
+void JsonWriter::endObject() {
+    if (_depth > 0) _depth--;
+    _out.write('}');
+}
+
+void JsonWriter::beginArray(size_t) {
+    separator();
+    _out.write('[');
+    if (_depth < 31) _depth++;
+    _needComma &= ~(1UL << _depth);
+}
+
+void JsonWriter::endArray() {
+    if (_depth > 0) _depth--;
+    _out.write(']');
+}
+
+void JsonWriter::key(const char* name) {
+    separator();
+    _out.write('"');
+    writeEscaped(name);
+    _out.write("\":", 2);
+    _afterKey = true;
+}
+
+void JsonWriter::value(const char* text) {
+    separator();
+    if (!text) {
+        _out.write("null", 4);
+        return;
+    }
+    _out.write('"');
+    writeEscaped(text);
+    _out.write('"');
+}
+
+void JsonWriter::value(bool flag) {
+    separator();
+    if (flag) _out.write("true", 4);
+    else _out.write("false", 5);
+}
+
+void JsonWriter::value(long number) {
+    separator();
+    _out.print(number);
+}
+
+void JsonWriter::value(unsigned long number) {
+    separator();
+    _out.print(number);
+}
+
+void JsonWriter::value(long long number) {
+    separator();
+    _out.print(number);
+}
+
+void JsonWriter::value(unsigned long long number) {
+    separator();
+    _out.print(number);
+}
+
+void JsonWriter::value(float number, uint8_t decimals) {
+    separator();
+    _out.printFixed(number, decimals);
+}
+
+void JsonWriter::nullValue() {
+    separator();
+    _out.write("null", 4);
+}
+
+/**
+ * @brief Schreibt einen String mit JSON-Escaping.
+ * Unkritische Abschnitte werden am Stück kopiert, nur Sonderzeichen einzeln.
+ */
+void JsonWriter::writeEscaped(const char* text) {
+    static const char HEX_DIGITS[] = "0123456789abcdef";
+    const char* run = text;
+    for (const char* p = text; *p; p++) {
+        unsigned char c = (unsigned char)*p;
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+
+        _out.write(run, p - run);
+        run = p + 1;
+        switch (c) {
+            case '"':  _out.write("\\\"", 2); break;
+            case '\\': _out.write("\\\\", 2); break;
+            case '\n': _out.write("\\n", 2); break;
+            case '\r': _out.write("\\r", 2); break;
+            case '\t': _out.write("\\t", 2); break;
+            default: {
+                char esc[6] = {'\\', 'u', '0', '0', HEX_DIGITS[c >> 4], HEX_DIGITS[c & 0x0F]};
+                _out.write(esc, 6);
+            }
+        }
+    }
+    _out.write(run, strlen(run));
+}
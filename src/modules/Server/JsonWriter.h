@@ -0,0 +1,65 @@
+//================================================================================
+//| DATEI: JsonWriter.h                                                          |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Streaming-JSON-Writer für die API-Antworten. Im Gegensatz zu ArduinoJson     |
+//| wird kein Dokument im Speicher aufgebaut: Jedes Feld wird sofort in den      |
+//| ResponseWriter formatiert und bei Bedarf als Chunk gesendet.                 |
+//================================================================================
+
+#pragma once
+
+#include "ResponseWriter.h"
+#include "ValueWriter.h"
+
+/**
+ * @class JsonWriter
+ * @brief Schreibt JSON-Objekte und -Arrays direkt in einen ResponseWriter.
+ *
+ * Kommas und Anführungszeichen werden automatisch gesetzt, Strings werden
+ * korrekt escaped. Beispiel:
+ *   json.beginObject();
+ *   json.field("angle", angle, 2);
+ *   json.field("enabled", true);
+ *   json.endObject();
+ *
+ * Die Anzahl bei beginObject()/beginArray() wird in JSON nicht benötigt.
+ */
+class JsonWriter : public ValueWriter {
+public:
+    explicit JsonWriter(ResponseWriter& out) : _out(out), _depth(0), _needComma(0) {}
+
+    using ValueWriter::value;
+
+    void beginObject(size_t count = VALUE_COUNT_UNKNOWN) override;
+    void endObject() override;
+    void beginArray(size_t count = VALUE_COUNT_UNKNOWN) override;
+    void endArray() override;
+
+    /**
+     * @brief Schreibt einen Schlüssel. Danach muss genau ein Wert folgen.
+     */
+    void key(const char* name) override;
+
+    // --- Werte (in Arrays oder nach key()) ---
+    void value(const char* text) override;
+    void value(bool flag) override;
+    void value(long number) override;
+    void value(unsigned long number) override;
+    void value(long long number) override;
+    void value(unsigned long long number) override;
+    void value(float number, uint8_t decimals = 2) override;
+    void nullValue() override;
+
+private:
+    ResponseWriter& _out;
+    uint8_t _depth;
+    // Bit n = auf Ebene n wurde bereits ein Element geschrieben (Komma nötig).
+    uint32_t _needComma;
+    bool _afterKey = false;
+
+    void separator();
+    void writeEscaped(const char* text);
+};
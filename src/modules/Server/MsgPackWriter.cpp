@@ -0,0 +1,135 @@
+//================================================================================
+//| DATEI: MsgPackWriter.cpp                                                     |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Implementiert den MessagePack-Writer. Kleine Werte passen ins Typ-Byte       |
+//| (fixint, fixstr, fixmap), größere bekommen einen Marker plus Big-Endian-Wert.|
+//================================================================================
+
+#include "MsgPackWriter.h"
+
+/**
+ * @brief Schreibt einen Marker gefolgt von `bytes` Bytes Big-Endian.
+ */
+void MsgPackWriter::writeUint(uint8_t marker, unsigned long long value, uint8_t bytes) {
+    char buf[9];
+    buf[0] = (char)marker;
+    for (uint8_t i = 0; i < bytes; i++) {
+        buf[bytes - i] = (char)(value >> (8 * i));
+    }
+    _out.write(buf, bytes + 1);
+}
+
+/**
+ * @brief Zählt ein Array-Element mit (in Maps zählt key()).
+ */
+void MsgPackWriter::element() {
+    if (_depth == 0 || _depth > MSGPACK_MAX_DEPTH) return;
+    Level& level = _levels[_depth - 1];
+    if (!level.isMap) level.count++;
+}
+
+void MsgPackWriter::begin(bool isMap, size_t count) {
+    element();
+    bool patch = (count == VALUE_COUNT_UNKNOWN);
+    size_t headerPos = _out.bytesWritten();
+
+    if (patch) {
+        writeUint(isMap ? 0xDE : 0xDC, 0, 2);   // map16/array16, Anzahl folgt beim Schließen
+    } else if (count < 16) {
+        _out.write((char)((isMap ? 0x80 : 0x90) | count));
+    } else if (count <= 0xFFFF) {
+        writeUint(isMap ? 0xDE : 0xDC, count, 2);
+    } else {
+        writeUint(isMap ? 0xDF : 0xDD, count, 4);
+    }
+
+    if (_depth < MSGPACK_MAX_DEPTH) {
+        Level& level = _levels[_depth];
+        level.headerPos = headerPos;
+        level.count = 0;
+        level.isMap = isMap;
+        level.patch = patch;
+    } else if (patch) {
+        _failed = true; // Zu tief verschachtelt, Anzahl bleibt 0
+    }
+    _depth++;
+}
+
+void MsgPackWriter::end() {
+    if (_depth == 0) return;
+    _depth--;
+    if (_depth >= MSGPACK_MAX_DEPTH) return;
+    const Level& level = _levels[_depth];
+    if (!level.patch) return;
+    char count[2] = {(char)(level.count >> 8), (char)level.count};
+    if (!_out.patch(level.headerPos + 1, count, sizeof(count))) _failed = true;
+}
+
+void MsgPackWriter::beginObject(size_t count) { begin(true, count); }
+void MsgPackWriter::endObject() { end(); }
+void MsgPackWriter::beginArray(size_t count) { begin(false, count); }
+void MsgPackWriter::endArray() { end(); }
+
+void MsgPackWriter::key(const char* name) {
+    if (_depth > 0 && _depth <= MSGPACK_MAX_DEPTH) _levels[_depth - 1].count++;
+    size_t len = strlen(name);
+    if (len < 32) _out.write((char)(0xA0 | len));
+    else writeUint(0xD9, len, 1);
+    _out.write(name, len);
+}
+
+void MsgPackWriter::value(const char* text) {
+    if (!text) {
+        nullValue();
+        return;
+    }
+    element();
+    size_t len = strlen(text);
+    if (len < 32) _out.write((char)(0xA0 | len));
+    else if (len <= 0xFF) writeUint(0xD9, len, 1);
+    else if (len <= 0xFFFF) writeUint(0xDA, len, 2);
+    else writeUint(0xDB, len, 4);
+    _out.write(text, len);
+}
+
+void MsgPackWriter::value(bool flag) {
+    element();
+    _out.write((char)(flag ? 0xC3 : 0xC2));
+}
+
+void MsgPackWriter::value(unsigned long long number) {
+    element();
+    if (number < 0x80) _out.write((char)number);              // positive fixint
+    else if (number <= 0xFF) writeUint(0xCC, number, 1);
+    else if (number <= 0xFFFF) writeUint(0xCD, number, 2);
+    else if (number <= 0xFFFFFFFFULL) writeUint(0xCE, number, 4);
+    else writeUint(0xCF, number, 8);
+}
+
+void MsgPackWriter::value(long long number) {
+    if (number >= 0) {
+        value((unsigned long long)number);
+        return;
+    }
+    element();
+    if (number >= -32) _out.write((char)number);              // negative fixint
+    else if (number >= -128) writeUint(0xD0, (unsigned long long)number, 1);
+    else if (number >= -32768) writeUint(0xD1, (unsigned long long)number, 2);
+    else if (number >= -2147483648LL) writeUint(0xD2, (unsigned long long)number, 4);
+    else writeUint(0xD3, (unsigned long long)number, 8);
+}
+
+void MsgPackWriter::value(float number, uint8_t) {
+    element();
+    uint32_t bits;
+    memcpy(&bits, &number, sizeof(bits));
+    writeUint(0xCA, bits, 4);
+}
+
+void MsgPackWriter::nullValue() {
+    element();
+    _out.write((char)0xC0);
+}
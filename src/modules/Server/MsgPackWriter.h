@@ -0,0 +1,71 @@
+//================================================================================
+//| DATEI: MsgPackWriter.h                                                       |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Streaming-Writer für MessagePack ("application/msgpack"). Das Format ist     |
+//| ähnlich kompakt wie CBOR, kennt aber keine Objekte ohne Längenangabe.        |
+//================================================================================
+
+#pragma once
+
+#include "ResponseWriter.h"
+#include "ValueWriter.h"
+
+// Maximale Verschachtelungstiefe, für die Elemente mitgezählt werden.
+#define MSGPACK_MAX_DEPTH  8
+
+/**
+ * @class MsgPackWriter
+ * @brief Schreibt MessagePack direkt in einen ResponseWriter.
+ *
+ * Wird beginObject()/beginArray() ohne Anzahl aufgerufen, wird ein 16-Bit-Header
+ * als Platzhalter geschrieben und die mitgezählte Anzahl beim Schließen
+ * nachgetragen. Das geht nur, solange der Header noch im Puffer liegt - große
+ * Antworten sollten die Anzahl daher angeben (sonst liefert failed() true).
+ */
+class MsgPackWriter : public ValueWriter {
+public:
+    explicit MsgPackWriter(ResponseWriter& out) : _out(out), _depth(0), _failed(false) {}
+
+    using ValueWriter::value;
+
+    void beginObject(size_t count = VALUE_COUNT_UNKNOWN) override;
+    void endObject() override;
+    void beginArray(size_t count = VALUE_COUNT_UNKNOWN) override;
+    void endArray() override;
+    void key(const char* name) override;
+
+    void value(const char* text) override;
+    void value(bool flag) override;
+    void value(long number) override { value((long long)number); }
+    void value(unsigned long number) override { value((unsigned long long)number); }
+    void value(long long number) override;
+    void value(unsigned long long number) override;
+    void value(float number, uint8_t decimals = 2) override;
+    void nullValue() override;
+
+    /**
+     * @brief true, wenn eine nachträgliche Anzahl nicht mehr eingetragen werden konnte.
+     */
+    bool failed() const { return _failed; }
+
+private:
+    struct Level {
+        size_t headerPos;   // Position des Platzhalters (nur bei patch)
+        uint16_t count;     // bisher geschriebene Elemente bzw. Schlüssel
+        bool isMap;
+        bool patch;
+    };
+
+    ResponseWriter& _out;
+    Level _levels[MSGPACK_MAX_DEPTH];
+    uint8_t _depth;
+    bool _failed;
+
+    void element();
+    void begin(bool isMap, size_t count);
+    void end();
+    void writeUint(uint8_t marker, unsigned long long value, uint8_t bytes);
+};
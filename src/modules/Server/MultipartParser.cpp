@@ -0,0 +1,256 @@
+//================================================================================
+//| DATEI: MultipartParser.cpp                                                   |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Implementiert die Zustandsmaschine des Multipart-Parsers. Im Body wird per   |
+//| memchr() nach '\r' gesucht, alles davor geht am Stück an den Callback.       |
+//| Da die Boundary kein '\r' enthalten darf, kommt '\r' im Trenner nur an       |
+//| erster Stelle vor - nach einem Fehlvergleich genügt es daher, das aktuelle   |
+//| Zeichen neu zu prüfen (kein KMP-Rückfall nötig).                             |
+//================================================================================
+
+#include "MultipartParser.h"
+
+MultipartParser::MultipartParser()
+    : _delimLen(0), _match(0), _carried(0), _state(STATE_ERROR), _inPart(false), _lineLen(0) {
+    _name[0] = _filename[0] = _partType[0] = '\0';
+}
+
+bool MultipartParser::isMultipart(const char* contentType) {
+    return contentType && strncasecmp(contentType, "multipart/form-data", 19) == 0;
+}
+
+bool MultipartParser::begin(const char* contentType) {
+    _state = STATE_ERROR;
+    if (!isMultipart(contentType)) return false;
+
+    const char* p = strcasestr(contentType, "boundary=");
+    if (!p) return false;
+    p += 9;
+
+    // Boundary darf in Anführungszeichen stehen: boundary="----abc"
+    char quote = (*p == '"') ? *p++ : '\0';
+    const char* end = p;
+    while (*end && (quote ? *end != quote : (*end != ';' && *end != ' ' && *end != '\t'))) end++;
+
+    size_t len = end - p;
+    if (len == 0 || len > MULTIPART_MAX_BOUNDARY || memchr(p, '\r', len)) return false;
+
+    memcpy(_delim, "\r\n--", 4);
+    memcpy(_delim + 4, p, len);
+    _delimLen = (uint8_t)(len + 4);
+
+    // Der erste Trenner steht meist direkt am Anfang (ohne vorangehendes "\r\n").
+    // Wir tun so, als wäre das CRLF schon gelesen worden.
+    _match = 2;
+    _carried = 0;
+    _inPart = false;
+    _state = STATE_PREAMBLE;
+    return true;
+}
+
+void MultipartParser::emit(const uint8_t* data, size_t len) {
+    if (len > 0 && _onData) _onData(data, len);
+}
+
+/**
+ * @brief Kopiert einen (ggf. in Anführungszeichen stehenden) Header-Parameter.
+ * @return true, wenn der Parameter gefunden wurde.
+ */
+static bool copyHeaderParam(const char* line, const char* key, char* out, size_t outSize) {
+    size_t keyLen = strlen(key);
+    const char* p = line;
+    while ((p = strcasestr(p, key)) != nullptr) {
+        // Nur ganze Parameternamen ("name=" darf nicht in "filename=" gefunden werden)
+        bool boundaryOk = (p == line) || p[-1] == ';' || p[-1] == ' ' || p[-1] == '\t';
+        p += keyLen;
+        if (boundaryOk && *p == '=') break;
+    }
+    if (!p) return false;
+    p++;
+
+    size_t n = 0;
+    if (*p == '"') {
+        p++;
+        while (*p && *p != '"' && n < outSize - 1) {
+            if (*p == '\\' && p[1]) p++;
+            out[n++] = *p++;
+        }
+    } else {
+        while (*p && *p != ';' && *p != ' ' && n < outSize - 1) out[n++] = *p++;
+    }
+    out[n] = '\0';
+    return true;
+}
+
+void MultipartParser::parseHeaderLine() {
+    _line[_lineLen] = '\0';
+    const char* colon = strchr(_line, ':');
+    if (!colon) return;
+    const char* value = colon + 1;
+    while (*value == ' ' || *value == '\t') value++;
+    size_t nameLen = colon - _line;
+
+    if (nameLen == 19 && strncasecmp(_line, "Content-Disposition", 19) == 0) {
+        copyHeaderParam(value, "name", _name, sizeof(_name));
+        if (copyHeaderParam(value, "filename", _filename, sizeof(_filename))) {
+            // Manche Browser schicken den kompletten Pfad mit (C:\Users\...\firmware.bin)
+            const char* base = _filename;
+            for (const char* c = _filename; *c; c++) {
+                if (*c == '/' || *c == '\\') base = c + 1;
+            }
+            if (base != _filename) memmove(_filename, base, strlen(base) + 1);
+        }
+    } else if (nameLen == 12 && strncasecmp(_line, "Content-Type", 12) == 0) {
+        strncpy(_partType, value, sizeof(_partType) - 1);
+        _partType[sizeof(_partType) - 1] = '\0';
+    }
+}
+
+/**
+ * @brief Body eines Teils. Gibt zusammenhängende Daten direkt aus dem Eingangspuffer
+ * weiter und hält nur Trenner-Kandidaten zurück.
+ * @return Anzahl verarbeiteter Bytes (bis einschließlich eines gefundenen Trenners).
+ */
+size_t MultipartParser::feedBody(const uint8_t* data, size_t len) {
+    size_t i = 0;
+    size_t runStart = 0;    // Beginn der noch nicht ausgegebenen Daten in diesem Stück
+    size_t matchStart = 0;  // Position des '\r' eines Kandidaten aus diesem Stück
+
+    while (i < len) {
+        if (_match == 0) {
+            const uint8_t* cr = (const uint8_t*)memchr(data + i, '\r', len - i);
+            if (!cr) {
+                i = len;
+                break;
+            }
+            i = cr - data;
+            matchStart = i;
+            _match = 1;
+            i++;
+            continue;
+        }
+
+        if (data[i] == (uint8_t)_delim[_match]) {
+            _match++;
+            i++;
+            if (_match == _delimLen) {
+                // Trenner vollständig: Daten davor gehören noch zum Teil.
+                if (!_carried) emit(data + runStart, matchStart - runStart);
+                _match = 0;
+                _carried = 0;
+                _inPart = false;
+                if (_onEnd) _onEnd();
+                _state = STATE_DELIM_END;
+                return i;
+            }
+            continue;
+        }
+
+        // Doch kein Trenner. Zeichen aus einem früheren Stück stehen nicht mehr im
+        // Puffer, sind aber identisch mit dem Anfang des Trenners.
+        if (_carried) {
+            emit((const uint8_t*)_delim, _carried);
+            _carried = 0;
+        }
+        _match = 0;
+        // Das aktuelle Zeichen nicht überspringen: es kann selbst ein '\r' sein.
+    }
+
+    // Stückende: Kandidat für das nächste Stück zurückhalten
+    if (_match > 0) {
+        if (!_carried) {
+            emit(data + runStart, matchStart - runStart);
+            _carried = _match;
+        } else {
+            _carried = _match; // Kandidat ging über das ganze Stück
+        }
+    } else {
+        emit(data + runStart, len - runStart);
+    }
+    return len;
+}
+
+bool MultipartParser::feed(const uint8_t* data, size_t len) {
+    size_t i = 0;
+    while (i < len) {
+        switch (_state) {
+            case STATE_PREAMBLE: {
+                uint8_t c = data[i++];
+                if (c == (uint8_t)_delim[_match]) {
+                    if (++_match == _delimLen) {
+                        _match = 0;
+                        _state = STATE_DELIM_END;
+                    }
+                } else {
+                    _match = (c == '\r') ? 1 : 0;
+                }
+                break;
+            }
+
+            case STATE_DELIM_END: {
+                uint8_t c = data[i++];
+                if (c == '\r') _state = STATE_DELIM_LF;
+                else if (c == '-') _state = STATE_FINAL_DASH;
+                else if (c != ' ' && c != '\t') _state = STATE_ERROR; // Leerzeichen sind erlaubt (RFC 2046)
+                break;
+            }
+
+            case STATE_DELIM_LF:
+                if (data[i++] != '\n') {
+                    _state = STATE_ERROR;
+                    break;
+                }
+                _lineLen = 0;
+                _name[0] = _filename[0] = _partType[0] = '\0';
+                _state = STATE_HEADER;
+                break;
+
+            case STATE_FINAL_DASH:
+                _state = (data[i++] == '-') ? STATE_DONE : STATE_ERROR;
+                break;
+
+            case STATE_HEADER: {
+                uint8_t c = data[i++];
+                if (c == '\r') {
+                    _state = STATE_HEADER_LF;
+                } else if (_lineLen < MULTIPART_MAX_HEADER) {
+                    _line[_lineLen++] = (char)c;
+                }
+                break;
+            }
+
+            case STATE_HEADER_LF:
+                if (data[i++] != '\n') {
+                    _state = STATE_ERROR;
+                    break;
+                }
+                if (_lineLen == 0) {
+                    // Leerzeile: Header zu Ende, ab jetzt Inhalt
+                    _inPart = true;
+                    _match = 0;
+                    _carried = 0;
+                    if (_onBegin) _onBegin(_name, _filename, _partType);
+                    _state = STATE_BODY;
+                } else {
+                    parseHeaderLine();
+                    _lineLen = 0;
+                    _state = STATE_HEADER;
+                }
+                break;
+
+            case STATE_BODY:
+                i += feedBody(data + i, len - i);
+                break;
+
+            case STATE_DONE:
+                return true; // Epilog wird ignoriert
+
+            case STATE_ERROR:
+                return false;
+        }
+    }
+    return _state != STATE_ERROR;
+}
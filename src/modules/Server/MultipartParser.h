@@ -0,0 +1,113 @@
+//================================================================================
+//| DATEI: MultipartParser.h                                                     |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Inkrementeller Parser für "multipart/form-data" (HTML-Formulare, curl -F).   |
+//| Die Daten kommen in beliebig großen Stücken aus httpd_req_recv(); der Parser |
+//| merkt sich zwischen zwei Stücken nur seinen Zustand, nie die Daten selbst.   |
+//|                                                                              |
+//| KEIN ZWISCHENPUFFER: Datei-Inhalte werden direkt aus dem Empfangspuffer an   |
+//| den Callback gereicht. Endet ein Stück mitten in einem möglichen Trenner     |
+//| ("\r\n--boundary"), wird nur die Anzahl passender Zeichen gespeichert. Stellt |
+//| sich später heraus, dass es doch kein Trenner war, werden diese Zeichen aus  |
+//| dem Trenner-Muster selbst nachgeliefert - sie sind ja identisch.             |
+//================================================================================
+
+#pragma once
+
+#include <Arduino.h>
+#include <functional>
+
+// RFC 2046: Boundary ist höchstens 70 Zeichen lang.
+#define MULTIPART_MAX_BOUNDARY   70
+// Maximale Länge einer Header-Zeile eines Teils (längere werden abgeschnitten).
+#define MULTIPART_MAX_HEADER     160
+// Maximale Länge von Feldname, Dateiname und Content-Type eines Teils.
+#define MULTIPART_MAX_NAME       64
+
+/**
+ * @class MultipartParser
+ * @brief Zustandsmaschine, die einen multipart/form-data Body in Teile zerlegt.
+ *
+ * Ablauf: begin() mit dem Content-Type-Header, dann feed() für jedes empfangene
+ * Stück. Pro Teil wird onPartBegin, beliebig oft onPartData und onPartEnd gerufen.
+ */
+class MultipartParser {
+public:
+    typedef std::function<void(const char* name, const char* filename, const char* contentType)> PartBeginHandler;
+    typedef std::function<void(const uint8_t* data, size_t len)> PartDataHandler;
+    typedef std::function<void()> PartEndHandler;
+
+    MultipartParser();
+
+    /**
+     * @brief Liest die Boundary aus dem Content-Type-Header.
+     * @return false, wenn kein multipart/form-data oder die Boundary ungültig ist.
+     */
+    bool begin(const char* contentType);
+
+    void onPartBegin(PartBeginHandler handler) { _onBegin = handler; }
+    void onPartData(PartDataHandler handler) { _onData = handler; }
+    void onPartEnd(PartEndHandler handler) { _onEnd = handler; }
+
+    /**
+     * @brief Verarbeitet das nächste Stück des Bodys.
+     * @return false bei einem Formatfehler (weitere Daten werden ignoriert).
+     */
+    bool feed(const uint8_t* data, size_t len);
+
+    /**
+     * @brief true, sobald der abschließende Trenner ("--boundary--") gelesen wurde.
+     */
+    bool isDone() const { return _state == STATE_DONE; }
+    bool hasError() const { return _state == STATE_ERROR; }
+
+    /**
+     * @brief true, solange ein Teil begonnen, aber noch nicht beendet wurde
+     * (z.B. wenn der Client die Übertragung abbricht).
+     */
+    bool inPart() const { return _inPart; }
+
+    /**
+     * @brief Prüft, ob ein Content-Type-Header multipart/form-data ist.
+     */
+    static bool isMultipart(const char* contentType);
+
+private:
+    enum State : uint8_t {
+        STATE_PREAMBLE,     // Text vor dem ersten Trenner (wird verworfen)
+        STATE_DELIM_END,    // nach einem Trenner: "\r\n" (nächster Teil) oder "--" (Ende)
+        STATE_DELIM_LF,
+        STATE_FINAL_DASH,
+        STATE_HEADER,       // Header-Zeilen eines Teils
+        STATE_HEADER_LF,
+        STATE_BODY,         // Inhalt eines Teils
+        STATE_DONE,         // Epilog (wird verworfen)
+        STATE_ERROR
+    };
+
+    // Trenner inkl. führendem "\r\n--"
+    char _delim[MULTIPART_MAX_BOUNDARY + 4];
+    uint8_t _delimLen;
+    uint8_t _match;         // Anzahl bereits passender Trenner-Zeichen
+    uint8_t _carried;       // davon aus einem früheren Stück (noch nicht ausgegeben)
+    State _state;
+    bool _inPart;
+
+    // Header des aktuellen Teils
+    char _line[MULTIPART_MAX_HEADER + 1];
+    uint8_t _lineLen;
+    char _name[MULTIPART_MAX_NAME + 1];
+    char _filename[MULTIPART_MAX_NAME + 1];
+    char _partType[MULTIPART_MAX_NAME + 1];
+
+    PartBeginHandler _onBegin;
+    PartDataHandler _onData;
+    PartEndHandler _onEnd;
+
+    size_t feedBody(const uint8_t* data, size_t len);
+    void parseHeaderLine();
+    void emit(const uint8_t* data, size_t len);
+};
@@ -13,6 +13,8 @@
 
 #include "OtaApiHandler.h"
 #include <SPIFFS.h> // Wird benötigt, um die HTML-Seite aus dem Dateisystem zu laden.
+#include "JsonWriter.h"
+#include "ResponseWriter.h"
 
 /**
  * @brief Standard-Konstruktor.
@@ -37,7 +39,7 @@ void OtaApiHandler::registerRoutes(AsyncWebServer& server) {
         } else {
             request->send(404, "text/plain", "update.html nicht gefunden");
         }
-    });
+    }, ROUTE_PRIORITY_BULK);
 
 
     // --- ROUTE 2: Den Firmware-Upload verarbeiten ---
@@ -45,18 +47,22 @@ void OtaApiHandler::registerRoutes(AsyncWebServer& server) {
     // WICHTIG: Durch die Änderung im HTML (Raw Upload) kommen hier reine Binärdaten an.
     server.on("/update", HTTP_POST, 
         // "onRequest"-Handler: Wird ausgeführt, wenn der Upload fertig ist.
-        [](AsyncWebServerRequest *request) {
+        [this](AsyncWebServerRequest *request) {
+            // Bei abgebrochenem Upload kann der Writer-Task noch laufen.
+            _pipeline.end();
+
             // Prüfen, ob während des Schreibens in den Flash ein Fehler aufgetreten ist.
-            bool success = !Update.hasError();
+            // (Hängt der Writer noch, wurde Update gar nicht angefasst.)
+            bool success = !_pipeline.failed() && !Update.hasError();
             
-            // Eine Antwort an den Client senden.
-            request->send(200, "text/plain", success ? "Update ERFOLGREICH! Neustart..." : "Update FEHLGESCHLAGEN!");
+            // Eine Antwort an den Client senden (Header müssen vor dem Body gesetzt werden).
             request->addHeader("Connection", "close"); 
+            sendResult(request, success, success ? "Update ERFOLGREICH! Neustart..." : "Update FEHLGESCHLAGEN!", true);
             
             // Wenn das Update erfolgreich war, starte den ESP32 neu.
+            // Der Neustart läuft verzögert im Worker-Pool, der httpd-Task bleibt frei.
             if (success) {
-                delay(1000);
-                ESP.restart();
+                request->defer([]() { ESP.restart(); }, 1000);
             }
         },
         // "onUpload"-Handler: Wird während des Uploads für jeden Daten-Chunk aufgerufen.
@@ -72,14 +78,14 @@ void OtaApiHandler::registerRoutes(AsyncWebServer& server) {
     // Reagiert auf POST-Anfragen an "/update_spiffs".
     server.on("/update_spiffs", HTTP_POST, 
         // "onRequest"-Handler
-        [](AsyncWebServerRequest *request) {
-            bool success = !Update.hasError();
-            request->send(200, "text/plain", success ? "SPIFFS Update ERFOLGREICH! Neustart..." : "SPIFFS Update FEHLGESCHLAGEN!");
+        [this](AsyncWebServerRequest *request) {
+            _pipeline.end();
+            bool success = !_pipeline.failed() && !Update.hasError();
             request->addHeader("Connection", "close");
+            sendResult(request, success, success ? "SPIFFS Update ERFOLGREICH! Neustart..." : "SPIFFS Update FEHLGESCHLAGEN!", true);
             
             if (success) {
-                delay(1000);
-                ESP.restart();
+                request->defer([]() { ESP.restart(); }, 1000);
             }
         },
         // "onUpload"-Handler
@@ -88,6 +94,119 @@ void OtaApiHandler::registerRoutes(AsyncWebServer& server) {
             this->handleUpdate(request, filename, index, data, len, final, true);
         }
     );
+
+
+    // --- ROUTE 4: Delta-Update ---
+    // Statt des kompletten Images wird nur ein Patch gegen die laufende Firmware
+    // übertragen (erzeugt mit tools/ota_delta.py). Das neue Image wird beim Empfang
+    // zusammengesetzt und erst nach erfolgreicher Hash-Prüfung aktiviert.
+    // Auch der Patch darf gzip-komprimiert sein.
+    server.on("/update_delta", HTTP_POST,
+        [this](AsyncWebServerRequest *request) {
+            request->addHeader("Connection", "close");
+            if (_deltaOk) {
+                sendResult(request, true, "Delta-Update ERFOLGREICH! Neustart...");
+                request->defer([]() { ESP.restart(); }, 1000);
+            } else {
+                _pipeline.end();
+                // Ein hängender Writer benutzt Patcher und Entpacker womöglich noch
+                if (!_pipeline.abandoned()) {
+                    _delta.abort();
+                    _inflater.end();
+                }
+                const char* reason = _delta.error() ? _delta.error() : (_compressed ? _inflater.error() : nullptr);
+                sendResult(request, false, reason ? reason : "Delta-Update FEHLGESCHLAGEN!");
+            }
+        },
+        [this](AsyncWebServerRequest *request, String filename, size_t index, uint8_t *data, size_t len, bool final) {
+            if (index == 0) {
+                Serial.printf("Delta-Update Start: %s\n", filename.c_str());
+                _deltaOk = false;
+                if (_pipeline.abandoned()) {
+                    beginUpload(filename, data, len, nullptr); // lehnt ab, failed() ist gesetzt
+                    return;
+                }
+                if (_resume.active()) _resume.clear();
+                _delta.begin();
+                beginUpload(filename, data, len, [this](const uint8_t* out, size_t n) { return _delta.write(out, n); });
+            }
+            if (len > 0) writeUpload(data, len);
+            if (final) _deltaOk = finishUpload() && !_pipeline.abandoned() && _delta.finish();
+        }
+    );
+
+
+    // --- ROUTE 5: Fortsetzbarer Upload ---
+    // Rohdaten (application/octet-stream) ab Byte `offset` eines Images mit `total`
+    // Bytes und SHA-256 `sha256` (Pflicht bei offset=0), `target`=firmware|spiffs.
+    // Nach einem Abbruch liefert GET /api/ota/session den übernommenen Stand; der
+    // Client sendet ab dort weiter (tools/ota_resume.py). Schon vorhandene Bytes
+    // am Anfang einer Anfrage werden übersprungen. gzip ist hier nicht möglich,
+    // weil sich die Offsets auf das geschriebene Image beziehen.
+    server.on("/update_resume", HTTP_POST,
+        [this](AsyncWebServerRequest *request) {
+            // Ohne Body (z.B. alle Bytes schon übertragen, nur Abschluss fehlt)
+            if (!_resumeBegun) {
+                beginResume(request);
+                finishResume();
+            }
+            // Abgebrochene Verbindung: Was angekommen ist, schreibt der Writer noch fertig.
+            _pipeline.end();
+            _resumeBegun = false;
+            request->addHeader("Connection", "close");
+            sendResumeResult(request);
+            if (_resumeDone && _resumeStatus == 200) {
+                request->defer([]() { ESP.restart(); }, 1000);
+            }
+        },
+        [this](AsyncWebServerRequest *request, String filename, size_t index, uint8_t *data, size_t len, bool final) {
+            if (index == 0) beginResume(request);
+            if (_resumeStatus != 200) return;
+
+            if (_resumeSkip > 0) {
+                size_t n = len < _resumeSkip ? len : _resumeSkip;
+                data += n;
+                len -= n;
+                _resumeSkip -= n;
+            }
+            if (len > 0) writeUpload(data, len);
+            if (final) finishResume();
+        }
+    );
+
+    // --- ROUTE 6: Stand bzw. Abbruch der fortsetzbaren Sitzung ---
+    server.on("/api/ota/session", HTTP_GET, [this](AsyncWebServerRequest *request){
+        char buffer[384];
+        ResponseWriter out(request, 200, "application/json", buffer, sizeof(buffer));
+        JsonWriter json(out);
+        _resume.writeStatusJson(json);
+        out.end();
+    });
+
+    server.on("/api/ota/session/cancel", HTTP_POST, [this](AsyncWebServerRequest *request){
+        _resume.clear();
+        request->send(200, "application/json", "{\"ok\":true}");
+    });
+
+    // Sitzung eines früheren Laufs übernehmen (Abbruch durch Reset/Stromausfall)
+    _resume.load();
+
+
+    // --- ROUTE 7: Statistik der OTA-Pipeline ---
+    // Durchsatz, Wartezeiten (Netzwerk vs. Flash), Pufferbelegung und Kosten
+    // des SHA-256 beim letzten Upload.
+    server.on("/api/ota/stats", HTTP_GET, [this](AsyncWebServerRequest *request){
+        char buffer[640];
+        ResponseWriter out(request, 200, "application/json", buffer, sizeof(buffer));
+        JsonWriter json(out);
+        json.beginObject();
+        json.key("pipeline");
+        _pipeline.writeStatsJson(json);
+        json.key("sha256");
+        _digest.writeStatsJson(json, _pipeline.stats().writeBusyUs);
+        json.endObject();
+        out.end();
+    });
 }
 
 /**
@@ -99,7 +218,26 @@ void OtaApiHandler::handleUpdate(AsyncWebServerRequest *request, String filename
     
     // --- Schritt 1: Das Update starten (wird nur einmal beim allerersten Chunk ausgeführt) ---
     if (index == 0) {
-        Serial.printf("Update Start: %s (%s)\n", filename.c_str(), isSpiffs ? "SPIFFS" : "Firmware");
+        // Hängt der Writer des letzten Uploads noch in Update.write(), darf Update
+        // nicht neu begonnen werden; die Pipeline lehnt alle Daten ab.
+        if (_pipeline.abandoned()) {
+            beginUpload(filename, data, len, nullptr);
+            return;
+        }
+
+        // Ein normales Update überschreibt die Partition einer offenen Sitzung.
+        if (_resume.active()) _resume.clear();
+
+        // Geschrieben wird im Writer-Task der Pipeline; gzip-Uploads werden dort entpackt.
+        // Der SHA-256 läuft über genau die Bytes, die in den Flash gehen.
+        beginUpload(filename, data, len, [this](const uint8_t* out, size_t n) {
+            if (Update.hasError()) return false;
+            _digest.update(out, n);
+            if (Update.write((uint8_t*)out, n) == n) return true;
+            Update.printError(Serial);
+            return false;
+        });
+        Serial.printf("Update Start: %s (%s%s)\n", filename.c_str(), isSpiffs ? "SPIFFS" : "Firmware", _compressed ? ", gzip" : "");
         
         // Wähle das Ziel-Kommando für die `Update`-Bibliothek.
         // U_FLASH -> Nächste freie App-Partition
@@ -111,24 +249,211 @@ void OtaApiHandler::handleUpdate(AsyncWebServerRequest *request, String filename
         if (!Update.begin(UPDATE_SIZE_UNKNOWN, cmd)) {
             Update.printError(Serial);
         }
-    }
 
-    // --- Schritt 2: Die Daten schreiben (wird für jeden Chunk ausgeführt) ---
-    // Schreibe den aktuellen Daten-Chunk in den Flash, solange kein Fehler vorliegt.
-    if (len > 0 && !Update.hasError()) {
-        // `Update.write` gibt die Anzahl der tatsächlich geschriebenen Bytes zurück.
-        if (Update.write(data, len) != len) {
-            Update.printError(Serial);
+        // Erwarteter Hash: Header "X-Image-SHA256" oder Parameter "sha256".
+        char expected[IMAGE_DIGEST_SIZE * 2 + 2];
+        const char* expectedHex = nullptr;
+        if (httpd_req_get_hdr_value_str(request->getNativeRequest(), "X-Image-SHA256", expected, sizeof(expected)) == ESP_OK) {
+            expectedHex = expected;
+        } else {
+            expectedHex = request->argPtr("sha256");
+        }
+        if (!_digest.begin(expectedHex)) {
+            Serial.println("Ungültiger SHA-256 angegeben, Update wird verworfen.");
+            Update.abort();
         }
     }
 
+    // --- Schritt 2: Die Daten weiterreichen (wird für jeden Chunk ausgeführt) ---
+    // Die Daten werden nur in einen Puffer kopiert; den Flash beschreibt der Writer-Task,
+    // während hier schon der nächste Chunk empfangen wird.
+    if (len > 0) writeUpload(data, len);
+
     // --- Schritt 3: Das Update abschließen (wird nur einmal beim letzten Chunk ausgeführt) ---
     if (final) {
+        // Restliche Puffer schreiben, bei gzip Trailer (CRC32, Länge) prüfen.
+        bool written = finishUpload();
+        if (_pipeline.abandoned()) return; // Update gehört noch dem hängenden Writer
+        if (!written) Update.abort();
+        // Ohne passenden Hash wird die neue Partition nicht aktiviert.
+        if (!_digest.finish() && !Update.hasError()) {
+            Serial.println("SHA-256 stimmt nicht mit dem erwarteten Wert überein!");
+            Update.abort();
+        }
         // `Update.end(true)` beendet den Schreibvorgang und verifiziert das Update.
-        if (Update.end(true)) {
-            Serial.printf("Update erfolgreich abgeschlossen: %u Bytes\n", index + len);
+        if (!Update.hasError() && Update.end(true)) {
+            Serial.printf("Update erfolgreich abgeschlossen: %u Bytes\n", (unsigned)uploadBytesOut());
         } else {
             Update.printError(Serial);
         }
     }
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Setzt die Upload-Statistik zurück und startet ggf. den gzip-Entpacker.
+ * @param output Ziel der entpackten Daten (Update.write bzw. DeltaPatcher).
+ */
+void OtaApiHandler::beginUpload(const String& filename, const uint8_t* data, size_t len, GzipInflater::OutputHandler output) {
+    _uploadStartMs = millis();
+    _uploadBytesIn = 0;
+    _compressed = GzipInflater::isGzip(filename, data, len);
+    if (_compressed) {
+        // Erst die Pipeline: lehnt sie ab (hängender Writer), bleibt der Entpacker unberührt.
+        _pipeline.begin([this](const uint8_t* in, size_t n) {
+            if (_inflater.write(in, n)) return true;
+            Serial.printf("Entpacken fehlgeschlagen: %s\n", _inflater.error());
+            return false;
+        });
+        if (!_pipeline.abandoned()) _inflater.begin(output);
+    } else {
+        _pipeline.begin(output);
+    }
+}
+
+/**
+ * @brief Gibt einen empfangenen Chunk an die Pipeline (kehrt sofort zurück, solange ein Puffer frei ist).
+ */
+bool OtaApiHandler::writeUpload(const uint8_t* data, size_t len) {
+    _uploadBytesIn += len;
+    return _pipeline.write(data, len);
+}
+
+/**
+ * @brief Wartet, bis alles geschrieben ist, und prüft bei gzip den Trailer.
+ * @return false, wenn beim Schreiben oder Entpacken ein Fehler auftrat.
+ */
+bool OtaApiHandler::finishUpload() {
+    bool ok = _pipeline.finish();
+    if (_pipeline.abandoned()) return false; // Entpacker gehört noch dem hängenden Writer
+    if (ok && _compressed && !_inflater.finish()) {
+        Serial.printf("Entpacken fehlgeschlagen: %s\n", _inflater.error());
+        ok = false;
+    }
+    _inflater.end();
+    return ok;
+}
+
+/**
+ * @brief Bytes, die tatsächlich geschrieben wurden (bei gzip die entpackte Größe).
+ */
+size_t OtaApiHandler::uploadBytesOut() const {
+    return _compressed ? _inflater.bytesOut() : _uploadBytesIn;
+}
+
+/**
+ * @brief Sendet das Ergebnis inkl. Übertragungsdauer und eingesparter Bytes.
+ * @param withDigest Ist-Wert und Prüfergebnis des SHA-256 anhängen.
+ */
+void OtaApiHandler::sendResult(AsyncWebServerRequest *request, bool success, const char* message, bool withDigest) {
+    size_t bytesOut = uploadBytesOut();
+    unsigned long ms = millis() - _uploadStartMs;
+    int saved = (bytesOut > 0 && _uploadBytesIn < bytesOut) ? (int)(100 - (_uploadBytesIn * 100) / bytesOut) : 0;
+
+    unsigned kbPerSec = ms ? (unsigned)((uint64_t)_uploadBytesIn / ms) : 0;
+
+    char text[320];
+    int n = snprintf(text, sizeof(text), "%s\n%u Bytes übertragen, %u Bytes geschrieben (%d %% gespart), %lu.%lu s, %u KB/s",
+                     message, (unsigned)_uploadBytesIn, (unsigned)bytesOut, saved, ms / 1000, (ms % 1000) / 100, kbPerSec);
+    if (withDigest && _digest.hex()[0] && n > 0 && (size_t)n < sizeof(text)) {
+        snprintf(text + n, sizeof(text) - n, "\nSHA-256 %s (%s)", _digest.hex(),
+                 !_digest.hasExpected() ? "nicht geprüft" : (_digest.matched() ? "geprüft" : "ABWEICHUNG"));
+    }
+    request->send(success ? 200 : 500, "text/plain", text);
+}
+
+/**
+ * @brief Prüft die Parameter von /update_resume und startet bzw. übernimmt die Sitzung.
+ * Setzt _resumeStatus (200, 400 oder 409) und die Anzahl zu überspringender Bytes.
+ */
+void OtaApiHandler::beginResume(AsyncWebServerRequest *request) {
+    _resumeBegun = true;
+    _resumeDone = false;
+    _resumeSkip = 0;
+    _resumeStatus = 200;
+    _resumeError = nullptr;
+    _uploadStartMs = millis();
+    _uploadBytesIn = 0;
+    _compressed = false;
+
+    if (_pipeline.abandoned()) {
+        // _resume.write() läuft womöglich noch im hängenden Writer
+        _resumeStatus = 503;
+        _resumeError = "previous upload still writing, retry later";
+        return;
+    }
+
+    const char* arg = request->argPtr("target");
+    OtaTarget target = (arg && strcmp(arg, "spiffs") == 0) ? OTA_TARGET_SPIFFS : OTA_TARGET_FIRMWARE;
+    arg = request->argPtr("offset");
+    uint32_t offset = arg ? strtoul(arg, nullptr, 10) : 0;
+    arg = request->argPtr("total");
+    uint32_t total = arg ? strtoul(arg, nullptr, 10) : 0;
+
+    char expected[IMAGE_DIGEST_SIZE * 2 + 2];
+    const char* expectedHex = nullptr;
+    if (httpd_req_get_hdr_value_str(request->getNativeRequest(), "X-Image-SHA256", expected, sizeof(expected)) == ESP_OK) {
+        expectedHex = expected;
+    } else {
+        expectedHex = request->argPtr("sha256");
+    }
+
+    if (offset == 0) {
+        if (!_resume.start(target, total, expectedHex)) {
+            _resumeStatus = 400;
+            _resumeError = _resume.error();
+            return;
+        }
+    } else if (!_resume.matches(target, total, expectedHex)) {
+        _resumeStatus = 409;
+        _resumeError = "no matching session, start at offset 0";
+        return;
+    } else if (!_resume.resume()) {
+        _resumeStatus = 409;
+        _resumeError = _resume.error();
+        return;
+    } else if (offset > _resume.committed()) {
+        _resumeStatus = 409;
+        _resumeError = "offset beyond committed data";
+        return;
+    } else {
+        _resumeSkip = _resume.committed() - offset;
+    }
+    Serial.printf("Fortsetzbares Update: ab %u von %u Bytes\n", (unsigned)(offset + _resumeSkip), (unsigned)_resume.total());
+    _pipeline.begin([this](const uint8_t* out, size_t n) { return _resume.write(out, n); });
+}
+
+/**
+ * @brief Leert die Pipeline; ist das Image vollständig, wird es geprüft und aktiviert.
+ */
+void OtaApiHandler::finishResume() {
+    if (_resumeStatus != 200) return;
+    if (!finishUpload()) {
+        _resumeStatus = 500;
+        _resumeError = _resume.error() ? _resume.error() : "write failed";
+    } else if (_resume.complete()) {
+        _resumeDone = true;
+        if (!_resume.finish()) {
+            _resumeStatus = 500;
+            _resumeError = _resume.error();
+        }
+    }
+}
+
+/**
+ * @brief Antwort auf /update_resume: Fehler, Zwischenstand oder Abschluss.
+ */
+void OtaApiHandler::sendResumeResult(AsyncWebServerRequest *request) {
+    char buffer[192];
+    ResponseWriter out(request, _resumeStatus, "application/json", buffer, sizeof(buffer));
+    JsonWriter json(out);
+    json.beginObject();
+    json.field("ok", _resumeStatus == 200);
+    if (_resumeStatus != 200) json.field("error", _resumeError ? _resumeError : "update failed");
+    bool complete = _resumeDone && _resumeStatus == 200;
+    json.field("complete", complete);
+    // Nach einem Hash-Fehler ist die Sitzung beendet, der Client beginnt bei 0.
+    json.field("committed", complete ? _resume.total() : _resume.committed());
+    json.field("received", (uint32_t)_uploadBytesIn);
+    json.endObject();
+    out.end();
+}
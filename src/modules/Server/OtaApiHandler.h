@@ -13,6 +13,11 @@
 
 #include "AsyncWebServer.h"
 #include <Update.h>
+#include "DeltaPatcher.h"
+#include "GzipInflater.h"
+#include "OtaPipeline.h"
+#include "ImageDigest.h"
+#include "ResumableUpdate.h"
 
 class OtaApiHandler {
 public:
@@ -22,11 +27,17 @@ public:
     OtaApiHandler();
 
     /**
-     * @brief Registriert die notwendigen URL-Routen (/update, /update_spiffs) am Webserver.
+     * @brief Registriert die notwendigen URL-Routen (/update, /update_spiffs, /update_delta, /update_resume, /api/ota/...) am Webserver.
      * @param server Referenz auf das Webserver-Objekt.
      */
     void registerRoutes(AsyncWebServer& server);
 
+    /**
+     * @brief true, solange eine fortsetzbare Sitzung die SPIFFS-Partition beschreibt.
+     * Dann darf das Dateisystem beim Start nicht formatiert werden (erst nach registerRoutes()).
+     */
+    bool spiffsResumePending() const { return _resume.active() && _resume.target() == OTA_TARGET_SPIFFS; }
+
 private:
     /**
      * @brief Interne Hilfsfunktion, die den eigentlichen Schreibvorgang in den Flash übernimmt.
@@ -40,4 +51,39 @@ private:
      * @param isSpiffs True für Dateisystem-Update, False für Firmware-Update.
      */
     void handleUpdate(AsyncWebServerRequest *request, String filename, size_t index, uint8_t *data, size_t len, bool final, bool isSpiffs);
+
+    void beginUpload(const String& filename, const uint8_t* data, size_t len, GzipInflater::OutputHandler output);
+    bool writeUpload(const uint8_t* data, size_t len);
+    bool finishUpload();
+    size_t uploadBytesOut() const;
+    void sendResult(AsyncWebServerRequest *request, bool success, const char* message, bool withDigest = false);
+
+    // Fortsetzbarer Upload (/update_resume)
+    void beginResume(AsyncWebServerRequest *request);
+    void finishResume();
+    void sendResumeResult(AsyncWebServerRequest *request);
+
+    // Delta-Update: Patch gegen die laufende Firmware (siehe DeltaPatcher).
+    DeltaPatcher _delta;
+    bool _deltaOk = false;
+
+    // gzip-Uploads und Statistik des laufenden Uploads (für die Antwort)
+    GzipInflater _inflater;
+    bool _compressed = false;
+    unsigned long _uploadStartMs = 0;
+    size_t _uploadBytesIn = 0;
+
+    // Empfang und Flash-Schreiben laufen parallel (Writer-Task, siehe OtaPipeline).
+    OtaPipeline _pipeline;
+
+    // SHA-256 des geschriebenen Images (Firmware/SPIFFS; Delta-Patches prüfen selbst).
+    ImageDigest _digest;
+
+    // Fortsetzbare Sitzung und Zustand der laufenden /update_resume-Anfrage
+    ResumableUpdate _resume;
+    bool _resumeBegun = false;
+    bool _resumeDone = false;
+    size_t _resumeSkip = 0;          // bereits vorhandene Bytes am Anfang dieser Anfrage
+    int _resumeStatus = 200;
+    const char* _resumeError = nullptr;
 };
\ No newline at end of file
@@ -0,0 +1,249 @@
+//================================================================================
+//| DATEI: OtaPipeline.cpp                                                       |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Implementiert die OTA-Pipeline. Zwei Queues mit Puffer-Indizes ("frei" und   |
+//| "gefüllt") verbinden httpd- und Writer-Task, wie die Slot-Queues im          |
+//| WorkerPool. Ein END-Eintrag in der Queue beendet den Writer; er meldet sich  |
+//| über ein Semaphore zurück, danach werden die Puffer freigegeben.             |
+//| Wer zuletzt auf die Puffer zugreift, gibt sie frei: normalerweise end(),     |
+//| nach einem Timeout der Writer selbst.                                        |
+//================================================================================
+
+#include "OtaPipeline.h"
+#include "JsonWriter.h"
+#include <esp_timer.h>
+#include <freertos/task.h>
+
+OtaPipeline::OtaPipeline()
+    : _free(nullptr), _full(nullptr), _done(nullptr), _running(false), _failed(false), _abandoned(false),
+      _writerExited(false), _current(-1), _currentLen(0), _startUs(0), _stats() {
+    _lock = portMUX_INITIALIZER_UNLOCKED;
+    for (uint8_t i = 0; i < OTA_PIPELINE_BUFFERS; i++) _buffers[i] = nullptr;
+}
+
+OtaPipeline::~OtaPipeline() {
+    end();
+}
+
+bool OtaPipeline::abandoned() const {
+    portENTER_CRITICAL(&_lock);
+    bool abandoned = _abandoned;
+    portEXIT_CRITICAL(&_lock);
+    return abandoned;
+}
+
+void OtaPipeline::begin(Sink sink) {
+    end();
+    if (abandoned()) {
+        // Der alte Writer ruft womöglich noch _sink auf: weder ersetzen noch synchron schreiben.
+        Serial.println("OTA-Pipeline: Writer des letzten Uploads hängt noch, Upload abgelehnt.");
+        _failed = true;
+        return;
+    }
+    _sink = sink;
+    _failed = false;
+    _current = -1;
+    _currentLen = 0;
+    _stats = OtaPipelineStats();
+    _startUs = esp_timer_get_time();
+
+    bool ok = true;
+    for (uint8_t i = 0; i < OTA_PIPELINE_BUFFERS && ok; i++) {
+        _buffers[i] = (uint8_t*)malloc(OTA_PIPELINE_BUFFER_SIZE);
+        ok = _buffers[i] != nullptr;
+    }
+    if (ok) {
+        _free = xQueueCreate(OTA_PIPELINE_BUFFERS, sizeof(Block));
+        _full = xQueueCreate(OTA_PIPELINE_BUFFERS + 1, sizeof(Block)); // +1 für END
+        _done = xSemaphoreCreateBinary();
+        ok = _free && _full && _done;
+    }
+    if (ok) {
+        for (uint8_t i = 0; i < OTA_PIPELINE_BUFFERS; i++) {
+            Block block = {i, 0};
+            xQueueSend(_free, &block, 0);
+        }
+        _writerExited = false;
+        ok = xTaskCreate(writerTask, "otaWriter", OTA_WRITER_STACK_SIZE, this, OTA_WRITER_PRIORITY, nullptr) == pdPASS;
+    }
+
+    if (!ok) {
+        // Rückfall: ohne Pipeline direkt im httpd-Task schreiben (wie vorher).
+        Serial.println("OTA-Pipeline: zu wenig Speicher, schreibe synchron.");
+        end();
+        return;
+    }
+    _running = true;
+    _stats.pipelined = true;
+}
+
+/**
+ * @brief Reiht den aktuellen Puffer beim Writer ein und zählt die Belegung.
+ */
+bool OtaPipeline::submitCurrent() {
+    Block block = {(uint8_t)_current, _currentLen};
+    _current = -1;
+    _currentLen = 0;
+    // Belegung vor dem Einreihen: 0 = Writer hat nichts mehr zu tun.
+    UBaseType_t waiting = uxQueueMessagesWaiting(_full);
+    if (waiting > OTA_PIPELINE_BUFFERS) waiting = OTA_PIPELINE_BUFFERS;
+    _stats.occupancy[waiting]++;
+    _stats.bytes += block.len;
+    return xQueueSend(_full, &block, 0) == pdTRUE; // Queue fasst alle Puffer
+}
+
+bool OtaPipeline::write(const uint8_t* data, size_t len) {
+    if (_failed) return false;
+
+    if (!_running) {
+        // Synchroner Rückfall
+        int64_t t0 = esp_timer_get_time();
+        if (!_sink(data, len)) _failed = true;
+        _stats.writeBusyUs += (uint32_t)(esp_timer_get_time() - t0);
+        _stats.bytes += len;
+        return !_failed;
+    }
+
+    while (len > 0) {
+        if (_current < 0) {
+            Block block;
+            int64_t t0 = esp_timer_get_time();
+            if (xQueueReceive(_free, &block, pdMS_TO_TICKS(OTA_PIPELINE_TIMEOUT_MS)) != pdTRUE) {
+                Serial.println("OTA-Pipeline: Writer antwortet nicht.");
+                _failed = true;
+                return false;
+            }
+            _stats.recvStallUs += (uint32_t)(esp_timer_get_time() - t0);
+            _current = block.index;
+        }
+
+        size_t n = OTA_PIPELINE_BUFFER_SIZE - _currentLen;
+        if (n > len) n = len;
+        memcpy(_buffers[_current] + _currentLen, data, n);
+        _currentLen += n;
+        data += n;
+        len -= n;
+
+        if (_currentLen == OTA_PIPELINE_BUFFER_SIZE) submitCurrent();
+    }
+    return !_failed;
+}
+
+void OtaPipeline::writerTask(void* arg) {
+    OtaPipeline* self = (OtaPipeline*)arg;
+    for (;;) {
+        Block block;
+        int64_t t0 = esp_timer_get_time();
+        xQueueReceive(self->_full, &block, portMAX_DELAY);
+        int64_t t1 = esp_timer_get_time();
+        if (block.index == BLOCK_END) break;
+        self->_stats.writeStallUs += (uint32_t)(t1 - t0);
+
+        // Nach einem Fehler werden die Puffer nur noch zurückgegeben.
+        if (!self->_failed) {
+            if (!self->_sink(self->_buffers[block.index], block.len)) self->_failed = true;
+            self->_stats.writeBusyUs += (uint32_t)(esp_timer_get_time() - t1);
+            self->_stats.buffers++;
+        }
+        block.len = 0;
+        xQueueSend(self->_free, &block, 0);
+    }
+
+    portENTER_CRITICAL(&self->_lock);
+    bool abandoned = self->_abandoned;
+    self->_writerExited = true;
+    portEXIT_CRITICAL(&self->_lock);
+    if (abandoned) {
+        // end() wartet nicht mehr: Puffer und Queues gehören uns, danach ist die Pipeline wieder frei.
+        Serial.println("OTA-Pipeline: hängender Writer beendet, Puffer freigegeben.");
+        self->release();
+        portENTER_CRITICAL(&self->_lock);
+        self->_abandoned = false;
+        portEXIT_CRITICAL(&self->_lock);
+    } else {
+        xSemaphoreGive(self->_done);
+    }
+    vTaskDelete(nullptr);
+}
+
+bool OtaPipeline::finish() {
+    if (_running && _current >= 0 && _currentLen > 0) submitCurrent();
+    end();
+    _stats.durationUs = (uint32_t)(esp_timer_get_time() - _startUs);
+
+    const OtaPipelineStats& s = _stats;
+    Serial.printf("OTA-Pipeline: %u Bytes in %u ms (%u KB/s), Empfang wartet %u ms, Flash wartet %u ms, Flash aktiv %u ms\n",
+                  (unsigned)s.bytes, (unsigned)(s.durationUs / 1000),
+                  (unsigned)(s.durationUs ? (uint64_t)s.bytes * 1000 / s.durationUs : 0),
+                  (unsigned)(s.recvStallUs / 1000), (unsigned)(s.writeStallUs / 1000), (unsigned)(s.writeBusyUs / 1000));
+    return !_failed;
+}
+
+void OtaPipeline::end() {
+    if (_running) {
+        // END hinter die letzten gefüllten Puffer stellen und warten, bis alles geschrieben ist.
+        Block block = {BLOCK_END, 0};
+        xQueueSend(_full, &block, portMAX_DELAY);
+        if (xSemaphoreTake(_done, pdMS_TO_TICKS(OTA_PIPELINE_TIMEOUT_MS)) != pdTRUE) {
+            portENTER_CRITICAL(&_lock);
+            bool exited = _writerExited;
+            if (!exited) _abandoned = true;
+            portEXIT_CRITICAL(&_lock);
+            _failed = true;
+            _running = false;
+            if (!exited) {
+                // Der Writer hängt im Flash: Puffer gehören jetzt ihm, er gibt sie selbst frei.
+                Serial.println("OTA-Pipeline: Writer beendet sich nicht, Puffer bleiben belegt.");
+                return;
+            }
+            // Knapp verpasst: der Writer gibt _done gleich, erst danach darf es weg
+            xSemaphoreTake(_done, portMAX_DELAY);
+        }
+        _running = false;
+    }
+    if (abandoned()) return;
+    release();
+}
+
+/**
+ * @brief Gibt Puffer, Queues und Semaphore frei. Nur ohne laufenden Writer.
+ */
+void OtaPipeline::release() {
+    for (uint8_t i = 0; i < OTA_PIPELINE_BUFFERS; i++) {
+        free(_buffers[i]);
+        _buffers[i] = nullptr;
+    }
+    if (_free) vQueueDelete(_free);
+    if (_full) vQueueDelete(_full);
+    if (_done) vSemaphoreDelete(_done);
+    _free = _full = nullptr;
+    _done = nullptr;
+    _current = -1;
+    _currentLen = 0;
+}
+
+void OtaPipeline::writeStatsJson(JsonWriter& json) const {
+    const OtaPipelineStats& s = _stats;
+    // Während eines Uploads die bisherige Dauer verwenden
+    uint32_t durationUs = _running ? (uint32_t)(esp_timer_get_time() - _startUs) : s.durationUs;
+
+    json.beginObject();
+    json.field("active", _running);
+    json.field("pipelined", s.pipelined);
+    json.field("buffers", OTA_PIPELINE_BUFFERS);
+    json.field("buffer_size", OTA_PIPELINE_BUFFER_SIZE);
+    json.field("bytes", s.bytes);
+    json.field("duration_ms", durationUs / 1000);
+    json.field("kb_per_s", durationUs ? (uint32_t)((uint64_t)s.bytes * 1000 / durationUs) : 0u);
+    json.field("recv_stall_ms", s.recvStallUs / 1000);
+    json.field("write_stall_ms", s.writeStallUs / 1000);
+    json.field("write_busy_ms", s.writeBusyUs / 1000);
+    json.key("occupancy");
+    json.beginArray();
+    for (uint8_t i = 0; i <= OTA_PIPELINE_BUFFERS; i++) json.value(s.occupancy[i]);
+    json.endArray();
+    json.endObject();
+}
@@ -0,0 +1,139 @@
+//================================================================================
+//| DATEI: OtaPipeline.h                                                         |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Entkoppelt beim OTA-Update den Empfang vom Schreiben in den Flash. Der       |
+//| httpd-Task kopiert die empfangenen Daten in einen von drei 4-KB-Puffern      |
+//| und liest sofort weiter; ein eigener Writer-Task leert die gefüllten Puffer  |
+//| (Update.write, Entpacken, Delta-Patch). Während ein Sektor gelöscht und      |
+//| programmiert wird, läuft der TCP-Empfang also weiter.                        |
+//|                                                                              |
+//| STATISTIK: Durchsatz, Wartezeit auf beiden Seiten ("recv_stall": httpd       |
+//| wartet auf einen freien Puffer = Flash ist der Engpass, "write_stall":       |
+//| Writer wartet auf Daten = Netzwerk ist der Engpass) und ein Histogramm der   |
+//| Pufferbelegung. Abrufbar unter /api/ota/stats.                               |
+//|                                                                              |
+//| HÄNGT DER WRITER (Flash antwortet nicht innerhalb OTA_PIPELINE_TIMEOUT_MS),  |
+//| gehören Puffer, Queues und Sink ab dann ihm: Er gibt sie selbst frei, wenn   |
+//| er doch noch endet. Bis dahin lehnt begin() jeden neuen Upload ab.           |
+//================================================================================
+
+#pragma once
+
+#include <Arduino.h>
+#include <functional>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+
+class JsonWriter;
+
+// Anzahl und Größe der Puffer (4 KB = ein Flash-Sektor).
+#define OTA_PIPELINE_BUFFERS      3
+#define OTA_PIPELINE_BUFFER_SIZE  4096
+// Stack des Writer-Tasks (Update.write, tinfl, SHA-256 des Delta-Patchers).
+#define OTA_WRITER_STACK_SIZE     6144
+// Unter dem httpd-Task (Priorität 5): Sobald Daten ankommen, wird zuerst empfangen.
+#define OTA_WRITER_PRIORITY       4
+// Längste Wartezeit auf einen freien Puffer bzw. auf das Leeren am Ende.
+#define OTA_PIPELINE_TIMEOUT_MS   30000
+
+/**
+ * @brief Kennzahlen des letzten (bzw. laufenden) Uploads.
+ */
+struct OtaPipelineStats {
+    uint32_t bytes;             // an den Writer übergebene Bytes
+    uint32_t buffers;           // geschriebene Puffer
+    uint32_t durationUs;        // begin() bis finish()
+    uint32_t recvStallUs;       // httpd wartet auf einen freien Puffer
+    uint32_t writeStallUs;      // Writer wartet auf einen gefüllten Puffer
+    uint32_t writeBusyUs;       // Zeit im Writer (Flash, Entpacken)
+    uint32_t occupancy[OTA_PIPELINE_BUFFERS + 1]; // wartende Puffer beim Einreihen (0..N)
+    bool pipelined;             // false: synchroner Rückfall (zu wenig Speicher)
+};
+
+/**
+ * @class OtaPipeline
+ * @brief Puffer-Pipeline zwischen httpd-Task und einem Writer-Task.
+ *
+ * Ablauf: begin(sink), write() für jedes empfangene Stück, am Ende finish().
+ * Der Sink läuft im Writer-Task; liefert er false, werden alle weiteren Daten
+ * verworfen und finish() meldet den Fehler. Puffer und Task existieren nur
+ * während eines Uploads.
+ */
+class OtaPipeline {
+public:
+    typedef std::function<bool(const uint8_t* data, size_t len)> Sink;
+
+    OtaPipeline();
+    ~OtaPipeline();
+
+    /**
+     * @brief Legt Puffer, Queues und Writer-Task an.
+     * Reicht der Speicher nicht, wird synchron im httpd-Task geschrieben.
+     */
+    void begin(Sink sink);
+
+    /**
+     * @brief Kopiert Daten in die Pipeline. Blockiert nur, wenn alle Puffer voll sind.
+     * @return false, wenn der Writer bereits einen Fehler gemeldet hat.
+     */
+    bool write(const uint8_t* data, size_t len);
+
+    /**
+     * @brief Reicht den letzten Puffer weiter und wartet, bis alles geschrieben ist.
+     * @return true, wenn der Sink alle Daten angenommen hat.
+     */
+    bool finish();
+
+    /**
+     * @brief Beendet den Writer-Task und gibt die Puffer frei (auch nach Abbruch).
+     * Endet der Writer nicht rechtzeitig, bleibt alles ihm überlassen (abandoned()).
+     */
+    void end();
+
+    bool failed() const { return _failed; }
+
+    /**
+     * @brief true, solange ein hängender Writer Puffer und Sink noch benutzt.
+     * Dann darf auch nichts angefasst werden, was der Sink verwendet (Update, Entpacker).
+     */
+    bool abandoned() const;
+    const OtaPipelineStats& stats() const { return _stats; }
+
+    /**
+     * @brief Schreibt die Kennzahlen als JSON-Objekt (inkl. KB/s).
+     */
+    void writeStatsJson(JsonWriter& json) const;
+
+private:
+    // Über die Queues werden nur Puffer-Indizes und Füllstände verschickt.
+    struct Block {
+        uint8_t index;
+        uint16_t len;
+    };
+    static const uint8_t BLOCK_END = 0xFF;
+
+    Sink _sink;
+    uint8_t* _buffers[OTA_PIPELINE_BUFFERS];
+    QueueHandle_t _free;
+    QueueHandle_t _full;
+    SemaphoreHandle_t _done;
+    bool _running;
+    volatile bool _failed;
+    mutable portMUX_TYPE _lock; // Übergabe der Puffer zwischen end() und Writer
+    bool _abandoned;            // end() hat aufgegeben, der Writer räumt selbst auf
+    bool _writerExited;         // Writer hat END gelesen und gibt gleich _done
+
+    int16_t _current;           // Puffer, der gerade gefüllt wird (-1: keiner)
+    uint16_t _currentLen;
+    int64_t _startUs;
+
+    OtaPipelineStats _stats;
+
+    bool submitCurrent();
+    void release();
+    static void writerTask(void* arg);
+};
@@ -0,0 +1,149 @@
+//================================================================================
+//| DATEI: ResponseWriter.cpp                                                    |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Implementiert den allokationsfreien Antwort-Puffer. Zahlen werden mit        |
+//| eigener Ganzzahl- bzw. Festkomma-Formatierung direkt in den Puffer           |
+//| geschrieben, was deutlich schneller ist als String(float, n) oder printf.    |
+//================================================================================
+
+#include "ResponseWriter.h"
+#include "AsyncWebServer.h"
+
+// Zehnerpotenzen für die Festkomma-Formatierung (max. 6 Nachkommastellen).
+static const uint32_t POW10[] = {1, 10, 100, 1000, 10000, 100000, 1000000};
+
+ResponseWriter::ResponseWriter(AsyncWebServerRequest* request, int code, const char* contentType, char* buffer, size_t capacity)
+    : _request(request), _code(code), _contentType(contentType), _buf(buffer), _cap(capacity),
+      _len(0), _flushed(0), _chunked(false), _overflow(false), _ended(false) {}
+
+/**
+ * @brief Sendet den aktuellen Pufferinhalt als Chunk und leert den Puffer.
+ * Beim ersten Flush werden Status und MIME-Type gesetzt.
+ */
+void ResponseWriter::flush() {
+    if (!_request) {
+        _overflow = true;
+        return;
+    }
+    if (!_chunked) {
+        _request->beginResponse(_code, _contentType);
+        _chunked = true;
+    }
+    if (!_request->sendChunk(_buf, _len)) {
+        _overflow = true; // Client weg - restliche Daten verwerfen
+    }
+    _flushed += _len;
+    _len = 0;
+}
+
+void ResponseWriter::write(const char* data, size_t len) {
+    while (len > 0) {
+        if (_len == _cap) {
+            flush();
+            if (_overflow) return;
+        }
+        size_t n = _cap - _len;
+        if (n > len) n = len;
+        memcpy(_buf + _len, data, n);
+        _len += n;
+        data += n;
+        len -= n;
+    }
+}
+
+bool ResponseWriter::patch(size_t position, const char* data, size_t len) {
+    if (position < _flushed || position + len > _flushed + _len) return false;
+    memcpy(_buf + (position - _flushed), data, len);
+    return true;
+}
+
+void ResponseWriter::write(char c) {
+    if (_len == _cap) {
+        flush();
+        if (_overflow) return;
+    }
+    _buf[_len++] = c;
+}
+
+void ResponseWriter::print(unsigned long value) {
+    print((unsigned long long)value);
+}
+
+void ResponseWriter::print(long value) {
+    print((long long)value);
+}
+
+void ResponseWriter::print(unsigned long long value) {
+    // Ziffern rückwärts in einen kleinen Stack-Puffer schreiben.
+    char digits[20];
+    uint8_t n = 0;
+    do {
+        digits[sizeof(digits) - 1 - n] = (char)('0' + (value % 10));
+        value /= 10;
+        n++;
+    } while (value > 0);
+    write(digits + sizeof(digits) - n, n);
+}
+
+void ResponseWriter::print(long long value) {
+    if (value < 0) {
+        write('-');
+        print((unsigned long long)(-(value + 1)) + 1);
+    } else {
+        print((unsigned long long)value);
+    }
+}
+
+void ResponseWriter::printFixed(float value, uint8_t decimals) {
+    if (isnan(value) || isinf(value)) {
+        write("null", 4);
+        return;
+    }
+    if (decimals > 6) decimals = 6;
+
+    // Wert auf Festkomma skalieren und kaufmännisch runden.
+    // Eine float-Mantisse hat nur 24 Bit, daher reicht die Genauigkeit von double hier aus.
+    double scaled = (double)value * POW10[decimals];
+    bool negative = scaled < 0;
+    if (negative) scaled = -scaled;
+    if (scaled >= 9.0e18) {
+        // Außerhalb des Festkomma-Bereichs: ganzzahlig ausgeben.
+        if (negative) write('-');
+        print((unsigned long long)(scaled / POW10[decimals]));
+        return;
+    }
+    unsigned long long fixed = (unsigned long long)(scaled + 0.5);
+
+    unsigned long long intPart = fixed / POW10[decimals];
+    uint32_t fracPart = (uint32_t)(fixed % POW10[decimals]);
+
+    if (negative && fixed != 0) write('-');
+    print(intPart);
+    if (decimals == 0) return;
+
+    char frac[6];
+    for (int i = decimals - 1; i >= 0; i--) {
+        frac[i] = (char)('0' + fracPart % 10);
+        fracPart /= 10;
+    }
+    write('.');
+    write(frac, decimals);
+}
+
+void ResponseWriter::end() {
+    if (_ended || !_request) return;
+    _ended = true;
+    if (_chunked) {
+        if (!_overflow) {
+            _request->sendChunk(_buf, _len);
+            _flushed += _len;
+            _len = 0;
+        }
+        _request->endResponse();
+    } else {
+        _request->sendBuffer(_code, _contentType, _buf, _len);
+    }
+}
@@ -0,0 +1,92 @@
+//================================================================================
+//| DATEI: ResponseWriter.h                                                      |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Puffer für dynamisch erzeugte HTTP-Antworten. Text und Zahlen werden direkt  |
+//| in einen festen Puffer (Stack) formatiert. Passt die Antwort hinein, wird    |
+//| sie in einem Stück gesendet; läuft der Puffer voll, wird automatisch auf     |
+//| Chunked-Transfer umgeschaltet. Es wird kein Heap-Speicher verwendet.         |
+//================================================================================
+
+#pragma once
+
+#include <Arduino.h>
+
+class AsyncWebServerRequest;
+
+/**
+ * @class ResponseWriter
+ * @brief Allokationsfreier Ausgabepuffer mit automatischem Chunk-Flush.
+ *
+ * Beispiel:
+ *   char buf[256];
+ *   ResponseWriter out(request, 200, "text/plain", buf, sizeof(buf));
+ *   out.print("Wert: "); out.print(42L);
+ *   out.end();
+ *
+ * Ohne Request (nullptr) arbeitet die Klasse als reiner Formatierungspuffer.
+ * Läuft er dann über, wird der Rest verworfen und overflowed() liefert true.
+ */
+class ResponseWriter {
+public:
+    ResponseWriter(AsyncWebServerRequest* request, int code, const char* contentType, char* buffer, size_t capacity);
+
+    // --- Rohdaten ---
+    void write(const char* data, size_t len);
+    void write(char c);
+    void print(const char* text) { write(text, strlen(text)); }
+    void print(const String& text) { write(text.c_str(), text.length()); }
+
+    // --- Zahlen (ohne printf, ohne String) ---
+    void print(long value);
+    void print(unsigned long value);
+    void print(int value) { print((long)value); }
+    void print(unsigned int value) { print((unsigned long)value); }
+    void print(long long value);
+    void print(unsigned long long value);
+
+    /**
+     * @brief Gibt eine Fließkommazahl mit fester Anzahl Nachkommastellen aus.
+     * Arbeitet über Festkomma-Ganzzahlen statt über printf("%f").
+     * NaN/Unendlich werden als "null" ausgegeben (gültiges JSON).
+     */
+    void printFixed(float value, uint8_t decimals);
+
+    /**
+     * @brief Schließt die Antwort ab und sendet sie.
+     * Wurde noch nichts gesendet, geht alles in einem Stück raus (mit Content-Length),
+     * ansonsten wird der Restpuffer als letzter Chunk gesendet.
+     */
+    void end();
+
+    // --- Zugriff für Puffer-Betrieb (ohne Request) ---
+    const char* data() const { return _buf; }
+    size_t length() const { return _len; }
+    bool overflowed() const { return _overflow; }
+
+    // Gesamtzahl geschriebener Bytes (inkl. bereits gesendeter Chunks).
+    size_t bytesWritten() const { return _flushed + _len; }
+
+    /**
+     * @brief Überschreibt bereits geschriebene Bytes (z.B. eine nachträglich bekannte Länge).
+     * @param position Absolute Position wie von bytesWritten() geliefert.
+     * @return false, wenn die Stelle schon als Chunk gesendet wurde.
+     */
+    bool patch(size_t position, const char* data, size_t len);
+
+private:
+    AsyncWebServerRequest* _request;
+    int _code;
+    const char* _contentType;
+    char* _buf;
+    size_t _cap;
+    size_t _len;
+    size_t _flushed;
+    bool _chunked;
+    bool _overflow;
+    bool _ended;
+
+    void flush();
+};
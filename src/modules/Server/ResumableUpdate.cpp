@@ -0,0 +1,229 @@
+//================================================================================
+//| DATEI: ResumableUpdate.cpp                                                   |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Implementiert die fortsetzbare OTA-Sitzung. Schreibvorgänge werden an den    |
+//| 64-KB-Grenzen geteilt, damit jeder Checkpoint auf einer Sektorgrenze liegt:  |
+//| Nach einem Neustart wird ab dort neu gelöscht und geschrieben, halb          |
+//| beschriebene Sektoren kann es also nicht geben.                              |
+//================================================================================
+
+#include "ResumableUpdate.h"
+#include "JsonWriter.h"
+#include <Preferences.h>
+#include <esp_ota_ops.h>
+
+#define OTA_RESUME_MAGIC      0x4F544152  // "OTAR"
+#define OTA_RESUME_NAMESPACE  "ota_resume"
+
+static void toHex(const uint8_t* data, size_t len, char* out) {
+    for (size_t i = 0; i < len; i++) snprintf(out + 2 * i, 3, "%02x", data[i]);
+}
+
+ResumableUpdate::ResumableUpdate()
+    : _active(false), _hashValid(false), _target(OTA_TARGET_FIRMWARE), _partition(nullptr),
+      _total(0), _committed(0), _checkpointed(0), _erasedTo(0), _error(nullptr) {}
+
+bool ResumableUpdate::fail(const char* reason) {
+    _error = reason;
+    Serial.printf("Fortsetzbares Update: %s\n", reason);
+    return false;
+}
+
+const esp_partition_t* ResumableUpdate::findPartition(OtaTarget target) {
+    if (target == OTA_TARGET_SPIFFS) {
+        return esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_SPIFFS, nullptr);
+    }
+    return esp_ota_get_next_update_partition(nullptr);
+}
+
+void ResumableUpdate::load() {
+    State s;
+    Preferences preferences;
+    if (!preferences.begin(OTA_RESUME_NAMESPACE, true)) return; // Namespace existiert noch nicht
+    size_t size = preferences.getBytes("state", &s, sizeof(s));
+    preferences.end();
+    if (size != sizeof(s) || s.magic != OTA_RESUME_MAGIC) return;
+
+    // Die Partition muss noch dieselbe Rolle haben (z.B. nicht inzwischen gebootet sein).
+    const esp_partition_t* partition = findPartition((OtaTarget)s.target);
+    if (!partition || strncmp(partition->label, s.label, sizeof(s.label)) != 0 ||
+        s.total > partition->size || s.committed > s.total || s.committed % OTA_RESUME_SECTOR != 0) {
+        clear();
+        return;
+    }
+
+    _target = (OtaTarget)s.target;
+    _partition = partition;
+    _total = s.total;
+    _committed = _checkpointed = _erasedTo = s.committed;
+    memcpy(_expected, s.expected, sizeof(_expected));
+    memcpy(_prefix, s.prefix, sizeof(_prefix));
+    _hashValid = false; // wird bei resume() aus dem Flash nachgerechnet
+    _active = true;
+    Serial.printf("Fortsetzbares Update gefunden: %u von %u Bytes (%s)\n",
+                  (unsigned)_committed, (unsigned)_total, _partition->label);
+}
+
+bool ResumableUpdate::start(OtaTarget target, uint32_t total, const char* sha256Hex) {
+    clear();
+    _error = nullptr;
+
+    if (!sha256Hex || !_digest.begin(sha256Hex) || !_digest.hasExpected()) return fail("sha256 required");
+    const esp_partition_t* partition = findPartition(target);
+    if (!partition) return fail("no target partition");
+    if (total == 0 || total > partition->size) return fail("invalid total size");
+
+    _target = target;
+    _partition = partition;
+    _total = total;
+    _committed = _erasedTo = 0;
+    memcpy(_expected, _digest.expected(), sizeof(_expected));
+    _hashValid = true;
+    _active = true;
+    checkpoint(); // Sitzung sofort sichtbar machen (auch nach einem Neustart)
+    Serial.printf("Fortsetzbares Update gestartet: %u Bytes -> %s\n", (unsigned)_total, _partition->label);
+    return true;
+}
+
+bool ResumableUpdate::matches(OtaTarget target, uint32_t total, const char* sha256Hex) const {
+    if (!_active || target != _target) return false;
+    if (total != 0 && total != _total) return false;
+    if (sha256Hex && *sha256Hex) {
+        char hex[IMAGE_DIGEST_SIZE * 2 + 1];
+        toHex(_expected, sizeof(_expected), hex);
+        if (strcasecmp(hex, sha256Hex) != 0) return false;
+    }
+    return true;
+}
+
+bool ResumableUpdate::resume() {
+    _error = nullptr;
+    if (!_active) return fail("no session");
+    if (_hashValid) return true;
+
+    // Hash des bereits geschriebenen Anfangsstücks aus dem Flash nachbilden
+    char hex[IMAGE_DIGEST_SIZE * 2 + 1];
+    toHex(_expected, sizeof(_expected), hex);
+    _digest.begin(hex);
+
+    uint8_t* buf = (uint8_t*)malloc(OTA_RESUME_SECTOR);
+    if (!buf) return fail("out of memory");
+    bool ok = true;
+    for (uint32_t offset = 0; offset < _committed && ok; offset += OTA_RESUME_SECTOR) {
+        uint32_t n = _committed - offset;
+        if (n > OTA_RESUME_SECTOR) n = OTA_RESUME_SECTOR;
+        ok = esp_partition_read(_partition, offset, buf, n) == ESP_OK;
+        if (ok) _digest.update(buf, n);
+    }
+    free(buf);
+
+    uint8_t prefix[IMAGE_DIGEST_SIZE];
+    _digest.prefix(prefix);
+    if (!ok || memcmp(prefix, _prefix, sizeof(prefix)) != 0) {
+        clear();
+        return fail("stored data does not match, restart from offset 0");
+    }
+    _hashValid = true;
+    return true;
+}
+
+/**
+ * @brief Schreibt ein Stück, das keine Checkpoint-Grenze überschreitet.
+ */
+bool ResumableUpdate::writeAligned(const uint8_t* data, size_t len) {
+    // Sektoren erst direkt vor dem Beschreiben löschen
+    while (_erasedTo < _committed + len) {
+        if (esp_partition_erase_range(_partition, _erasedTo, OTA_RESUME_SECTOR) != ESP_OK) return fail("flash erase failed");
+        _erasedTo += OTA_RESUME_SECTOR;
+    }
+    if (esp_partition_write(_partition, _committed, data, len) != ESP_OK) return fail("flash write failed");
+    _digest.update(data, len);
+    _committed += len;
+    return true;
+}
+
+bool ResumableUpdate::write(const uint8_t* data, size_t len) {
+    if (!_active || !_hashValid) return fail("no session");
+    if (len > _total - _committed) return fail("more data than announced");
+
+    while (len > 0) {
+        uint32_t boundary = (_committed / OTA_RESUME_CHECKPOINT + 1) * OTA_RESUME_CHECKPOINT;
+        size_t n = boundary - _committed;
+        if (n > len) n = len;
+        if (!writeAligned(data, n)) return false;
+        data += n;
+        len -= n;
+        if (_committed % OTA_RESUME_CHECKPOINT == 0) checkpoint();
+    }
+    return true;
+}
+
+void ResumableUpdate::checkpoint() {
+    _digest.prefix(_prefix);
+
+    State s;
+    memset(&s, 0, sizeof(s));
+    s.magic = OTA_RESUME_MAGIC;
+    s.target = _target;
+    snprintf(s.label, sizeof(s.label), "%s", _partition->label);
+    s.total = _total;
+    s.committed = _committed;
+    memcpy(s.expected, _expected, sizeof(s.expected));
+    memcpy(s.prefix, _prefix, sizeof(s.prefix));
+
+    Preferences preferences;
+    preferences.begin(OTA_RESUME_NAMESPACE, false);
+    preferences.putBytes("state", &s, sizeof(s));
+    preferences.end();
+    _checkpointed = _committed;
+}
+
+bool ResumableUpdate::finish() {
+    if (!complete()) return fail("upload incomplete");
+
+    bool matched = _digest.finish();
+    const esp_partition_t* partition = _partition;
+    OtaTarget target = _target;
+    clear();
+    if (!matched) return fail("sha256 mismatch");
+
+    // Prüft das App-Image (Header, Segmente, Prüfsumme) und trägt es als Boot-Partition ein.
+    if (target == OTA_TARGET_FIRMWARE && esp_ota_set_boot_partition(partition) != ESP_OK) {
+        return fail("image rejected by bootloader check");
+    }
+    Serial.printf("Fortsetzbares Update abgeschlossen (%s)\n", partition->label);
+    return true;
+}
+
+void ResumableUpdate::clear() {
+    bool persisted = _active;
+    _active = false;
+    _hashValid = false;
+    _committed = _checkpointed = _erasedTo = 0;
+    if (persisted) {
+        Preferences preferences;
+        preferences.begin(OTA_RESUME_NAMESPACE, false);
+        preferences.remove("state");
+        preferences.end();
+    }
+}
+
+void ResumableUpdate::writeStatusJson(JsonWriter& json) const {
+    json.beginObject();
+    json.field("active", _active);
+    if (_active) {
+        char hex[IMAGE_DIGEST_SIZE * 2 + 1];
+        toHex(_expected, sizeof(_expected), hex);
+        json.field("target", _target == OTA_TARGET_SPIFFS ? "spiffs" : "firmware");
+        json.field("partition", _partition->label);
+        json.field("total", _total);
+        json.field("committed", _committed);
+        json.field("checkpoint", _checkpointed); // übersteht einen Neustart
+        json.field("sha256", hex);
+        json.field("rehash_needed", !_hashValid);
+    }
+    json.endObject();
+}
@@ -0,0 +1,132 @@
+//================================================================================
+//| DATEI: ResumableUpdate.h                                                     |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Fortsetzbare OTA-Uploads (/update_resume). Bricht die Verbindung ab, sendet  |
+//| der Client beim nächsten Versuch nur die fehlenden Bytes ab einem Offset.    |
+//|                                                                              |
+//| WARUM NICHT Update.h: Die Update-Bibliothek kennt nur "von vorn beginnen";   |
+//| ihr Zustand (Position, gelöschte Sektoren) ist privat. Hier wird direkt in   |
+//| die Partition geschrieben (esp_partition_*), Sektoren werden unmittelbar     |
+//| vor dem Beschreiben gelöscht. Aktiviert wird die Firmware erst nach          |
+//| geprüftem SHA-256 über esp_ota_set_boot_partition() (prüft das Image).       |
+//|                                                                              |
+//| SITZUNG IM NVS (Namespace "ota_resume"): Ziel-Partition, Gesamtgröße, Soll-  |
+//| Hash, übernommene Bytes und der Hash dieses Anfangsstücks. Gespeichert wird  |
+//| alle 64 KB (immer auf Sektorgrenzen), damit auch ein Neustart mitten im      |
+//| Upload nur die Daten seit dem letzten Checkpoint kostet.                     |
+//| Bei target=spiffs startet das Gerät danach ohne Dateisystem, statt das halbe |
+//| Image zu formatieren, bis die Sitzung fertig oder abgebrochen ist.           |
+//================================================================================
+
+#pragma once
+
+#include <Arduino.h>
+#include <esp_partition.h>
+#include "ImageDigest.h"
+
+class JsonWriter;
+
+// Abstand der NVS-Checkpoints (Vielfaches der Sektorgröße).
+#define OTA_RESUME_CHECKPOINT  (64 * 1024)
+#define OTA_RESUME_SECTOR      4096
+
+enum OtaTarget : uint8_t {
+    OTA_TARGET_FIRMWARE = 0,
+    OTA_TARGET_SPIFFS = 1
+};
+
+/**
+ * @class ResumableUpdate
+ * @brief Schreibt ein Image in mehreren Anläufen in die Ziel-Partition.
+ *
+ * start() bzw. resume() im httpd-Task, write() im Writer-Task der OtaPipeline,
+ * finish() wieder im httpd-Task.
+ */
+class ResumableUpdate {
+public:
+    ResumableUpdate();
+
+    /**
+     * @brief Liest eine gespeicherte Sitzung aus dem NVS (einmal beim Start).
+     */
+    void load();
+
+    /**
+     * @brief Beginnt eine neue Sitzung; eine alte wird verworfen.
+     * @param sha256Hex Soll-Hash des kompletten Images (Pflicht).
+     */
+    bool start(OtaTarget target, uint32_t total, const char* sha256Hex);
+
+    /**
+     * @brief Prüft, ob die Anfrage zur Sitzung passt (leere Angaben passen immer).
+     */
+    bool matches(OtaTarget target, uint32_t total, const char* sha256Hex) const;
+
+    /**
+     * @brief Stellt nach einem Neustart den Hash-Zustand wieder her: Das bereits
+     * geschriebene Stück wird aus dem Flash gelesen und mit dem gespeicherten
+     * Zwischen-Hash verglichen.
+     */
+    bool resume();
+
+    /**
+     * @brief Hängt Daten an (Position = committed()).
+     */
+    bool write(const uint8_t* data, size_t len);
+
+    /**
+     * @brief Prüft den Hash und aktiviert das Image (Firmware: Boot-Partition).
+     * Die Sitzung wird in jedem Fall beendet, weil sie nicht mehr fortsetzbar ist.
+     */
+    bool finish();
+
+    /**
+     * @brief Verwirft die Sitzung (RAM und NVS).
+     */
+    void clear();
+
+    bool active() const { return _active; }
+    bool complete() const { return _active && _committed == _total; }
+    uint32_t committed() const { return _committed; }
+    uint32_t total() const { return _total; }
+    OtaTarget target() const { return _target; }
+    const char* error() const { return _error; }
+
+    /**
+     * @brief Stand der Sitzung für GET /api/ota/session.
+     */
+    void writeStatusJson(JsonWriter& json) const;
+
+private:
+    // Inhalt des NVS-Eintrags (als Blob gespeichert)
+    struct State {
+        uint32_t magic;
+        uint8_t target;
+        char label[17];
+        uint32_t total;
+        uint32_t committed;
+        uint8_t expected[IMAGE_DIGEST_SIZE];
+        uint8_t prefix[IMAGE_DIGEST_SIZE];  // SHA-256 der ersten `committed` Bytes
+    };
+
+    bool _active;
+    bool _hashValid;            // _digest enthält genau die ersten _committed Bytes
+    OtaTarget _target;
+    const esp_partition_t* _partition;
+    uint32_t _total;
+    uint32_t _committed;
+    uint32_t _checkpointed;     // Stand des letzten NVS-Eintrags
+    uint32_t _erasedTo;        // bis hier sind die Sektoren gelöscht
+    uint8_t _expected[IMAGE_DIGEST_SIZE];
+    uint8_t _prefix[IMAGE_DIGEST_SIZE];
+    ImageDigest _digest;
+    const char* _error;
+
+    static const esp_partition_t* findPartition(OtaTarget target);
+    bool writeAligned(const uint8_t* data, size_t len);
+    void checkpoint();
+    bool fail(const char* reason);
+};
@@ -0,0 +1,126 @@
+//================================================================================
+//| DATEI: RouteMetrics.cpp                                                      |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Erfassen und Ausgeben der Routen-Metriken. Die Histogramm-Buckets werden     |
+//| einzeln gezählt und erst bei der Ausgabe kumuliert, so bleibt record()       |
+//| bei einem einzigen atomaren Inkrement pro Bucket.                            |
+//================================================================================
+
+#include "RouteMetrics.h"
+#include "ResponseWriter.h"
+
+RouteMetrics::RouteMetrics() {
+    for (uint8_t i = 0; i < 5; i++) status[i].store(0);
+    for (uint8_t i = 0; i <= ROUTE_METRICS_BUCKETS; i++) buckets[i].store(0);
+}
+
+void RouteMetrics::record(int statusCode, size_t in, size_t out, uint32_t durationUs) {
+    requests.fetch_add(1, std::memory_order_relaxed);
+    int cls = statusCode / 100 - 1;
+    if (cls < 0 || cls > 4) cls = 4; // Unbekannte Codes als Serverfehler werten
+    status[cls].fetch_add(1, std::memory_order_relaxed);
+    bytesIn.fetch_add((uint32_t)in, std::memory_order_relaxed);
+    bytesOut.fetch_add((uint32_t)out, std::memory_order_relaxed);
+    durationSumUs.fetch_add(durationUs, std::memory_order_relaxed);
+
+    uint8_t bucket = 0;
+    while (bucket < ROUTE_METRICS_BUCKETS && durationUs > ROUTE_METRICS_BUCKET_US[bucket]) bucket++;
+    buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+void writeMetricHeader(ResponseWriter& out, const char* name, const char* type, const char* help) {
+    out.print("# HELP ");
+    out.print(name);
+    out.write(' ');
+    out.print(help);
+    out.print("\n# TYPE ");
+    out.print(name);
+    out.write(' ');
+    out.print(type);
+    out.write('\n');
+}
+
+/**
+ * @brief Schreibt "name{route="...",method="..."" (ohne schließende Klammer).
+ */
+static void writeLabels(ResponseWriter& out, const char* name, const char* route, const char* method) {
+    out.print(name);
+    out.print("{route=\"");
+    out.print(route);
+    out.print("\",method=\"");
+    out.print(method);
+    out.write('"');
+}
+
+/**
+ * @brief Gibt Mikrosekunden als Sekunden mit 6 Nachkommastellen aus (ohne float).
+ */
+static void writeSeconds(ResponseWriter& out, uint32_t us) {
+    char buf[20];
+    snprintf(buf, sizeof(buf), "%u.%06u", (unsigned)(us / 1000000), (unsigned)(us % 1000000));
+    out.print(buf);
+}
+
+void writeRouteMetrics(ResponseWriter& out, uint8_t family, const char* route, const char* method, const RouteMetrics& m) {
+    switch (family) {
+        case ROUTE_METRIC_REQUESTS: {
+            static const char* const codes[5] = {"1xx", "2xx", "3xx", "4xx", "5xx"};
+            for (uint8_t i = 0; i < 5; i++) {
+                uint32_t n = m.status[i].load(std::memory_order_relaxed);
+                if (n == 0) continue;
+                writeLabels(out, "http_requests_total", route, method);
+                out.print(",code=\"");
+                out.print(codes[i]);
+                out.print("\"} ");
+                out.print(n);
+                out.write('\n');
+            }
+            break;
+        }
+        case ROUTE_METRIC_BYTES_IN:
+            writeLabels(out, "http_request_bytes_total", route, method);
+            out.print("} ");
+            out.print(m.bytesIn.load(std::memory_order_relaxed));
+            out.write('\n');
+            break;
+        case ROUTE_METRIC_BYTES_OUT:
+            writeLabels(out, "http_response_bytes_total", route, method);
+            out.print("} ");
+            out.print(m.bytesOut.load(std::memory_order_relaxed));
+            out.write('\n');
+            break;
+        case ROUTE_METRIC_DURATION: {
+            uint32_t cumulative = 0;
+            for (uint8_t i = 0; i <= ROUTE_METRICS_BUCKETS; i++) {
+                cumulative += m.buckets[i].load(std::memory_order_relaxed);
+                writeLabels(out, "http_request_duration_seconds_bucket", route, method);
+                out.print(",le=\"");
+                if (i < ROUTE_METRICS_BUCKETS) {
+                    // Bucket-Grenzen sind ganze Millisekunden -> "0.005" statt "0.005000"
+                    char le[12];
+                    uint32_t ms = ROUTE_METRICS_BUCKET_US[i] / 1000;
+                    if (ms >= 1000) snprintf(le, sizeof(le), "%u", (unsigned)(ms / 1000));
+                    else snprintf(le, sizeof(le), "0.%03u", (unsigned)ms);
+                    out.print(le);
+                } else {
+                    out.print("+Inf");
+                }
+                out.print("\"} ");
+                out.print(cumulative);
+                out.write('\n');
+            }
+            writeLabels(out, "http_request_duration_seconds_sum", route, method);
+            out.print("} ");
+            writeSeconds(out, m.durationSumUs.load(std::memory_order_relaxed));
+            out.write('\n');
+            writeLabels(out, "http_request_duration_seconds_count", route, method);
+            out.print("} ");
+            out.print(cumulative);
+            out.write('\n');
+            break;
+        }
+    }
+}
@@ -0,0 +1,75 @@
+//================================================================================
+//| DATEI: RouteMetrics.h                                                        |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Zähler pro Route (Anzahl, Statusklassen, Bytes, Latenz-Histogramm) und       |
+//| globale Server-Zähler. Ausgabe im Prometheus-Textformat für /api/metrics.    |
+//|                                                                              |
+//| LOCK-FREI: Alle Zähler sind 32-Bit std::atomic. Auf dem ESP32 werden diese   |
+//| direkt als atomare Befehle übersetzt, der Dispatcher muss also nie auf eine  |
+//| Sperre warten - auch nicht, wenn Worker-Tasks parallel Requests bedienen.    |
+//================================================================================
+
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+
+class ResponseWriter;
+
+// Obergrenzen der Latenz-Buckets in Mikrosekunden (+Inf kommt automatisch dazu).
+#define ROUTE_METRICS_BUCKETS  9
+static const uint32_t ROUTE_METRICS_BUCKET_US[ROUTE_METRICS_BUCKETS] = {
+    1000, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000
+};
+
+/**
+ * @brief Messwerte einer einzelnen Route.
+ * Die Summe der Latenzen läuft nach ca. 71 min reiner Handler-Zeit über; Prometheus
+ * behandelt das wie einen Zähler-Reset (rate() bleibt korrekt).
+ */
+struct RouteMetrics {
+    std::atomic<uint32_t> requests{0};
+    std::atomic<uint32_t> status[5];                          // 1xx .. 5xx
+    std::atomic<uint32_t> bytesIn{0};
+    std::atomic<uint32_t> bytesOut{0};
+    std::atomic<uint32_t> buckets[ROUTE_METRICS_BUCKETS + 1]; // letzter = +Inf
+    std::atomic<uint32_t> durationSumUs{0};
+
+    RouteMetrics();
+
+    /**
+     * @brief Verbucht einen abgeschlossenen Request.
+     */
+    void record(int statusCode, size_t in, size_t out, uint32_t durationUs);
+};
+
+/**
+ * @brief Globale Zähler des Servers (Sockets und Fehler).
+ */
+struct ServerMetrics {
+    std::atomic<uint32_t> openSockets{0};
+    std::atomic<uint32_t> connections{0};   // insgesamt angenommene Verbindungen
+    std::atomic<uint32_t> errors{0};        // Dispatcher-Fehler und abgebrochene Sendevorgänge
+};
+
+/**
+ * @brief Schreibt die Kopfzeilen (# HELP / # TYPE) einer Metrik.
+ */
+void writeMetricHeader(ResponseWriter& out, const char* name, const char* type, const char* help);
+
+/**
+ * @brief Schreibt alle Zeilen einer Route (Zähler + Histogramm) im Prometheus-Format.
+ * Die Kopfzeilen müssen vorher einmal pro Metrik geschrieben werden, daher wird
+ * die Funktion pro Metrik-Familie (@p family) für alle Routen aufgerufen.
+ */
+void writeRouteMetrics(ResponseWriter& out, uint8_t family, const char* route, const char* method, const RouteMetrics& m);
+
+// Metrik-Familien für writeRouteMetrics()
+#define ROUTE_METRIC_REQUESTS   0
+#define ROUTE_METRIC_BYTES_IN   1
+#define ROUTE_METRIC_BYTES_OUT  2
+#define ROUTE_METRIC_DURATION   3
+#define ROUTE_METRIC_FAMILIES   4
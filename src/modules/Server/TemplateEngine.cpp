@@ -0,0 +1,164 @@
+//================================================================================
+//| DATEI: TemplateEngine.cpp                                                    |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Implementiert das Kompilieren (einmaliges Scannen) und das Streamen der      |
+//| Platzhalter-Templates. Ersetzt das frühere readString() + replace(), das     |
+//| etwa die dreifache Dateigröße an Heap benötigt hat.                          |
+//================================================================================
+
+#include "TemplateEngine.h"
+#include "AsyncWebServer.h"
+#include "ResponseWriter.h"
+
+static inline bool isPlaceholderChar(char c) {
+    return (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+void HtmlTemplate::addLiteral(uint32_t offset, uint32_t length) {
+    if (length == 0) return;
+    TemplateSegment seg = {offset, length, -1};
+    _segments.push_back(seg);
+}
+
+void HtmlTemplate::addPlaceholder(const char* name) {
+    // Gleiche Namen teilen sich einen Eintrag in der Namensliste.
+    int8_t index = -1;
+    for (size_t i = 0; i < _names.size(); i++) {
+        if (_names[i] == name) {
+            index = (int8_t)i;
+            break;
+        }
+    }
+    if (index < 0) {
+        if (_names.size() >= 127) return;
+        _names.push_back(String(name));
+        index = (int8_t)(_names.size() - 1);
+    }
+    TemplateSegment seg = {0, 0, index};
+    _segments.push_back(seg);
+}
+
+/**
+ * @brief Scannt die Datei blockweise mit einer kleinen Zustandsmaschine.
+ * Platzhalter dürfen über Blockgrenzen hinweg reichen.
+ */
+bool HtmlTemplate::compile(fs::FS& fs, const String& path) {
+    File file = fs.open(path, "r");
+    if (!file) return false;
+
+    _path = path;
+    _segments.clear();
+    _names.clear();
+
+    char buf[256];
+    char name[TEMPLATE_MAX_NAME_LEN + 1];
+    uint8_t nameLen = 0;
+    bool inTag = false;
+    uint32_t tagStart = 0;
+    uint32_t literalStart = 0;
+    uint32_t pos = 0;
+
+    size_t n;
+    while ((n = file.read((uint8_t*)buf, sizeof(buf))) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            char c = buf[i];
+            uint32_t abs = pos + i;
+            if (!inTag) {
+                if (c == '%') {
+                    inTag = true;
+                    tagStart = abs;
+                    nameLen = 0;
+                }
+            } else if (c == '%') {
+                if (nameLen > 0) {
+                    // Gültiger Platzhalter: Literal davor abschließen.
+                    name[nameLen] = '\0';
+                    addLiteral(literalStart, tagStart - literalStart);
+                    addPlaceholder(name);
+                    literalStart = abs + 1;
+                    inTag = false;
+                } else {
+                    // "%%": das zweite '%' könnte einen neuen Platzhalter beginnen.
+                    tagStart = abs;
+                }
+            } else if (isPlaceholderChar(c) && nameLen < TEMPLATE_MAX_NAME_LEN) {
+                name[nameLen++] = c;
+            } else {
+                inTag = false; // Kein Platzhalter - bleibt Teil des Literals
+            }
+        }
+        pos += n;
+    }
+    addLiteral(literalStart, pos - literalStart);
+    file.close();
+    return true;
+}
+
+/**
+ * @brief Streamt das Template: Literal-Abschnitte werden aus der Datei gelesen,
+ * Platzhalter über den Prozessor aufgelöst.
+ */
+void HtmlTemplate::send(AsyncWebServerRequest* request, fs::FS& fs, const char* contentType, const TemplateProcessor& processor) {
+    File file = fs.open(_path, "r");
+    if (!file) {
+        request->send(404, "text/plain", "File not found");
+        return;
+    }
+
+    char out[1024];
+    ResponseWriter writer(request, 200, contentType, out, sizeof(out));
+    char buf[256];
+    uint32_t filePos = 0;
+
+    for (size_t i = 0; i < _segments.size(); i++) {
+        const TemplateSegment& seg = _segments[i];
+        if (seg.placeholder >= 0) {
+            if (processor) writer.print(processor(_names[seg.placeholder]));
+            continue;
+        }
+        if (filePos != seg.offset) file.seek(seg.offset);
+        uint32_t remaining = seg.length;
+        while (remaining > 0) {
+            size_t chunk = remaining < sizeof(buf) ? remaining : sizeof(buf);
+            size_t got = file.read((uint8_t*)buf, chunk);
+            if (got == 0) break;
+            writer.write(buf, got);
+            remaining -= got;
+        }
+        filePos = seg.offset + seg.length - remaining;
+    }
+    file.close();
+    writer.end();
+}
+
+HtmlTemplate* TemplateCache::get(fs::FS& fs, const String& path) {
+    // Erster Aufruf erfolgt in serveStatic() (vor dem Start der Worker).
+    if (!_lock) _lock = xSemaphoreCreateMutex();
+    xSemaphoreTake(_lock, portMAX_DELAY);
+
+    HtmlTemplate* result = nullptr;
+    for (uint8_t i = 0; i < TEMPLATE_CACHE_SIZE && !result; i++) {
+        if (_used[i] && _entries[i].path() == path) result = &_entries[i];
+    }
+
+    if (!result) {
+        // Noch nicht kompiliert: nächsten Slot (Ringpuffer) überschreiben.
+        uint8_t slot = _next;
+        _next = (_next + 1) % TEMPLATE_CACHE_SIZE;
+        _used[slot] = _entries[slot].compile(fs, path);
+        if (_used[slot]) result = &_entries[slot];
+    }
+
+    xSemaphoreGive(_lock);
+    return result;
+}
+
+void TemplateCache::invalidate() {
+    // Kann aus dem httpd-Task kommen, während ein Worker get() aufruft.
+    if (_lock) xSemaphoreTake(_lock, portMAX_DELAY);
+    for (uint8_t i = 0; i < TEMPLATE_CACHE_SIZE; i++) _used[i] = false;
+    if (_lock) xSemaphoreGive(_lock);
+}
@@ -0,0 +1,100 @@
+//================================================================================
+//| DATEI: TemplateEngine.h                                                      |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Vorkompilierte Platzhalter-Templates für HTML-Dateien aus dem SPIFFS.        |
+//| Jede Datei wird einmalig gescannt und in eine Liste aus Literal-Abschnitten  |
+//| (Offset + Länge in der Datei) und Platzhaltern (%NAME%) zerlegt. Beim        |
+//| Ausliefern werden die Abschnitte direkt aus der Datei gestreamt und nur die  |
+//| Platzhalter durch den Prozessor ersetzt. Die Datei wird nie komplett in den  |
+//| RAM geladen.                                                                 |
+//================================================================================
+
+#pragma once
+
+#include <Arduino.h>
+#include <FS.h>
+#include <functional>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <vector>
+
+class AsyncWebServerRequest;
+
+// Callback, der den Wert für einen Platzhalter liefert (z.B. "IP" -> "192.168.4.1").
+typedef std::function<String(const String&)> TemplateProcessor;
+
+// Maximale Länge eines Platzhalter-Namens (ohne die beiden '%').
+#define TEMPLATE_MAX_NAME_LEN   24
+// Anzahl gleichzeitig gecachter Templates (reicht für alle Seiten in data/).
+#define TEMPLATE_CACHE_SIZE     8
+
+/**
+ * @brief Ein Abschnitt eines kompilierten Templates.
+ * placeholder < 0: Literal (Bytes [offset, offset+length) der Datei).
+ * placeholder >= 0: Index in die Namensliste des Templates.
+ */
+struct TemplateSegment {
+    uint32_t offset;
+    uint32_t length;
+    int8_t placeholder;
+};
+
+/**
+ * @class HtmlTemplate
+ * @brief Eine kompilierte Template-Datei (Segmentliste + Platzhalter-Namen).
+ */
+class HtmlTemplate {
+public:
+    /**
+     * @brief Scannt die Datei einmalig und erstellt die Segmentliste.
+     * Als Platzhalter gilt nur %NAME% mit NAME aus [A-Z0-9_], damit CSS-Angaben
+     * wie "width: 100%;" nicht fälschlich erkannt werden.
+     * @return false, wenn die Datei nicht geöffnet werden konnte.
+     */
+    bool compile(fs::FS& fs, const String& path);
+
+    /**
+     * @brief Streamt das Template als Chunked-Antwort.
+     * Speicherbedarf: ein fester Puffer + der größte Platzhalter-Wert.
+     */
+    void send(AsyncWebServerRequest* request, fs::FS& fs, const char* contentType, const TemplateProcessor& processor);
+
+    const String& path() const { return _path; }
+    bool hasPlaceholders() const { return !_names.empty(); }
+
+private:
+    String _path;
+    std::vector<TemplateSegment> _segments;
+    std::vector<String> _names;
+
+    void addLiteral(uint32_t offset, uint32_t length);
+    void addPlaceholder(const char* name);
+};
+
+/**
+ * @class TemplateCache
+ * @brief Hält die kompilierten Templates, damit jede Datei nur einmal gescannt wird.
+ * get() ist threadsicher, da statische Dateien auch aus dem Worker-Pool kommen.
+ */
+class TemplateCache {
+public:
+    /**
+     * @brief Liefert das kompilierte Template (kompiliert es beim ersten Zugriff).
+     * @return nullptr, wenn die Datei nicht existiert.
+     */
+    HtmlTemplate* get(fs::FS& fs, const String& path);
+
+    /**
+     * @brief Verwirft alle kompilierten Templates (z.B. nach einem Datei-Update).
+     */
+    void invalidate();
+
+private:
+    HtmlTemplate _entries[TEMPLATE_CACHE_SIZE];
+    bool _used[TEMPLATE_CACHE_SIZE] = {};
+    uint8_t _next = 0; // Ringpuffer-Index für die Verdrängung
+    SemaphoreHandle_t _lock = nullptr;
+};
@@ -0,0 +1,64 @@
+//================================================================================
+//| DATEI: ValueWriter.h                                                         |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Gemeinsame Schnittstelle der Streaming-Serializer (JSON, CBOR, MessagePack). |
+//| Ein Handler beschreibt seine Felder genau einmal gegen diese Schnittstelle;  |
+//| welches Format tatsächlich geschrieben wird, entscheidet der Aufrufer (siehe |
+//| ApiResponse, Auswahl über den Accept-Header).                                |
+//================================================================================
+
+#pragma once
+
+#include <Arduino.h>
+
+// Anzahl der Elemente eines Objekts/Arrays ist vorab nicht bekannt.
+#define VALUE_COUNT_UNKNOWN  ((size_t)-1)
+
+/**
+ * @class ValueWriter
+ * @brief Abstrakter Writer für verschachtelte Objekte, Arrays und Werte.
+ *
+ * Die Anzahl bei beginObject()/beginArray() ist optional. JSON ignoriert sie,
+ * die Binärformate erzeugen damit den kompaktesten Header.
+ */
+class ValueWriter {
+public:
+    virtual ~ValueWriter() {}
+
+    virtual void beginObject(size_t count = VALUE_COUNT_UNKNOWN) = 0;
+    virtual void endObject() = 0;
+    virtual void beginArray(size_t count = VALUE_COUNT_UNKNOWN) = 0;
+    virtual void endArray() = 0;
+
+    /**
+     * @brief Schreibt einen Schlüssel. Danach muss genau ein Wert folgen.
+     */
+    virtual void key(const char* name) = 0;
+
+    // --- Werte (in Arrays oder nach key()) ---
+    virtual void value(const char* text) = 0;
+    virtual void value(bool flag) = 0;
+    virtual void value(long number) = 0;
+    virtual void value(unsigned long number) = 0;
+    virtual void value(long long number) = 0;
+    virtual void value(unsigned long long number) = 0;
+    /**
+     * @param decimals Nachkommastellen für Textformate. Binärformate speichern float32.
+     */
+    virtual void value(float number, uint8_t decimals = 2) = 0;
+    virtual void nullValue() = 0;
+
+    void value(const String& text) { value(text.c_str()); }
+    void value(int number) { value((long)number); }
+    void value(unsigned int number) { value((unsigned long)number); }
+    void value(double number, uint8_t decimals = 2) { value((float)number, decimals); }
+
+    // --- Kurzformen für key() + value() ---
+    template <typename T>
+    void field(const char* name, const T& val) { key(name); value(val); }
+    void field(const char* name, float val, uint8_t decimals) { key(name); value(val, decimals); }
+    void field(const char* name, double val, uint8_t decimals) { key(name); value((float)val, decimals); }
+};
@@ -11,25 +11,30 @@
 //================================================================================
 
 #include "WebServer.h"
+#include "JsonWriter.h"
+#include "ApiResponse.h"
 #include "../../config.h"
 #include <SPIFFS.h>
-// Wir brauchen den Balancer, um Befehle an ihn zu senden
-#include "../../BalanceDriver.h" 
-
-// Externe Funktionsdeklarationen aus BalanceDriver.h
+// Aus BalanceDriver.h. Der Header definiert seine Variablen selbst und darf daher
+// nur einmal (in main.cpp) eingebunden werden - hier genügen die Deklarationen.
+extern float Kp, Ki, Kd;
 extern void setRobotMovement(int moveX, int moveY);
 extern void toggleMotors(bool enable);
-extern void updatePidValues(float Kp, float Ki, float Kd);
+extern bool updatePidValues(float Kp, float Ki, float Kd, const char*& key, const char*& error);
 extern void getCurrentRobotStatus(float& angle, float& error, float& gyroRate, int& motorSpeed, bool& motorsEnabled, float& currentKp, float& currentKi, float& currentKd);
 
 
 // Konstruktor
-WebServer::WebServer(WifiManager& wifiManager, SystemApiHandler& systemApiHandler, WifiApiHandler& wifiApiHandler, OtaApiHandler& otaApiHandler)
+WebServer::WebServer(WifiManager& wifiManager, SystemApiHandler& systemApiHandler, WifiApiHandler& wifiApiHandler, OtaApiHandler& otaApiHandler,
+                     CommandBatch& commandBatch, FileSyncApiHandler& fileSyncApiHandler, TelemetryHistory& telemetryHistory)
     : _server(80), 
       _wifiManager(wifiManager), 
       _systemApiHandler(systemApiHandler), 
       _wifiApiHandler(wifiApiHandler),
-      _otaApiHandler(otaApiHandler) {}
+      _otaApiHandler(otaApiHandler),
+      _commandBatch(commandBatch),
+      _fileSyncApiHandler(fileSyncApiHandler),
+      _telemetryHistory(telemetryHistory) {}
 
 // Setup
 void WebServer::setup() {
@@ -39,26 +44,19 @@ void WebServer::setup() {
     _systemApiHandler.registerRoutes(_server);
     _wifiApiHandler.registerRoutes(_server);
     _otaApiHandler.registerRoutes(_server);
-
-    if (SPIFFS.begin(true)) {
+    _commandBatch.registerRoutes(_server);
+    _fileSyncApiHandler.registerRoutes(_server);
+    _telemetryHistory.registerRoutes(_server);
+
+    // Ein halb geschriebenes SPIFFS-Image lässt sich nicht mounten. Formatieren
+    // würde die fortsetzbare Sitzung zerstören (der Anfangs-Hash passt dann nicht
+    // mehr), also in dem Fall ohne Dateisystem starten, bis das Upload fertig ist.
+    bool keepSpiffsImage = _otaApiHandler.spiffsResumePending();
+    if (SPIFFS.begin(!keepSpiffsImage)) {
         
-        // 2. SPEZIAL-ROUTE: wifi.html (Dein Fix)
-        _server.on("/wifi.html", HTTP_GET, [this](AsyncWebServerRequest *request){
-            if(SPIFFS.exists("/wifi.html")){
-                File file = SPIFFS.open("/wifi.html", "r");
-                String content = file.readString();
-                file.close();
-
-                content.replace("%HOSTNAME%", HOSTNAME); 
-                content.replace("%MODE%", _wifiManager.getMode());
-                content.replace("%IP%", _wifiManager.getIpAddress());
-                content.replace("%SSID%", _wifiManager.getSsid());
-                
-                request->send(200, "text/html", content);
-            } else {
-                request->send(404, "text/plain", "wifi.html nicht gefunden");
-            }
-        });
+        // 2. PLATZHALTER: Alle HTML-Dateien (z.B. wifi.html mit %IP%, %SSID%) werden
+        // einmalig vorkompiliert und beim Ausliefern gestreamt. Die Werte liefert processor().
+        _server.setTemplateProcessor(std::bind(&WebServer::processor, this, std::placeholders::_1));
 
         // =========================================================
         // NEU: API-ENDPUNKTE FÜR ROBOTER-STEUERUNG
@@ -66,20 +64,17 @@ void WebServer::setup() {
 
         // API zum Senden von Bewegungsbefehlen
         _server.on("/api/robot/move", HTTP_POST, [](AsyncWebServerRequest *request){
-            int moveX = 0; 
-            int moveY = 0; 
-            String command = "";
-
-            // KORRIGIERT: Robuste Methode mit request->arg() und String-Check
-            if(request->arg("x").length() > 0) moveX = request->arg("x").toInt(); 
-            if(request->arg("y").length() > 0) moveY = request->arg("y").toInt();
-            if(request->arg("cmd").length() > 0) command = request->arg("cmd");
+            // Parameter werden einmalig ins Request-Arena geparst, die Zugriffe
+            // danach sind reine Lookups ohne String-Kopien oder Heap-Allokationen.
+            int moveX = request->argInt("x");
+            int moveY = request->argInt("y");
+            const char* command = request->argPtr("cmd");
 
-            Serial.print("Web-Befehl: X="); Serial.print(moveX); Serial.print(", Y="); Serial.print(moveY); Serial.print(", CMD="); Serial.println(command);
+            Serial.printf("Web-Befehl: X=%d, Y=%d, CMD=%s\n", moveX, moveY, command ? command : "");
 
-            if (command == "enable") {
+            if (request->argEquals("cmd", "enable")) {
                 toggleMotors(true);
-            } else if (command == "disable") {
+            } else if (request->argEquals("cmd", "disable")) {
                 toggleMotors(false);
             } else {
                 setRobotMovement(moveX, moveY);
@@ -97,40 +92,80 @@ void WebServer::setup() {
 
             getCurrentRobotStatus(angle, error, gyroRate, motorSpeed, enabled, currentKp, currentKi, currentKd);
 
-            String jsonResponse = "{";
-            jsonResponse += "\"angle\": " + String(angle, 2) + ",";
-            jsonResponse += "\"error\": " + String(error, 2) + ",";
-            jsonResponse += "\"gyro\": " + String(gyroRate, 2) + ",";
-            jsonResponse += "\"motor\": " + String(motorSpeed) + ",";
-            jsonResponse += "\"enabled\": " + String(enabled ? "true" : "false") + ","; 
-            jsonResponse += "\"kp\": " + String(currentKp, 2) + ","; 
-            jsonResponse += "\"ki\": " + String(currentKi, 3) + ","; 
-            jsonResponse += "\"kd\": " + String(currentKd, 2); 
-            jsonResponse += "}";
-
-            request->send(200, "application/json", jsonResponse);
+            // Direkt in einen Stack-Puffer formatieren (keine String-Verkettung, kein Heap).
+            // Host-Tools können per "Accept: application/cbor" bzw. msgpack binär abfragen.
+            char buffer[192];
+            ApiResponse res(request, buffer, sizeof(buffer));
+            ValueWriter& out = res.writer();
+            out.beginObject(8);
+            out.field("angle", angle, 2);
+            out.field("error", error, 2);
+            out.field("gyro", gyroRate, 2);
+            out.field("motor", motorSpeed);
+            out.field("enabled", enabled);
+            out.field("kp", currentKp, 2);
+            out.field("ki", currentKi, 3);
+            out.field("kd", currentKd, 2);
+            out.endObject();
+            res.end();
         });
 
         // API zum Ändern der PID-Werte über das Web-Interface
         _server.on("/api/robot/pid", HTTP_POST, [](AsyncWebServerRequest *request){
-            float Kp_new = Kp; 
-            float Ki_new = Ki;
-            float Kd_new = Kd;
-
-            // KORRIGIERT: Robuste Methode mit request->arg() und String-Check
-            if(request->arg("kp").length() > 0) Kp_new = request->arg("kp").toFloat();
-            if(request->arg("ki").length() > 0) Ki_new = request->arg("ki").toFloat();
-            if(request->arg("kd").length() > 0) Kd_new = request->arg("kd").toFloat();
+            // Fehlende Werte behalten den aktuellen Stand. Funktioniert für Query-
+            // Parameter und für den URL-codierten Body aus control.html.
+            float Kp_new = request->argFloat("kp", Kp);
+            float Ki_new = request->argFloat("ki", Ki);
+            float Kd_new = request->argFloat("kd", Kd);
             
-            updatePidValues(Kp_new, Ki_new, Kd_new);
-
+            // Werte außerhalb der ConfigStore-Grenzen: nichts übernommen, Grund an den Client
+            const char* key;
+            const char* error;
+            if (!updatePidValues(Kp_new, Ki_new, Kd_new, key, error)) {
+                char msg[64];
+                snprintf(msg, sizeof(msg), "%s: %s", key, error);
+                request->send(400, "text/plain", msg);
+                return;
+            }
             request->send(200, "text/plain", "PID Updated");
         });
 
+        // Diagnose: Zähler des Request-Parsers (Nachweis "kein Heap auf heißen Routen")
+        // und Auslastung des Worker-Pools (Queue-Tiefe, Wartezeiten je Priorität)
+        _server.on("/api/server/stats", HTTP_GET, [this](AsyncWebServerRequest *request){
+            const RequestStats& stats = AsyncWebServerRequest::getStats();
+            char buffer[512];
+            ResponseWriter out(request, 200, "application/json", buffer, sizeof(buffer));
+            JsonWriter json(out);
+            json.beginObject();
+            json.field("requests", stats.requests);
+            json.field("params", stats.params);
+            json.field("heap_allocs", stats.heapAllocs);
+            json.field("heap_bytes", stats.heapBytes);
+            json.field("string_args", stats.stringArgs);
+            json.field("overflows", stats.overflows);
+            json.field("timeouts", stats.timeouts);
+            json.field("async_offload", ASYNC_WEB_SERVER_OFFLOAD == 1);
+            json.key("workers");
+            _server.workers().writeStatsJson(json);
+            json.endObject();
+            out.end();
+        });
+
+        // Metriken pro Route im Prometheus-Textformat (zum Scrapen durch das Monitoring)
+        _server.on("/api/metrics", HTTP_GET, [this](AsyncWebServerRequest *request){
+            char buffer[1024];
+            ResponseWriter out(request, 200, "text/plain; version=0.0.4", buffer, sizeof(buffer));
+            _server.writeMetrics(out);
+            out.end();
+        });
+
         // =========================================================
 
         // 3. STATISCHE ROUTEN (Dateien aus /data Ordner)
         _server.serveStatic("/", SPIFFS, "/");
+    } else if (keepSpiffsImage) {
+        Serial.println("SPIFFS-Upload offen: Dateisystem bleibt unformatiert (/update_resume fortsetzen oder /api/ota/session/cancel).");
     }
 
     _server.onNotFound([](AsyncWebServerRequest *request) {
@@ -17,6 +17,9 @@
 #include "../../modules/System/SystemApiHandler.h" // Einbinden des neuen System-Handlers
 #include "../../modules/WiFi/WifiApiHandler.h"     // Einbinden des neuen WLAN-Handlers
 #include "OtaApiHandler.h"
+#include "FileSyncApiHandler.h"
+#include "../../modules/Robot/CommandBatch.h"
+#include "../../modules/Robot/TelemetryHistory.h"
 
 /**
  * @class WebServer
@@ -37,13 +40,17 @@ public:
      * @param wifiManager Wird für den Platzhalter-Prozessor benötigt (%IP%, %SSID%).
      * @param systemApiHandler Der Handler für alle System-API-Routen.
      * @param wifiApiHandler Der Handler für alle WLAN-API-Routen.
+     * @param commandBatch Nimmt gebündelte Roboter-Befehle entgegen (/api/batch).
+     * @param fileSyncApiHandler Tauscht einzelne SPIFFS-Dateien aus (/api/fs/...).
+     * @param telemetryHistory Verlauf der Roboter-Telemetrie (/api/robot/history).
      */
-    WebServer(WifiManager& wifiManager, SystemApiHandler& systemApiHandler, WifiApiHandler& wifiApiHandler, OtaApiHandler& otaApiHandler);
+    WebServer(WifiManager& wifiManager, SystemApiHandler& systemApiHandler, WifiApiHandler& wifiApiHandler, OtaApiHandler& otaApiHandler,
+              CommandBatch& commandBatch, FileSyncApiHandler& fileSyncApiHandler, TelemetryHistory& telemetryHistory);
 
     void setup();
 
 private:
-    // Verarbeitet Platzhalter wie %HOSTNAME% in HTML-Dateien.
+    // Verarbeitet Platzhalter wie %HOSTNAME% in HTML-Dateien (siehe TemplateEngine).
     String processor(const String& var);
 
     AsyncWebServer _server;
@@ -53,4 +60,7 @@ private:
     SystemApiHandler& _systemApiHandler;
     WifiApiHandler& _wifiApiHandler;
     OtaApiHandler& _otaApiHandler;
+    CommandBatch& _commandBatch;
+    FileSyncApiHandler& _fileSyncApiHandler;
+    TelemetryHistory& _telemetryHistory;
 };
\ No newline at end of file
@@ -0,0 +1,146 @@
+//================================================================================
+//| DATEI: WorkerPool.cpp                                                        |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Implementiert den Worker-Pool. Ein zählendes Semaphore weckt genau einen     |
+//| Worker pro eingereihtem Job; dieser bedient zuerst die CONTROL-Queue und     |
+//| erst danach die BULK-Queue.                                                  |
+//================================================================================
+
+#include "WorkerPool.h"
+#include "JsonWriter.h"
+#include <esp_timer.h>
+
+WorkerPool::WorkerPool()
+    : _free(nullptr), _pending(nullptr), _stats(), _mux(portMUX_INITIALIZER_UNLOCKED) {
+    _queues[0] = nullptr;
+    _queues[1] = nullptr;
+}
+
+void WorkerPool::begin() {
+    if (_pending) return;
+
+    _free = xQueueCreate(WORKER_QUEUE_LEN, sizeof(uint8_t));
+    _queues[ROUTE_PRIORITY_CONTROL] = xQueueCreate(WORKER_QUEUE_LEN, sizeof(uint8_t));
+    _queues[ROUTE_PRIORITY_BULK] = xQueueCreate(WORKER_QUEUE_LEN, sizeof(uint8_t));
+    SemaphoreHandle_t pending = xSemaphoreCreateCounting(WORKER_QUEUE_LEN, 0);
+    if (!_free || !_queues[0] || !_queues[1] || !pending) {
+        Serial.println("Fehler: Worker-Pool konnte nicht angelegt werden!");
+        return;
+    }
+
+    for (uint8_t i = 0; i < WORKER_QUEUE_LEN; i++) {
+        xQueueSend(_free, &i, 0);
+    }
+    _pending = pending;
+
+    for (uint8_t i = 0; i < WORKER_POOL_SIZE; i++) {
+        char name[12];
+        snprintf(name, sizeof(name), "httpWorker%u", (unsigned)i);
+        xTaskCreate(workerTask, name, WORKER_STACK_SIZE, this, WORKER_TASK_PRIORITY, nullptr);
+    }
+}
+
+bool WorkerPool::submit(std::function<void()> job, RoutePriority priority, uint32_t delayMs) {
+    uint8_t slot;
+    if (!_pending || xQueueReceive(_free, &slot, 0) != pdTRUE) {
+        portENTER_CRITICAL(&_mux);
+        _stats[priority].rejected++;
+        portEXIT_CRITICAL(&_mux);
+        return false;
+    }
+
+    Job& entry = _jobs[slot];
+    entry.fn = job;
+    entry.enqueuedUs = esp_timer_get_time();
+    entry.delayMs = delayMs;
+    entry.priority = priority;
+
+    portENTER_CRITICAL(&_mux);
+    WorkerQueueStats& s = _stats[priority];
+    s.enqueued++;
+    s.depth++;
+    if (s.depth > s.maxDepth) s.maxDepth = s.depth;
+    portEXIT_CRITICAL(&_mux);
+
+    // Kann nicht fehlschlagen: Jede Queue fasst so viele Einträge wie es Slots gibt.
+    xQueueSend(_queues[priority], &slot, 0);
+    xSemaphoreGive(_pending);
+    return true;
+}
+
+uint8_t WorkerPool::freeSlots() {
+    return _free ? (uint8_t)uxQueueMessagesWaiting(_free) : 0;
+}
+
+void WorkerPool::workerTask(void* arg) {
+    WorkerPool* self = (WorkerPool*)arg;
+    for (;;) {
+        xSemaphoreTake(self->_pending, portMAX_DELAY);
+        self->runNext();
+    }
+}
+
+/**
+ * @brief Holt den nächsten Job (CONTROL vor BULK) und führt ihn aus.
+ */
+void WorkerPool::runNext() {
+    uint8_t slot;
+    if (xQueueReceive(_queues[ROUTE_PRIORITY_CONTROL], &slot, 0) != pdTRUE &&
+        xQueueReceive(_queues[ROUTE_PRIORITY_BULK], &slot, 0) != pdTRUE) {
+        return;
+    }
+
+    Job& entry = _jobs[slot];
+    uint32_t waitUs = (uint32_t)(esp_timer_get_time() - entry.enqueuedUs);
+
+    portENTER_CRITICAL(&_mux);
+    WorkerQueueStats& s = _stats[entry.priority];
+    s.depth--;
+    s.waitTotalUs += waitUs;
+    if (waitUs > s.waitMaxUs) s.waitMaxUs = waitUs;
+    portEXIT_CRITICAL(&_mux);
+
+    // Verzögerte Jobs (z.B. Neustart) blockieren nur diesen Worker, nie den httpd-Task.
+    if (entry.delayMs > 0) vTaskDelay(pdMS_TO_TICKS(entry.delayMs));
+    if (entry.fn) entry.fn();
+
+    portENTER_CRITICAL(&_mux);
+    _stats[entry.priority].executed++;
+    portEXIT_CRITICAL(&_mux);
+
+    entry.fn = nullptr; // Captures sofort freigeben
+    xQueueSend(_free, &slot, 0);
+}
+
+void WorkerPool::writeStatsJson(JsonWriter& json) {
+    static const char* const names[2] = {"control", "bulk"};
+
+    WorkerQueueStats copy[2];
+    portENTER_CRITICAL(&_mux);
+    copy[0] = _stats[0];
+    copy[1] = _stats[1];
+    portEXIT_CRITICAL(&_mux);
+
+    json.beginObject();
+    json.field("workers", WORKER_POOL_SIZE);
+    json.field("slots", WORKER_QUEUE_LEN);
+    json.field("free_slots", freeSlots());
+    json.field("async_requests", asyncRequests);
+    for (uint8_t p = 0; p < 2; p++) {
+        const WorkerQueueStats& s = copy[p];
+        json.key(names[p]);
+        json.beginObject();
+        json.field("enqueued", s.enqueued);
+        json.field("executed", s.executed);
+        json.field("rejected", s.rejected);
+        json.field("depth", s.depth);
+        json.field("max_depth", s.maxDepth);
+        json.field("wait_avg_us", s.executed ? (uint32_t)(s.waitTotalUs / s.executed) : 0u);
+        json.field("wait_max_us", s.waitMaxUs);
+        json.endObject();
+    }
+    json.endObject();
+}
\ No newline at end of file
@@ -0,0 +1,112 @@
+//================================================================================
+//| DATEI: WorkerPool.h                                                          |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Kleiner Pool aus FreeRTOS-Tasks, auf die langsame Arbeit aus dem httpd-Task  |
+//| ausgelagert wird (z.B. verzögerter Neustart, große Datei-Antworten). So      |
+//| bleibt der httpd-Task frei für zeitkritische Steuerbefehle.                  |
+//|                                                                              |
+//| PRIORITÄTEN: Es gibt zwei Warteschlangen. Jobs der Klasse CONTROL werden     |
+//| immer vor BULK-Jobs (statische Dateien) abgearbeitet.                        |
+//================================================================================
+
+#pragma once
+
+#include <Arduino.h>
+#include <functional>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+
+class JsonWriter;
+
+// Anzahl der Worker-Tasks.
+#define WORKER_POOL_SIZE       2
+// Maximale Anzahl wartender Jobs (über beide Prioritäten).
+#define WORKER_QUEUE_LEN       8
+// Stack pro Worker (Datei-Antworten brauchen Request-Arena + Sendepuffer).
+#define WORKER_STACK_SIZE      6144
+// Unter dem httpd-Task (Priorität 5), damit Steuerbefehle ihn verdrängen.
+#define WORKER_TASK_PRIORITY   4
+
+/**
+ * @brief Prioritätsklasse einer Route bzw. eines Jobs.
+ * CONTROL: Steuer-/API-Routen, laufen direkt im httpd-Task (minimale Latenz).
+ * BULK: Statische Dateien und andere große Antworten, werden ausgelagert.
+ */
+enum RoutePriority : uint8_t {
+    ROUTE_PRIORITY_CONTROL = 0,
+    ROUTE_PRIORITY_BULK = 1
+};
+
+/**
+ * @brief Kennzahlen einer Warteschlange.
+ */
+struct WorkerQueueStats {
+    uint32_t enqueued;      // angenommene Jobs
+    uint32_t executed;      // abgearbeitete Jobs
+    uint32_t rejected;      // abgelehnt, weil alle Slots belegt waren
+    uint16_t depth;         // aktuell wartende Jobs
+    uint16_t maxDepth;      // höchste beobachtete Tiefe
+    uint32_t waitMaxUs;     // längste Wartezeit bis zum Start
+    uint64_t waitTotalUs;   // Summe der Wartezeiten (für den Mittelwert)
+};
+
+/**
+ * @class WorkerPool
+ * @brief Feste Anzahl Worker-Tasks mit zwei Prioritäts-Warteschlangen.
+ *
+ * Die Jobs liegen in einem festen Slot-Array; über die FreeRTOS-Queues werden
+ * nur Slot-Indizes verschickt. Dadurch ist der Speicherbedarf konstant.
+ */
+class WorkerPool {
+public:
+    WorkerPool();
+
+    /**
+     * @brief Erstellt Queues und Worker-Tasks. Mehrfacher Aufruf ist harmlos.
+     */
+    void begin();
+
+    /**
+     * @brief Reiht einen Job ein.
+     * @param delayMs Optionale Wartezeit vor der Ausführung (z.B. Neustart nach Antwort).
+     * @return false, wenn der Pool nicht läuft oder alle Slots belegt sind.
+     */
+    bool submit(std::function<void()> job, RoutePriority priority, uint32_t delayMs = 0);
+
+    /**
+     * @brief Anzahl freier Job-Slots.
+     */
+    uint8_t freeSlots();
+
+    bool isRunning() const { return _pending != nullptr; }
+
+    /**
+     * @brief Schreibt Queue-Tiefen und Wartezeiten beider Prioritäten als JSON-Objekt.
+     */
+    void writeStatsJson(JsonWriter& json);
+
+    // Zähler für ausgelagerte HTTP-Requests (siehe AsyncWebServer::_dispatcher).
+    uint32_t asyncRequests = 0;
+
+private:
+    struct Job {
+        std::function<void()> fn;
+        int64_t enqueuedUs;
+        uint32_t delayMs;
+        RoutePriority priority;
+    };
+
+    Job _jobs[WORKER_QUEUE_LEN];
+    QueueHandle_t _free;            // freie Slot-Indizes
+    QueueHandle_t _queues[2];       // je Priorität eine Queue mit Slot-Indizes
+    SemaphoreHandle_t _pending;     // zählt alle wartenden Jobs
+    WorkerQueueStats _stats[2];
+    portMUX_TYPE _mux;
+
+    static void workerTask(void* arg);
+    void runNext();
+};
\ No newline at end of file
@@ -0,0 +1,507 @@
+//================================================================================
+//| DATEI: ConfigStore.cpp                                                       |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Implementiert den Konfigurations-Cache. Die RAM-Werte sind mit einem         |
+//| Spinlock geschützt (nur kurze Kopien). Der Commit kopiert die geänderten     |
+//| Werte heraus und schreibt sie ohne Lock; wer währenddessen etwas ändert,     |
+//| markiert den Schlüssel einfach erneut.                                       |
+//================================================================================
+
+#include "ConfigStore.h"
+#include "../../modules/Server/JsonWriter.h"
+#include <Preferences.h>
+#include <math.h>
+
+ConfigStore configStore;
+
+static portMUX_TYPE s_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static const ConfigDef kDefs[CFG_COUNT] = {
+#define CONFIG_DEF(id, name, type, def, min, max, decimals, ns, secret) { name, type, (float)(def), (float)(min), (float)(max), decimals, ns, secret },
+    CONFIG_ENTRIES(CONFIG_DEF)
+#undef CONFIG_DEF
+};
+
+static inline uint32_t bitOf(ConfigKey key) { return 1UL << key; }
+
+ConfigStore::ConfigStore()
+    : _dirty(0), _stored(0), _firstDirtyMs(0), _lastSetMs(0), _onChange(nullptr), _commitLock(nullptr), _task(nullptr),
+      _sets(0), _rejected(0), _unchanged(0), _coalesced(0), _skipped(0), _commits(0), _nvsWrites(0), _nvsErrors(0),
+      _lastCommitMs(0) {
+    for (uint8_t k = 0; k < CFG_COUNT; k++) {
+        setDefault((ConfigKey)k);
+        _persisted[k] = 0;
+    }
+}
+
+const ConfigDef& ConfigStore::def(ConfigKey key) {
+    return kDefs[key];
+}
+
+ConfigKey ConfigStore::find(const char* name) {
+    for (uint8_t k = 0; k < CFG_COUNT; k++) {
+        if (strcmp(kDefs[k].name, name) == 0) return (ConfigKey)k;
+    }
+    return CFG_COUNT;
+}
+
+void ConfigStore::setDefault(ConfigKey key) {
+    Slot& slot = _values[key];
+    memset(&slot, 0, sizeof(slot));
+    switch (kDefs[key].type) {
+        case CONFIG_FLOAT:  slot.f = kDefs[key].def; break;
+        case CONFIG_INT:    slot.i = (int32_t)kDefs[key].def; break;
+        case CONFIG_BOOL:   slot.b = kDefs[key].def != 0.0f; break;
+        case CONFIG_STRING: break; // Text-Standardwert ist immer ""
+    }
+}
+
+/**
+ * @brief Vergleichswert für "steht schon so im NVS": Bitmuster bzw. FNV-1a-Hash bei Text.
+ */
+uint32_t ConfigStore::fingerprint(ConfigKey key, const Slot& slot) const {
+    switch (kDefs[key].type) {
+        case CONFIG_FLOAT: {
+            uint32_t bits;
+            memcpy(&bits, &slot.f, sizeof(bits));
+            return bits;
+        }
+        case CONFIG_INT:  return (uint32_t)slot.i;
+        case CONFIG_BOOL: return slot.b ? 1 : 0;
+        case CONFIG_STRING: {
+            uint32_t hash = 2166136261UL;
+            for (const char* p = slot.s; *p; p++) hash = (hash ^ (uint8_t)*p) * 16777619UL;
+            return hash;
+        }
+    }
+    return 0;
+}
+
+void ConfigStore::begin() {
+    _commitLock = xSemaphoreCreateMutex();
+
+    Preferences preferences;
+    const char* openNs = nullptr;
+    bool open = false;
+    uint8_t loaded = 0;
+    for (uint8_t k = 0; k < CFG_COUNT; k++) {
+        ConfigKey key = (ConfigKey)k;
+        const ConfigDef& d = kDefs[k];
+        if (openNs != d.ns) {
+            if (open) preferences.end();
+            open = preferences.begin(d.ns, true); // schlägt fehl, solange der Namespace nicht existiert
+            openNs = d.ns;
+        }
+        if (!open || !preferences.isKey(d.name)) continue;
+
+        Slot slot;
+        memset(&slot, 0, sizeof(slot));
+        ConfigValue value = { key, 0.0f, 0, false, slot.s };
+        switch (d.type) {
+            case CONFIG_FLOAT:  slot.f = value.f = preferences.getFloat(d.name, d.def); break;
+            case CONFIG_INT:    slot.i = value.i = preferences.getInt(d.name, (int32_t)d.def); break;
+            case CONFIG_BOOL:   slot.b = value.b = preferences.getBool(d.name, d.def != 0.0f); break;
+            case CONFIG_STRING: preferences.getString(d.name, slot.s, sizeof(slot.s)); break;
+        }
+        _stored |= bitOf(key);
+        _persisted[k] = fingerprint(key, slot);
+
+        const char* error;
+        if (validate(key, value, error)) {
+            _values[k] = slot;
+            loaded++;
+        } else {
+            // Z.B. nach engeren Grenzen in einer neuen Firmware: Standardwert gilt und wird gespeichert.
+            Serial.printf("Config: '%s' ungültig (%s), nutze Standardwert\n", d.name, error);
+            _dirty |= bitOf(key);
+        }
+    }
+    if (open) preferences.end();
+
+    // motor_min > motor_max kann nur aus alten oder von Hand geschriebenen Daten stammen.
+    if (_values[CFG_MOTOR_MIN].i > _values[CFG_MOTOR_MAX].i) {
+        setDefault(CFG_MOTOR_MIN);
+        setDefault(CFG_MOTOR_MAX);
+        _dirty |= bitOf(CFG_MOTOR_MIN) | bitOf(CFG_MOTOR_MAX);
+    }
+    _firstDirtyMs = _lastSetMs = millis();
+
+    Serial.printf("Config: %u von %u Werten aus dem NVS geladen\n", (unsigned)loaded, (unsigned)CFG_COUNT);
+    xTaskCreate(commitTask, "config", CONFIG_TASK_STACK, this, CONFIG_TASK_PRIORITY, &_task);
+    if (_dirty && _task) xTaskNotifyGive(_task);
+}
+
+// --- Lesen ---
+
+float ConfigStore::getFloat(ConfigKey key) {
+    portENTER_CRITICAL(&s_mux);
+    float value = _values[key].f;
+    portEXIT_CRITICAL(&s_mux);
+    return value;
+}
+
+int32_t ConfigStore::getInt(ConfigKey key) {
+    portENTER_CRITICAL(&s_mux);
+    int32_t value = _values[key].i;
+    portEXIT_CRITICAL(&s_mux);
+    return value;
+}
+
+bool ConfigStore::getBool(ConfigKey key) {
+    portENTER_CRITICAL(&s_mux);
+    bool value = _values[key].b;
+    portEXIT_CRITICAL(&s_mux);
+    return value;
+}
+
+size_t ConfigStore::getString(ConfigKey key, char* out, size_t capacity) {
+    if (capacity == 0) return 0;
+    portENTER_CRITICAL(&s_mux);
+    size_t len = strlen(_values[key].s);
+    if (len >= capacity) len = capacity - 1;
+    memcpy(out, _values[key].s, len);
+    portEXIT_CRITICAL(&s_mux);
+    out[len] = '\0';
+    return len;
+}
+
+// --- Prüfen ---
+
+bool ConfigStore::validate(ConfigKey key, const ConfigValue& value, const char*& error) {
+    const ConfigDef& d = kDefs[key];
+    switch (d.type) {
+        case CONFIG_FLOAT:
+            // !(a && b) statt (a || b), damit auch NaN abgelehnt wird
+            if (!(value.f >= d.min && value.f <= d.max)) { error = "out of range"; return false; }
+            break;
+        case CONFIG_INT:
+            if (value.i < (int32_t)d.min || value.i > (int32_t)d.max) { error = "out of range"; return false; }
+            break;
+        case CONFIG_BOOL:
+            break;
+        case CONFIG_STRING: {
+            // Leer ist immer erlaubt (z.B. offenes WLAN), sonst gelten die Längengrenzen.
+            size_t len = value.s ? strlen(value.s) : 0;
+            if (len > (size_t)d.max) { error = "too long"; return false; }
+            if (len > 0 && len < (size_t)d.min) { error = "too short"; return false; }
+            break;
+        }
+    }
+    return true;
+}
+
+bool ConfigStore::parse(ConfigKey key, const char* text, ConfigValue& out, const char*& error) {
+    out.key = key;
+    out.f = 0.0f;
+    out.i = 0;
+    out.b = false;
+    out.s = nullptr;
+    if (key >= CFG_COUNT) { error = "unknown key"; return false; }
+    if (!text) text = "";
+
+    char* end = nullptr;
+    switch (kDefs[key].type) {
+        case CONFIG_FLOAT:
+            out.f = strtof(text, &end);
+            if (end == text || *end != '\0') { error = "not a number"; return false; }
+            break;
+        case CONFIG_INT: {
+            long v = strtol(text, &end, 10);
+            if (end == text || *end != '\0') { error = "not an integer"; return false; }
+            if (v < INT32_MIN || v > INT32_MAX) { error = "out of range"; return false; }
+            out.i = (int32_t)v;
+            break;
+        }
+        case CONFIG_BOOL:
+            if (!strcmp(text, "1") || !strcasecmp(text, "true") || !strcasecmp(text, "on")) out.b = true;
+            else if (!strcmp(text, "0") || !strcasecmp(text, "false") || !strcasecmp(text, "off")) out.b = false;
+            else { error = "not a boolean"; return false; }
+            break;
+        case CONFIG_STRING:
+            out.s = text;
+            break;
+    }
+    return validate(key, out, error);
+}
+
+// --- Schreiben (RAM) ---
+
+/**
+ * @brief Übernimmt einen geprüften Wert. Nur mit gehaltenem s_mux aufrufen.
+ * @return true, wenn sich der RAM-Wert geändert hat.
+ */
+bool ConfigStore::apply(const ConfigValue& value) {
+    Slot& slot = _values[value.key];
+    bool changed = false;
+    switch (kDefs[value.key].type) {
+        case CONFIG_FLOAT:
+            changed = memcmp(&slot.f, &value.f, sizeof(float)) != 0;
+            slot.f = value.f;
+            break;
+        case CONFIG_INT:
+            changed = slot.i != value.i;
+            slot.i = value.i;
+            break;
+        case CONFIG_BOOL:
+            changed = slot.b != value.b;
+            slot.b = value.b;
+            break;
+        case CONFIG_STRING: {
+            const char* text = value.s ? value.s : "";
+            changed = strcmp(slot.s, text) != 0;
+            if (changed) {
+                memset(slot.s, 0, sizeof(slot.s));
+                strncpy(slot.s, text, CONFIG_STRING_MAX);
+            }
+            break;
+        }
+    }
+    if (!changed) {
+        _unchanged++;
+        return false;
+    }
+
+    uint32_t now = millis();
+    if (!_dirty) _firstDirtyMs = now;
+    if (_dirty & bitOf(value.key)) _coalesced++; // der vorige Wert ist nie im Flash gelandet
+    _dirty |= bitOf(value.key);
+    _lastSetMs = now;
+    _sets++;
+    return true;
+}
+
+int ConfigStore::setMany(const ConfigValue* values, size_t count, size_t& errorIndex, const char*& error) {
+    // 1. Alles prüfen, bevor irgendetwas übernommen wird
+    int32_t motorMin = getInt(CFG_MOTOR_MIN);
+    int32_t motorMax = getInt(CFG_MOTOR_MAX);
+    for (size_t n = 0; n < count; n++) {
+        const ConfigValue& v = values[n];
+        if (v.key >= CFG_COUNT) { error = "unknown key"; errorIndex = n; _rejected++; return -1; }
+        if (!validate(v.key, v, error)) { errorIndex = n; _rejected++; return -1; }
+        if (v.key == CFG_MOTOR_MIN) motorMin = v.i;
+        if (v.key == CFG_MOTOR_MAX) motorMax = v.i;
+    }
+    if (motorMin > motorMax) {
+        error = "motor_min > motor_max";
+        errorIndex = count > 0 ? count - 1 : 0;
+        _rejected++;
+        return -1;
+    }
+
+    // 2. In einem Rutsch übernehmen, damit niemand einen halben Satz liest
+    uint32_t changedMask = 0;
+    bool wasClean;
+    portENTER_CRITICAL(&s_mux);
+    wasClean = _dirty == 0;
+    for (size_t n = 0; n < count; n++) {
+        if (apply(values[n])) changedMask |= bitOf(values[n].key);
+    }
+    portEXIT_CRITICAL(&s_mux);
+
+    if (changedMask && wasClean && _task) xTaskNotifyGive(_task);
+
+    int changed = 0;
+    for (uint8_t k = 0; k < CFG_COUNT; k++) {
+        if (!(changedMask & bitOf((ConfigKey)k))) continue;
+        changed++;
+        if (_onChange) _onChange((ConfigKey)k);
+    }
+    return changed;
+}
+
+bool ConfigStore::setFloat(ConfigKey key, float value) {
+    ConfigValue v = { key, value, 0, false, nullptr };
+    size_t index;
+    const char* error;
+    return setMany(&v, 1, index, error) >= 0;
+}
+
+bool ConfigStore::setInt(ConfigKey key, int32_t value) {
+    ConfigValue v = { key, 0.0f, value, false, nullptr };
+    size_t index;
+    const char* error;
+    return setMany(&v, 1, index, error) >= 0;
+}
+
+bool ConfigStore::setBool(ConfigKey key, bool value) {
+    ConfigValue v = { key, 0.0f, 0, value, nullptr };
+    size_t index;
+    const char* error;
+    return setMany(&v, 1, index, error) >= 0;
+}
+
+bool ConfigStore::setString(ConfigKey key, const char* value) {
+    ConfigValue v = { key, 0.0f, 0, false, value };
+    size_t index;
+    const char* error;
+    return setMany(&v, 1, index, error) >= 0;
+}
+
+// --- Schreiben (NVS) ---
+
+void ConfigStore::commit() {
+    if (!_commitLock) return; // begin() noch nicht gelaufen
+    runCommit();
+}
+
+void ConfigStore::runCommit() {
+    xSemaphoreTake(_commitLock, portMAX_DELAY);
+
+    // Offene Werte herauskopieren; Änderungen ab jetzt markieren neu.
+    Slot snapshot[CFG_COUNT];
+    uint32_t dirty;
+    portENTER_CRITICAL(&s_mux);
+    dirty = _dirty;
+    _dirty = 0;
+    for (uint8_t k = 0; k < CFG_COUNT; k++) {
+        if (dirty & bitOf((ConfigKey)k)) snapshot[k] = _values[k];
+    }
+    portEXIT_CRITICAL(&s_mux);
+
+    if (!dirty) {
+        xSemaphoreGive(_commitLock);
+        return;
+    }
+
+    Preferences preferences;
+    const char* openNs = nullptr;
+    bool open = false;
+    uint32_t failed = 0;
+    uint32_t writes = 0;
+    for (uint8_t k = 0; k < CFG_COUNT; k++) {
+        ConfigKey key = (ConfigKey)k;
+        if (!(dirty & bitOf(key))) continue;
+        const ConfigDef& d = kDefs[k];
+
+        // Z.B. Regler hin und wieder zurück geschoben: im NVS steht schon der richtige Wert.
+        uint32_t fp = fingerprint(key, snapshot[k]);
+        if ((_stored & bitOf(key)) && _persisted[k] == fp) {
+            _skipped++;
+            continue;
+        }
+
+        if (openNs != d.ns) {
+            if (open) preferences.end();
+            open = preferences.begin(d.ns, false);
+            openNs = d.ns;
+        }
+        size_t written = 0;
+        if (open) {
+            switch (d.type) {
+                case CONFIG_FLOAT:  written = preferences.putFloat(d.name, snapshot[k].f); break;
+                case CONFIG_INT:    written = preferences.putInt(d.name, snapshot[k].i); break;
+                case CONFIG_BOOL:   written = preferences.putBool(d.name, snapshot[k].b); break;
+                case CONFIG_STRING: written = preferences.putString(d.name, snapshot[k].s); break;
+            }
+        }
+        // Ein leerer Text meldet 0 Bytes, ist aber trotzdem gespeichert.
+        if (written > 0 || (open && d.type == CONFIG_STRING && snapshot[k].s[0] == '\0')) {
+            _persisted[k] = fp;
+            _stored |= bitOf(key);
+            writes++;
+        } else {
+            failed |= bitOf(key);
+        }
+    }
+    if (open) preferences.end();
+
+    if (failed) {
+        // Beim nächsten Commit erneut versuchen
+        portENTER_CRITICAL(&s_mux);
+        _dirty |= failed;
+        portEXIT_CRITICAL(&s_mux);
+        _nvsErrors++;
+        Serial.println("Config: Schreiben ins NVS fehlgeschlagen");
+    }
+    _nvsWrites += writes;
+    _commits++;
+    _lastCommitMs = millis();
+    xSemaphoreGive(_commitLock);
+}
+
+void ConfigStore::commitTask(void* arg) {
+    ConfigStore* self = (ConfigStore*)arg;
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY); // erste Änderung nach einem Commit
+
+        for (;;) {
+            uint32_t dirty, firstDirty, lastSet;
+            portENTER_CRITICAL(&s_mux);
+            dirty = self->_dirty;
+            firstDirty = self->_firstDirtyMs;
+            lastSet = self->_lastSetMs;
+            portEXIT_CRITICAL(&s_mux);
+            if (!dirty) break;
+
+            uint32_t now = millis();
+            uint32_t quiet = now - lastSet;
+            uint32_t age = now - firstDirty;
+            if (quiet >= CONFIG_COMMIT_DELAY_MS || age >= CONFIG_COMMIT_MAX_DELAY_MS) {
+                self->runCommit();
+                // Ist ein Wert fehlgeschlagen, nicht sofort wieder hämmern
+                if (self->_dirty) {
+                    portENTER_CRITICAL(&s_mux);
+                    self->_firstDirtyMs = self->_lastSetMs = millis();
+                    portEXIT_CRITICAL(&s_mux);
+                }
+                continue;
+            }
+            uint32_t wait = CONFIG_COMMIT_DELAY_MS - quiet;
+            if (wait > CONFIG_COMMIT_MAX_DELAY_MS - age) wait = CONFIG_COMMIT_MAX_DELAY_MS - age;
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait));
+        }
+    }
+}
+
+// --- Ausgabe ---
+
+void ConfigStore::writeValuesJson(JsonWriter& json) {
+    Slot values[CFG_COUNT];
+    portENTER_CRITICAL(&s_mux);
+    memcpy(values, _values, sizeof(values));
+    portEXIT_CRITICAL(&s_mux);
+
+    json.beginObject();
+    for (uint8_t k = 0; k < CFG_COUNT; k++) {
+        const ConfigDef& d = kDefs[k];
+        if (d.secret) continue;
+        switch (d.type) {
+            case CONFIG_FLOAT:  json.field(d.name, values[k].f, d.decimals); break;
+            case CONFIG_INT:    json.field(d.name, (long)values[k].i); break;
+            case CONFIG_BOOL:   json.field(d.name, values[k].b); break;
+            case CONFIG_STRING: json.field(d.name, (const char*)values[k].s); break;
+        }
+    }
+    json.endObject();
+}
+
+void ConfigStore::writeStatsJson(JsonWriter& json) {
+    uint32_t dirty;
+    portENTER_CRITICAL(&s_mux);
+    dirty = _dirty;
+    portEXIT_CRITICAL(&s_mux);
+
+    uint32_t pending = 0;
+    for (uint8_t k = 0; k < CFG_COUNT; k++) {
+        if (dirty & bitOf((ConfigKey)k)) pending++;
+    }
+
+    json.beginObject();
+    json.field("sets", _sets);
+    json.field("rejected", _rejected);
+    json.field("unchanged", _unchanged);
+    json.field("coalesced", _coalesced);
+    json.field("skipped", _skipped);
+    // Schreibvorgänge, die ein direktes putX() je Änderung gekostet hätte
+    json.field("writes_avoided", _unchanged + _coalesced + _skipped);
+    json.field("nvs_writes", _nvsWrites);
+    json.field("nvs_errors", _nvsErrors);
+    json.field("commits", _commits);
+    json.field("pending", pending);
+    json.field("last_commit_ms", _lastCommitMs);
+    json.field("commit_delay_ms", (uint32_t)CONFIG_COMMIT_DELAY_MS);
+    json.endObject();
+}
@@ -0,0 +1,205 @@
+//================================================================================
+//| DATEI: ConfigStore.h                                                         |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Zentrale, typisierte Konfiguration (PID-Werte, Sollwinkel, Deadzone,         |
+//| Motorgrenzen, Health-Takt, WLAN). Jeder Schlüssel hat Typ, Standardwert und  |
+//| Grenzen; alle Werte liegen im RAM, Lesen kostet keinen NVS-Zugriff.          |
+//|                                                                              |
+//| VERZÖGERTES SPEICHERN: set() ändert nur den RAM-Wert und markiert den        |
+//| Schlüssel. Ein Hintergrund-Task schreibt erst, wenn CONFIG_COMMIT_DELAY_MS   |
+//| lang nichts mehr geändert wurde, spätestens aber nach                        |
+//| CONFIG_COMMIT_MAX_DELAY_MS.                                                  |
+//| Ein Schieberegler, der 50 Werte pro Sekunde schickt, erzeugt so einen        |
+//| einzigen Flash-Schreibvorgang. Werte, die schon so im NVS stehen, werden     |
+//| gar nicht geschrieben.                                                       |
+//================================================================================
+
+#pragma once
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+class JsonWriter;
+
+#define CONFIG_COMMIT_DELAY_MS      2000   // Ruhezeit vor dem Schreiben
+#define CONFIG_COMMIT_MAX_DELAY_MS  10000  // spätestens so lange nach der ersten Änderung
+#define CONFIG_STRING_MAX           64     // längster Text-Wert (WPA-Passwort)
+#define CONFIG_TASK_STACK           4096
+#define CONFIG_TASK_PRIORITY        1
+
+enum ConfigType : uint8_t {
+    CONFIG_FLOAT,
+    CONFIG_INT,
+    CONFIG_BOOL,
+    CONFIG_STRING
+};
+
+// Schlüssel-Tabelle: ID, Name (= NVS-Schlüssel und API-Name), Typ, Standardwert,
+// Minimum, Maximum (bei Text: Länge, leer ist immer erlaubt), Nachkommastellen
+// für JSON, NVS-Namespace, geheim.
+// Die WLAN-Daten bleiben im alten Namespace "wifi_creds", damit bereits
+// gespeicherte Zugangsdaten nach dem Update weiter gelten.
+#define CONFIG_ENTRIES(X) \
+    X(CFG_KP,            "kp",        CONFIG_FLOAT,  3.0f,   0.0f,    100.0f, 3, "config",     false) \
+    X(CFG_KI,            "ki",        CONFIG_FLOAT,  0.005f, 0.0f,    10.0f,  4, "config",     false) \
+    X(CFG_KD,            "kd",        CONFIG_FLOAT,  0.3f,   0.0f,    100.0f, 3, "config",     false) \
+    X(CFG_TARGET_ANGLE,  "target",    CONFIG_FLOAT,  0.0f,   -90.0f,  90.0f,  2, "config",     false) \
+    X(CFG_DEADZONE,      "deadzone",  CONFIG_FLOAT,  50.0f,  0.0f,    180.0f, 2, "config",     false) \
+    X(CFG_MOTOR_MIN,     "motor_min", CONFIG_INT,    80,     0,       255,    0, "config",     false) \
+    X(CFG_MOTOR_MAX,     "motor_max", CONFIG_INT,    255,    0,       255,    0, "config",     false) \
+    X(CFG_HEALTH_MS,     "health_ms", CONFIG_INT,    1000,   250,     60000,  0, "config",     false) \
+    X(CFG_WIFI_IP_REUSE, "ip_reuse",  CONFIG_BOOL,   0,      0,       1,      0, "config",     false) \
+    X(CFG_WIFI_SSID,     "ssid",      CONFIG_STRING, 0,      1,       32,     0, "wifi_creds", false) \
+    X(CFG_WIFI_PASSWORD, "password",  CONFIG_STRING, 0,      8,       63,     0, "wifi_creds", true)
+
+enum ConfigKey : uint8_t {
+#define CONFIG_ENUM(id, name, type, def, min, max, decimals, ns, secret) id,
+    CONFIG_ENTRIES(CONFIG_ENUM)
+#undef CONFIG_ENUM
+    CFG_COUNT
+};
+
+/**
+ * @brief Beschreibung eines Schlüssels (aus CONFIG_ENTRIES erzeugt).
+ */
+struct ConfigDef {
+    const char* name;
+    ConfigType type;
+    float def;
+    float min;
+    float max;
+    uint8_t decimals;
+    const char* ns;
+    bool secret;        // wird von GET /api/config nicht ausgegeben
+};
+
+/**
+ * @brief Ein geprüfter, noch nicht übernommener Wert (für Sammel-Änderungen).
+ * Text-Werte zeigen auf den Aufrufer-Puffer, bis set() sie kopiert.
+ */
+struct ConfigValue {
+    ConfigKey key;
+    float f;
+    int32_t i;
+    bool b;
+    const char* s;
+};
+
+/**
+ * @class ConfigStore
+ * @brief RAM-Cache aller Einstellungen mit verzögertem Schreiben ins NVS.
+ *
+ * Getter und Setter dürfen aus jedem Task aufgerufen werden (Spinlock, kein
+ * Flash-Zugriff). Ins NVS schreibt nur der Commit-Task bzw. commit().
+ */
+class ConfigStore {
+public:
+    typedef void (*ChangeHandler)(ConfigKey key);
+
+    ConfigStore();
+
+    /**
+     * @brief Lädt alle Werte aus dem NVS (fehlende = Standardwert) und startet den
+     * Commit-Task. Muss vor allen Modulen laufen, die Einstellungen lesen.
+     */
+    void begin();
+
+    /**
+     * @brief Wird nach jeder übernommenen Änderung aufgerufen (im Task des Aufrufers).
+     */
+    void onChange(ChangeHandler handler) { _onChange = handler; }
+
+    float getFloat(ConfigKey key);
+    int32_t getInt(ConfigKey key);
+    bool getBool(ConfigKey key);
+    size_t getString(ConfigKey key, char* out, size_t capacity);
+
+    /**
+     * @brief Setzt einen Wert. Außerhalb der Grenzen wird abgelehnt (false),
+     * gespeichert wird verzögert. Ein unveränderter Wert gilt als Erfolg.
+     */
+    bool setFloat(ConfigKey key, float value);
+    bool setInt(ConfigKey key, int32_t value);
+    bool setBool(ConfigKey key, bool value);
+    bool setString(ConfigKey key, const char* value);
+
+    /**
+     * @brief Sucht einen Schlüssel über seinen Namen.
+     * @return CFG_COUNT, wenn es ihn nicht gibt.
+     */
+    static ConfigKey find(const char* name);
+    static const ConfigDef& def(ConfigKey key);
+
+    /**
+     * @brief Wandelt Text (z.B. aus einem Request) in einen geprüften Wert.
+     * @param error Grund bei Rückgabe false.
+     */
+    static bool parse(ConfigKey key, const char* text, ConfigValue& out, const char*& error);
+
+    /**
+     * @brief Übernimmt mehrere Werte ganz oder gar nicht. Prüft auch Abhängigkeiten
+     * zwischen Schlüsseln (motor_min <= motor_max) mit den neuen Werten.
+     * @param errorIndex Index des abgelehnten Werts (bei Rückgabe -1).
+     * @return Anzahl tatsächlich geänderter Werte bzw. -1 bei einem Fehler.
+     */
+    int setMany(const ConfigValue* values, size_t count, size_t& errorIndex, const char*& error);
+
+    /**
+     * @brief Schreibt alle offenen Änderungen sofort (z.B. vor einem Neustart).
+     */
+    void commit();
+
+    /**
+     * @brief Alle nicht geheimen Werte als JSON-Objekt ("name": wert).
+     */
+    void writeValuesJson(JsonWriter& json);
+
+    /**
+     * @brief Zähler: Änderungen, NVS-Schreibvorgänge und eingesparte Schreibvorgänge.
+     */
+    void writeStatsJson(JsonWriter& json);
+
+private:
+    union Slot {
+        float f;
+        int32_t i;
+        bool b;
+        char s[CONFIG_STRING_MAX + 1];
+    };
+
+    Slot _values[CFG_COUNT];
+    uint32_t _persisted[CFG_COUNT];     // Fingerabdruck des Werts im NVS
+    uint32_t _dirty;                    // Bit je Schlüssel: RAM weicht evtl. vom NVS ab
+    uint32_t _stored;                   // Bit je Schlüssel: existiert im NVS
+    uint32_t _firstDirtyMs;
+    uint32_t _lastSetMs;
+    ChangeHandler _onChange;
+    SemaphoreHandle_t _commitLock;      // ein Commit zur Zeit (Task oder commit())
+    TaskHandle_t _task;
+
+    // Zähler für /api/config/stats
+    uint32_t _sets;                     // übernommene Änderungen
+    uint32_t _rejected;                 // Wert außerhalb der Grenzen
+    uint32_t _unchanged;                // gleicher Wert wie im RAM
+    uint32_t _coalesced;                // überschrieben, bevor er gespeichert war
+    uint32_t _skipped;                  // beim Commit schon so im NVS
+    uint32_t _commits;
+    uint32_t _nvsWrites;
+    uint32_t _nvsErrors;
+    uint32_t _lastCommitMs;
+
+    static bool validate(ConfigKey key, const ConfigValue& value, const char*& error);
+    bool apply(const ConfigValue& value);
+    uint32_t fingerprint(ConfigKey key, const Slot& slot) const;
+    void setDefault(ConfigKey key);
+    void runCommit();
+
+    static void commitTask(void* arg);
+};
+
+// Eine Instanz für alle Module (wie eventLog).
+extern ConfigStore configStore;
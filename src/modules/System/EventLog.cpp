@@ -0,0 +1,530 @@
+//================================================================================
+//| DATEI: EventLog.cpp                                                          |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Implementiert den RTC-Ringpuffer des Ereignis-Logs und die Auslagerung in    |
+//| die NVS-Partition "nvs2". Alle Zugriffe auf den Ring laufen über einen       |
+//| Spinlock; der Flash-Index ist mit einem Mutex geschützt, weil NVS-Zugriffe   |
+//| blockieren dürfen.                                                           |
+//================================================================================
+
+#include "EventLog.h"
+#include "../../modules/Server/JsonWriter.h"
+#include <esp_system.h>
+#include <nvs_flash.h>
+
+#define EVENT_LOG_RTC_MAGIC   0x45564C31  // "EVL1"
+#define EVENT_LOG_META_MAGIC  0x45564D31  // "EVM1"
+#define EVENT_LOG_NAMESPACE   "evlog"
+#define EVENT_LOG_MIN_RECORD  4           // len, Kopf, ID, Zeit
+#define PAGE_HEADER_SIZE      (sizeof(uint32_t) + 2 * sizeof(uint16_t))
+
+EventLog eventLog;
+
+// --- RTC-Ringpuffer (überlebt Resets, nicht aber Stromausfall) ---
+struct RtcRing {
+    uint32_t magic;
+    uint32_t tail;        // Position des ältesten Datensatzes
+    uint32_t used;        // belegte Bytes
+    uint32_t firstSeq;    // Nummer des Datensatzes bei `tail`
+    uint32_t nextSeq;     // Nummer des nächsten Datensatzes
+    uint32_t spilledSeq;  // Datensätze davor liegen bereits im Flash
+    uint32_t dropped;     // verdrängt, bevor sie ausgelagert waren
+    uint8_t data[EVENT_LOG_RTC_SIZE];
+};
+RTC_NOINIT_ATTR static RtcRing s_ring;
+static portMUX_TYPE s_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static const char* const kEventNames[] = {
+#define EVENT_LOG_NAME(id, name, text) name,
+    EVENT_LOG_EVENTS(EVENT_LOG_NAME)
+#undef EVENT_LOG_NAME
+};
+
+static const char* const kEventTexts[] = {
+#define EVENT_LOG_TEXT(id, name, text) text,
+    EVENT_LOG_EVENTS(EVENT_LOG_TEXT)
+#undef EVENT_LOG_TEXT
+};
+
+// --- Kodierung ---
+
+static size_t putVarint(uint8_t* out, uint32_t value) {
+    size_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = (uint8_t)value;
+    return n;
+}
+
+static uint32_t getVarint(const uint8_t*& p, const uint8_t* end) {
+    uint32_t value = 0;
+    for (uint8_t shift = 0; p < end && shift < 35; shift += 7) {
+        uint8_t b = *p++;
+        value |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) break;
+    }
+    return value;
+}
+
+static inline uint32_t zigzag(int32_t v) { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+static inline int32_t unzigzag(uint32_t v) { return (int32_t)(v >> 1) ^ -(int32_t)(v & 1); }
+
+// NVS-Schlüssel einer Flash-Seite ("p00" bis "p47")
+static void pageKey(uint8_t page, char (&key)[5]) { snprintf(key, sizeof(key), "p%02u", (unsigned)page); }
+
+// --- Ring-Hilfen (nur mit gehaltenem s_mux aufrufen) ---
+
+static inline uint8_t ringAt(uint32_t pos) {
+    return s_ring.data[pos % EVENT_LOG_RTC_SIZE];
+}
+
+static void ringCopyOut(uint32_t pos, uint8_t* out, size_t len) {
+    size_t first = EVENT_LOG_RTC_SIZE - pos;
+    if (first > len) first = len;
+    memcpy(out, s_ring.data + pos, first);
+    memcpy(out + first, s_ring.data, len - first);
+}
+
+static void ringCopyIn(uint32_t pos, const uint8_t* in, size_t len) {
+    size_t first = EVENT_LOG_RTC_SIZE - pos;
+    if (first > len) first = len;
+    memcpy(s_ring.data + pos, in, first);
+    memcpy(s_ring.data, in + first, len - first);
+}
+
+// Position des Datensatzes `seq` (firstSeq <= seq <= nextSeq).
+static uint32_t ringOffsetOf(uint32_t seq) {
+    uint32_t pos = s_ring.tail;
+    for (uint32_t s = s_ring.firstSeq; s < seq; s++) pos = (pos + ringAt(pos)) % EVENT_LOG_RTC_SIZE;
+    return pos;
+}
+
+// Nach einem Reset: Passen Längen und Nummern noch zusammen?
+static bool ringValid() {
+    if (s_ring.magic != EVENT_LOG_RTC_MAGIC || s_ring.tail >= EVENT_LOG_RTC_SIZE ||
+        s_ring.used > EVENT_LOG_RTC_SIZE || s_ring.nextSeq < s_ring.firstSeq) {
+        return false;
+    }
+    uint32_t pos = s_ring.tail, remaining = s_ring.used, records = 0;
+    while (remaining > 0) {
+        uint8_t len = ringAt(pos);
+        if (len < EVENT_LOG_MIN_RECORD || len > EVENT_LOG_MAX_RECORD || len > remaining) return false;
+        pos = (pos + len) % EVENT_LOG_RTC_SIZE;
+        remaining -= len;
+        records++;
+    }
+    return records == s_ring.nextSeq - s_ring.firstSeq;
+}
+
+static void ringReset(uint32_t seq) {
+    s_ring.magic = EVENT_LOG_RTC_MAGIC;
+    s_ring.tail = 0;
+    s_ring.used = 0;
+    s_ring.firstSeq = s_ring.nextSeq = s_ring.spilledSeq = seq;
+    s_ring.dropped = 0;
+}
+
+EventLog::EventLog()
+    : _flashReady(false), _flashLock(nullptr), _task(nullptr),
+      _spillWrites(0), _appendCount(0), _appendMaxCycles(0) {
+    memset(&_meta, 0, sizeof(_meta));
+    memset(&_page, 0, PAGE_HEADER_SIZE);
+}
+
+void EventLog::begin() {
+    _flashLock = xSemaphoreCreateMutex();
+    _flashReady = loadFlash();
+    if (!_flashReady) Serial.println("EventLog: Partition " EVENT_LOG_PARTITION " nicht nutzbar, nur RTC-Puffer.");
+
+    portENTER_CRITICAL(&s_mux);
+    // Beim Einschalten ist der RTC-Speicher zufällig; sonst wird er geprüft.
+    if (esp_reset_reason() == ESP_RST_POWERON || !ringValid() || s_ring.nextSeq < _meta.next) {
+        ringReset(_meta.next);
+    }
+    if (_flashReady) {
+        // Was laut Flash-Index fehlt, wird erneut ausgelagert.
+        uint32_t spilled = _meta.next;
+        if (spilled < s_ring.firstSeq) spilled = s_ring.firstSeq;
+        if (spilled > s_ring.nextSeq) spilled = s_ring.nextSeq;
+        s_ring.spilledSeq = spilled;
+    }
+    portEXIT_CRITICAL(&s_mux);
+
+    Serial.printf("EventLog: %u Einträge im RTC-Puffer (#%u..#%u), %u Flash-Seiten\n",
+                  (unsigned)(s_ring.nextSeq - s_ring.firstSeq), (unsigned)s_ring.firstSeq,
+                  (unsigned)s_ring.nextSeq, (unsigned)_meta.pages);
+
+    if (_flashReady) {
+        xTaskCreate(spillTask, "eventLog", EVENT_LOG_TASK_STACK, this, EVENT_LOG_TASK_PRIORITY, &_task);
+    }
+    log(EVENT_INFO, EVT_BOOT, {(int32_t)esp_reset_reason()});
+}
+
+void EventLog::log(EventLevel level, EventId id, std::initializer_list<int32_t> args) {
+    uint8_t record[EVENT_LOG_MAX_RECORD];
+    size_t n = 2;
+    n += putVarint(record + n, id);
+    n += putVarint(record + n, millis());
+    uint8_t argc = 0;
+    for (int32_t arg : args) {
+        if (argc == EVENT_LOG_MAX_ARGS) break;
+        n += putVarint(record + n, zigzag(arg));
+        argc++;
+    }
+    record[0] = (uint8_t)n;
+    record[1] = (uint8_t)((level << 6) | argc);
+    append(record, n);
+}
+
+void EventLog::text(EventLevel level, const char* text) {
+    uint8_t record[EVENT_LOG_MAX_RECORD];
+    size_t n = 2;
+    n += putVarint(record + n, EVT_TEXT);
+    n += putVarint(record + n, millis());
+
+    size_t len = strlen(text);
+    if (len > EVENT_LOG_MAX_RECORD - n) {
+        len = EVENT_LOG_MAX_RECORD - n;
+        while (len > 0 && ((uint8_t)text[len] & 0xC0) == 0x80) len--; // UTF-8-Zeichen nicht zerschneiden
+    }
+    memcpy(record + n, text, len);
+    n += len;
+    record[0] = (uint8_t)n;
+    record[1] = (uint8_t)((level << 6) | 0x20);
+    append(record, n);
+}
+
+void EventLog::append(const uint8_t* record, size_t len) {
+    uint32_t t0 = ESP.getCycleCount();
+    portENTER_CRITICAL(&s_mux);
+    // Kein Platz: die ältesten Datensätze verdrängen
+    while (EVENT_LOG_RTC_SIZE - s_ring.used < len) {
+        uint8_t oldLen = ringAt(s_ring.tail);
+        s_ring.tail = (s_ring.tail + oldLen) % EVENT_LOG_RTC_SIZE;
+        s_ring.used -= oldLen;
+        if (s_ring.firstSeq >= s_ring.spilledSeq) {
+            s_ring.dropped++;
+            s_ring.spilledSeq = s_ring.firstSeq + 1;
+        }
+        s_ring.firstSeq++;
+    }
+    ringCopyIn((s_ring.tail + s_ring.used) % EVENT_LOG_RTC_SIZE, record, len);
+    s_ring.used += len;
+    s_ring.nextSeq++;
+    bool wake = s_ring.nextSeq - s_ring.spilledSeq >= EVENT_LOG_SPILL_THRESHOLD;
+    portEXIT_CRITICAL(&s_mux);
+
+    uint32_t cycles = ESP.getCycleCount() - t0;
+    _appendCount++;
+    if (cycles > _appendMaxCycles) _appendMaxCycles = cycles;
+    if (wake && _task) xTaskNotifyGive(_task);
+}
+
+size_t EventLog::read(uint32_t& cursor, uint8_t* out, size_t capacity, uint16_t maxRecords, uint32_t& firstSeq) {
+    if (cursor < s_ring.firstSeq) {
+        size_t n = readFlash(cursor, out, capacity, maxRecords, firstSeq);
+        if (n > 0) return n;
+    }
+
+    size_t total = 0;
+    uint16_t count = 0;
+    portENTER_CRITICAL(&s_mux);
+    if (cursor < s_ring.firstSeq) cursor = s_ring.firstSeq; // verdrängte Datensätze überspringen
+    if (cursor > s_ring.nextSeq) cursor = s_ring.nextSeq;
+    firstSeq = cursor;
+    uint32_t pos = ringOffsetOf(cursor);
+    while (cursor < s_ring.nextSeq && count < maxRecords) {
+        uint8_t len = ringAt(pos);
+        if (total + len > capacity) break;
+        ringCopyOut(pos, out + total, len);
+        total += len;
+        pos = (pos + len) % EVENT_LOG_RTC_SIZE;
+        cursor++;
+        count++;
+    }
+    portEXIT_CRITICAL(&s_mux);
+    return total;
+}
+
+/**
+ * @brief Liest aus der Flash-Seite, die `cursor` enthält (höchstens eine Seite pro Aufruf).
+ */
+size_t EventLog::readFlash(uint32_t& cursor, uint8_t* out, size_t capacity, uint16_t maxRecords, uint32_t& firstSeq) {
+    if (!_flashReady) return 0;
+    size_t total = 0;
+    xSemaphoreTake(_flashLock, portMAX_DELAY);
+
+    // Seiten von der ältesten zur neuesten durchsuchen
+    int page = -1;
+    for (uint8_t k = 0; k < _meta.pages; k++) {
+        uint8_t i = (_meta.head + EVENT_LOG_FLASH_PAGES - _meta.pages + 1 + k) % EVENT_LOG_FLASH_PAGES;
+        if (cursor < _meta.first[i] + _meta.count[i]) {
+            page = i;
+            break;
+        }
+    }
+
+    if (page >= 0) {
+        Page* p = &_page;
+        if (page != _meta.head) {
+            p = (Page*)malloc(sizeof(Page));
+            char key[5];
+            pageKey(page, key);
+            if (p && _prefs.getBytes(key, p, sizeof(Page)) < PAGE_HEADER_SIZE) p->count = 0;
+        }
+        if (p) {
+            if (cursor < p->firstSeq) cursor = p->firstSeq;
+            firstSeq = cursor;
+            const uint8_t* rec = p->data;
+            const uint8_t* end = p->data + p->bytes;
+            uint16_t count = 0;
+            for (uint32_t s = p->firstSeq; s < p->firstSeq + p->count && rec < end && rec[0] >= EVENT_LOG_MIN_RECORD; s++) {
+                if (s >= cursor) {
+                    if (total + rec[0] > capacity || count == maxRecords) break;
+                    memcpy(out + total, rec, rec[0]);
+                    total += rec[0];
+                    cursor++;
+                    count++;
+                }
+                rec += rec[0];
+            }
+            if (p != &_page) free(p);
+        }
+    }
+    xSemaphoreGive(_flashLock);
+    return total;
+}
+
+size_t EventLog::format(uint32_t seq, const uint8_t* record, char* out, size_t capacity) {
+    const uint8_t* p = record + 2;
+    const uint8_t* end = record + record[0];
+    uint8_t level = record[1] >> 6;
+    bool isText = record[1] & 0x20;
+    uint8_t argc = record[1] & 0x0F;
+    uint32_t id = getVarint(p, end);
+    uint32_t ms = getVarint(p, end);
+
+    int n = snprintf(out, capacity, "%u %lu.%03lu %c %s: ", (unsigned)seq, (unsigned long)(ms / 1000),
+                     (unsigned long)(ms % 1000), "DIWE"[level], id < EVT_COUNT ? kEventNames[id] : "?");
+    if (n < 0 || (size_t)n >= capacity) return capacity ? capacity - 1 : 0;
+    size_t len = n;
+
+    // Platzhalter des Ereignistexts der Reihe nach füllen
+    const char* fmt = id < EVT_COUNT ? kEventTexts[id] : "%d %d %d %d"; // unbekannt: Rohwerte
+    for (const char* f = fmt; *f && len + 1 < capacity; f++) {
+        if (f[0] == '%' && f[1] == 'd') {
+            if (argc > 0) {
+                argc--;
+                int k = snprintf(out + len, capacity - len, "%ld", (long)unzigzag(getVarint(p, end)));
+                if (k > 0) len += (size_t)k < capacity - len ? (size_t)k : capacity - len - 1;
+            }
+            f++;
+        } else if (f[0] == '%' && f[1] == 's') {
+            while (isText && p < end && len + 1 < capacity) out[len++] = (char)*p++;
+            f++;
+        } else {
+            out[len++] = *f;
+        }
+    }
+    while (len > 0 && out[len - 1] == ' ') len--;
+    out[len] = '\0';
+    return len;
+}
+
+void EventLog::clear() {
+    if (_flashLock) xSemaphoreTake(_flashLock, portMAX_DELAY);
+    portENTER_CRITICAL(&s_mux);
+    uint32_t next = s_ring.nextSeq;
+    ringReset(next);
+    portEXIT_CRITICAL(&s_mux);
+
+    if (_flashReady) {
+        _prefs.clear();
+        memset(&_meta, 0, sizeof(_meta));
+        _meta.magic = EVENT_LOG_META_MAGIC;
+        _meta.next = next;
+        _page.firstSeq = next;
+        _page.count = _page.bytes = 0;
+        _prefs.putBytes("meta", &_meta, sizeof(_meta));
+    }
+    if (_flashLock) xSemaphoreGive(_flashLock);
+    log(EVENT_INFO, EVT_LOG_CLEARED);
+}
+
+uint32_t EventLog::flashOldest() const {
+    if (_meta.pages == 0) return _meta.next;
+    return _meta.first[(_meta.head + EVENT_LOG_FLASH_PAGES - _meta.pages + 1) % EVENT_LOG_FLASH_PAGES];
+}
+
+uint32_t EventLog::flashNext() const {
+    return _meta.next;
+}
+
+uint32_t EventLog::oldestSeq() {
+    uint32_t oldest = s_ring.firstSeq;
+    if (_flashReady) {
+        xSemaphoreTake(_flashLock, portMAX_DELAY);
+        if (_meta.pages > 0 && flashOldest() < oldest) oldest = flashOldest();
+        xSemaphoreGive(_flashLock);
+    }
+    return oldest;
+}
+
+uint32_t EventLog::nextSeq() const {
+    return s_ring.nextSeq;
+}
+
+// --- Flash (NVS-Partition "nvs2") ---
+
+bool EventLog::loadFlash() {
+    esp_err_t err = nvs_flash_init_partition(EVENT_LOG_PARTITION);
+    if (err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        // Partition war nie formatiert (oder von einer anderen NVS-Version)
+        nvs_flash_erase_partition(EVENT_LOG_PARTITION);
+        err = nvs_flash_init_partition(EVENT_LOG_PARTITION);
+    }
+    if (err != ESP_OK || !_prefs.begin(EVENT_LOG_NAMESPACE, false, EVENT_LOG_PARTITION)) return false;
+
+    if (_prefs.getBytes("meta", &_meta, sizeof(_meta)) != sizeof(_meta) || _meta.magic != EVENT_LOG_META_MAGIC ||
+        _meta.head >= EVENT_LOG_FLASH_PAGES || _meta.pages > EVENT_LOG_FLASH_PAGES) {
+        memset(&_meta, 0, sizeof(_meta));
+        _meta.magic = EVENT_LOG_META_MAGIC;
+    }
+
+    _page.firstSeq = _meta.next;
+    _page.count = _page.bytes = 0;
+    if (_meta.pages > 0) {
+        char key[5];
+        pageKey(_meta.head, key);
+        size_t size = _prefs.getBytes(key, &_page, sizeof(_page));
+        if (size >= PAGE_HEADER_SIZE && _page.bytes <= EVENT_LOG_PAGE_SIZE && size == PAGE_HEADER_SIZE + _page.bytes) {
+            // Die Seite wird vor dem Index geschrieben und kann daher neuer sein.
+            _meta.first[_meta.head] = _page.firstSeq;
+            _meta.count[_meta.head] = _page.count;
+            _meta.next = _page.firstSeq + _page.count;
+        } else {
+            _page.firstSeq = _meta.next;
+            _page.count = _page.bytes = 0;
+        }
+    }
+    return true;
+}
+
+bool EventLog::storePage() {
+    char key[5];
+    pageKey(_meta.head, key);
+    bool ok = _prefs.putBytes(key, &_page, PAGE_HEADER_SIZE + _page.bytes) > 0 &&
+              _prefs.putBytes("meta", &_meta, sizeof(_meta)) == sizeof(_meta);
+    _spillWrites++;
+    return ok;
+}
+
+/**
+ * @brief Beginnt die nächste Flash-Seite; ist der Ring voll, wird die älteste ersetzt.
+ */
+void EventLog::startPage(uint32_t seq) {
+    if (_page.count > 0 || _meta.pages == 0) {
+        _meta.head = (_meta.head + 1) % EVENT_LOG_FLASH_PAGES;
+        if (_meta.pages < EVENT_LOG_FLASH_PAGES) _meta.pages++;
+    }
+    _page.firstSeq = seq;
+    _page.count = _page.bytes = 0;
+    _meta.first[_meta.head] = seq;
+    _meta.count[_meta.head] = 0;
+}
+
+/**
+ * @brief Kopiert alle noch nicht ausgelagerten Datensätze in die Kopfseite und speichert sie.
+ * Eine Seite enthält nur lückenlose Nummern; nach verdrängten Datensätzen beginnt eine neue.
+ */
+void EventLog::spill() {
+    xSemaphoreTake(_flashLock, portMAX_DELAY);
+    for (;;) {
+        uint8_t* dst = _page.data + _page.bytes;
+        size_t room = EVENT_LOG_PAGE_SIZE - _page.bytes;
+        size_t bytes = 0;
+        uint16_t n = 0;
+
+        portENTER_CRITICAL(&s_mux);
+        if (s_ring.spilledSeq < s_ring.firstSeq) s_ring.spilledSeq = s_ring.firstSeq;
+        uint32_t seq = s_ring.spilledSeq;
+        uint32_t pos = ringOffsetOf(seq);
+        while (seq + n < s_ring.nextSeq) {
+            uint8_t len = ringAt(pos);
+            if (bytes + len > room) break;
+            ringCopyOut(pos, dst + bytes, len);
+            bytes += len;
+            pos = (pos + len) % EVENT_LOG_RTC_SIZE;
+            n++;
+        }
+        bool more = seq + n < s_ring.nextSeq;
+        portEXIT_CRITICAL(&s_mux);
+
+        if (n == 0 && !more) break;
+        bool gap = _page.count > 0 && seq != _page.firstSeq + _page.count;
+        if (gap || n == 0 || _meta.pages == 0) {
+            startPage(seq); // neue Seite, die Daten werden im nächsten Durchlauf kopiert
+            continue;
+        }
+
+        _page.count += n;
+        _page.bytes += bytes;
+        _meta.count[_meta.head] = _page.count;
+        _meta.next = seq + n;
+        if (!storePage()) {
+            Serial.println("EventLog: Schreiben in " EVENT_LOG_PARTITION " fehlgeschlagen.");
+            _page.count -= n;
+            _page.bytes -= bytes;
+            _meta.count[_meta.head] = _page.count;
+            _meta.next = seq;
+            break;
+        }
+
+        portENTER_CRITICAL(&s_mux);
+        if (s_ring.spilledSeq < seq + n) s_ring.spilledSeq = seq + n;
+        portEXIT_CRITICAL(&s_mux);
+        if (!more) break;
+    }
+    xSemaphoreGive(_flashLock);
+}
+
+void EventLog::spillTask(void* arg) {
+    EventLog* self = (EventLog*)arg;
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(EVENT_LOG_SPILL_INTERVAL_MS));
+        self->spill();
+        // Weckrufe in der Pause sammeln sich und lösen danach genau einen Durchlauf aus
+        vTaskDelay(pdMS_TO_TICKS(EVENT_LOG_SPILL_MIN_MS));
+    }
+}
+
+void EventLog::writeStatsJson(JsonWriter& json) {
+    uint32_t rtcFirst, next, spilled, dropped, used;
+    portENTER_CRITICAL(&s_mux);
+    rtcFirst = s_ring.firstSeq;
+    next = s_ring.nextSeq;
+    spilled = s_ring.spilledSeq;
+    dropped = s_ring.dropped;
+    used = s_ring.used;
+    portEXIT_CRITICAL(&s_mux);
+
+    json.beginObject();
+    json.field("oldest", oldestSeq());
+    json.field("next", next);
+    json.field("rtc_first", rtcFirst);
+    json.field("rtc_used", used);
+    json.field("rtc_size", (uint32_t)EVENT_LOG_RTC_SIZE);
+    json.field("spilled", spilled);
+    json.field("dropped", dropped);
+    json.field("flash", _flashReady);
+    json.field("flash_pages", (uint32_t)_meta.pages);
+    json.field("spill_writes", _spillWrites);
+    json.field("appends", _appendCount);
+    json.field("append_max_us", (float)_appendMaxCycles / ESP.getCpuFreqMHz(), 2);
+    json.endObject();
+}
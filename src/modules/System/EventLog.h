@@ -0,0 +1,172 @@
+//================================================================================
+//| DATEI: EventLog.h                                                            |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Strukturiertes Ereignis-Log. Statt fertiger Textzeilen werden kompakte       |
+//| Binär-Datensätze gespeichert (Zeitstempel, Level, Ereignis-ID, Argumente als |
+//| Varint), meist 5-12 Bytes statt 128.                                         |
+//|                                                                              |
+//| SPEICHER:                                                                    |
+//| 1. Ringpuffer im RTC-Speicher (RTC_NOINIT_ATTR): übersteht Resets, Watchdog  |
+//|    und Panics, aber keinen Stromausfall. Ist er voll, werden die ältesten    |
+//|    Datensätze verdrängt, statt das Loggen einzustellen.                      |
+//| 2. Ein Hintergrund-Task lagert neue Datensätze seitenweise in die bisher     |
+//|    ungenutzte NVS-Partition "nvs2" aus. NVS verteilt die Schreibzugriffe     |
+//|    selbst über die Sektoren (Wear-Levelling).                                |
+//|                                                                              |
+//| Jeder Datensatz hat eine fortlaufende Nummer (seq), die über Neustarts       |
+//| weiterläuft. GET /api/logs blättert damit per `cursor`; tools/logdecode.py   |
+//| holt die Rohdaten (format=bin) und dekodiert sie auf dem PC.                 |
+//|                                                                              |
+//| DATENSATZ: [len][level:2|text:1|0|argc:4][id varint][ms varint][args...]     |
+//| Argumente sind Zigzag-Varints; bei Text-Einträgen folgen UTF-8-Bytes.        |
+//================================================================================
+
+#pragma once
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <initializer_list>
+
+class JsonWriter;
+
+#define EVENT_LOG_RTC_SIZE           2048  // Bytes im RTC-Ringpuffer
+#define EVENT_LOG_MAX_RECORD         64    // längster Datensatz
+#define EVENT_LOG_MAX_ARGS           4
+#define EVENT_LOG_FLASH_PAGES        48    // Seiten im NVS (je ein Blob)
+#define EVENT_LOG_PAGE_SIZE          1024
+#define EVENT_LOG_SPILL_INTERVAL_MS  10000 // spätestens so oft wird ausgelagert
+#define EVENT_LOG_SPILL_THRESHOLD    64    // oder sobald so viele Datensätze offen sind
+#define EVENT_LOG_SPILL_MIN_MS       2000  // aber nie öfter (Ereignis-Sturm)
+#define EVENT_LOG_PARTITION          "nvs2"
+#define EVENT_LOG_TASK_STACK         4096
+#define EVENT_LOG_TASK_PRIORITY      1
+
+// Ereignis-Tabelle: ID, Name, Text (%d = nächstes Argument, %s = Text).
+// tools/logdecode.py liest diese Tabelle direkt aus dieser Datei. Neue
+// Ereignisse nur hinten anfügen, damit alte Logs lesbar bleiben.
+#define EVENT_LOG_EVENTS(X) \
+    X(EVT_TEXT,            "text",            "%s") \
+    X(EVT_BOOT,            "boot",            "Neustart, Grund %d") \
+    X(EVT_LOG_CLEARED,     "log_cleared",     "Log gelöscht") \
+    X(EVT_EMERGENCY_STOP,  "emergency_stop",  "Not-Aus, Winkelfehler %d/10 Grad") \
+    X(EVT_BALANCE_RESUMED, "balance_resumed", "Balance wieder aufgenommen") \
+    X(EVT_MOTORS,          "motors",          "Motoren %d (1 = an)") \
+    X(EVT_WIFI_CONNECTED,  "wifi_connected",  "WLAN verbunden nach %d ms (gezielt: %d)") \
+    X(EVT_WIFI_LOST,       "wifi_lost",       "WLAN getrennt, Grund %d") \
+    X(EVT_WIFI_AP,         "wifi_ap",         "Access Point %d (1 = an)")
+
+enum EventId : uint16_t {
+#define EVENT_LOG_ENUM(id, name, text) id,
+    EVENT_LOG_EVENTS(EVENT_LOG_ENUM)
+#undef EVENT_LOG_ENUM
+    EVT_COUNT
+};
+
+enum EventLevel : uint8_t {
+    EVENT_DEBUG = 0,
+    EVENT_INFO = 1,
+    EVENT_WARN = 2,
+    EVENT_ERROR = 3
+};
+
+/**
+ * @class EventLog
+ * @brief RTC-Ringpuffer mit Auslagerung in den Flash.
+ *
+ * log() und text() dürfen aus jedem Task aufgerufen werden (auch aus der
+ * Regelschleife): Kodieren auf dem Stack, dann ein memcpy in einer kurzen
+ * Critical Section. Der Flash wird nur vom Auslagerungs-Task beschrieben.
+ */
+class EventLog {
+public:
+    EventLog();
+
+    /**
+     * @brief Prüft den RTC-Puffer, lädt den Flash-Index und startet den Auslagerungs-Task.
+     * Trägt den Neustart-Grund als erstes Ereignis ein.
+     */
+    void begin();
+
+    /**
+     * @brief Hängt ein Ereignis mit bis zu EVENT_LOG_MAX_ARGS Ganzzahl-Argumenten an.
+     */
+    void log(EventLevel level, EventId id, std::initializer_list<int32_t> args = {});
+
+    /**
+     * @brief Hängt eine freie Textzeile an (wird gekürzt, wenn sie nicht passt).
+     */
+    void text(EventLevel level, const char* text);
+
+    /**
+     * @brief Kopiert ganze Datensätze ab `cursor` (RTC oder Flash).
+     * Liegt `cursor` vor dem ältesten vorhandenen Datensatz, wird dort begonnen.
+     * @param firstSeq Nummer des ersten kopierten Datensatzes.
+     * @return Anzahl Bytes; `cursor` zeigt danach auf den nächsten Datensatz.
+     */
+    size_t read(uint32_t& cursor, uint8_t* out, size_t capacity, uint16_t maxRecords, uint32_t& firstSeq);
+
+    /**
+     * @brief Formatiert einen Datensatz als Textzeile ("seq zeit level name: text").
+     */
+    static size_t format(uint32_t seq, const uint8_t* record, char* out, size_t capacity);
+
+    /**
+     * @brief Löscht RTC-Puffer und Flash. Die Nummerierung läuft weiter.
+     */
+    void clear();
+
+    uint32_t oldestSeq();
+    uint32_t nextSeq() const;
+
+    /**
+     * @brief Füllstand, ausgelagerte Seiten, verlorene Datensätze und Kosten von log().
+     */
+    void writeStatsJson(JsonWriter& json);
+
+private:
+    // Eine Flash-Seite (als NVS-Blob "pNN" gespeichert)
+    struct Page {
+        uint32_t firstSeq;
+        uint16_t count;
+        uint16_t bytes;
+        uint8_t data[EVENT_LOG_PAGE_SIZE];
+    };
+
+    // Index aller Seiten (NVS-Blob "meta")
+    struct Meta {
+        uint32_t magic;
+        uint32_t next;                              // Nummer nach dem letzten ausgelagerten Datensatz
+        uint8_t head;                               // Seite, in die gerade geschrieben wird
+        uint8_t pages;                              // belegte Seiten
+        uint32_t first[EVENT_LOG_FLASH_PAGES];
+        uint16_t count[EVENT_LOG_FLASH_PAGES];
+    };
+
+    Preferences _prefs;
+    bool _flashReady;
+    SemaphoreHandle_t _flashLock;   // _meta, _page und _prefs
+    Meta _meta;
+    Page _page;                     // aktuelle Kopfseite im RAM
+    TaskHandle_t _task;
+
+    uint32_t _spillWrites;
+    uint32_t _appendCount;
+    uint32_t _appendMaxCycles;
+
+    void append(const uint8_t* record, size_t len);
+    bool loadFlash();
+    bool storePage();
+    void startPage(uint32_t seq);
+    void spill();
+    size_t readFlash(uint32_t& cursor, uint8_t* out, size_t capacity, uint16_t maxRecords, uint32_t& firstSeq);
+    uint32_t flashOldest() const;
+    uint32_t flashNext() const;
+
+    static void spillTask(void* arg);
+};
+
+// Eine Instanz für alle Module (wie Serial oder Update).
+extern EventLog eventLog;
@@ -0,0 +1,424 @@
+//================================================================================
+//| DATEI: HeapTrace.cpp                                                         |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Implementiert die Heap-Buchhaltung und die malloc-Wrapper. Alles hier kann   |
+//| aus jedem Task und schon vor den globalen Konstruktoren aufgerufen werden:   |
+//| Der Zustand ist statisch (null-initialisiert), die Zähler sind atomar, und   |
+//| die Leck-Tabelle liegt außerhalb der umgeleiteten Funktionen                 |
+//| (heap_caps_malloc) hinter einem Spinlock.                                    |
+//================================================================================
+
+#include "HeapTrace.h"
+#include "../Server/ValueWriter.h"
+#include <esp_heap_caps.h>
+#include <esp_http_server.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+static HeapCounters s_subsystems[HEAP_SUBSYSTEM_COUNT] = {
+#define HEAP_SUBSYSTEM_DEF(id, name) { name },
+    HEAP_SUBSYSTEMS(HEAP_SUBSYSTEM_DEF)
+#undef HEAP_SUBSYSTEM_DEF
+};
+
+static std::atomic<HeapCounters*> s_routes(nullptr);
+
+// Gesamtzähler über alle Scopes
+static std::atomic<uint32_t> s_allocs(0);
+static std::atomic<uint32_t> s_frees(0);
+static std::atomic<uint32_t> s_allocBytes(0);
+static std::atomic<uint32_t> s_freeBytes(0);
+
+// Aktiver Scope je Task. Ein Slot gehört nach dem ersten enter() fest zu seinem Task.
+struct ScopeSlot {
+    std::atomic<TaskHandle_t> task;
+    HeapCounters* current;
+};
+static ScopeSlot s_scopes[HEAP_TRACE_SCOPE_TASKS];
+static std::atomic<uint32_t> s_scopeOverflow(0);
+static portMUX_TYPE s_scopeMux = portMUX_INITIALIZER_UNLOCKED;
+
+// Leck-Suche: offene Adressierung mit linearer Sondierung über den Zeiger.
+struct LeakEntry {
+    void* ptr;                  // nullptr = frei
+    uint32_t size;
+    HeapCounters* scope;
+};
+static LeakEntry* s_leaks = nullptr;
+static volatile bool s_leakArmed = false;
+static uint32_t s_leakCount = 0;
+static uint32_t s_leakDropped = 0;
+static uint32_t s_leakStartMs = 0;
+static portMUX_TYPE s_leakMux = portMUX_INITIALIZER_UNLOCKED;
+
+static inline uint32_t leakHash(const void* ptr) {
+    return (((uint32_t)(uintptr_t)ptr >> 3) * 2654435761u) & (HEAP_TRACE_LEAK_SLOTS - 1);
+}
+
+// Nur mit s_leakMux aufrufen.
+static void leakInsert(void* ptr, uint32_t size, HeapCounters* scope) {
+    if (s_leakCount >= HEAP_TRACE_LEAK_SLOTS * 3 / 4) {
+        s_leakDropped++;
+        return;
+    }
+    uint32_t i = leakHash(ptr);
+    while (s_leaks[i].ptr && s_leaks[i].ptr != ptr) i = (i + 1) & (HEAP_TRACE_LEAK_SLOTS - 1);
+    if (!s_leaks[i].ptr) s_leakCount++;
+    s_leaks[i].ptr = ptr;
+    s_leaks[i].size = size;
+    s_leaks[i].scope = scope;
+}
+
+// Nur mit s_leakMux aufrufen. Rückt nachfolgende Einträge auf (keine Grabsteine).
+static void leakRemove(void* ptr) {
+    uint32_t i = leakHash(ptr);
+    while (s_leaks[i].ptr != ptr) {
+        if (!s_leaks[i].ptr) return;    // vor dem Start allokiert
+        i = (i + 1) & (HEAP_TRACE_LEAK_SLOTS - 1);
+    }
+    s_leakCount--;
+    uint32_t hole = i;
+    for (;;) {
+        i = (i + 1) & (HEAP_TRACE_LEAK_SLOTS - 1);
+        if (!s_leaks[i].ptr) break;
+        uint32_t home = leakHash(s_leaks[i].ptr);
+        // Eintrag darf in das Loch, wenn sein Platz nicht zwischen Loch und i liegt
+        bool between = hole <= i ? (home > hole && home <= i) : (home > hole || home <= i);
+        if (!between) {
+            s_leaks[hole] = s_leaks[i];
+            hole = i;
+        }
+    }
+    s_leaks[hole].ptr = nullptr;
+}
+
+static ScopeSlot* findSlot(TaskHandle_t task) {
+    for (uint8_t i = 0; i < HEAP_TRACE_SCOPE_TASKS; i++) {
+        if (s_scopes[i].task.load(std::memory_order_acquire) == task) return &s_scopes[i];
+    }
+    return nullptr;
+}
+
+static HeapCounters* currentScope() {
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    ScopeSlot* slot = task ? findSlot(task) : nullptr;
+    HeapCounters* scope = slot ? slot->current : nullptr;
+    return scope ? scope : &s_subsystems[HEAP_OTHER];
+}
+
+// --- Scopes ---
+
+HeapCounters& HeapTrace::subsystem(HeapSubsystem id) {
+    return s_subsystems[id < HEAP_SUBSYSTEM_COUNT ? id : HEAP_OTHER];
+}
+
+void HeapTrace::addRoute(HeapCounters& counters) {
+    HeapCounters* head = s_routes.load();
+    do {
+        counters.next = head;
+    } while (!s_routes.compare_exchange_weak(head, &counters));
+}
+
+HeapCounters* HeapTrace::enter(HeapCounters* counters) {
+#if HEAP_TRACE_ENABLED
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    if (!task) return nullptr;
+    ScopeSlot* slot = findSlot(task);
+    if (!slot) {
+        portENTER_CRITICAL(&s_scopeMux);
+        slot = findSlot(nullptr);
+        if (slot) {
+            slot->current = nullptr;
+            slot->task.store(task, std::memory_order_release);
+        }
+        portEXIT_CRITICAL(&s_scopeMux);
+        if (!slot) {
+            s_scopeOverflow.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+    }
+    HeapCounters* previous = slot->current;
+    slot->current = counters;
+    return previous;
+#else
+    return nullptr;
+#endif
+}
+
+void HeapTrace::leave(HeapCounters* previous) {
+#if HEAP_TRACE_ENABLED
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    ScopeSlot* slot = task ? findSlot(task) : nullptr;
+    if (slot) slot->current = previous;
+#endif
+}
+
+// --- Buchhaltung ---
+
+void HeapTrace::onAlloc(void* ptr, size_t size) {
+    HeapCounters* scope = currentScope();
+    s_allocs.fetch_add(1, std::memory_order_relaxed);
+    s_allocBytes.fetch_add((uint32_t)size, std::memory_order_relaxed);
+    scope->allocs.fetch_add(1, std::memory_order_relaxed);
+    scope->allocBytes.fetch_add((uint32_t)size, std::memory_order_relaxed);
+
+    if (s_leakArmed) {
+        portENTER_CRITICAL(&s_leakMux);
+        if (s_leaks) leakInsert(ptr, (uint32_t)size, scope);
+        portEXIT_CRITICAL(&s_leakMux);
+    }
+}
+
+void HeapTrace::onFree(void* ptr, size_t size) {
+    HeapCounters* scope = currentScope();
+    s_frees.fetch_add(1, std::memory_order_relaxed);
+    s_freeBytes.fetch_add((uint32_t)size, std::memory_order_relaxed);
+    scope->frees.fetch_add(1, std::memory_order_relaxed);
+    scope->freeBytes.fetch_add((uint32_t)size, std::memory_order_relaxed);
+
+    if (s_leakArmed) {
+        portENTER_CRITICAL(&s_leakMux);
+        if (s_leaks) leakRemove(ptr);
+        portEXIT_CRITICAL(&s_leakMux);
+    }
+}
+
+// --- Leck-Suche ---
+
+bool HeapTrace::startLeakCheck() {
+#if HEAP_TRACE_ENABLED
+    // Nicht über malloc, sonst würde die Tabelle sich selbst verbuchen
+    LeakEntry* table = nullptr;
+    portENTER_CRITICAL(&s_leakMux);
+    table = s_leaks;
+    s_leaks = nullptr;
+    s_leakArmed = false;
+    portEXIT_CRITICAL(&s_leakMux);
+    if (!table) table = (LeakEntry*)heap_caps_malloc(sizeof(LeakEntry) * HEAP_TRACE_LEAK_SLOTS, MALLOC_CAP_8BIT);
+    if (!table) return false;
+    memset(table, 0, sizeof(LeakEntry) * HEAP_TRACE_LEAK_SLOTS);
+
+    portENTER_CRITICAL(&s_leakMux);
+    s_leaks = table;
+    s_leakCount = 0;
+    s_leakDropped = 0;
+    s_leakStartMs = millis();
+    s_leakArmed = true;
+    portEXIT_CRITICAL(&s_leakMux);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void HeapTrace::stopLeakCheck() {
+    portENTER_CRITICAL(&s_leakMux);
+    LeakEntry* table = s_leaks;
+    s_leaks = nullptr;
+    s_leakArmed = false;
+    portEXIT_CRITICAL(&s_leakMux);
+    if (table) heap_caps_free(table);
+}
+
+// --- Ausgabe ---
+
+static void writeScopeName(ValueWriter& out, const HeapCounters& c) {
+    out.field("name", c.name ? c.name : "?");
+    if (c.method >= 0) out.field("method", http_method_str((enum http_method)c.method));
+}
+
+static void writeScope(ValueWriter& out, const HeapCounters& c) {
+    uint32_t allocs = c.allocs.load(std::memory_order_relaxed);
+    uint32_t frees = c.frees.load(std::memory_order_relaxed);
+    if (allocs == 0 && frees == 0) return;     // ungenutzte Routen weglassen
+    uint32_t allocBytes = c.allocBytes.load(std::memory_order_relaxed);
+    uint32_t freeBytes = c.freeBytes.load(std::memory_order_relaxed);
+    out.beginObject();
+    writeScopeName(out, c);
+    out.field("allocs", (unsigned long)allocs);
+    out.field("frees", (unsigned long)frees);
+    out.field("alloc_bytes", (unsigned long)allocBytes);
+    out.field("free_bytes", (unsigned long)freeBytes);
+    out.endObject();
+}
+
+void HeapTrace::writeReport(ValueWriter& out) {
+    multi_heap_info_t info;
+    heap_caps_get_info(&info, MALLOC_CAP_8BIT);
+    uint32_t allocBytes = s_allocBytes.load(std::memory_order_relaxed);
+    uint32_t freeBytes = s_freeBytes.load(std::memory_order_relaxed);
+
+    out.beginObject();
+    out.field("tracking", (bool)HEAP_TRACE_ENABLED);
+
+    out.key("heap");
+    out.beginObject(6);
+    out.field("free", (unsigned long)info.total_free_bytes);
+    out.field("largest_block", (unsigned long)info.largest_free_block);
+    out.field("min_free", (unsigned long)info.minimum_free_bytes);
+    out.field("alloc_blocks", (unsigned long)info.allocated_blocks);
+    out.field("free_blocks", (unsigned long)info.free_blocks);
+    // 0 = der ganze freie Speicher ist ein Block, gegen 1 = in viele kleine Stücke zerfallen
+    float fragmentation = info.total_free_bytes
+        ? 1.0f - (float)info.largest_free_block / (float)info.total_free_bytes : 0.0f;
+    out.field("fragmentation", fragmentation, 3);
+    out.endObject();
+
+    out.field("allocs", (unsigned long)s_allocs.load(std::memory_order_relaxed));
+    out.field("frees", (unsigned long)s_frees.load(std::memory_order_relaxed));
+    out.field("alloc_bytes", (unsigned long)allocBytes);
+    out.field("free_bytes", (unsigned long)freeBytes);
+    // Kann negativ sein: Freigaben von Blöcken, die am Wrapper vorbei allokiert wurden
+    out.field("net_bytes", (long)(int32_t)(allocBytes - freeBytes));
+    out.field("scope_overflow", (unsigned long)s_scopeOverflow.load(std::memory_order_relaxed));
+    out.field("leak_check", (bool)s_leakArmed);
+
+    out.key("scopes");
+    out.beginArray();
+    for (uint8_t i = 0; i < HEAP_SUBSYSTEM_COUNT; i++) writeScope(out, s_subsystems[i]);
+    for (HeapCounters* c = s_routes.load(); c; c = c->next) writeScope(out, *c);
+    out.endArray();
+    out.endObject();
+}
+
+void HeapTrace::writeLeakReport(ValueWriter& out) {
+    struct Group {
+        const HeapCounters* scope;
+        uint32_t count;
+        uint32_t bytes;
+    };
+    Group groups[HEAP_TRACE_LEAK_GROUPS];
+    uint8_t groupCount = 0;
+    uint32_t otherCount = 0, otherBytes = 0;
+    LeakEntry top[HEAP_TRACE_LEAK_TOP];
+    uint8_t topCount = 0;
+    uint32_t live = 0, liveBytes = 0;
+
+    // In kleinen Stücken kopieren, damit der Spinlock nur kurz gehalten wird
+    const uint32_t chunk = 32;
+    LeakEntry entries[chunk];
+    bool armed = false;
+    uint32_t dropped = 0, startMs = 0;
+    for (uint32_t base = 0; base < HEAP_TRACE_LEAK_SLOTS; base += chunk) {
+        portENTER_CRITICAL(&s_leakMux);
+        armed = s_leaks != nullptr;
+        if (armed) memcpy(entries, s_leaks + base, sizeof(entries));
+        dropped = s_leakDropped;
+        startMs = s_leakStartMs;
+        portEXIT_CRITICAL(&s_leakMux);
+        if (!armed) break;
+
+        for (uint32_t i = 0; i < chunk; i++) {
+            const LeakEntry& e = entries[i];
+            if (!e.ptr) continue;
+            live++;
+            liveBytes += e.size;
+
+            uint8_t g = 0;
+            while (g < groupCount && groups[g].scope != e.scope) g++;
+            if (g == groupCount && groupCount < HEAP_TRACE_LEAK_GROUPS) groups[groupCount++] = { e.scope, 0, 0 };
+            if (g < groupCount) {
+                groups[g].count++;
+                groups[g].bytes += e.size;
+            } else {
+                otherCount++;
+                otherBytes += e.size;
+            }
+
+            // Die größten Blöcke absteigend sortiert halten
+            uint8_t pos = topCount;
+            while (pos > 0 && top[pos - 1].size < e.size) pos--;
+            if (pos < HEAP_TRACE_LEAK_TOP) {
+                uint8_t last = topCount < HEAP_TRACE_LEAK_TOP ? topCount : HEAP_TRACE_LEAK_TOP - 1;
+                for (uint8_t k = last; k > pos; k--) top[k] = top[k - 1];
+                top[pos] = e;
+                if (topCount < HEAP_TRACE_LEAK_TOP) topCount++;
+            }
+        }
+    }
+
+    out.beginObject();
+    out.field("tracking", (bool)HEAP_TRACE_ENABLED);
+    out.field("armed", armed);
+    if (armed) {
+        out.field("since_ms", (unsigned long)(millis() - startMs));
+        out.field("live", (unsigned long)live);
+        out.field("live_bytes", (unsigned long)liveBytes);
+        out.field("dropped", (unsigned long)dropped);   // Tabelle war voll
+
+        out.key("scopes");
+        out.beginArray();
+        for (uint8_t g = 0; g < groupCount; g++) {
+            out.beginObject();
+            writeScopeName(out, *groups[g].scope);
+            out.field("count", (unsigned long)groups[g].count);
+            out.field("bytes", (unsigned long)groups[g].bytes);
+            out.endObject();
+        }
+        if (otherCount) {
+            out.beginObject(3);
+            out.field("name", "...");
+            out.field("count", (unsigned long)otherCount);
+            out.field("bytes", (unsigned long)otherBytes);
+            out.endObject();
+        }
+        out.endArray();
+
+        out.key("largest");
+        out.beginArray(topCount);
+        char addr[12];
+        for (uint8_t i = 0; i < topCount; i++) {
+            snprintf(addr, sizeof(addr), "0x%08x", (unsigned)(uintptr_t)top[i].ptr);
+            out.beginObject();
+            out.field("ptr", (const char*)addr);
+            out.field("size", (unsigned long)top[i].size);
+            writeScopeName(out, *top[i].scope);
+            out.endObject();
+        }
+        out.endArray();
+    }
+    out.endObject();
+}
+
+// --- malloc-Wrapper (nur im Diagnose-Build, -Wl,--wrap=...) ---
+
+#if HEAP_TRACE_ENABLED
+extern "C" {
+void* __real_malloc(size_t size);
+void __real_free(void* ptr);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+
+void* __wrap_malloc(size_t size) {
+    void* ptr = __real_malloc(size);
+    if (ptr) HeapTrace::onAlloc(ptr, heap_caps_get_allocated_size(ptr));
+    return ptr;
+}
+
+void __wrap_free(void* ptr) {
+    if (ptr) HeapTrace::onFree(ptr, heap_caps_get_allocated_size(ptr));
+    __real_free(ptr);
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+    void* ptr = __real_calloc(count, size);
+    if (ptr) HeapTrace::onAlloc(ptr, heap_caps_get_allocated_size(ptr));
+    return ptr;
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+    if (!ptr) return __wrap_malloc(size);
+    // Alten Block vorher austragen: Nach dem realloc könnte ein anderer Task
+    // dieselbe Adresse schon neu bekommen haben.
+    size_t oldSize = heap_caps_get_allocated_size(ptr);
+    HeapTrace::onFree(ptr, oldSize);
+    void* result = __real_realloc(ptr, size);
+    if (result) HeapTrace::onAlloc(result, heap_caps_get_allocated_size(result));
+    else if (size) HeapTrace::onAlloc(ptr, oldSize);  // fehlgeschlagen, alter Block lebt weiter
+    return result;
+}
+}
+#endif
@@ -0,0 +1,135 @@
+//================================================================================
+//| DATEI: HeapTrace.h                                                           |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Heap-Buchhaltung je Route und Subsystem. Im Diagnose-Build                   |
+//| (env:esp32dev-heaptrace, -DHEAP_TRACKING) leitet der Linker malloc, free,    |
+//| calloc und realloc über --wrap hierher um. Jede Allokation wird dem gerade   |
+//| aktiven HeapScope des Tasks zugerechnet (z.B. der Route im Dispatcher oder   |
+//| "time" in der Hauptschleife), Freigaben dem Scope, in dem sie passieren.     |
+//|                                                                              |
+//| LECK-SUCHE: POST /api/system/heap/leakcheck merkt sich ab dann jede neue     |
+//| Allokation, bis sie freigegeben wird. GET auf dieselbe Route zeigt, was seit |
+//| dem Start noch lebt (je Scope und die größten Blöcke).                       |
+//|                                                                              |
+//| Größter freier Block und Fragmentierung gibt es auch im normalen Build.      |
+//| Nicht erfasst werden Allokationen, die direkt heap_caps_malloc() nutzen      |
+//| (WLAN-Treiber, Teile der newlib).                                            |
+//================================================================================
+
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+
+class ValueWriter;
+
+#define HEAP_TRACE_SCOPE_TASKS   8      // Tasks, die gleichzeitig einen Scope setzen können
+#define HEAP_TRACE_LEAK_SLOTS    512    // gemerkte Allokationen (Zweierpotenz)
+#define HEAP_TRACE_LEAK_TOP      8      // größte noch lebende Blöcke in der Antwort
+#define HEAP_TRACE_LEAK_GROUPS   12     // Scopes in der Leck-Auswertung
+
+#ifdef HEAP_TRACKING
+#define HEAP_TRACE_ENABLED       1
+#else
+#define HEAP_TRACE_ENABLED       0
+#endif
+
+// Subsysteme ohne eigene Route: ID, Name.
+#define HEAP_SUBSYSTEMS(X) \
+    X(HEAP_OTHER,     "other") \
+    X(HEAP_SETUP,     "setup") \
+    X(HEAP_BALANCE,   "balance") \
+    X(HEAP_WIFI,      "wifi") \
+    X(HEAP_TIME,      "time") \
+    X(HEAP_EVENTS,    "events")
+
+enum HeapSubsystem : uint8_t {
+#define HEAP_SUBSYSTEM_ENUM(id, name) id,
+    HEAP_SUBSYSTEMS(HEAP_SUBSYSTEM_ENUM)
+#undef HEAP_SUBSYSTEM_ENUM
+    HEAP_SUBSYSTEM_COUNT
+};
+
+/**
+ * @brief Zähler eines Scopes (Route oder Subsystem). Lock-frei wie RouteMetrics.
+ * Der constexpr-Konstruktor hält statische Instanzen frei von Laufzeit-
+ * Initialisierung, denn malloc wird schon vor den globalen Konstruktoren gerufen.
+ */
+struct HeapCounters {
+    const char* name;
+    int method;                             // HTTP-Methode, -1 = Subsystem
+    HeapCounters* next;                     // Liste aller Routen-Zähler
+    std::atomic<uint32_t> allocs;
+    std::atomic<uint32_t> frees;
+    std::atomic<uint32_t> allocBytes;
+    std::atomic<uint32_t> freeBytes;
+
+    constexpr HeapCounters(const char* name = nullptr, int method = -1)
+        : name(name), method(method), next(nullptr), allocs(0), frees(0), allocBytes(0), freeBytes(0) {}
+};
+
+/**
+ * @class HeapTrace
+ * @brief Statische Heap-Buchhaltung (es gibt nur einen Heap und nur einen Wrapper).
+ */
+class HeapTrace {
+public:
+    /**
+     * @brief Nimmt die Zähler einer Route in die Auswertung auf (von addRoute()).
+     */
+    static void addRoute(HeapCounters& counters);
+
+    static HeapCounters& subsystem(HeapSubsystem id);
+
+    /**
+     * @brief Setzt den Scope des aufrufenden Tasks.
+     * @return Vorheriger Scope für leave().
+     */
+    static HeapCounters* enter(HeapCounters* counters);
+    static void leave(HeapCounters* previous);
+
+    /**
+     * @brief Verbucht eine Allokation bzw. Freigabe (aus den malloc-Wrappern).
+     */
+    static void onAlloc(void* ptr, size_t size);
+    static void onFree(void* ptr, size_t size);
+
+    /**
+     * @brief Startet die Leck-Suche neu (vergisst alle bisher gemerkten Blöcke).
+     * @return false, wenn der Diagnose-Build fehlt oder kein Speicher für die Tabelle da ist.
+     */
+    static bool startLeakCheck();
+    static void stopLeakCheck();
+
+    /**
+     * @brief Heap-Zustand (frei, größter Block, Fragmentierung) und Zähler je Scope.
+     */
+    static void writeReport(ValueWriter& out);
+
+    /**
+     * @brief Allokationen seit startLeakCheck(), die noch nicht freigegeben wurden.
+     */
+    static void writeLeakReport(ValueWriter& out);
+};
+
+/**
+ * @class HeapScope
+ * @brief Rechnet alle Allokationen des Tasks bis zum Ende des Blocks einem Scope zu.
+ *
+ *   { HeapScope scope(HEAP_TIME); timeService.loop(); }
+ */
+class HeapScope {
+public:
+    explicit HeapScope(HeapCounters& counters) : _previous(HeapTrace::enter(&counters)) {}
+    explicit HeapScope(HeapSubsystem id) : _previous(HeapTrace::enter(&HeapTrace::subsystem(id))) {}
+    ~HeapScope() { HeapTrace::leave(_previous); }
+
+private:
+    HeapCounters* _previous;
+
+    HeapScope(const HeapScope&);
+    HeapScope& operator=(const HeapScope&);
+};
@@ -0,0 +1,209 @@
+//================================================================================
+//| DATEI: SamplingProfiler.cpp                                                  |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Implementiert den Sampling-Profiler. Der Tick-Interrupt sichert beim         |
+//| Eintritt den Kontext des unterbrochenen Tasks auf dessen Stack und legt      |
+//| einen Zeiger darauf in pxTopOfStack (erstes Feld des TCB) ab. Daraus kommen  |
+//| PC, Stackpointer und Rücksprungadresse; weiter geht es mit derselben         |
+//| Stack-Verfolgung, die auch der Panic-Handler nutzt. Alles, was onTick()      |
+//| aufruft, liegt im IRAM oder ROM.                                             |
+//================================================================================
+
+#include "SamplingProfiler.h"
+#include "../Server/ValueWriter.h"
+#include "../Server/ResponseWriter.h"
+#include <esp_heap_caps.h>
+#include <esp_freertos_hooks.h>
+#include <esp_debug_helpers.h>
+#include <esp_cpu.h>
+#include <esp_ota_ops.h>
+#include <hal/cpu_hal.h>
+#include <freertos/xtensa_context.h>
+
+SamplingProfiler samplingProfiler;
+
+static void IRAM_ATTR tickHookCore0() { samplingProfiler.onTick(0); }
+static void IRAM_ATTR tickHookCore1() { samplingProfiler.onTick(1); }
+
+SamplingProfiler::SamplingProfiler()
+    : _running(false), _buf(nullptr), _cap(0), _used(0), _divider(SAMPLING_PROFILER_DEFAULT_DIVIDER),
+      _depth(SAMPLING_PROFILER_DEFAULT_DEPTH), _samples(0), _dropped(0), _cycles(0), _firstTick(0), _lastTick(0),
+      _taskCount(0) {
+    _lock = portMUX_INITIALIZER_UNLOCKED;
+    for (uint8_t c = 0; c < SAMPLING_PROFILER_CORES; c++) {
+        _countdown[c] = 0;
+        _coreSamples[c] = 0;
+    }
+}
+
+bool SamplingProfiler::start(uint32_t bytes, uint16_t divider, uint8_t depth) {
+    if (_running) return false;
+    clear();
+    _buf = (uint8_t*)heap_caps_malloc(bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!_buf) return false;
+
+    portENTER_CRITICAL(&_lock);
+    _cap = bytes;
+    _used = 0;
+    _divider = divider;
+    _depth = depth;
+    _samples = 0;
+    _dropped = 0;
+    _cycles = 0;
+    _taskCount = 0;
+    for (uint8_t c = 0; c < SAMPLING_PROFILER_CORES; c++) {
+        _countdown[c] = divider;
+        _coreSamples[c] = 0;
+    }
+    _running = true;
+    portEXIT_CRITICAL(&_lock);
+
+    esp_register_freertos_tick_hook_for_cpu(tickHookCore0, 0);
+    esp_register_freertos_tick_hook_for_cpu(tickHookCore1, 1);
+    return true;
+}
+
+void SamplingProfiler::stop() {
+    if (!_running) return;
+    esp_deregister_freertos_tick_hook_for_cpu(tickHookCore0, 0);
+    esp_deregister_freertos_tick_hook_for_cpu(tickHookCore1, 1);
+    // Ein Hook, der auf dem anderen Kern gerade schreibt, hält den Lock bis zum Ende.
+    portENTER_CRITICAL(&_lock);
+    _running = false;
+    portEXIT_CRITICAL(&_lock);
+}
+
+void SamplingProfiler::clear() {
+    stop();
+    portENTER_CRITICAL(&_lock);
+    uint8_t* buf = _buf;
+    _buf = nullptr;
+    _cap = 0;
+    _used = 0;
+    _samples = 0;
+    _dropped = 0;
+    _taskCount = 0;
+    portEXIT_CRITICAL(&_lock);
+    if (buf) heap_caps_free(buf);
+}
+
+// Nur mit _lock aufrufen. Ein wiederverwendetes Handle (Task gelöscht, neuer Task
+// an derselben Adresse) wird am Namen erkannt.
+uint8_t IRAM_ATTR SamplingProfiler::taskIndex(TaskHandle_t handle) {
+    const char* name = pcTaskGetTaskName(handle);
+    for (uint8_t i = 0; i < _taskCount; i++) {
+        if (_tasks[i].handle == handle && strncmp(_tasks[i].name, name, sizeof(_tasks[i].name)) == 0) return i;
+    }
+    if (_taskCount >= SAMPLING_PROFILER_MAX_TASKS) return SAMPLING_PROFILER_NO_TASK;
+    TaskEntry& entry = _tasks[_taskCount];
+    entry.handle = handle;
+    strncpy(entry.name, name, sizeof(entry.name));   // ohne Null, falls genau 16 Zeichen
+    return _taskCount++;
+}
+
+void IRAM_ATTR SamplingProfiler::onTick(uint8_t core) {
+    if (--_countdown[core] > 0) return;
+    _countdown[core] = _divider;
+    uint32_t started = cpu_hal_get_cycle_count();
+
+    // Der Tick unterbricht nie eine andere Interrupt-Routine (niedrigste Stufe),
+    // pxTopOfStack zeigt also immer auf den Rahmen des unterbrochenen Tasks.
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    const XtExcFrame* frame = *(XtExcFrame* const*)task;
+
+    uint32_t pcs[SAMPLING_PROFILER_MAX_DEPTH];
+    uint8_t depth = 0;
+    esp_backtrace_frame_t bt;
+    memset(&bt, 0, sizeof(bt));
+    bt.pc = frame->pc;
+    bt.sp = frame->a1;
+    bt.next_pc = frame->a0;
+    // Der unterbrochene PC ist exakt. Die Rücksprungadressen der Aufrufer tragen
+    // oben die Fenstergröße und zeigen hinter den call-Befehl; process_stack_pc()
+    // macht daraus die Adresse des call-Befehls selbst.
+    pcs[depth++] = bt.pc;
+    while (depth < _depth && bt.next_pc != 0) {
+        if (!esp_backtrace_get_next_frame(&bt)) break;
+        pcs[depth++] = esp_cpu_process_stack_pc(bt.pc);
+    }
+
+    portENTER_CRITICAL_ISR(&_lock);
+    if (_running) {
+        uint32_t size = 2 + depth * 4;
+        if (_used + size > _cap) {
+            _dropped++;
+        } else {
+            uint8_t* out = _buf + _used;
+            out[0] = (uint8_t)((core << 7) | depth);
+            out[1] = taskIndex(task);
+            memcpy(out + 2, pcs, depth * 4);
+            _used += size;
+            TickType_t now = xTaskGetTickCountFromISR();
+            if (_samples == 0) _firstTick = now;
+            _lastTick = now;
+            _samples++;
+            _coreSamples[core]++;
+        }
+        _cycles += cpu_hal_get_cycle_count() - started;
+    }
+    portEXIT_CRITICAL_ISR(&_lock);
+}
+
+void SamplingProfiler::writeStatus(ValueWriter& out) {
+    portENTER_CRITICAL(&_lock);
+    bool running = _running;
+    uint32_t cap = _cap, used = _used, samples = _samples, dropped = _dropped, cycles = _cycles;
+    uint32_t core0 = _coreSamples[0], core1 = _coreSamples[1];
+    uint32_t durationMs = samples ? (uint32_t)(_lastTick - _firstTick) * portTICK_PERIOD_MS : 0;
+    uint8_t tasks = _taskCount;
+    portEXIT_CRITICAL(&_lock);
+    uint32_t total = samples + dropped;
+
+    out.beginObject();
+    out.field("running", running);
+    out.field("tick_hz", (unsigned long)configTICK_RATE_HZ);
+    out.field("divider", (unsigned long)_divider);
+    out.field("rate_hz", (unsigned long)(configTICK_RATE_HZ / _divider));   // je Kern
+    out.field("depth", (unsigned long)_depth);
+    out.field("buffer_bytes", (unsigned long)cap);
+    out.field("used_bytes", (unsigned long)used);
+    out.field("samples", (unsigned long)samples);
+    out.field("samples_core0", (unsigned long)core0);
+    out.field("samples_core1", (unsigned long)core1);
+    out.field("dropped", (unsigned long)dropped);
+    out.field("tasks", (unsigned long)tasks);
+    out.field("duration_ms", (unsigned long)durationMs);
+    // Takte je Sample im Interrupt (Stack-Verfolgung plus Eintrag)
+    out.field("cycles_per_sample", (unsigned long)(total ? cycles / total : 0));
+    out.endObject();
+}
+
+void SamplingProfiler::writeProfile(ResponseWriter& out) {
+    stop();
+    // Nach stop() schreibt niemand mehr; der Puffer gehört bis clear()/start() uns.
+    uint8_t header[SAMPLING_PROFILER_HEADER_SIZE];
+    memset(header, 0, sizeof(header));
+    memcpy(header, "PRF1", 4);
+    header[4] = _depth;
+    uint16_t tickHz = configTICK_RATE_HZ;
+    uint16_t taskCount = _taskCount;
+    uint32_t durationMs = _samples ? (uint32_t)(_lastTick - _firstTick) * portTICK_PERIOD_MS : 0;
+    memcpy(header + 6, &tickHz, 2);
+    memcpy(header + 8, &_divider, 2);
+    memcpy(header + 10, &taskCount, 2);
+    memcpy(header + 12, &_samples, 4);
+    memcpy(header + 16, &_dropped, 4);
+    memcpy(header + 20, &durationMs, 4);
+    memcpy(header + 24, &_used, 4);
+    // Damit das Werkzeug eine falsche firmware.elf erkennt
+    char sha[17];
+    esp_ota_get_app_elf_sha256(sha, sizeof(sha));
+    memcpy(header + 28, sha, 16);
+    out.write((const char*)header, sizeof(header));
+
+    for (uint8_t i = 0; i < taskCount; i++) out.write(_tasks[i].name, sizeof(_tasks[i].name));
+    if (_buf) out.write((const char*)_buf, _used);
+}
@@ -0,0 +1,123 @@
+//================================================================================
+//| DATEI: SamplingProfiler.h                                                    |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Statistischer CPU-Profiler. Solange er läuft, hängt ein Tick-Hook an beiden  |
+//| Kernen (FreeRTOS-Tick, 1 kHz, jeder n-te Tick). Im Interrupt wird der        |
+//| unterbrochene Task und sein Aufrufstapel (PC plus Rücksprungadressen) in     |
+//| einen festen Puffer geschrieben. Ist er voll, werden weitere Samples nur     |
+//| noch gezählt.                                                                |
+//|                                                                              |
+//| POST /api/system/profiler (action=start|stop|clear) steuert ihn,             |
+//| GET /api/system/profiler/data liefert das Profil als Binärdatei. Die         |
+//| Adressen löst tools/profile_symbolize.py auf dem PC gegen die firmware.elf   |
+//| auf (flache Liste und "collapsed stacks" für Flame Graphs).                  |
+//|                                                                              |
+//| Einschränkung: Code, der genau im Takt des Ticks läuft (z.B. direkt nach     |
+//| einem vTaskDelay()), wird seltener getroffen, als er Zeit braucht.           |
+//================================================================================
+
+#pragma once
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+class ValueWriter;
+class ResponseWriter;
+
+#define SAMPLING_PROFILER_DEFAULT_KB       32     // Puffer, wird bei start() allokiert
+#define SAMPLING_PROFILER_MAX_KB           96
+#define SAMPLING_PROFILER_DEFAULT_DIVIDER  4      // jeder 4. Tick = 250 Hz je Kern
+#define SAMPLING_PROFILER_MAX_DIVIDER      1000
+#define SAMPLING_PROFILER_DEFAULT_DEPTH    8      // Adressen je Sample
+#define SAMPLING_PROFILER_MAX_DEPTH        16
+#define SAMPLING_PROFILER_MAX_TASKS        32     // weitere Tasks erscheinen als "?"
+#define SAMPLING_PROFILER_CORES            2
+
+// Dateikopf von /api/system/profiler/data (little-endian):
+//   "PRF1", uint8 Tiefe, uint8 reserviert, uint16 Tick-Frequenz, uint16 Teiler,
+//   uint16 Anzahl Tasks, uint32 Samples, uint32 verworfen, uint32 Dauer (ms),
+//   uint32 Datenbytes, char ELF-SHA-256[16] (Hex-Anfang)
+// danach je Task char[16] Name, danach die Samples:
+//   uint8 (Kern << 7 | Anzahl Adressen), uint8 Task-Index (0xFF = unbekannt),
+//   uint32 Adressen[] (unterbrochener PC zuerst, dann die call-Befehle der
+//   Aufrufer; beide direkt für addr2line, ohne weitere Korrektur)
+#define SAMPLING_PROFILER_HEADER_SIZE      44
+#define SAMPLING_PROFILER_NO_TASK          0xFF
+
+/**
+ * @class SamplingProfiler
+ * @brief Sammelt Stichproben des Aufrufstapels aus dem Tick-Interrupt.
+ *
+ * onTick() läuft im Interrupt (IRAM) und nimmt einen Spinlock, weil beide Kerne
+ * in denselben Puffer schreiben. start()/stop()/writeProfile() laufen im Task.
+ */
+class SamplingProfiler {
+public:
+    SamplingProfiler();
+
+    /**
+     * @brief Verwirft ein altes Profil, allokiert den Puffer und hängt die Tick-Hooks ein.
+     * @return false, wenn er schon läuft oder der Speicher fehlt.
+     */
+    bool start(uint32_t bytes, uint16_t divider, uint8_t depth);
+
+    /**
+     * @brief Hängt die Hooks aus. Das Profil bleibt bis clear() oder start() erhalten.
+     */
+    void stop();
+
+    /**
+     * @brief Gibt den Puffer frei.
+     */
+    void clear();
+
+    bool running() const { return _running; }
+
+    /**
+     * @brief Zustand für GET /api/system/profiler (Füllstand, Rate, Kosten je Sample).
+     */
+    void writeStatus(ValueWriter& out);
+
+    /**
+     * @brief Schreibt das Profil im Binärformat (siehe oben). Ein laufender
+     * Profiler wird dafür gestoppt.
+     */
+    void writeProfile(ResponseWriter& out);
+
+    /**
+     * @brief Ein Tick auf `core`. Nur aus den Tick-Hooks aufrufen.
+     */
+    void onTick(uint8_t core);
+
+private:
+    struct TaskEntry {
+        TaskHandle_t handle;
+        char name[16];
+    };
+
+    portMUX_TYPE _lock;
+    volatile bool _running;
+    uint8_t* _buf;
+    uint32_t _cap;
+    uint32_t _used;
+    uint16_t _divider;
+    uint8_t _depth;
+    uint16_t _countdown[SAMPLING_PROFILER_CORES];
+    uint32_t _samples;
+    uint32_t _coreSamples[SAMPLING_PROFILER_CORES];
+    uint32_t _dropped;              // Puffer voll
+    uint32_t _cycles;               // CPU-Takte in onTick(), für die Kosten je Sample
+    TickType_t _firstTick;
+    TickType_t _lastTick;
+    TaskEntry _tasks[SAMPLING_PROFILER_MAX_TASKS];
+    uint8_t _taskCount;
+
+    uint8_t taskIndex(TaskHandle_t handle);
+};
+
+// Eine Instanz für alle Module (wie taskProfiler).
+extern SamplingProfiler samplingProfiler;
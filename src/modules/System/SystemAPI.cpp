@@ -8,6 +8,10 @@
 //| ESP32-spezifische Funktionen aufgerufen, um Informationen über den freien    |
 //| Speicher (Heap), die Systemlaufzeit, den letzten Neustartgrund und weitere   |
 //| relevante Metriken zu ermitteln und diese in einem JSON-Format aufzubereiten.|
+//|                                                                              |
+//| Der Sampler-Task schreibt den Snapshot in den hinteren von zwei Puffern und  |
+//| tauscht dann unter dem Spinlock die Rollen. Leser kopieren den vorderen      |
+//| Puffer unter demselben Lock; ein halb geschriebener Stand ist nie sichtbar.  |
 //================================================================================
 
 #include "SystemAPI.h"
@@ -16,106 +20,291 @@
 #include <WiFi.h>         // Für WiFi.macAddress() etc.
 #include "../../config.h"
 #include "../../services/TimeService.h"
-    
-// Definiert, wie oft der Neustart-Grund im RTC-Speicher gespeichert wird, um eine Historie zu haben.
-// RTC-Speicher überlebt einen Neustart (aber keinen Stromausfall).
-#define MAX_LOG_ENTRIES 5
-// `RTC_NOINIT_ATTR` sorgt dafür, dass die Variable bei einem Neustart nicht auf 0 gesetzt wird.
-RTC_NOINIT_ATTR char log_entries[MAX_LOG_ENTRIES][128];
-RTC_NOINIT_ATTR int log_count = 0;
-
-
-SystemAPI::SystemAPI(WifiManager& wifiManager, TimeService& timeService) : _wifiManager(wifiManager), _timeService(timeService) {
-    // Beim allerersten Start (nach dem Flashen) initialisieren wir den Log-Zähler.
-    if (esp_reset_reason() == ESP_RST_POWERON) {
-        log_count = 0;
+#include "EventLog.h"
+#include "ConfigStore.h"
+#include "../../modules/Server/JsonWriter.h"
+#include "../../modules/Server/ResponseWriter.h"
+
+SystemAPI::SystemAPI(WifiManager& wifiManager, TimeService& timeService)
+    : _wifiManager(wifiManager), _timeService(timeService), _resetReason(0), _heapTotal(0), _front(0), _task(nullptr) {
+    // Der Neustart-Grund wird von eventLog.begin() als erstes Ereignis eingetragen.
+    _lock = portMUX_INITIALIZER_UNLOCKED;
+    _macAddress[0] = '\0';
+    memset(&_sample, 0, sizeof(_sample));
+    memset(&_trend, 0, sizeof(_trend));
+    _snapshotLen[0] = _snapshotLen[1] = 0;
+}
+
+/**
+ * @brief Liest die Werte, die sich bis zum nächsten Neustart nicht ändern, und
+ * startet den Sampler. Die MAC kommt direkt aus dem eFuse, damit sie nicht vom
+ * WLAN-Treiber abhängt.
+ */
+void SystemAPI::begin() {
+    if (_task) return;
+    _resetReason = esp_reset_reason();
+    _heapTotal = ESP.getHeapSize();
+    uint8_t mac[6];
+    esp_read_mac(mac, ESP_MAC_WIFI_STA);
+    snprintf(_macAddress, sizeof(_macAddress), "%02X:%02X:%02X:%02X:%02X:%02X",
+             mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+
+    refreshHealth(); // erster Snapshot, bevor der Webserver Anfragen annimmt
+    xTaskCreate(samplerTask, "health", HEALTH_TASK_STACK, this, HEALTH_TASK_PRIORITY, &_task);
+}
+
+void SystemAPI::samplerTask(void* arg) {
+    SystemAPI* self = (SystemAPI*)arg;
+    for (;;) {
+        vTaskDelay(pdMS_TO_TICKS(configStore.getInt(CFG_HEALTH_MS)));
+        self->refreshHealth();
+    }
+}
+
+/**
+ * @brief Misst, schreibt den Verlauf fort und legt das fertige JSON im hinteren
+ * Puffer ab. Läuft im Sampler-Task (und einmal in begin()).
+ */
+void SystemAPI::refreshHealth() {
+    HealthSample sample;
+    sampleHealth(sample);
+
+    HealthTrend trend;
+    portENTER_CRITICAL(&_lock);
+    _sample = sample;
+    updateTrend(sample, sample.sampledMs);
+    trend = _trend;
+    uint8_t back = _front ^ 1;
+    portEXIT_CRITICAL(&_lock);
+
+    ResponseWriter out(nullptr, 0, nullptr, _snapshot[back], sizeof(_snapshot[back]));
+    JsonWriter json(out);
+    writeHealthDocument(json, sample, trend);
+    if (out.overflowed()) return; // alter Snapshot bleibt gültig
+
+    portENTER_CRITICAL(&_lock);
+    _snapshotLen[back] = out.length();
+    _front = back;
+    portEXIT_CRITICAL(&_lock);
+}
+
+size_t SystemAPI::copyHealthJson(char* out, size_t capacity) {
+    portENTER_CRITICAL(&_lock);
+    size_t len = _snapshotLen[_front];
+    if (len > capacity) len = 0;
+    memcpy(out, _snapshot[_front], len);
+    portEXIT_CRITICAL(&_lock);
+    return len;
+}
+
+void SystemAPI::latestHealth(HealthSample& sample) {
+    portENTER_CRITICAL(&_lock);
+    sample = _sample;
+    portEXIT_CRITICAL(&_lock);
+}
+
+/**
+ * @brief Schreibt den letzten Stand in den Writer (für CBOR/MessagePack; JSON
+ * liefert der Handler direkt aus dem fertigen Snapshot).
+ *
+ * @param out Writer, in den die Felder direkt formatiert werden (kein Dokument im RAM).
+ */
+void SystemAPI::writeSystemHealth(ValueWriter& out) {
+    HealthSample sample;
+    HealthTrend trend;
+    portENTER_CRITICAL(&_lock);
+    sample = _sample;
+    trend = _trend;
+    portEXIT_CRITICAL(&_lock);
+    writeHealthDocument(out, sample, trend);
+}
+
+void SystemAPI::writeHealthDocument(ValueWriter& out, const HealthSample& sample, const HealthTrend& trend) {
+    out.beginObject();
+    writeHealthFields(out, sample);
+    out.field("sampled_ms", (unsigned long)sample.sampledMs);
+    out.key("trend");
+    writeTrend(out, trend);
+    out.endObject();
+}
+
+/**
+ * @brief Schreibt eine Messung in die laufende Periode; ist sie abgelaufen,
+ * wandert sie in den Ring. Nur mit _lock aufrufen.
+ */
+void SystemAPI::updateTrend(const HealthSample& sample, uint32_t nowMs) {
+    HealthTrend& t = _trend;
+    if (t.currentSamples > 0 && nowMs - t.currentStart >= HEALTH_TREND_PERIOD_MS) {
+        HealthTrendPeriod done = t.current;
+        if (done.rssiSamples) done.rssiSum /= done.rssiSamples;
+        t.periods[t.head] = done;
+        t.head = (t.head + 1) % HEALTH_TREND_PERIODS;
+        if (t.count < HEALTH_TREND_PERIODS) t.count++;
+        t.currentSamples = 0;
+    }
+    if (t.currentSamples == 0) {
+        memset(&t.current, 0, sizeof(t.current));
+        t.current.heapMin = sample.heapFree;
+        t.currentStart = nowMs;
+    }
+    t.currentSamples++;
+    if (sample.heapFree < t.current.heapMin) t.current.heapMin = sample.heapFree;
+    if (sample.wifiRssi != 0) {
+        int8_t rssi = (int8_t)sample.wifiRssi;
+        if (t.current.rssiSamples == 0 || rssi < t.current.rssiMin) t.current.rssiMin = rssi;
+        if (t.current.rssiSamples == 0 || rssi > t.current.rssiMax) t.current.rssiMax = rssi;
+        t.current.rssiSum += rssi;
+        t.current.rssiSamples++;
     }
+}
 
-    // Füge den aktuellen Neustart-Grund zu den Logs hinzu, wenn Platz ist.
-    if (log_count < MAX_LOG_ENTRIES) {
-        String reason = "Neustart-Grund: " + getResetReasonText(esp_reset_reason());
-        snprintf(log_entries[log_count], sizeof(log_entries[log_count]), "%s", reason.c_str());
-        log_count++;
+/**
+ * @brief Verlauf als Objekt: Zusammenfassung über die ganze Stunde, die Steigung
+ * des Heap-Tiefststands (Bytes pro Stunde, negativ = Speicher geht verloren) und
+ * je Minute Heap-Tiefststand und mittlerer RSSI (älteste zuerst, 0 = getrennt).
+ */
+void SystemAPI::writeTrend(ValueWriter& out, const HealthTrend& t) {
+    // Abgeschlossene Perioden plus die laufende, älteste zuerst
+    HealthTrendPeriod periods[HEALTH_TREND_PERIODS + 1];
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < t.count; i++) {
+        periods[n++] = t.periods[(t.head + HEALTH_TREND_PERIODS - t.count + i) % HEALTH_TREND_PERIODS];
     }
+    if (t.currentSamples) {
+        periods[n] = t.current;
+        if (periods[n].rssiSamples) periods[n].rssiSum /= periods[n].rssiSamples;
+        n++;
+    }
+
+    uint32_t heapLow = 0;
+    int rssiMin = 0, rssiMax = 0;
+    bool haveRssi = false;
+    // Kleinste Quadrate über (Minute, Heap-Tiefststand)
+    float sx = 0, sy = 0, sxx = 0, sxy = 0;
+    for (uint8_t i = 0; i < n; i++) {
+        const HealthTrendPeriod& p = periods[i];
+        if (i == 0 || p.heapMin < heapLow) heapLow = p.heapMin;
+        if (p.rssiSamples) {
+            if (!haveRssi || p.rssiMin < rssiMin) rssiMin = p.rssiMin;
+            if (!haveRssi || p.rssiMax > rssiMax) rssiMax = p.rssiMax;
+            haveRssi = true;
+        }
+        sx += i;
+        sy += p.heapMin;
+        sxx += (float)i * i;
+        sxy += (float)i * p.heapMin;
+    }
+    float denom = n * sxx - sx * sx;
+    float slopePerHour = (n >= 2 && denom != 0) ? (n * sxy - sx * sy) / denom * (3600000.0f / HEALTH_TREND_PERIOD_MS) : 0;
+
+    out.beginObject();
+    out.field("period_s", HEALTH_TREND_PERIOD_MS / 1000);
+    out.field("heap_low", (unsigned long)heapLow);
+    out.field("heap_slope_per_h", (long)lroundf(slopePerHour));
+    out.field("rssi_min", rssiMin);
+    out.field("rssi_max", rssiMax);
+    out.key("heap_min");
+    out.beginArray(n);
+    for (uint8_t i = 0; i < n; i++) out.value((unsigned long)periods[i].heapMin);
+    out.endArray();
+    out.key("rssi");
+    out.beginArray(n);
+    for (uint8_t i = 0; i < n; i++) out.value((long)(periods[i].rssiSamples ? periods[i].rssiSum : 0));
+    out.endArray();
+    out.endObject();
 }
 
 /**
- * @brief Sammelt alle System-Gesundheitsdaten und formatiert sie als JSON-String.
- * 
- * Diese Funktion ist der Kern der Diagnose-API. Sie liest Hardware- und Software-Zustände
- * aus und stellt sie strukturiert für das Frontend bereit.
- * 
- * @return Ein String, der das JSON-Objekt mit allen Gesundheitsdaten enthält.
+ * @brief Liest alle veränderlichen Hardware- und Netzwerk-Werte in eine
+ * Momentaufnahme. Die festen Werte kommen aus begin().
  */
-String SystemAPI::getSystemHealthJson() {
-    // Wir verwenden ArduinoJson, um das JSON-Objekt sicher und effizient zu erstellen.
-    // Die Größe (1024 Bytes) ist großzügig bemessen, um alle Daten aufzunehmen.
-    StaticJsonDocument<1024> doc;
+void SystemAPI::sampleHealth(HealthSample& sample) {
+    sample.sampledMs = millis();
 
     // --- Stabilitäts-Daten ---
-    int reasonCode = esp_reset_reason();
-    doc["reset_reason_code"] = reasonCode;
-    doc["reset_reason_text"] = getResetReasonText(reasonCode);
-    doc["uptime_seconds"] = esp_timer_get_time() / 1000000;
+    sample.resetReason = _resetReason;
+    sample.uptimeSeconds = (uint32_t)(esp_timer_get_time() / 1000000);
 
     // --- Heap-Speicher (RAM) Daten ---
-    doc["heap_total"] = ESP.getHeapSize();
-    doc["heap_free"] = ESP.getFreeHeap();
-    doc["heap_min_free"] = ESP.getMinFreeHeap(); // Wichtigster Wert zur Speicher-Analyse!
+    sample.heapTotal = _heapTotal;
+    sample.heapFree = ESP.getFreeHeap();
+    sample.heapMinFree = ESP.getMinFreeHeap(); // Wichtigster Wert zur Speicher-Analyse!
 
     // --- Netzwerk-Daten ---
-    doc["wifi_ssid"] = _wifiManager.getSsid();
-    doc["wifi_rssi"] = _wifiManager.isStationConnected() ? WiFi.RSSI() : 0;
-    doc["ip_address"] = _wifiManager.getIpAddress();
-    doc["last_time_sync"] = 0; // Platzhalter, für eine echte Implementierung mit NTP-Client
+    bool connected = _wifiManager.isStationConnected();
+    snprintf(sample.wifiSsid, sizeof(sample.wifiSsid), "%s", _wifiManager.getSsid().c_str());
+    sample.wifiRssi = connected ? WiFi.RSSI() : 0;
+    snprintf(sample.ipAddress, sizeof(sample.ipAddress), "%s", _wifiManager.getIpAddress().c_str());
+    _wifiManager.getStats(sample.wifi);
 
     // --- System-Identifikations-Daten ---
-    doc["firmware_version"] = firmware_version;
-    doc["mac_address"] = WiFi.macAddress();
+    memcpy(sample.macAddress, _macAddress, sizeof(sample.macAddress));
     #ifdef CONFIG_IDF_TARGET_ESP32
         // Die CPU-Temperatur ist nur auf einigen ESP32-Chips verfügbar.
-        doc["cpu_temp"] = temperatureRead();
+        sample.cpuTemp = temperatureRead();
     #else
-        doc["cpu_temp"] = 0;
+        sample.cpuTemp = 0;
     #endif
 
     // --- System-Zeit ---
-    doc["last_time_sync"] = _timeService.getLastSyncTimestamp();
-
-    // Das erstellte JSON-Objekt in einen String umwandeln.
-    String output;
-    serializeJson(doc, output);
-    return output;
+    sample.lastTimeSync = _timeService.getLastSyncTimestamp();
 }
 
 /**
- * @brief Gibt die gespeicherten Neustart-Gründe als einfachen Text zurück.
+ * @brief Schreibt die Health-Felder. Ist `previous` gesetzt, werden nur Felder
+ * geschrieben, die sich seitdem geändert haben (für Delta-Updates per SSE).
  */
-String SystemAPI::getLogs() {
-    if (log_count == 0) {
-        return "Keine Logs vorhanden.";
-    }
-    String log_string = "";
-    for (int i = 0; i < log_count; i++) {
-        log_string += String(i + 1) + ": " + log_entries[i] + "\n";
+void SystemAPI::writeHealthFields(ValueWriter& out, const HealthSample& s, const HealthSample* previous) {
+    const HealthSample* p = previous;
+
+    if (!p || p->resetReason != s.resetReason) {
+        out.field("reset_reason_code", s.resetReason);
+        out.field("reset_reason_text", getResetReasonText(s.resetReason));
     }
-    return log_string;
+    if (!p || p->uptimeSeconds != s.uptimeSeconds) out.field("uptime_seconds", s.uptimeSeconds);
+
+    if (!p || p->heapTotal != s.heapTotal) out.field("heap_total", s.heapTotal);
+    if (!p || p->heapFree != s.heapFree) out.field("heap_free", s.heapFree);
+    if (!p || p->heapMinFree != s.heapMinFree) out.field("heap_min_free", s.heapMinFree);
+
+    if (!p || strcmp(p->wifiSsid, s.wifiSsid) != 0) out.field("wifi_ssid", s.wifiSsid);
+    if (!p || p->wifiRssi != s.wifiRssi) out.field("wifi_rssi", s.wifiRssi);
+    if (!p || strcmp(p->ipAddress, s.ipAddress) != 0) out.field("ip_address", s.ipAddress);
+    if (!p || p->wifi.state != s.wifi.state) out.field("wifi_state", WifiManager::stateName(s.wifi.state));
+    if (!p || p->wifi.attempts != s.wifi.attempts) out.field("wifi_attempts", s.wifi.attempts);
+    if (!p || p->wifi.failures != s.wifi.failures) out.field("wifi_failures", s.wifi.failures);
+    if (!p || p->wifi.drops != s.wifi.drops) out.field("wifi_drops", s.wifi.drops);
+    if (!p || p->wifi.lastConnectMs != s.wifi.lastConnectMs) out.field("wifi_connect_ms", s.wifi.lastConnectMs);
+    if (!p || p->wifi.maxConnectMs != s.wifi.maxConnectMs) out.field("wifi_connect_max_ms", s.wifi.maxConnectMs);
+    if (!p || p->wifi.lastReason != s.wifi.lastReason) out.field("wifi_disconnect_reason", (int)s.wifi.lastReason);
+    if (!p || p->wifi.lastPath != s.wifi.lastPath) out.field("wifi_connect_path", WifiManager::pathName(s.wifi.lastPath));
+    if (!p || p->wifi.fastConnectMs != s.wifi.fastConnectMs) out.field("wifi_fast_ms", s.wifi.fastConnectMs);
+    if (!p || p->wifi.fullConnectMs != s.wifi.fullConnectMs) out.field("wifi_full_ms", s.wifi.fullConnectMs);
+    if (!p || p->wifi.fastOk != s.wifi.fastOk) out.field("wifi_fast_ok", s.wifi.fastOk);
+    if (!p || p->wifi.fastFailed != s.wifi.fastFailed) out.field("wifi_fast_failed", s.wifi.fastFailed);
+
+    if (!p) out.field("firmware_version", firmware_version);
+    if (!p || strcmp(p->macAddress, s.macAddress) != 0) out.field("mac_address", s.macAddress);
+    // Temperatur nur melden, wenn sich der ganzzahlige Wert ändert, sonst rauscht sie in jedem Delta mit.
+    if (!p || lroundf(p->cpuTemp) != lroundf(s.cpuTemp)) out.field("cpu_temp", s.cpuTemp, 2);
+
+    if (!p || p->lastTimeSync != s.lastTimeSync) out.field("last_time_sync", s.lastTimeSync);
 }
 
 /**
- * @brief Löscht die im RTC-Speicher gehaltenen Logs.
+ * @brief Löscht das Ereignis-Log (RTC-Puffer und Flash).
  */
 void SystemAPI::clearLogs() {
-    log_count = 0;
+    eventLog.clear();
 }
 
 
 /**
  * @brief Übersetzt den numerischen ESP32-Reset-Grund in einen für Menschen lesbaren Text.
  * @param reasonCode Der numerische Code von `esp_reset_reason()`.
- * @return Ein String mit der Beschreibung des Grundes.
+ * @return Konstanter Text mit der Beschreibung des Grundes (liegt im Flash).
  */
-String SystemAPI::getResetReasonText(int reasonCode) {
+const char* SystemAPI::getResetReasonText(int reasonCode) {
     switch (reasonCode) {
         case 1  : return "Power on"; // Normaler Start nach Einschalten
         case 3  : return "Software reset via ESP.restart()"; // Kontrollierter Neustart
@@ -8,32 +8,126 @@
 //| zentrale Anlaufstelle für das Sammeln und Bereitstellen von                  |
 //| System-Diagnosedaten wie Speicherverbrauch, Laufzeit, Neustartgründe und     |
 //| Netzwerkstatus. Sie kapselt die Hardware-nahen Abfragen.                     |
+//|                                                                              |
+//| HEALTH-SNAPSHOT: Ein Task mit niedriger Priorität liest die Werte im Takt    |
+//| der Einstellung "health_ms" und legt das fertige JSON in einem Puffer ab.    |
+//| Requests kopieren nur noch diesen Puffer. Werte, die sich nie ändern (MAC,   |
+//| Neustart-Grund, Heap-Größe), werden einmal beim Start gelesen. Dazu kommen   |
+//| Verläufe pro Minute (Heap-Tiefststand, RSSI), die einzelne Abfragen nicht    |
+//| liefern könnten.                                                             |
 //================================================================================
 
 #pragma once
 
 #include <Arduino.h>
-#include <ArduinoJson.h> // Wichtig: ArduinoJson muss in platformio.ini stehen
+#include "../../modules/Server/ValueWriter.h"
 #include "../../modules/WiFi/WifiManager.h"
 #include "../../services/TimeService.h"
 
+#define HEALTH_SNAPSHOT_SIZE        1536   // fertiges JSON für /api/system/health
+#define HEALTH_TREND_PERIOD_MS      60000  // ein Verlaufswert pro Minute
+#define HEALTH_TREND_PERIODS        60     // eine Stunde Verlauf
+#define HEALTH_TASK_STACK           4096
+#define HEALTH_TASK_PRIORITY        1
+
+/**
+ * @brief Momentaufnahme aller Health-Werte.
+ * Ermöglicht es, zwei Zeitpunkte zu vergleichen und nur Änderungen zu senden (SSE).
+ */
+struct HealthSample {
+    uint32_t sampledMs;         // millis() der Messung, nicht der Anfrage
+    int resetReason;
+    uint32_t uptimeSeconds;
+    uint32_t heapTotal;
+    uint32_t heapFree;
+    uint32_t heapMinFree;
+    char wifiSsid[33];
+    int wifiRssi;
+    char ipAddress[16];
+    WifiStats wifi;             // Verbindungsversuche und Abbrüche
+    char macAddress[18];
+    float cpuTemp;
+    long long lastTimeSync;
+};
+
+/**
+ * @brief Zusammenfassung einer Verlaufsperiode (HEALTH_TREND_PERIOD_MS).
+ * rssiSamples = 0: in dieser Periode war keine Station-Verbindung.
+ */
+struct HealthTrendPeriod {
+    uint32_t heapMin;           // kleinster gemessener freier Heap
+    int32_t rssiSum;            // wird beim Abschluss zum Mittelwert
+    int8_t rssiMin;
+    int8_t rssiMax;
+    uint16_t rssiSamples;
+};
+
+/**
+ * @brief Verlauf der letzten Stunde plus die laufende Periode.
+ */
+struct HealthTrend {
+    HealthTrendPeriod periods[HEALTH_TREND_PERIODS];
+    uint8_t head;               // nächster Schreibplatz
+    uint8_t count;
+    HealthTrendPeriod current;
+    uint32_t currentStart;
+    uint16_t currentSamples;
+};
+
 class SystemAPI {
 public:
     // Der Konstruktor benötigt eine Referenz zum WifiManager, um Netzwerkdaten abzurufen.
     SystemAPI(WifiManager& wifiManager, TimeService& timeService);
 
-    // Generiert die JSON-Antwort für den /api/system/health Endpunkt.
-    String getSystemHealthJson();
+    // Liest die festen Werte, erstellt den ersten Snapshot und startet den Sampler-Task.
+    // Nach wifiManager.setup() aufrufen, damit der erste Snapshot den WLAN-Stand enthält.
+    void begin();
+
+    // Ein Durchlauf des Samplers: messen, Verlauf fortschreiben, JSON erzeugen.
+    void refreshHealth();
+
+    // Kopiert den zuletzt erzeugten JSON-Snapshot. Gibt die Länge zurück (0 = noch keiner).
+    size_t copyHealthJson(char* out, size_t capacity);
+
+    // Kopiert die zuletzt gemessenen Werte (ohne Hardware-Zugriff, z.B. für SSE-Deltas).
+    void latestHealth(HealthSample& sample);
 
-    // Gibt die gesammelten "Logs" zurück (in diesem Beispiel der Neustart-Grund).
-    String getLogs();
+    // Schreibt die Antwort für den /api/system/health Endpunkt aus dem letzten Stand (JSON, CBOR, MessagePack).
+    void writeSystemHealth(ValueWriter& out);
 
-    // Löscht die "Logs".
+    // Liest alle aktuellen Health-Werte in eine Momentaufnahme (feste Werte aus dem Cache).
+    void sampleHealth(HealthSample& sample);
+
+    // Schreibt die Felder einer Momentaufnahme. Mit `previous` nur die geänderten Felder.
+    void writeHealthFields(ValueWriter& out, const HealthSample& sample, const HealthSample* previous = nullptr);
+
+    // Löscht das Ereignis-Log. Gelesen wird direkt über `eventLog` (seitenweise).
     void clearLogs();
 
 private:
     WifiManager& _wifiManager; // Referenz zum WifiManager
     TimeService& _timeService; // Referenz zum TimeService
+
+    // Feste Werte (einmal in begin() gelesen)
+    int _resetReason;
+    uint32_t _heapTotal;
+    char _macAddress[18];
+
+    // Letzter Stand; _sample, _trend und der vordere Snapshot-Puffer sind durch
+    // _lock geschützt. Der hintere Puffer gehört allein dem Sampler-Task.
+    portMUX_TYPE _lock;
+    HealthSample _sample;
+    HealthTrend _trend;
+    char _snapshot[2][HEALTH_SNAPSHOT_SIZE];
+    size_t _snapshotLen[2];
+    uint8_t _front;
+    TaskHandle_t _task;
+
+    void updateTrend(const HealthSample& sample, uint32_t nowMs);
+    void writeHealthDocument(ValueWriter& out, const HealthSample& sample, const HealthTrend& trend);
+    static void writeTrend(ValueWriter& out, const HealthTrend& trend);
+    static void samplerTask(void* arg);
+
     // Hilfsfunktion, um den numerischen Neustart-Grund in einen lesbaren Text zu übersetzen.
-    String getResetReasonText(int reasonCode);
+    const char* getResetReasonText(int reasonCode);
 };
\ No newline at end of file
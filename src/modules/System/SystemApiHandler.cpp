@@ -33,23 +33,149 @@ void SystemApiHandler::registerRoutes(AsyncWebServer& server) {
     server.on("/api/system/health", HTTP_GET, std::bind(&SystemApiHandler::handleGetHealth, this, std::placeholders::_1));
     server.on("/api/logs", HTTP_GET, std::bind(&SystemApiHandler::handleGetLogs, this, std::placeholders::_1));
     server.on("/api/logs/clear", HTTP_POST, std::bind(&SystemApiHandler::handleClearLogs, this, std::placeholders::_1));
+    server.on("/api/logs/stats", HTTP_GET, std::bind(&SystemApiHandler::handleGetLogStats, this, std::placeholders::_1));
     server.on("/api/system/reboot", HTTP_POST, std::bind(&SystemApiHandler::handleReboot, this, std::placeholders::_1));
+    server.on("/api/events/stats", HTTP_GET, std::bind(&SystemApiHandler::handleGetEventStats, this, std::placeholders::_1));
+    server.on("/api/config", HTTP_GET, std::bind(&SystemApiHandler::handleGetConfig, this, std::placeholders::_1));
+    server.on("/api/config", HTTP_POST, std::bind(&SystemApiHandler::handleSetConfig, this, std::placeholders::_1));
+    server.on("/api/config/stats", HTTP_GET, std::bind(&SystemApiHandler::handleGetConfigStats, this, std::placeholders::_1));
+    server.on("/api/system/tasks", HTTP_GET, std::bind(&SystemApiHandler::handleGetTasks, this, std::placeholders::_1));
+    server.on("/api/system/heap", HTTP_GET, std::bind(&SystemApiHandler::handleGetHeap, this, std::placeholders::_1));
+    server.on("/api/system/heap/leakcheck", HTTP_GET, std::bind(&SystemApiHandler::handleGetLeakCheck, this, std::placeholders::_1));
+    server.on("/api/system/heap/leakcheck", HTTP_POST, std::bind(&SystemApiHandler::handleLeakCheck, this, std::placeholders::_1));
+    server.on("/api/system/profiler", HTTP_GET, std::bind(&SystemApiHandler::handleGetProfiler, this, std::placeholders::_1));
+    server.on("/api/system/profiler", HTTP_POST, std::bind(&SystemApiHandler::handleProfiler, this, std::placeholders::_1));
+    server.on("/api/system/profiler/data", HTTP_GET, std::bind(&SystemApiHandler::handleGetProfile, this, std::placeholders::_1));
+
+    // Server-Sent Events: Health-Deltas ("health") und neue Log-Zeilen ("log").
+    _events.attach(server, "/api/events");
+}
+
+/**
+ * @brief Holt neue Einträge aus dem EventLog und sendet sie wie GET /api/logs als "log".
+ * Ohne Clients läuft der Cursor nur mit, ein neuer Client bekommt also keinen Rückstand.
+ */
+void SystemApiHandler::forwardLogRecords(uint8_t clients) {
+    if (clients == 0) {
+        _logCursor = eventLog.nextSeq();
+        return;
+    }
+    uint8_t records[LOG_EVENT_BATCH * EVENT_LOG_MAX_RECORD];
+    uint32_t seq = _logCursor;
+    size_t len = eventLog.read(_logCursor, records, sizeof(records), LOG_EVENT_BATCH, seq);
+    char line[128];
+    for (size_t pos = 0; pos < len; pos += records[pos]) {
+        size_t n = EventLog::format(seq++, records + pos, line, sizeof(line));
+        _events.send("log", line, n);
+    }
+}
+
+/**
+ * @brief Sendet neue Log-Einträge, prüft periodisch die Health-Werte und sendet nur
+ * geänderte Felder. Kommt ein neuer Client hinzu, wird einmal der vollständige Stand gesendet.
+ */
+void SystemApiHandler::loop() {
+    _events.loop();
+    forwardLogRecords(_events.clientCount());
+
+    unsigned long now = millis();
+    if (now - _lastHealthCheck < HEALTH_EVENT_INTERVAL_MS) return;
+    _lastHealthCheck = now;
+
+    uint8_t clients = _events.clientCount();
+    bool newClient = clients > _lastClientCount;
+    _lastClientCount = clients;
+    if (clients == 0) return;
+
+    HealthSample sample;
+    _systemApi.latestHealth(sample); // Stand des Sampler-Tasks, kein Hardware-Zugriff hier
+
+    char buffer[768];
+    ResponseWriter out(nullptr, 0, nullptr, buffer, sizeof(buffer));
+    JsonWriter json(out);
+    json.beginObject();
+    _systemApi.writeHealthFields(json, sample, (_hasLastHealth && !newClient) ? &_lastHealth : nullptr);
+    json.endObject();
+
+    // "{}" = nichts geändert -> nichts senden
+    if (out.length() > 2 && !out.overflowed()) {
+        _events.send("health", out.data(), out.length());
+    }
+    _lastHealth = sample;
+    _hasLastHealth = true;
 }
 
 /**
  * @brief Bearbeitet Anfragen für System-Gesundheitsdaten.
- * Ruft die entsprechende Methode der `_systemApi` auf und sendet deren
- * Rückgabewert (einen JSON-String) an den Client.
+ * JSON ist schon fertig serialisiert (Sampler-Task der `_systemApi`) und wird nur
+ * kopiert. CBOR und MessagePack (Wahl per Accept-Header) werden aus dem letzten
+ * Stand erzeugt, ebenfalls ohne Hardware-Zugriff im httpd-Task.
  */
 void SystemApiHandler::handleGetHealth(AsyncWebServerRequest *request) {
-    request->send(200, "application/json", _systemApi.getSystemHealthJson());
+    if (ApiResponse::negotiate(request) == API_FORMAT_JSON) {
+        char snapshot[HEALTH_SNAPSHOT_SIZE];
+        size_t len = _systemApi.copyHealthJson(snapshot, sizeof(snapshot));
+        if (len > 0) {
+            request->sendBuffer(200, "application/json", snapshot, len);
+            return;
+        }
+    }
+    char buffer[512];
+    ApiResponse res(request, buffer, sizeof(buffer));
+    _systemApi.writeSystemHealth(res.writer());
+    res.end();
 }
 
 /**
- * @brief Bearbeitet Anfragen zum Abrufen der Logs.
+ * @brief Bearbeitet Anfragen zum Abrufen der Logs (seitenweise).
+ *
+ * Parameter: `cursor` (Nummer des ersten gewünschten Eintrags, Standard: die
+ * letzten `limit`), `limit` und `format=bin` für die Rohdatensätze, die
+ * tools/logdecode.py auf dem PC dekodiert. Ohne `format` kommen Textzeilen.
+ * Der Header X-Log-Next enthält den Cursor für die nächste Seite.
  */
 void SystemApiHandler::handleGetLogs(AsyncWebServerRequest *request) {
-    request->send(200, "text/plain", _systemApi.getLogs());
+    const char* arg = request->argPtr("limit");
+    uint32_t limit = arg ? strtoul(arg, nullptr, 10) : LOG_PAGE_DEFAULT;
+    if (limit == 0 || limit > LOG_PAGE_MAX) limit = LOG_PAGE_MAX;
+    arg = request->argPtr("cursor");
+    bool tail = arg == nullptr;
+    uint32_t next = eventLog.nextSeq();
+    uint32_t cursor = tail ? (next > limit ? next - limit : 0) : strtoul(arg, nullptr, 10);
+
+    uint8_t records[LOG_PAGE_BYTES];
+    uint32_t firstSeq = cursor;
+    size_t len = eventLog.read(cursor, records, sizeof(records), (uint16_t)limit, firstSeq);
+
+    char value[12];
+    snprintf(value, sizeof(value), "%u", (unsigned)cursor);
+    request->addHeader("X-Log-Next", value);
+    snprintf(value, sizeof(value), "%u", (unsigned)eventLog.oldestSeq());
+    request->addHeader("X-Log-Oldest", value);
+
+    char buffer[512];
+    arg = request->argPtr("format");
+    if (arg && strcmp(arg, "bin") == 0) {
+        // Kopf: "EVL1", Nummer des ersten Datensatzes, nächster Cursor (je uint32, little-endian)
+        ResponseWriter out(request, 200, "application/octet-stream", buffer, sizeof(buffer));
+        out.write("EVL1", 4);
+        out.write((const char*)&firstSeq, sizeof(firstSeq));
+        out.write((const char*)&cursor, sizeof(cursor));
+        out.write((const char*)records, len);
+        out.end();
+        return;
+    }
+
+    ResponseWriter out(request, 200, "text/plain", buffer, sizeof(buffer));
+    if (len == 0 && tail) out.print("Keine Logs vorhanden.\n");
+    char line[128];
+    uint32_t seq = firstSeq;
+    for (size_t pos = 0; pos < len; pos += records[pos]) {
+        size_t n = EventLog::format(seq++, records + pos, line, sizeof(line) - 1);
+        line[n++] = '\n';
+        out.write(line, n);
+    }
+    out.end();
 }
 
 /**
@@ -60,6 +186,208 @@ void SystemApiHandler::handleClearLogs(AsyncWebServerRequest *request) {
     request->send(200, "text/plain", "Logs gelöscht."); // ...dann den Erfolg bestätigen.
 }
 
+/**
+ * @brief Füllstand von RTC-Puffer und Flash sowie Kosten eines Log-Eintrags.
+ */
+void SystemApiHandler::handleGetLogStats(AsyncWebServerRequest *request) {
+    char buffer[320];
+    ResponseWriter out(request, 200, "application/json", buffer, sizeof(buffer));
+    JsonWriter json(out);
+    eventLog.writeStatsJson(json);
+    out.end();
+}
+
+/**
+ * @brief Liefert Client-Anzahl und Queue-Tiefen des Event-Streams.
+ */
+void SystemApiHandler::handleGetEventStats(AsyncWebServerRequest *request) {
+    char buffer[256];
+    ResponseWriter out(request, 200, "application/json", buffer, sizeof(buffer));
+    JsonWriter json(out);
+    _events.writeStatsJson(json);
+    out.end();
+}
+
+/**
+ * @brief Alle Einstellungen aus dem RAM (geheime Werte wie das WLAN-Passwort fehlen).
+ */
+void SystemApiHandler::handleGetConfig(AsyncWebServerRequest *request) {
+    char buffer[320];
+    ResponseWriter out(request, 200, "application/json", buffer, sizeof(buffer));
+    JsonWriter json(out);
+    configStore.writeValuesJson(json);
+    out.end();
+}
+
+/**
+ * @brief Setzt mehrere Einstellungen auf einmal, z.B. POST /api/config mit
+ * "kp=3.2&kd=0.4&motor_min=70". Entweder werden alle Werte übernommen oder keiner.
+ * Gespeichert wird verzögert; "commit=1" schreibt sofort ins NVS.
+ */
+void SystemApiHandler::handleSetConfig(AsyncWebServerRequest *request) {
+    ConfigValue values[REQUEST_MAX_PARAMS];
+    size_t count = 0;
+    bool commitNow = false;
+    const char* badKey = nullptr;
+    const char* error = nullptr;
+
+    for (size_t n = 0; n < request->params() && !badKey; n++) {
+        const RequestParam* param = request->getParam(n);
+        if (strcmp(param->name, "commit") == 0) {
+            commitNow = strcmp(param->value, "1") == 0;
+            continue;
+        }
+        ConfigKey key = ConfigStore::find(param->name);
+        if (!ConfigStore::parse(key, param->value, values[count], error)) {
+            badKey = param->name;
+            break;
+        }
+        count++;
+    }
+
+    int changed = -1;
+    if (!badKey) {
+        size_t errorIndex = 0;
+        changed = configStore.setMany(values, count, errorIndex, error);
+        if (changed < 0) badKey = ConfigStore::def(values[errorIndex].key).name;
+    }
+    if (changed >= 0 && commitNow) configStore.commit();
+
+    char buffer[160];
+    ResponseWriter out(request, changed < 0 ? 400 : 200, "application/json", buffer, sizeof(buffer));
+    JsonWriter json(out);
+    json.beginObject();
+    json.field("ok", changed >= 0);
+    if (changed < 0) {
+        json.field("key", badKey);
+        json.field("error", error);
+    } else {
+        json.field("changed", changed);
+        json.field("committed", commitNow);
+    }
+    json.endObject();
+    out.end();
+}
+
+/**
+ * @brief Zähler des ConfigStores, u.a. wie viele Flash-Schreibvorgänge eingespart wurden.
+ */
+void SystemApiHandler::handleGetConfigStats(AsyncWebServerRequest *request) {
+    char buffer[320];
+    ResponseWriter out(request, 200, "application/json", buffer, sizeof(buffer));
+    JsonWriter json(out);
+    configStore.writeStatsJson(json);
+    out.end();
+}
+
+/**
+ * @brief CPU-Auslastung je Kern und je Task (letzte Sekunde, 10 s, 60 s) sowie
+ * die kleinste Stack-Reserve jedes Tasks. Format wie bei /api/system/health.
+ */
+void SystemApiHandler::handleGetTasks(AsyncWebServerRequest *request) {
+    char buffer[512];
+    ApiResponse res(request, buffer, sizeof(buffer));
+    taskProfiler.writeReport(res.writer());
+    res.end();
+}
+
+/**
+ * @brief Heap-Zustand (größter freier Block, Fragmentierung) und, im Diagnose-Build
+ * mit HEAP_TRACKING, Allokationen und Freigaben je Route und Subsystem.
+ */
+void SystemApiHandler::handleGetHeap(AsyncWebServerRequest *request) {
+    char buffer[512];
+    ApiResponse res(request, buffer, sizeof(buffer));
+    HeapTrace::writeReport(res.writer());
+    res.end();
+}
+
+/**
+ * @brief Was seit dem Start der Leck-Suche allokiert und noch nicht freigegeben wurde.
+ * Typischer Ablauf: POST (Start), die verdächtige Aktion ein paarmal auslösen, GET.
+ */
+void SystemApiHandler::handleGetLeakCheck(AsyncWebServerRequest *request) {
+    char buffer[512];
+    ApiResponse res(request, buffer, sizeof(buffer));
+    HeapTrace::writeLeakReport(res.writer());
+    res.end();
+}
+
+/**
+ * @brief Startet die Leck-Suche (neu); "stop=1" beendet sie und gibt die Tabelle frei.
+ */
+void SystemApiHandler::handleLeakCheck(AsyncWebServerRequest *request) {
+    const char* stop = request->argPtr("stop");
+    if (stop && strcmp(stop, "1") == 0) {
+        HeapTrace::stopLeakCheck();
+        request->send(200, "application/json", "{\"armed\":false}");
+        return;
+    }
+    if (!HeapTrace::startLeakCheck()) {
+        request->send(HEAP_TRACE_ENABLED ? 503 : 501, "application/json",
+                      HEAP_TRACE_ENABLED ? "{\"error\":\"no memory\"}" : "{\"error\":\"build without HEAP_TRACKING\"}");
+        return;
+    }
+    request->send(200, "application/json", "{\"armed\":true}");
+}
+
+/**
+ * @brief Zustand des Sampling-Profilers (läuft, Füllstand, Kosten je Sample).
+ */
+void SystemApiHandler::handleGetProfiler(AsyncWebServerRequest *request) {
+    char buffer[512];
+    ApiResponse res(request, buffer, sizeof(buffer));
+    samplingProfiler.writeStatus(res.writer());
+    res.end();
+}
+
+/**
+ * @brief Steuert den Sampling-Profiler: action=start (optional kb, divider, depth),
+ * action=stop oder action=clear (Puffer freigeben). Antwortet mit dem Zustand.
+ */
+void SystemApiHandler::handleProfiler(AsyncWebServerRequest *request) {
+    const char* action = request->argPtr("action");
+    if (action && strcmp(action, "start") == 0) {
+        const char* arg = request->argPtr("kb");
+        uint32_t kb = arg ? strtoul(arg, nullptr, 10) : SAMPLING_PROFILER_DEFAULT_KB;
+        arg = request->argPtr("divider");
+        uint32_t divider = arg ? strtoul(arg, nullptr, 10) : SAMPLING_PROFILER_DEFAULT_DIVIDER;
+        arg = request->argPtr("depth");
+        uint32_t depth = arg ? strtoul(arg, nullptr, 10) : SAMPLING_PROFILER_DEFAULT_DEPTH;
+        if (kb == 0 || kb > SAMPLING_PROFILER_MAX_KB || divider == 0 || divider > SAMPLING_PROFILER_MAX_DIVIDER ||
+            depth == 0 || depth > SAMPLING_PROFILER_MAX_DEPTH) {
+            request->send(400, "application/json", "{\"error\":\"invalid kb, divider or depth\"}");
+            return;
+        }
+        if (samplingProfiler.running()) {
+            request->send(409, "application/json", "{\"error\":\"already running\"}");
+            return;
+        }
+        if (!samplingProfiler.start(kb * 1024, (uint16_t)divider, (uint8_t)depth)) {
+            request->send(503, "application/json", "{\"error\":\"no memory\"}");
+            return;
+        }
+    } else if (action && strcmp(action, "stop") == 0) {
+        samplingProfiler.stop();
+    } else if (action && strcmp(action, "clear") == 0) {
+        samplingProfiler.clear();
+    } else {
+        request->send(400, "application/json", "{\"error\":\"action must be start, stop or clear\"}");
+        return;
+    }
+    handleGetProfiler(request);
+}
+
+/**
+ * @brief Das Profil als Binärdatei für tools/profile_symbolize.py (stoppt den Profiler).
+ */
+void SystemApiHandler::handleGetProfile(AsyncWebServerRequest *request) {
+    char buffer[512];
+    ResponseWriter out(request, 200, "application/octet-stream", buffer, sizeof(buffer));
+    samplingProfiler.writeProfile(out);
+    out.end();
+}
+
 /**
  * @brief Bearbeitet Anfragen für einen Geräteneustart.
  */
@@ -67,7 +395,7 @@ void SystemApiHandler::handleReboot(AsyncWebServerRequest *request) {
     // Zuerst eine Antwort an den Client senden, damit die Anfrage abgeschlossen wird.
     request->send(200, "text/plain", "Neustart wird eingeleitet.");
     // Eine kurze Verzögerung gibt dem Browser Zeit, die Antwort zu empfangen,
-    // bevor die Verbindung durch den Neustart abrupt getrennt wird.
-    delay(1000);
-    ESP.restart();
+    // bevor die Verbindung durch den Neustart abrupt getrennt wird. Die Wartezeit
+    // läuft im Worker-Pool, damit der httpd-Task währenddessen weiter antwortet.
+    request->defer([]() { ESP.restart(); }, 1000);
 }
\ No newline at end of file
@@ -13,6 +13,24 @@
 
 #include "modules/Server/AsyncWebServer.h" // Notwendig, da wir mit Web-Anfragen (Requests) arbeiten.
 #include "SystemAPI.h"         // Wir benötigen Zugriff auf die SystemAPI, um die eigentlichen Daten abzurufen.
+#include "modules/Server/EventStream.h" // Live-Updates per Server-Sent Events
+#include "modules/Server/ApiResponse.h" // JSON, CBOR oder MessagePack je nach Accept-Header
+#include "EventLog.h"                   // Ereignis-Log (RTC-Ring + Flash)
+#include "ConfigStore.h"                // Einstellungen (RAM-Cache, verzögert im NVS)
+#include "TaskProfiler.h"               // CPU-Anteil und Stack-Reserve je Task
+#include "HeapTrace.h"                  // Heap-Zähler je Route/Subsystem, Leck-Suche
+#include "SamplingProfiler.h"           // Stichproben des Aufrufstapels aus dem Tick
+
+// Wie oft die Health-Werte für den Event-Stream geprüft werden.
+#define HEALTH_EVENT_INTERVAL_MS 1000
+
+// Seitengröße für GET /api/logs (Einträge bzw. Bytes Rohdaten pro Antwort).
+#define LOG_PAGE_DEFAULT 50
+#define LOG_PAGE_MAX     200
+#define LOG_PAGE_BYTES   768
+
+// Höchstens so viele neue Log-Einträge gehen pro loop() an den Event-Stream.
+#define LOG_EVENT_BATCH  8
 
 /**
  * @class SystemApiHandler
@@ -42,16 +60,46 @@ public:
      */
     void registerRoutes(AsyncWebServer& server);
 
+    /**
+     * @brief Wird in der Hauptschleife aufgerufen. Reicht neue Log-Einträge weiter,
+     * prüft die Health-Werte und pusht geänderte Felder an alle Event-Stream-Clients.
+     */
+    void loop();
+
 private:
     // Eine private Referenz auf das Logik-Modul.
     // 'const' ist hier nicht möglich, da z.B. `clearLogs` den Zustand ändert.
     SystemAPI& _systemApi;
 
+    // Event-Stream (/api/events) und der zuletzt gesendete Health-Stand für Deltas.
+    EventStream _events;
+    HealthSample _lastHealth;
+    bool _hasLastHealth = false;
+    uint8_t _lastClientCount = 0;
+    unsigned long _lastHealthCheck = 0;
+
+    // Nächster Log-Eintrag für /api/events. Das EventLog wird hier abgeholt statt
+    // aus log() heraus gesendet, damit die Regelschleife nie auf den Stream wartet.
+    uint32_t _logCursor = 0;
+    void forwardLogRecords(uint8_t clients);
+
     // Private Handler-Methoden für jeden einzelnen API-Endpunkt.
     // Diese Kapselung sorgt dafür, dass die Methoden nur innerhalb der Klasse
     // aufgerufen werden können und die `registerRoutes` Funktion übersichtlich bleibt.
     void handleGetHealth(AsyncWebServerRequest *request);
     void handleGetLogs(AsyncWebServerRequest *request);
     void handleClearLogs(AsyncWebServerRequest *request);
+    void handleGetLogStats(AsyncWebServerRequest *request);
     void handleReboot(AsyncWebServerRequest *request);
+    void handleGetEventStats(AsyncWebServerRequest *request);
+    void handleGetConfig(AsyncWebServerRequest *request);
+    void handleSetConfig(AsyncWebServerRequest *request);
+    void handleGetConfigStats(AsyncWebServerRequest *request);
+    void handleGetTasks(AsyncWebServerRequest *request);
+    void handleGetHeap(AsyncWebServerRequest *request);
+    void handleGetLeakCheck(AsyncWebServerRequest *request);
+    void handleLeakCheck(AsyncWebServerRequest *request);
+    void handleGetProfiler(AsyncWebServerRequest *request);
+    void handleProfiler(AsyncWebServerRequest *request);
+    void handleGetProfile(AsyncWebServerRequest *request);
 };
\ No newline at end of file
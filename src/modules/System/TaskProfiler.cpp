@@ -0,0 +1,360 @@
+//================================================================================
+//| DATEI: TaskProfiler.cpp                                                      |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Implementiert den Task-Profiler. Tasks werden über ihr Handle wiedererkannt; |
+//| verschwindet ein Task, wird sein Slot frei. Ein neu gefundener Task liefert  |
+//| erst ab dem zweiten Intervall CPU-Werte (der erste Zählerstand ist die       |
+//| Basis).                                                                      |
+//================================================================================
+
+#include "TaskProfiler.h"
+#include "../Server/ValueWriter.h"
+#include "../Server/AsyncWebServer.h"
+#include "../Server/OtaPipeline.h"
+#include "EventLog.h"
+#include "ConfigStore.h"
+#include "SystemAPI.h"
+#include "../WiFi/WifiManager.h"
+#include <esp_timer.h>
+#if !TASK_PROFILER_RUNTIME_STATS
+#include <esp_freertos_hooks.h>
+#endif
+
+TaskProfiler taskProfiler;
+
+// Stack-Größen der Tasks, die wir kennen (Namensanfang -> Bytes).
+// Fremde Tasks (WLAN, lwIP, ...) nur, wenn die sdkconfig ihre Größe verrät.
+struct KnownStack {
+    const char* prefix;
+    uint32_t size;
+};
+
+static const KnownStack kKnownStacks[] = {
+#ifdef CONFIG_ARDUINO_LOOP_STACK_SIZE
+    { "loopTask", CONFIG_ARDUINO_LOOP_STACK_SIZE },
+#endif
+    { "httpd", HTTPD_STACK_SIZE },
+    { "httpWorker", WORKER_STACK_SIZE },
+    { "otaWriter", OTA_WRITER_STACK_SIZE },
+    { "eventLog", EVENT_LOG_TASK_STACK },
+    { "config", CONFIG_TASK_STACK },
+    { "health", HEALTH_TASK_STACK },
+    { "wifiMgr", WIFI_TASK_STACK },
+    { "taskProf", TASK_PROFILER_TASK_STACK },
+#ifdef CONFIG_FREERTOS_IDLE_TASK_STACKSIZE
+    { "IDLE", CONFIG_FREERTOS_IDLE_TASK_STACKSIZE },
+#endif
+#ifdef CONFIG_ESP_IPC_TASK_STACK_SIZE
+    { "ipc", CONFIG_ESP_IPC_TASK_STACK_SIZE },
+#endif
+#ifdef CONFIG_ESP_TIMER_TASK_STACK_SIZE
+    { "esp_timer", CONFIG_ESP_TIMER_TASK_STACK_SIZE },
+#endif
+#ifdef CONFIG_LWIP_TCPIP_TASK_STACK_SIZE
+    { "tiT", CONFIG_LWIP_TCPIP_TASK_STACK_SIZE },
+#endif
+#ifdef CONFIG_ESP_SYSTEM_EVENT_TASK_STACK_SIZE
+    { "sys_evt", CONFIG_ESP_SYSTEM_EVENT_TASK_STACK_SIZE },
+#endif
+};
+
+static const char* stateName(uint8_t state) {
+    switch (state) {
+        case 0: return "running";     // eRunning
+        case 1: return "ready";
+        case 2: return "blocked";
+        case 3: return "suspended";
+        default: return "deleted";
+    }
+}
+
+#if !TASK_PROFILER_RUNTIME_STATS
+// false = der IDLE-Task ruft den Hook sofort wieder auf, statt bis zum nächsten
+// Interrupt zu schlafen. Nur so bedeutet eine kurze Pause zwischen zwei Aufrufen
+// "Kern war frei". Weil der Kern dabei voll läuft, nur während einer Abfrage.
+static bool idleHookCore0() { taskProfiler.idleTick(0); return false; }
+static bool idleHookCore1() { taskProfiler.idleTick(1); return false; }
+#endif
+
+// --- Gleitende Fenster ---
+
+void TaskProfiler::Window::reset() {
+    memset(ring, 0, sizeof(ring));
+    pos = 0;
+    count = 0;
+    sumShort = 0;
+    sumLong = 0;
+}
+
+void TaskProfiler::Window::push(uint16_t value) {
+    // Werte, die aus den Fenstern fallen, vor dem Überschreiben abziehen
+    if (count >= TASK_PROFILER_SHORT_WINDOW) {
+        sumShort -= ring[(pos + TASK_PROFILER_WINDOW - TASK_PROFILER_SHORT_WINDOW) % TASK_PROFILER_WINDOW];
+    }
+    if (count == TASK_PROFILER_WINDOW) sumLong -= ring[pos];
+    else count++;
+
+    ring[pos] = value;
+    sumShort += value;
+    sumLong += value;
+    pos = (pos + 1) % TASK_PROFILER_WINDOW;
+}
+
+void TaskProfiler::Window::averages(uint16_t out[3]) const {
+    if (count == 0) {
+        out[0] = out[1] = out[2] = 0;
+        return;
+    }
+    out[0] = ring[(pos + TASK_PROFILER_WINDOW - 1) % TASK_PROFILER_WINDOW];
+    out[1] = sumShort / (count < TASK_PROFILER_SHORT_WINDOW ? count : TASK_PROFILER_SHORT_WINDOW);
+    out[2] = sumLong / count;
+}
+
+// --- Profiler ---
+
+TaskProfiler::TaskProfiler()
+    : _lock(nullptr), _task(nullptr), _primed(false), _lastTotal(0), _samples(0), _untracked(0), _sampleUs(0),
+      _leaseUntilMs(0), _hooked(false), _idleValid(false) {
+    for (size_t i = 0; i < TASK_PROFILER_MAX_TASKS; i++) {
+        _slots[i].handle = nullptr;
+        _slots[i].cpu.reset();
+    }
+    for (uint8_t c = 0; c < TASK_PROFILER_CORES; c++) {
+        _cores[c].reset();
+        _idleUs[c] = 0;
+        _idleLast[c] = 0;
+        _lastIdleUs[c] = 0;
+    }
+}
+
+void TaskProfiler::begin() {
+    if (_task) return;
+    _lock = xSemaphoreCreateMutex();
+    xTaskCreate(samplerTask, "taskProf", TASK_PROFILER_TASK_STACK, this, TASK_PROFILER_TASK_PRIORITY, &_task);
+}
+
+void TaskProfiler::idleTick(uint8_t core) {
+    uint32_t now = (uint32_t)esp_timer_get_time();
+    uint32_t gap = now - _idleLast[core];
+    if (gap < TASK_PROFILER_IDLE_GAP_US) _idleUs[core] = _idleUs[core] + gap;
+    _idleLast[core] = now;
+}
+
+// Nur im Sampler-Task mit _lock. Die Kern-Fenster beginnen jedes Mal neu, damit
+// eine alte Messung nicht mit der neuen vermischt wird.
+void TaskProfiler::setIdleHooks(bool on) {
+#if !TASK_PROFILER_RUNTIME_STATS
+    if (on) {
+        esp_register_freertos_idle_hook_for_cpu(idleHookCore0, 0);
+        esp_register_freertos_idle_hook_for_cpu(idleHookCore1, 1);
+    } else {
+        esp_deregister_freertos_idle_hook_for_cpu(idleHookCore0, 0);
+        esp_deregister_freertos_idle_hook_for_cpu(idleHookCore1, 1);
+    }
+    for (uint8_t c = 0; c < TASK_PROFILER_CORES; c++) _cores[c].reset();
+    _hooked = on;
+    _idleValid = false;
+#endif
+}
+
+uint32_t TaskProfiler::knownStackSize(const char* name) {
+    for (size_t i = 0; i < sizeof(kKnownStacks) / sizeof(kKnownStacks[0]); i++) {
+        if (strncmp(name, kKnownStacks[i].prefix, strlen(kKnownStacks[i].prefix)) == 0) return kKnownStacks[i].size;
+    }
+    return 0;
+}
+
+TaskProfiler::Slot* TaskProfiler::track(TaskHandle_t handle, const char* name, bool& added) {
+    Slot* free = nullptr;
+    for (size_t i = 0; i < TASK_PROFILER_MAX_TASKS; i++) {
+        if (_slots[i].handle == handle) {
+            added = false;
+            return &_slots[i];
+        }
+        if (!free && !_slots[i].handle) free = &_slots[i];
+    }
+    if (!free) return nullptr;
+
+    free->handle = handle;
+    strncpy(free->name, name, sizeof(free->name) - 1);
+    free->name[sizeof(free->name) - 1] = '\0';
+    free->stackSize = knownStackSize(free->name);
+    free->lastCounter = 0;
+    free->cpu.reset();
+    added = true;
+    return free;
+}
+
+void TaskProfiler::sample() {
+#if TASK_PROFILER_TASK_LIST
+    uint32_t started = (uint32_t)esp_timer_get_time();
+    uint32_t total = 0;
+    UBaseType_t n = uxTaskGetSystemState(_status, sizeof(_status) / sizeof(_status[0]), &total);
+#if !TASK_PROFILER_RUNTIME_STATS
+    total = started;                    // Wandzeit in µs für die Idle-Hook-Messung
+#endif
+    uint32_t elapsed = total - _lastTotal;
+    bool measure = _primed && elapsed > 0;
+
+    xSemaphoreTake(_lock, portMAX_DELAY);
+#if !TASK_PROFILER_RUNTIME_STATS
+    bool wanted = (int32_t)(_leaseUntilMs - millis()) > 0;
+    if (wanted != _hooked) setIdleHooks(wanted);
+#endif
+    for (size_t i = 0; i < TASK_PROFILER_MAX_TASKS; i++) _slots[i].seen = false;
+
+    uint32_t untracked = 0;
+    uint16_t idle[TASK_PROFILER_CORES] = {};
+    for (UBaseType_t t = 0; t < n; t++) {
+        const TaskStatus_t& status = _status[t];
+        bool added = false;
+        Slot* slot = track(status.xHandle, status.pcTaskName, added);
+        if (!slot) {
+            untracked++;
+            continue;
+        }
+        slot->seen = true;
+        slot->core = status.xCoreID == tskNO_AFFINITY ? -1 : (int8_t)status.xCoreID;
+        slot->priority = (uint8_t)status.uxCurrentPriority;
+        slot->state = (uint8_t)status.eCurrentState;
+        slot->stackFree = status.usStackHighWaterMark; // StackType_t ist auf dem ESP32 ein Byte
+
+#if TASK_PROFILER_RUNTIME_STATS
+        uint32_t counter = status.ulRunTimeCounter;
+        if (measure && !added) {
+            uint64_t permille = (uint64_t)(counter - slot->lastCounter) * 1000 / elapsed;
+            if (permille > 1000) permille = 1000;
+            slot->cpu.push((uint16_t)permille);
+            for (uint8_t c = 0; c < TASK_PROFILER_CORES; c++) {
+                if (status.xHandle == xTaskGetIdleTaskHandleForCPU(c)) idle[c] = (uint16_t)permille;
+            }
+        }
+        slot->lastCounter = counter;
+#endif
+    }
+
+    // Beendete Tasks geben ihren Slot frei
+    for (size_t i = 0; i < TASK_PROFILER_MAX_TASKS; i++) {
+        if (!_slots[i].seen) _slots[i].handle = nullptr;
+    }
+
+#if TASK_PROFILER_RUNTIME_STATS
+    bool measureCores = measure;
+#else
+    // Ohne Hooks gibt es keine Idle-Zeit; das erste Intervall mit Hooks ist die Basis.
+    bool measureCores = measure && _idleValid;
+    _idleValid = _hooked;
+#endif
+    for (uint8_t c = 0; c < TASK_PROFILER_CORES; c++) {
+#if !TASK_PROFILER_RUNTIME_STATS
+        uint32_t idleUs = _idleUs[c];
+        if (measureCores) {
+            uint64_t permille = (uint64_t)(idleUs - _lastIdleUs[c]) * 1000 / elapsed;
+            idle[c] = permille > 1000 ? 1000 : (uint16_t)permille;
+        }
+        _lastIdleUs[c] = idleUs;
+#endif
+        if (measureCores) _cores[c].push(1000 - idle[c]);
+    }
+
+    _untracked = untracked;
+    _lastTotal = total;
+    _primed = true;
+    _samples++;
+    _sampleUs = (uint32_t)esp_timer_get_time() - started;
+    xSemaphoreGive(_lock);
+#endif
+}
+
+size_t TaskProfiler::snapshot(TaskProfile* out, size_t capacity, uint16_t cores[TASK_PROFILER_CORES][3]) {
+    size_t count = 0;
+    if (!_lock) {
+        memset(cores, 0, sizeof(uint16_t) * 3 * TASK_PROFILER_CORES);
+        return 0;
+    }
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    for (size_t i = 0; i < TASK_PROFILER_MAX_TASKS && count < capacity; i++) {
+        const Slot& slot = _slots[i];
+        if (!slot.handle) continue;
+        TaskProfile& p = out[count++];
+        memcpy(p.name, slot.name, sizeof(p.name));
+        p.core = slot.core;
+        p.priority = slot.priority;
+        p.state = slot.state;
+        p.stackFree = slot.stackFree;
+        p.stackSize = slot.stackSize;
+        slot.cpu.averages(p.cpu);
+    }
+    for (uint8_t c = 0; c < TASK_PROFILER_CORES; c++) _cores[c].averages(cores[c]);
+    xSemaphoreGive(_lock);
+    return count;
+}
+
+void TaskProfiler::writeReport(ValueWriter& out) {
+    _leaseUntilMs = millis() + TASK_PROFILER_IDLE_LEASE_MS;
+    TaskProfile tasks[TASK_PROFILER_MAX_TASKS];
+    uint16_t cores[TASK_PROFILER_CORES][3];
+    size_t count = snapshot(tasks, TASK_PROFILER_MAX_TASKS, cores);
+
+    out.beginObject();
+    out.field("task_list", (bool)TASK_PROFILER_TASK_LIST);
+    out.field("runtime_stats", (bool)TASK_PROFILER_RUNTIME_STATS);
+    // false: noch kein Intervall gemessen (ohne Laufzeitzähler: Hooks hängen erst
+    // seit dieser Abfrage), die Kern-Werte folgen nach 1-2 s
+    out.field("core_load", _cores[0].count > 0);
+    out.field("interval_ms", TASK_PROFILER_INTERVAL_MS);
+    out.key("windows_s");
+    out.beginArray(3);
+    out.value(TASK_PROFILER_INTERVAL_MS / 1000);
+    out.value(TASK_PROFILER_SHORT_WINDOW * TASK_PROFILER_INTERVAL_MS / 1000);
+    out.value(TASK_PROFILER_WINDOW * TASK_PROFILER_INTERVAL_MS / 1000);
+    out.endArray();
+    out.field("samples", (unsigned long)_samples);
+    out.field("sample_us", (unsigned long)_sampleUs);
+    out.field("untracked", (unsigned long)_untracked);
+
+    // Auslastung in Prozent je Kern und Fenster
+    out.key("cores");
+    out.beginArray(TASK_PROFILER_CORES);
+    for (uint8_t c = 0; c < TASK_PROFILER_CORES; c++) {
+        out.beginArray(3);
+        for (uint8_t w = 0; w < 3; w++) out.value(cores[c][w] / 10.0f, 1);
+        out.endArray();
+    }
+    out.endArray();
+
+    out.key("tasks");
+    out.beginArray(count);
+    for (size_t i = 0; i < count; i++) {
+        const TaskProfile& p = tasks[i];
+        out.beginObject(TASK_PROFILER_RUNTIME_STATS ? 7 : 6);
+        out.field("name", p.name);
+        out.field("core", (int)p.core);
+        out.field("prio", (unsigned)p.priority);
+        out.field("state", stateName(p.state));
+        out.field("stack_free", (unsigned long)p.stackFree);
+        out.field("stack_size", (unsigned long)p.stackSize);
+#if TASK_PROFILER_RUNTIME_STATS
+        // Prozent eines Kerns (alle Tasks zusammen ergeben bis zu 200 %)
+        out.key("cpu");
+        out.beginArray(3);
+        for (uint8_t w = 0; w < 3; w++) out.value(p.cpu[w] / 10.0f, 1);
+        out.endArray();
+#endif
+        out.endObject();
+    }
+    out.endArray();
+    out.endObject();
+}
+
+void TaskProfiler::samplerTask(void* arg) {
+    TaskProfiler* self = (TaskProfiler*)arg;
+    TickType_t wake = xTaskGetTickCount();
+    for (;;) {
+        self->sample();
+        vTaskDelayUntil(&wake, pdMS_TO_TICKS(TASK_PROFILER_INTERVAL_MS));
+    }
+}
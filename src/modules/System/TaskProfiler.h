@@ -0,0 +1,161 @@
+//================================================================================
+//| DATEI: TaskProfiler.h                                                        |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Laufzeit- und Stack-Profil aller FreeRTOS-Tasks (loopTask, httpd, WLAN, ...).|
+//| Ein eigener Task liest jede Sekunde uxTaskGetSystemState() und berechnet je  |
+//| Task den CPU-Anteil im letzten Intervall, über 10 s und über 60 s, sowie die |
+//| Auslastung jedes Kerns (100 % minus Anteil seines IDLE-Tasks).               |
+//| Dazu kommt je Task der kleinste freie Stack seit dem Start (High-Water-Mark),|
+//| bei bekannten Tasks auch die Stack-Größe.                                    |
+//|                                                                              |
+//| OHNE LAUFZEITZÄHLER: Der vorkompilierte Arduino-Core ist ohne                |
+//| configGENERATE_RUN_TIME_STATS gebaut. Dann fehlt der CPU-Anteil je Task; die |
+//| Kern-Auslastung wird über einen Idle-Hook gemessen (Zeit, in der der IDLE-   |
+//| Task ohne Unterbrechung läuft). Der Hook lässt den Kern dafür im Leerlauf    |
+//| kreisen statt zu schlafen, deshalb hängt er nur, solange jemand              |
+//| /api/system/tasks abfragt (bis TASK_PROFILER_IDLE_LEASE_MS danach).          |
+//================================================================================
+
+#pragma once
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+
+class ValueWriter;
+
+#define TASK_PROFILER_MAX_TASKS      24    // weitere Tasks werden nur gezählt
+#define TASK_PROFILER_INTERVAL_MS    1000
+#define TASK_PROFILER_WINDOW         60    // Intervalle im langen Fenster
+#define TASK_PROFILER_SHORT_WINDOW   10    // Intervalle im kurzen Fenster
+#define TASK_PROFILER_IDLE_GAP_US    50    // längere Pausen im Idle-Hook = andere Arbeit
+#define TASK_PROFILER_IDLE_LEASE_MS  30000 // Idle-Hooks so lange nach der letzten Abfrage
+#define TASK_PROFILER_CORES          2
+#define TASK_PROFILER_TASK_STACK     3072
+#define TASK_PROFILER_TASK_PRIORITY  1
+
+#if defined(configUSE_TRACE_FACILITY) && configUSE_TRACE_FACILITY
+#define TASK_PROFILER_TASK_LIST      1
+#else
+#define TASK_PROFILER_TASK_LIST      0
+#endif
+
+#if TASK_PROFILER_TASK_LIST && defined(configGENERATE_RUN_TIME_STATS) && configGENERATE_RUN_TIME_STATS
+#define TASK_PROFILER_RUNTIME_STATS  1
+#else
+#define TASK_PROFILER_RUNTIME_STATS  0
+#endif
+
+/**
+ * @brief Stand eines Tasks für die Ausgabe (Kopie, unabhängig vom Sampler).
+ * CPU-Werte in Promille eines Kerns: letztes Intervall, kurzes und langes Fenster.
+ */
+struct TaskProfile {
+    char name[16];
+    int8_t core;                // -1 = auf keinen Kern festgelegt
+    uint8_t priority;
+    uint8_t state;              // eTaskState
+    uint32_t stackFree;         // kleinster freier Stack seit Start (Bytes)
+    uint32_t stackSize;         // 0 = unbekannt
+    uint16_t cpu[3];
+};
+
+/**
+ * @class TaskProfiler
+ * @brief Periodisches Profil aller Tasks mit gleitenden Fenstern.
+ *
+ * Nur der Sampler-Task schreibt; snapshot() kopiert die fertigen Mittelwerte
+ * unter einem Mutex, die Fenster werden dabei nicht neu aufsummiert.
+ */
+class TaskProfiler {
+public:
+    TaskProfiler();
+
+    /**
+     * @brief Startet den Sampler-Task. Die Idle-Hooks hängt erst die erste Abfrage ein.
+     */
+    void begin();
+
+    /**
+     * @brief Ein Messintervall auswerten. Läuft im Sampler-Task.
+     */
+    void sample();
+
+    /**
+     * @brief Kopiert alle erfassten Tasks und die Kern-Auslastung (Promille).
+     * @return Anzahl Einträge in `out`.
+     */
+    size_t snapshot(TaskProfile* out, size_t capacity, uint16_t cores[TASK_PROFILER_CORES][3]);
+
+    /**
+     * @brief Antwort für GET /api/system/tasks (Kerne, Tasks, Fenstergrößen).
+     * Verlängert ohne Laufzeitzähler die Messung der Kern-Auslastung.
+     */
+    void writeReport(ValueWriter& out);
+
+    /**
+     * @brief Vom Idle-Hook des Kerns aufgerufen (nur ohne Laufzeitzähler).
+     */
+    void idleTick(uint8_t core);
+
+private:
+    // Gleitende Fenster über die Werte je Intervall, Summen laufen mit.
+    struct Window {
+        uint16_t ring[TASK_PROFILER_WINDOW];
+        uint8_t pos;
+        uint8_t count;
+        uint32_t sumShort;
+        uint32_t sumLong;
+
+        void reset();
+        void push(uint16_t value);
+        void averages(uint16_t out[3]) const;
+    };
+
+    struct Slot {
+        TaskHandle_t handle;    // nullptr = frei
+        char name[16];
+        int8_t core;
+        uint8_t priority;
+        uint8_t state;
+        bool seen;
+        uint32_t stackFree;
+        uint32_t stackSize;
+        uint32_t lastCounter;
+        Window cpu;
+    };
+
+    Slot _slots[TASK_PROFILER_MAX_TASKS];
+    Window _cores[TASK_PROFILER_CORES];
+    SemaphoreHandle_t _lock;
+    TaskHandle_t _task;
+    bool _primed;
+    uint32_t _lastTotal;        // Laufzeitzähler bzw. esp_timer (µs) beim letzten Intervall
+    uint32_t _samples;
+    uint32_t _untracked;        // Tasks ohne freien Slot im letzten Intervall
+    uint32_t _sampleUs;         // Dauer des letzten Intervalls im Sampler
+
+    // Idle-Hook: zusammenhängende Leerlaufzeit je Kern (nur ohne Laufzeitzähler)
+    volatile uint32_t _idleUs[TASK_PROFILER_CORES];
+    volatile uint32_t _idleLast[TASK_PROFILER_CORES];
+    uint32_t _lastIdleUs[TASK_PROFILER_CORES];
+    volatile uint32_t _leaseUntilMs;    // Hooks bis hier eingehängt lassen (millis)
+    bool _hooked;
+    bool _idleValid;                    // Basis für die Idle-Zeit steht (Hooks hingen ein Intervall)
+
+#if TASK_PROFILER_TASK_LIST
+    TaskStatus_t _status[TASK_PROFILER_MAX_TASKS + 8];
+#endif
+
+    Slot* track(TaskHandle_t handle, const char* name, bool& added);
+    void setIdleHooks(bool on);
+    static uint32_t knownStackSize(const char* name);
+    static void samplerTask(void* arg);
+};
+
+// Eine Instanz für alle Module (wie eventLog).
+extern TaskProfiler taskProfiler;
@@ -6,12 +6,12 @@
 //| ZWECK:                                                                       |
 //| Implementiert die Logik zum Verarbeiten der HTTP-Anfrage zum Speichern von   |
 //| WLAN-Zugangsdaten. Die Klasse extrahiert SSID und Passwort aus der Anfrage,  |
-//| speichert sie persistent im NVS (Non-Volatile Storage) und leitet einen      |
-//| Neustart des Geräts ein.                                                     |
+//| übergibt sie dem ConfigStore, der sie persistent im NVS (Non-Volatile        |
+//| Storage) ablegt, und leitet einen Neustart des Geräts ein.                   |
 //================================================================================
 
 #include "WifiApiHandler.h"
-#include <Preferences.h> // Notwendig für das Speichern der Daten im NVS.
+#include "../System/ConfigStore.h" // Speichert die Daten im NVS (Namespace "wifi_creds").
 
 /**
  * @brief Konstruktor-Implementierung.
@@ -33,23 +33,23 @@ void WifiApiHandler::registerRoutes(AsyncWebServer& server) {
 void WifiApiHandler::handleSaveCredentials(AsyncWebServerRequest *request) {
     // Prüft, ob die erwarteten Parameter "ssid" und "password" in der Anfrage enthalten sind.
     if (request->hasParam("ssid") && request->hasParam("password")) {
-        String ssid = request->arg("ssid");
-        String password = request->arg("password");
-
-        // Die Logik zum Speichern der Daten im nicht-flüchtigen Speicher (NVS).
-        // Ein noch sauberer Ansatz wäre, eine Methode `_wifiManager.saveCredentials(ssid, password)`
-        // aufzurufen, um die Logik vollständig im WifiManager zu kapseln.
-        Preferences preferences;
-        preferences.begin("wifi_creds", false); // Namespace "wifi_creds" im Schreibmodus öffnen.
-        preferences.putString("ssid", ssid);
-        preferences.putString("password", password);
-        preferences.end(); // Namespace schließen und Änderungen speichern.
+        // Beide Werte prüfen (Länge) und gemeinsam übernehmen.
+        ConfigValue values[2];
+        const char* error = nullptr;
+        size_t errorIndex = 0;
+        if (!ConfigStore::parse(CFG_WIFI_SSID, request->argPtr("ssid"), values[0], error) ||
+            !ConfigStore::parse(CFG_WIFI_PASSWORD, request->argPtr("password"), values[1], error) ||
+            configStore.setMany(values, 2, errorIndex, error) < 0) {
+            request->send(400, "text/plain", String("Ungültige Daten: ") + error);
+            return;
+        }
+        // Nicht auf den verzögerten Commit warten - gleich folgt der Neustart.
+        configStore.commit();
         Serial.println("WLAN-Daten im NVS gespeichert.");
 
         // Bestätigung an den Client senden und Neustart einleiten, damit die neuen Daten verwendet werden.
         request->send(200, "text/plain", "Daten gespeichert. ESP32 startet neu.");
-        delay(1000);
-        ESP.restart();
+        request->defer([]() { ESP.restart(); }, 1000);
     } else {
         // Wenn Parameter fehlen, wird ein "Bad Request"-Fehler (400) gesendet.
         request->send(400, "text/plain", "Fehlende Daten.");
@@ -8,55 +8,321 @@
 //| das Auslesen gespeicherter Zugangsdaten aus dem NVS, den Verbindungsaufbau,  |
 //| das Starten des Konfigurations-Access-Points und das zeitgesteuerte          |
 //| Deaktivieren des APs nach erfolgreicher Verbindung.                          |
+//|                                                                              |
+//| Der Ereignis-Handler läuft im Event-Task des Arduino-Cores und setzt nur     |
+//| Bits für den WLAN-Task. Alle WiFi-Aufrufe nach setup() kommen aus step().    |
+//| Auch der Schnellstart-Cache wird nur dort geschrieben, und nur wenn sich     |
+//| BSSID, Kanal oder IP geändert haben.                                         |
 //================================================================================
 
 #include "WifiManager.h"
 #include "../../config.h" // Für globale Konfigurationen wie AP_SSID
-#include <Preferences.h>
+#include "../System/ConfigStore.h"
+#include "../System/EventLog.h"
+#include "../System/HeapTrace.h"
 #include <esp_wifi.h>  // Für erweiterte WLAN-Funktionen
 
+// Für den statischen Ereignis-Handler (es gibt nur einen WifiManager).
+static WifiManager* s_instance = nullptr;
+
+#define WIFI_FAST_NAMESPACE "wifi_fast"
+#define WIFI_FAST_KEY       "last"
+#define WIFI_FAST_VERSION   1
+
 /**
  * @brief Konstruktor-Implementierung. Initialisiert die Member-Variablen.
  */
-WifiManager::WifiManager() : _apStopTime(0), _apShouldBeDisabled(false) {}
+WifiManager::WifiManager()
+    : _apStopTime(0), _apShouldBeDisabled(false), _task(nullptr), _eventReason(0), _attemptStart(0), _retryAt(0),
+      _lostSince(0), _fastValid(false), _fastNext(false), _attemptFast(false), _staticIp(false) {
+    _lock = portMUX_INITIALIZER_UNLOCKED;
+    memset(&_fast, 0, sizeof(_fast));
+    memset(&_stats, 0, sizeof(_stats));
+    _stats.state = WIFI_STATE_IDLE;
+    _stats.backoffMs = WIFI_BACKOFF_MIN_MS;
+}
 
 /**
  * @brief Initialisiert das WLAN.
  */
 void WifiManager::setup() {
-    Preferences preferences;
-    // Öffne den NVS-Namespace "wifi_creds". 'false' bedeutet Lese-/Schreibzugriff.
-    preferences.begin("wifi_creds", false);
-    // Lese SSID und Passwort aus NVS. Wenn die Schlüssel nicht existieren, wird ein leerer String zurückgegeben.
-    String ssid = preferences.getString("ssid", "");
-    String password = preferences.getString("password", "");
-    preferences.end(); // Schließe den Namespace.
+    if (_task) return;
+    s_instance = this;
 
+    // Zugangsdaten liegen im ConfigStore; der WLAN-Treiber soll sie nicht
+    // zusätzlich bei jedem Versuch in seinen NVS-Bereich schreiben.
+    WiFi.persistent(false);
+    // Wiederverbinden übernimmt der Zustandsautomat (mit Pause), nicht der Core.
+    WiFi.setAutoReconnect(false);
     // Setze den Hostnamen des Geräts im Netzwerk.
     WiFi.setHostname(HOSTNAME);
     // Starte im kombinierten Modus (Station + Access Point).
     WiFi.mode(WIFI_AP_STA);
-    
+
     // Starte immer den Access Point, damit das Gerät erreichbar ist.
     startAP();
 
-    // Wenn eine SSID gespeichert ist, versuche, dich damit zu verbinden.
-    if (ssid.length() > 0) {
-        connectToWifi(ssid, password);
+    // SSID und Passwort liegen bereits im RAM des ConfigStores (geladen aus dem
+    // NVS-Namespace "wifi_creds"). Fehlen sie, sind beide leer.
+    char ssid[CONFIG_STRING_MAX + 1];
+    configStore.getString(CFG_WIFI_SSID, ssid, sizeof(ssid));
+    if (ssid[0] != '\0') {
+        // Erster Versuch sofort im ersten Schritt des Tasks, wenn möglich gezielt
+        loadFastCache();
+        _fastNext = _fastValid;
+        _retryAt = millis();
+        setState(WIFI_STATE_BACKOFF);
     } else {
         Serial.println("Keine WLAN-Daten gefunden. Nur AP-Modus aktiv.");
     }
+
+    WiFi.onEvent(onWifiEvent);
+    xTaskCreate(wifiTask, "wifiMgr", WIFI_TASK_STACK, this, WIFI_TASK_PRIORITY, &_task);
+}
+
+void WifiManager::onWifiEvent(arduino_event_id_t event, arduino_event_info_t info) {
+    WifiManager* self = s_instance;
+    if (!self || !self->_task) return;
+    switch (event) {
+        case ARDUINO_EVENT_WIFI_STA_GOT_IP:
+            xTaskNotify(self->_task, WIFI_NOTIFY_GOT_IP, eSetBits);
+            break;
+        case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
+            self->_eventReason = info.wifi_sta_disconnected.reason;
+            xTaskNotify(self->_task, WIFI_NOTIFY_LOST, eSetBits);
+            break;
+        case ARDUINO_EVENT_WIFI_STA_LOST_IP:
+            xTaskNotify(self->_task, WIFI_NOTIFY_LOST, eSetBits);
+            break;
+        default:
+            break;
+    }
+}
+
+void WifiManager::wifiTask(void* arg) {
+    WifiManager* self = (WifiManager*)arg;
+    for (;;) {
+        uint32_t events = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &events, pdMS_TO_TICKS(WIFI_STEP_MS));
+        HeapScope heapScope(HEAP_WIFI);
+        self->step(events, millis());
+    }
+}
+
+/**
+ * @brief Ein Schritt des Zustandsautomaten: erst die Ereignisse, dann die Zeitgeber.
+ */
+void WifiManager::step(uint32_t events, uint32_t nowMs) {
+    WifiState state = _stats.state;
+
+    // Trennung zuerst: Kamen beide Ereignisse, entscheidet danach der echte Zustand.
+    if (events & WIFI_NOTIFY_LOST) {
+        if (state == WIFI_STATE_CONNECTED) {
+            uint8_t reason = _eventReason;
+            portENTER_CRITICAL(&_lock);
+            _stats.drops++;
+            _stats.lastReason = reason;
+            _stats.backoffMs = WIFI_BACKOFF_MIN_MS;
+            portEXIT_CRITICAL(&_lock);
+            Serial.print("WLAN-Verbindung verloren, Grund ");
+            Serial.println(reason);
+            eventLog.log(EVENT_WARN, EVT_WIFI_LOST, {reason});
+            _lostSince = nowMs;
+            _apShouldBeDisabled = false;
+            _fastNext = _fastValid;     // meist ist derselbe AP gleich wieder da
+            _attemptStart = nowMs;
+            _retryAt = nowMs + WIFI_BACKOFF_MIN_MS;
+            setState(WIFI_STATE_BACKOFF);
+        } else if (state == WIFI_STATE_CONNECTING) {
+            attemptFailed(nowMs);
+        }
+        // In BACKOFF/IDLE stammt die Meldung vom eigenen disconnect()
+    }
+
+    if ((events & WIFI_NOTIFY_GOT_IP) && _stats.state != WIFI_STATE_CONNECTED && isStationConnected()) {
+        uint32_t took = nowMs - _attemptStart;
+        portENTER_CRITICAL(&_lock);
+        _stats.lastConnectMs = took;
+        if (took > _stats.maxConnectMs) _stats.maxConnectMs = took;
+        _stats.backoffMs = WIFI_BACKOFF_MIN_MS;
+        _stats.lastPath = _attemptFast ? WIFI_PATH_FAST : WIFI_PATH_FULL;
+        if (_attemptFast) {
+            _stats.fastOk++;
+            _stats.fastConnectMs = took;
+        } else {
+            _stats.fullConnectMs = took;
+        }
+        portEXIT_CRITICAL(&_lock);
+        setState(WIFI_STATE_CONNECTED);
+        _lostSince = 0;
+
+        Serial.print("Erfolgreich mit WLAN verbunden nach ");
+        Serial.print(took);
+        Serial.print(_attemptFast ? " ms (gezielt), IP-Adresse: " : " ms, IP-Adresse: ");
+        Serial.println(WiFi.localIP());
+        eventLog.log(EVENT_INFO, EVT_WIFI_CONNECTED, {(int32_t)took, _attemptFast ? 1 : 0});
+        saveFastCache();
+        // Setze den Timer, um den AP in 5 Minuten abzuschalten.
+        if (apActive()) {
+            _apStopTime = nowMs + AP_TIMEOUT_MS;
+            _apShouldBeDisabled = true;
+        }
+    }
+
+    switch (_stats.state) {
+        case WIFI_STATE_CONNECTING:
+            if (nowMs - _attemptStart >= (_attemptFast ? WIFI_FAST_TIMEOUT_MS : WIFI_CONNECT_TIMEOUT_MS)) {
+                WiFi.disconnect();
+                attemptFailed(nowMs);
+            }
+            break;
+        case WIFI_STATE_BACKOFF:
+            if ((int32_t)(nowMs - _retryAt) >= 0) beginAttempt(nowMs);
+            break;
+        case WIFI_STATE_CONNECTED:
+            // Prüfe, ob der AP-Abschalt-Timer abgelaufen ist.
+            if (_apShouldBeDisabled && (int32_t)(nowMs - _apStopTime) >= 0) {
+                stopAP();
+                _apShouldBeDisabled = false; // Verhindert mehrfaches Ausführen
+            }
+            break;
+        default:
+            break;
+    }
+
+    // Station zu lange weg: AP wieder einschalten, damit das Gerät erreichbar bleibt.
+    if (_lostSince != 0 && nowMs - _lostSince >= WIFI_AP_FALLBACK_MS && !apActive()) {
+        WiFi.mode(WIFI_AP_STA);
+        startAP();
+        eventLog.log(EVENT_INFO, EVT_WIFI_AP, {1});
+    }
+}
+
+/**
+ * @brief Startet einen Verbindungsversuch (kehrt sofort zurück, das Ergebnis
+ * kommt als Ereignis). Die Zugangsdaten werden jedes Mal frisch gelesen.
+ * Gezielt nur, wenn der Cache zur aktuellen SSID passt.
+ */
+void WifiManager::beginAttempt(uint32_t nowMs) {
+    char ssid[CONFIG_STRING_MAX + 1];
+    char password[CONFIG_STRING_MAX + 1];
+    configStore.getString(CFG_WIFI_SSID, ssid, sizeof(ssid));
+    configStore.getString(CFG_WIFI_PASSWORD, password, sizeof(password));
+    if (ssid[0] == '\0') {
+        setState(WIFI_STATE_IDLE);
+        return;
+    }
+
+    _attemptFast = _fastNext && _fastValid && strcmp(ssid, _fast.ssid) == 0;
+    _fastNext = false;
+    bool reuseIp = _attemptFast && configStore.getBool(CFG_WIFI_IP_REUSE) && _fast.ip != 0;
+
+    // Statische IP nur für einen gezielten Versuch mit ip_reuse, sonst DHCP
+    if (reuseIp) {
+        WiFi.config(IPAddress(_fast.ip), IPAddress(_fast.gateway), IPAddress(_fast.mask), IPAddress(_fast.dns));
+        _staticIp = true;
+    } else if (_staticIp) {
+        WiFi.config(IPAddress(), IPAddress(), IPAddress());
+        _staticIp = false;
+    }
+
+    Serial.print("Verbinde mit WLAN: ");
+    Serial.print(ssid);
+    if (_attemptFast) {
+        Serial.print(" (gezielt, Kanal ");
+        Serial.print(_fast.channel);
+        Serial.print(reuseIp ? ", alte IP)" : ")");
+    }
+    Serial.println();
+    _attemptStart = nowMs;
+    _eventReason = 0;
+    portENTER_CRITICAL(&_lock);
+    _stats.attempts++;
+    portEXIT_CRITICAL(&_lock);
+    setState(WIFI_STATE_CONNECTING);
+    if (_attemptFast) {
+        WiFi.begin(ssid, password, _fast.channel, _fast.bssid);
+    } else {
+        WiFi.begin(ssid, password);
+    }
 }
 
 /**
- * @brief Hauptschleifen-Funktion für den WifiManager.
+ * @brief Versuch gescheitert: nächster Versuch nach der aktuellen Pause, die
+ * sich danach bis WIFI_BACKOFF_MAX_MS verdoppelt.
  */
-void WifiManager::loop() {
-    // Prüfe, ob der AP-Abschalt-Timer abgelaufen ist.
-    if (_apShouldBeDisabled && millis() > _apStopTime) {
-        stopAP();
-        _apShouldBeDisabled = false; // Verhindert mehrfaches Ausführen
+void WifiManager::attemptFailed(uint32_t nowMs) {
+    uint8_t reason = _eventReason;
+    if (_attemptFast) {
+        // AP umgezogen, anderer Kanal oder IP vergeben: sofort normal mit Scan
+        portENTER_CRITICAL(&_lock);
+        _stats.fastFailed++;
+        if (reason) _stats.lastReason = reason;
+        portEXIT_CRITICAL(&_lock);
+        Serial.println("Gezielte Verbindung fehlgeschlagen, versuche es mit Scan.");
+        _attemptFast = false;
+        _retryAt = nowMs;
+        setState(WIFI_STATE_BACKOFF);
+        return;
     }
+    portENTER_CRITICAL(&_lock);
+    uint32_t wait = _stats.backoffMs;
+    _stats.failures++;
+    if (reason) _stats.lastReason = reason;
+    _stats.backoffMs = wait * 2 > WIFI_BACKOFF_MAX_MS ? WIFI_BACKOFF_MAX_MS : wait * 2;
+    portEXIT_CRITICAL(&_lock);
+
+    Serial.print("Verbindung zum WLAN fehlgeschlagen, nächster Versuch in ");
+    Serial.print(wait);
+    Serial.println(" ms.");
+    _retryAt = nowMs + wait;
+    setState(WIFI_STATE_BACKOFF);
+}
+
+void WifiManager::setState(WifiState state) {
+    portENTER_CRITICAL(&_lock);
+    _stats.state = state;
+    portEXIT_CRITICAL(&_lock);
+}
+
+/**
+ * @brief Liest die zuletzt erfolgreiche Verbindung aus dem NVS.
+ */
+void WifiManager::loadFastCache() {
+    Preferences preferences;
+    preferences.begin(WIFI_FAST_NAMESPACE, true);
+    WifiFastCache cache;
+    size_t len = preferences.getBytes(WIFI_FAST_KEY, &cache, sizeof(cache));
+    preferences.end();
+    _fastValid = len == sizeof(cache) && cache.version == WIFI_FAST_VERSION && cache.channel != 0;
+    if (_fastValid) _fast = cache;
+}
+
+/**
+ * @brief Merkt sich BSSID, Kanal und IP-Konfiguration der stehenden Verbindung.
+ * Geschrieben wird nur, wenn sich etwas geändert hat.
+ */
+void WifiManager::saveFastCache() {
+    WifiFastCache cache;
+    memset(&cache, 0, sizeof(cache));   // Füllbytes definiert, damit memcmp greift
+    const uint8_t* bssid = WiFi.BSSID();
+    if (!bssid) return;
+    cache.version = WIFI_FAST_VERSION;
+    snprintf(cache.ssid, sizeof(cache.ssid), "%s", WiFi.SSID().c_str());
+    memcpy(cache.bssid, bssid, sizeof(cache.bssid));
+    cache.channel = (uint8_t)WiFi.channel();
+    cache.ip = (uint32_t)WiFi.localIP();
+    cache.gateway = (uint32_t)WiFi.gatewayIP();
+    cache.mask = (uint32_t)WiFi.subnetMask();
+    cache.dns = (uint32_t)WiFi.dnsIP(0);
+    if (_fastValid && memcmp(&cache, &_fast, sizeof(cache)) == 0) return;
+
+    Preferences preferences;
+    preferences.begin(WIFI_FAST_NAMESPACE, false);
+    preferences.putBytes(WIFI_FAST_KEY, &cache, sizeof(cache));
+    preferences.end();
+    _fast = cache;
+    _fastValid = cache.channel != 0;
 }
 
 /**
@@ -70,35 +336,6 @@ void WifiManager::startAP() {
     Serial.println(WiFi.softAPIP());
 }
 
-/**
- * @brief Verbindet sich mit einem gegebenen WLAN.
- */
-void WifiManager::connectToWifi(const String& ssid, const String& password) {
-    Serial.print("Verbinde mit WLAN: ");
-    Serial.println(ssid);
-    WiFi.begin(ssid.c_str(), password.c_str());
-
-    // Warte maximal 10 Sekunden auf eine Verbindung.
-    int attempts = 0;
-    while (WiFi.status() != WL_CONNECTED && attempts < 20) {
-        delay(500);
-        Serial.print(".");
-        attempts++;
-    }
-
-    if (WiFi.status() == WL_CONNECTED) {
-        Serial.println("\nErfolgreich mit WLAN verbunden.");
-        Serial.print("IP-Adresse: ");
-        Serial.println(WiFi.localIP());
-        // Setze den Timer, um den AP in 5 Minuten abzuschalten.
-        _apStopTime = millis() + AP_TIMEOUT_MS;
-        _apShouldBeDisabled = true;
-    } else {
-        Serial.println("\nVerbindung zum WLAN fehlgeschlagen.");
-        WiFi.disconnect(true); // Alte Konfiguration löschen
-    }
-}
-
 /**
  * @brief Deaktiviert den Access Point, um Strom zu sparen.
  */
@@ -107,9 +344,14 @@ void WifiManager::stopAP() {
         WiFi.softAPdisconnect(true);
         WiFi.mode(WIFI_STA); // Wechsle in den reinen Station-Modus
         Serial.println("Access Point wurde deaktiviert.");
+        eventLog.log(EVENT_INFO, EVT_WIFI_AP, {0});
     }
 }
 
+bool WifiManager::apActive() {
+    return WiFi.getMode() == WIFI_AP || WiFi.getMode() == WIFI_AP_STA;
+}
+
 // --- Implementierung der Getter-Funktionen ---
 
 bool WifiManager::isStationConnected() {
@@ -130,4 +372,27 @@ String WifiManager::getMode() {
     if (isStationConnected()) return "Station";
     if (apActive) return "Access Point";
     return "Inaktiv";
-}
\ No newline at end of file
+}
+
+void WifiManager::getStats(WifiStats& stats) {
+    portENTER_CRITICAL(&_lock);
+    stats = _stats;
+    portEXIT_CRITICAL(&_lock);
+}
+
+const char* WifiManager::pathName(WifiConnectPath path) {
+    switch (path) {
+        case WIFI_PATH_FAST: return "fast";
+        case WIFI_PATH_FULL: return "full";
+        default:             return "none";
+    }
+}
+
+const char* WifiManager::stateName(WifiState state) {
+    switch (state) {
+        case WIFI_STATE_CONNECTING: return "connecting";
+        case WIFI_STATE_CONNECTED:  return "connected";
+        case WIFI_STATE_BACKOFF:    return "backoff";
+        default:                    return "idle";
+    }
+}
@@ -8,6 +8,20 @@
 //| um den Start des Access Points (AP), die Verbindung zu einem gespeicherten   |
 //| Netzwerk (Station-Modus) und stellt Methoden zur Abfrage des aktuellen       |
 //| Netzwerkstatus bereit.                                                       |
+//|                                                                              |
+//| ZUSTANDSAUTOMAT: Die Verbindung läuft in einem eigenen Task, angestoßen von  |
+//| den WLAN-Ereignissen (GOT_IP, DISCONNECTED) und einem Zeitraster. Nichts     |
+//| davon wartet in der Hauptschleife. Ein Versuch, der nicht innerhalb von      |
+//| WIFI_CONNECT_TIMEOUT_MS eine IP bekommt, gilt als gescheitert; danach wird   |
+//| mit wachsender Pause (1 s, 2 s, 4 s, ... bis 60 s) erneut versucht, auch     |
+//| nach einem Verbindungsabbruch. Ist die Station länger als                    |
+//| WIFI_AP_FALLBACK_MS getrennt, geht der Access Point wieder an.               |
+//|                                                                              |
+//| SCHNELLSTART: Nach jeder erfolgreichen Verbindung werden BSSID, Kanal und    |
+//| IP-Konfiguration im NVS (Namespace "wifi_fast") gemerkt. Nach einem Neustart |
+//| oder Abbruch wird zuerst gezielt dieser Access Point auf diesem Kanal        |
+//| angesprochen (kein Scan), mit "ip_reuse" auch ohne DHCP mit der alten IP.    |
+//| Scheitert das, folgt sofort ein normaler Versuch mit Scan und DHCP.          |
 //================================================================================
 
 #pragma once
@@ -15,6 +29,65 @@
 #include <WiFi.h>
 #include <Preferences.h>
 
+#define WIFI_CONNECT_TIMEOUT_MS   15000  // ein Verbindungsversuch bis zur IP
+#define WIFI_FAST_TIMEOUT_MS      5000   // gezielter Versuch mit gemerkter BSSID
+#define WIFI_BACKOFF_MIN_MS       1000
+#define WIFI_BACKOFF_MAX_MS       60000
+#define WIFI_AP_FALLBACK_MS       20000  // so lange ohne Station, dann AP wieder an
+#define WIFI_STEP_MS              250    // Zeitraster des Tasks ohne Ereignis
+#define WIFI_TASK_STACK           4096
+#define WIFI_TASK_PRIORITY        1
+
+// Benachrichtigungs-Bits vom Ereignis-Handler an den WLAN-Task
+#define WIFI_NOTIFY_GOT_IP        (1u << 0)
+#define WIFI_NOTIFY_LOST          (1u << 1)
+
+enum WifiState : uint8_t {
+    WIFI_STATE_IDLE,            // keine Zugangsdaten, nur AP
+    WIFI_STATE_CONNECTING,      // Versuch läuft
+    WIFI_STATE_CONNECTED,       // Station hat eine IP
+    WIFI_STATE_BACKOFF          // Pause bis zum nächsten Versuch
+};
+
+enum WifiConnectPath : uint8_t {
+    WIFI_PATH_NONE,
+    WIFI_PATH_FAST,             // gemerkte BSSID und Kanal, ohne Scan
+    WIFI_PATH_FULL              // Scan und DHCP
+};
+
+/**
+ * @brief Zuletzt erfolgreiche Verbindung, wie sie im NVS liegt (IPs in Netzwerk-Byte-Reihenfolge).
+ */
+struct WifiFastCache {
+    uint8_t version;
+    char ssid[33];
+    uint8_t bssid[6];
+    uint8_t channel;
+    uint32_t ip;
+    uint32_t gateway;
+    uint32_t mask;
+    uint32_t dns;
+};
+
+/**
+ * @brief Zähler der Verbindungsverwaltung (für /api/system/health).
+ */
+struct WifiStats {
+    WifiState state;
+    WifiConnectPath lastPath;   // Weg der letzten erfolgreichen Verbindung
+    uint8_t lastReason;         // letzter Trenngrund (wifi_err_reason_t), 0 = keiner
+    uint32_t attempts;          // gestartete Verbindungsversuche
+    uint32_t failures;          // davon gescheitert
+    uint32_t drops;             // Abbrüche einer stehenden Verbindung
+    uint32_t lastConnectMs;     // Dauer des letzten erfolgreichen Versuchs
+    uint32_t maxConnectMs;
+    uint32_t backoffMs;         // Pause vor dem nächsten Versuch
+    uint32_t fastOk;            // gezielte Versuche mit Erfolg
+    uint32_t fastFailed;        // gezielte Versuche ohne Erfolg (danach Scan)
+    uint32_t fastConnectMs;     // Dauer bis zur IP, letzter gezielter Versuch
+    uint32_t fullConnectMs;     // Dauer bis zur IP, letzter Versuch mit Scan
+};
+
 /**
  * @class WifiManager
  * @brief Verwaltet die WLAN-Konnektivität des ESP32.
@@ -31,16 +104,11 @@ public:
     WifiManager();
 
     /**
-     * @brief Initialisiert den WLAN-Modus. Liest gespeicherte Daten und startet AP oder STA.
+     * @brief Initialisiert den WLAN-Modus, startet den AP und den Verbindungs-Task.
+     * Der erste Verbindungsversuch läuft bereits im Task, setup() kehrt sofort zurück.
      */
     void setup();
 
-    /**
-     * @brief Wird in der Hauptschleife aufgerufen, um zeitgesteuerte Aufgaben zu erledigen.
-     * Insbesondere das Deaktivieren des AP nach einer gewissen Zeit.
-     */
-    void loop();
-
     /**
      * @brief Prüft, ob der ESP32 erfolgreich mit einem WLAN-Netzwerk verbunden ist.
      * @return true, wenn verbunden, sonst false.
@@ -65,13 +133,49 @@ public:
      */
     String getMode();
 
+    /**
+     * @brief Kopiert die Zähler der Verbindungsverwaltung.
+     */
+    void getStats(WifiStats& stats);
+
+    static const char* stateName(WifiState state);
+    static const char* pathName(WifiConnectPath path);
+
+    /**
+     * @brief Ein Schritt des Zustandsautomaten. Läuft im WLAN-Task.
+     * @param events Bits WIFI_NOTIFY_* seit dem letzten Schritt.
+     */
+    void step(uint32_t events, uint32_t nowMs);
+
 private:
     // Private Hilfsfunktionen, die nur innerhalb der Klasse verwendet werden.
     void startAP();
-    void connectToWifi(const String& ssid, const String& password);
     void stopAP();
+    bool apActive();
+    void beginAttempt(uint32_t nowMs);
+    void attemptFailed(uint32_t nowMs);
+    void setState(WifiState state);
+    void loadFastCache();
+    void saveFastCache();
+
+    static void onWifiEvent(arduino_event_id_t event, arduino_event_info_t info);
+    static void wifiTask(void* arg);
 
     // Member-Variablen zum Verwalten des AP-Timeouts.
     unsigned long _apStopTime;
     bool _apShouldBeDisabled;
-};
\ No newline at end of file
+
+    TaskHandle_t _task;
+    portMUX_TYPE _lock;         // schützt _stats (Leser in anderen Tasks)
+    WifiStats _stats;
+    volatile uint8_t _eventReason;  // Trenngrund aus dem Ereignis-Task
+    uint32_t _attemptStart;
+    uint32_t _retryAt;
+    uint32_t _lostSince;        // 0 = Station nicht verloren
+
+    WifiFastCache _fast;
+    bool _fastValid;
+    bool _fastNext;             // nächster Versuch gezielt (nach Start und Abbruch)
+    bool _attemptFast;          // laufender Versuch ist gezielt
+    bool _staticIp;             // IP aus dem Cache statt DHCP eingestellt
+};
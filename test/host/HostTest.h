@@ -0,0 +1,127 @@
+//================================================================================
+//| DATEI: test/host/HostTest.h                                                  |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Kleine Hilfen für die C++-Host-Tests (test_*.cpp): CHECK-Makro mit Zähler,   |
+//| reproduzierbarer Zufall (fester Seed) für Stückelungen und Testdaten,        |
+//| Zeitmessung und Heap-Zählung für die Benchmarks (bench_*.cpp). Bewusst ohne  |
+//| Test-Framework, wie der Rest von test/host.                                  |
+//================================================================================
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <string>
+#include <vector>
+#include "../../src/modules/System/HeapTrace.h"
+
+static int hostTestFailures = 0;
+
+// Meldet einen Fehler mit Ort und Beschreibung, bricht aber nicht ab.
+#define CHECK(cond, ...)                                                  \
+    do {                                                                  \
+        if (!(cond)) {                                                    \
+            hostTestFailures++;                                           \
+            fprintf(stderr, "FEHLER %s:%d: ", __FILE__, __LINE__);        \
+            fprintf(stderr, __VA_ARGS__);                                 \
+            fputc('\n', stderr);                                          \
+        }                                                                 \
+    } while (0)
+
+/**
+ * @brief xorshift32 mit festem Seed, damit Fehlschläge reproduzierbar sind.
+ */
+class TestRandom {
+public:
+    explicit TestRandom(uint32_t seed) : _state(seed ? seed : 1) {}
+
+    uint32_t next() {
+        _state ^= _state << 13;
+        _state ^= _state >> 17;
+        _state ^= _state << 5;
+        return _state;
+    }
+
+    // Gleichverteilt in [lo, hi]
+    uint32_t range(uint32_t lo, uint32_t hi) { return lo + next() % (hi - lo + 1); }
+
+    void fill(uint8_t* data, size_t len) {
+        for (size_t i = 0; i < len; i++) data[i] = (uint8_t)next();
+    }
+
+    /**
+     * @brief Zerlegt len Bytes in zufällige Stücke von 1..maxChunk Bytes.
+     */
+    std::vector<size_t> splits(size_t len, size_t maxChunk) {
+        std::vector<size_t> chunks;
+        while (len > 0) {
+            size_t n = range(1, (uint32_t)(maxChunk < len ? maxChunk : len));
+            chunks.push_back(n);
+            len -= n;
+        }
+        return chunks;
+    }
+
+private:
+    uint32_t _state;
+};
+
+/**
+ * @brief Monotone Uhr in Mikrosekunden (für Durchsatz und Benchmarks).
+ */
+inline double testMicros() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+/**
+ * @brief Ergebnis von benchmark(): Zeit und Heap-Verbrauch pro Aufruf.
+ */
+struct BenchResult {
+    double us;              // bester Mittelwert über mehrere Runden
+    uint32_t allocs;
+    uint32_t allocBytes;
+};
+
+/**
+ * @brief Misst fn(): Allokationen eines Aufrufs über einen eigenen HeapScope
+ * (wie /api/system/heap je Route), danach die Zeit als beste von 5 Runden.
+ */
+template <typename F>
+BenchResult benchmark(F fn, int iterations) {
+    BenchResult r;
+    HeapCounters counters("bench");
+    {
+        HeapScope scope(counters);
+        fn();
+    }
+    r.allocs = counters.allocs;
+    r.allocBytes = counters.allocBytes;
+
+    r.us = 1e30;
+    for (int round = 0; round < 5; round++) {
+        double t0 = testMicros();
+        for (int i = 0; i < iterations; i++) fn();
+        double us = (testMicros() - t0) / iterations;
+        if (us < r.us) r.us = us;
+    }
+    return r;
+}
+
+/**
+ * @brief Schlusszeile und Exit-Code für main().
+ */
+inline int testSummary(const char* name) {
+    if (hostTestFailures) {
+        printf("%s: %d Fehler\n", name, hostTestFailures);
+        return 1;
+    }
+    printf("%s: OK\n", name);
+    return 0;
+}
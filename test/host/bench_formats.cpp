@@ -0,0 +1,126 @@
+//================================================================================
+//| DATEI: test/host/bench_formats.cpp                                           |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Kodiert dieselben Dokumente mit JsonWriter, CborWriter und MsgPackWriter     |
+//| und vergleicht Größe (Bytes auf der Leitung), Kodierzeit und Heap-           |
+//| Allokationen. Die Dokumente kommen, wo möglich, aus dem Firmware-Code        |
+//| selbst (SystemAPI, HeapTrace, TaskProfiler); /api/robot/status ist wie in    |
+//| WebServer.cpp nachgebaut, eine History-Seite synthetisch.                    |
+//|                                                                              |
+//| Die Zeiten sind die des PCs - aussagekräftig ist das Verhältnis der Formate. |
+//================================================================================
+
+#include "HostTest.h"
+#include "../../src/modules/Server/JsonWriter.h"
+#include "../../src/modules/Server/CborWriter.h"
+#include "../../src/modules/Server/MsgPackWriter.h"
+#include "../../src/modules/System/SystemAPI.h"
+#include "../../src/modules/System/TaskProfiler.h"
+#include "../../src/modules/System/ConfigStore.h"
+#include <functional>
+
+typedef std::function<void(ValueWriter& out)> DocumentFn;
+
+/**
+ * @brief Ein Dokument, wie es eine Route ausliefert.
+ */
+struct Document {
+    const char* name;
+    DocumentFn write;
+};
+
+/**
+ * @brief Wie /api/robot/status in WebServer.cpp (dort an die Regelung gebunden).
+ */
+static void writeRobotStatus(ValueWriter& out) {
+    out.beginObject(8);
+    out.field("angle", -1.37f, 2);
+    out.field("error", 0.42f, 2);
+    out.field("gyro", 12.85f, 2);
+    out.field("motor", -87);
+    out.field("enabled", true);
+    out.field("kp", 25.0f, 2);
+    out.field("ki", 0.125f, 3);
+    out.field("kd", 1.2f, 2);
+    out.endObject();
+}
+
+/**
+ * @brief Seite aus dem Telemetrie-Verlauf: 300 Zeilen mit angle, error, gyro, motor
+ * (Zahlen-lastig, ähnlich /api/robot/history).
+ */
+static void writeHistoryPage(ValueWriter& out) {
+    out.beginObject(4);
+    out.field("tier", "raw");
+    out.field("interval_ms", 20);
+    out.field("start_ms", 123456780UL);
+    out.key("rows");
+    out.beginArray(300);
+    for (int i = 0; i < 300; i++) {
+        out.beginArray(4);
+        out.value(sinf(i * 0.05f) * 8.0f, 2);
+        out.value(cosf(i * 0.05f) * 2.0f, 2);
+        out.value(sinf(i * 0.11f) * 40.0f, 2);
+        out.value((int)(sinf(i * 0.07f) * 200));
+        out.endArray();
+    }
+    out.endArray();
+    out.endObject();
+}
+
+/**
+ * @brief Kodiert ein Dokument in einen Puffer (ResponseWriter ohne Request).
+ */
+template <class Writer>
+static size_t encode(const DocumentFn& doc, char* buf, size_t capacity) {
+    ResponseWriter out(nullptr, 200, "", buf, capacity);
+    Writer writer(out);
+    doc(writer);
+    CHECK(!out.overflowed(), "Puffer zu klein (%zu Bytes)", capacity);
+    return out.length();
+}
+
+/**
+ * @brief Misst ein Format für ein Dokument und gibt eine Tabellenzeile aus.
+ * @return Größe in Bytes
+ */
+template <class Writer>
+static size_t measure(const char* format, const Document& doc, size_t jsonSize) {
+    static char buf[32768];
+    size_t size = encode<Writer>(doc.write, buf, sizeof(buf));
+    BenchResult r = benchmark([&]() { encode<Writer>(doc.write, buf, sizeof(buf)); }, 2000);
+    CHECK(r.allocs == 0, "%s/%s: %u Allokationen beim Kodieren", doc.name, format, r.allocs);
+    printf("  %-8s %7zu Bytes %5.0f %%  %8.2f µs  %3u Allok.\n", format, size,
+           jsonSize ? 100.0 * size / jsonSize : 100.0, r.us, r.allocs);
+    return size;
+}
+
+int main() {
+    // Firmware-Objekte wie in main.cpp, nur ohne WLAN-Verbindung
+    static WifiManager wifiManager;
+    static TimeService timeService(wifiManager);
+    static SystemAPI systemApi(wifiManager, timeService);
+    configStore.begin();
+    taskProfiler.begin();
+    systemApi.begin();
+    delay(1500); // TaskProfiler braucht ein Intervall für die Kern-Auslastung
+
+    const Document documents[] = {
+        {"/api/robot/status", writeRobotStatus},
+        {"/api/system/health", [](ValueWriter& out) { systemApi.writeSystemHealth(out); }},
+        {"/api/system/heap", [](ValueWriter& out) { HeapTrace::writeReport(out); }},
+        {"/api/system/tasks", [](ValueWriter& out) { taskProfiler.writeReport(out); }},
+        {"History-Seite (300 Zeilen)", writeHistoryPage},
+    };
+
+    for (const Document& doc : documents) {
+        printf("%s\n", doc.name);
+        size_t json = measure<JsonWriter>("JSON", doc, 0);
+        measure<CborWriter>("CBOR", doc, json);
+        measure<MsgPackWriter>("MsgPack", doc, json);
+    }
+    return testSummary("bench_formats");
+}
@@ -0,0 +1,216 @@
+//================================================================================
+//| DATEI: test/host/bench_json.cpp                                              |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Vergleicht JsonWriter mit den früheren Wegen, eine API-Antwort zu bauen:     |
+//| String-Verkettung (wie /api/robot/status vorher in WebServer.cpp) und        |
+//| ArduinoJson 6 mit StaticJsonDocument und serializeJson() in einen String     |
+//| (wie /api/system/health vorher in SystemAPI.cpp). Gemessen werden Heap-      |
+//| Allokationen, allozierte Bytes und µs pro Antwort (nur Erzeugen, ohne        |
+//| Senden). Der String-Shim bildet SSO und Wachstum des ESP32-Cores nach.       |
+//|                                                                              |
+//| ARDUINOJSON: Wird nur mitgebaut, wenn die Bibliothek da ist - automatisch    |
+//| aus .pio/libdeps (nach einem "pio run") oder mit ARDUINOJSON=<pfad>/src.     |
+//================================================================================
+
+#include "HostTest.h"
+#include "../../src/config.h"
+#include "../../src/modules/Server/JsonWriter.h"
+#include "../../src/modules/System/SystemAPI.h"
+#include "../../src/modules/System/ConfigStore.h"
+
+#ifdef HAVE_ARDUINOJSON
+#include <ArduinoJson.h>
+#endif
+
+/**
+ * @brief Werte von /api/robot/status (wie getCurrentRobotStatus()).
+ */
+struct RobotStatus {
+    float angle, error, gyroRate;
+    int motorSpeed;
+    bool enabled;
+    float kp, ki, kd;
+};
+
+static const RobotStatus STATUS = {-1.37f, 0.42f, 12.85f, -87, true, 25.0f, 0.125f, 1.2f};
+
+// Felder von /api/system/health vor dem Umbau (13 Stück)
+static HealthSample health;
+
+// --- /api/robot/status ---------------------------------------------------------
+
+// Alter Weg aus WebServer.cpp
+static String statusString(const RobotStatus& s) {
+    String jsonResponse = "{";
+    jsonResponse += "\"angle\": " + String(s.angle, 2) + ",";
+    jsonResponse += "\"error\": " + String(s.error, 2) + ",";
+    jsonResponse += "\"gyro\": " + String(s.gyroRate, 2) + ",";
+    jsonResponse += "\"motor\": " + String(s.motorSpeed) + ",";
+    jsonResponse += "\"enabled\": " + String(s.enabled ? "true" : "false") + ",";
+    jsonResponse += "\"kp\": " + String(s.kp, 2) + ",";
+    jsonResponse += "\"ki\": " + String(s.ki, 3) + ",";
+    jsonResponse += "\"kd\": " + String(s.kd, 2);
+    jsonResponse += "}";
+    return jsonResponse;
+}
+
+// Heutiger Weg: Stack-Puffer wie in WebServer.cpp (192 Bytes)
+static size_t statusWriter(const RobotStatus& s, char* buffer, size_t capacity) {
+    ResponseWriter out(nullptr, 200, "application/json", buffer, capacity);
+    JsonWriter json(out);
+    json.beginObject();
+    json.field("angle", s.angle, 2);
+    json.field("error", s.error, 2);
+    json.field("gyro", s.gyroRate, 2);
+    json.field("motor", s.motorSpeed);
+    json.field("enabled", s.enabled);
+    json.field("kp", s.kp, 2);
+    json.field("ki", s.ki, 3);
+    json.field("kd", s.kd, 2);
+    json.endObject();
+    return out.length();
+}
+
+#ifdef HAVE_ARDUINOJSON
+static String statusArduinoJson(const RobotStatus& s) {
+    StaticJsonDocument<256> doc;
+    doc["angle"] = serialized(String(s.angle, 2));
+    doc["error"] = serialized(String(s.error, 2));
+    doc["gyro"] = serialized(String(s.gyroRate, 2));
+    doc["motor"] = s.motorSpeed;
+    doc["enabled"] = s.enabled;
+    doc["kp"] = serialized(String(s.kp, 2));
+    doc["ki"] = serialized(String(s.ki, 3));
+    doc["kd"] = serialized(String(s.kd, 2));
+    String output;
+    serializeJson(doc, output);
+    return output;
+}
+#endif
+
+// --- /api/system/health --------------------------------------------------------
+
+// Dieselben Felder als String-Verkettung (zum Vergleich mit dem String-Weg oben)
+static String healthString(const HealthSample& h) {
+    String json = "{";
+    json += "\"reset_reason_code\":" + String(h.resetReason) + ",";
+    json += "\"reset_reason_text\":\"Power-on\",";
+    json += "\"uptime_seconds\":" + String((unsigned long)h.uptimeSeconds) + ",";
+    json += "\"heap_total\":" + String((unsigned long)h.heapTotal) + ",";
+    json += "\"heap_free\":" + String((unsigned long)h.heapFree) + ",";
+    json += "\"heap_min_free\":" + String((unsigned long)h.heapMinFree) + ",";
+    json += "\"wifi_ssid\":\"" + String(h.wifiSsid) + "\",";
+    json += "\"wifi_rssi\":" + String(h.wifiRssi) + ",";
+    json += "\"ip_address\":\"" + String(h.ipAddress) + "\",";
+    json += "\"firmware_version\":\"" + String(firmware_version) + "\",";
+    json += "\"mac_address\":\"" + String(h.macAddress) + "\",";
+    json += "\"cpu_temp\":" + String(h.cpuTemp, 2) + ",";
+    json += "\"last_time_sync\":" + String((long)h.lastTimeSync);
+    json += "}";
+    return json;
+}
+
+static size_t healthWriter(const HealthSample& h, char* buffer, size_t capacity) {
+    ResponseWriter out(nullptr, 200, "application/json", buffer, capacity);
+    JsonWriter json(out);
+    json.beginObject();
+    json.field("reset_reason_code", h.resetReason);
+    json.field("reset_reason_text", "Power-on");
+    json.field("uptime_seconds", (unsigned long)h.uptimeSeconds);
+    json.field("heap_total", (unsigned long)h.heapTotal);
+    json.field("heap_free", (unsigned long)h.heapFree);
+    json.field("heap_min_free", (unsigned long)h.heapMinFree);
+    json.field("wifi_ssid", h.wifiSsid);
+    json.field("wifi_rssi", h.wifiRssi);
+    json.field("ip_address", h.ipAddress);
+    json.field("firmware_version", firmware_version);
+    json.field("mac_address", h.macAddress);
+    json.field("cpu_temp", h.cpuTemp, 2);
+    json.field("last_time_sync", h.lastTimeSync);
+    json.endObject();
+    return out.length();
+}
+
+#ifdef HAVE_ARDUINOJSON
+// Alter Weg aus SystemAPI::getSystemHealthJson(): SSID, IP und MAC kamen dort als String.
+static String healthArduinoJson(const HealthSample& h) {
+    StaticJsonDocument<1024> doc;
+    doc["reset_reason_code"] = h.resetReason;
+    doc["reset_reason_text"] = String("Power-on");
+    doc["uptime_seconds"] = h.uptimeSeconds;
+    doc["heap_total"] = h.heapTotal;
+    doc["heap_free"] = h.heapFree;
+    doc["heap_min_free"] = h.heapMinFree;
+    doc["wifi_ssid"] = String(h.wifiSsid);
+    doc["wifi_rssi"] = h.wifiRssi;
+    doc["ip_address"] = String(h.ipAddress);
+    doc["firmware_version"] = firmware_version;
+    doc["mac_address"] = String(h.macAddress);
+    doc["cpu_temp"] = h.cpuTemp;
+    doc["last_time_sync"] = h.lastTimeSync;
+    String output;
+    serializeJson(doc, output);
+    return output;
+}
+#endif
+
+static void report(const char* label, const BenchResult& r, size_t bytes) {
+    printf("  %-34s %4zu Bytes JSON  %6.2f µs  %2u Allok.  %5u Bytes Heap\n", label, bytes, r.us, r.allocs,
+           r.allocBytes);
+}
+
+int main() {
+    // Ein echter Health-Snapshot der Firmware (ohne WLAN: SSID leer, IP 0.0.0.0)
+    static WifiManager wifiManager;
+    static TimeService timeService(wifiManager);
+    static SystemAPI systemApi(wifiManager, timeService);
+    configStore.begin();
+    systemApi.begin();
+    systemApi.latestHealth(health);
+    strcpy(health.wifiSsid, "HSD-Labor-Robotik");
+    strcpy(health.ipAddress, "192.168.178.57");
+    health.wifiRssi = -61;
+
+    const int iterations = 20000;
+    char buffer[1536];
+    size_t len;
+    BenchResult r;
+
+    printf("/api/robot/status\n");
+    len = statusString(STATUS).length();
+    report("String-Verkettung (alt)", benchmark([&]() { statusString(STATUS); }, iterations), len);
+#ifdef HAVE_ARDUINOJSON
+    len = statusArduinoJson(STATUS).length();
+    report("ArduinoJson 6 + String", benchmark([&]() { statusArduinoJson(STATUS); }, iterations), len);
+#endif
+    len = statusWriter(STATUS, buffer, 192);
+    r = benchmark([&]() { statusWriter(STATUS, buffer, 192); }, iterations);
+    report("JsonWriter (192 Bytes Stack)", r, len);
+    CHECK(r.allocs == 0, "JsonWriter alloziert (%u)", r.allocs);
+
+    printf("/api/system/health (13 Felder wie vor dem Umbau)\n");
+    len = healthString(health).length();
+    report("String-Verkettung", benchmark([&]() { healthString(health); }, iterations), len);
+#ifdef HAVE_ARDUINOJSON
+    len = healthArduinoJson(health).length();
+    report("ArduinoJson 6 + String (alt)", benchmark([&]() { healthArduinoJson(health); }, iterations), len);
+#endif
+    len = healthWriter(health, buffer, sizeof(buffer));
+    r = benchmark([&]() { healthWriter(health, buffer, sizeof(buffer)); }, iterations);
+    report("JsonWriter", r, len);
+    CHECK(r.allocs == 0, "JsonWriter alloziert (%u)", r.allocs);
+
+    // Heute liefert die Route den fertigen Snapshot des Sampler-Tasks (alle Felder + Verlauf).
+    len = systemApi.copyHealthJson(buffer, sizeof(buffer));
+    r = benchmark([&]() { systemApi.copyHealthJson(buffer, sizeof(buffer)); }, iterations);
+    report("copyHealthJson (Snapshot, heute)", r, len);
+    CHECK(r.allocs == 0, "copyHealthJson alloziert (%u)", r.allocs);
+
+#ifndef HAVE_ARDUINOJSON
+    printf("ArduinoJson nicht gefunden - Vergleich übersprungen (ARDUINOJSON=<pfad>/src setzen).\n");
+#endif
+    return testSummary("bench_json");
+}
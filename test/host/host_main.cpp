@@ -0,0 +1,58 @@
+//================================================================================
+//| DATEI: test/host/host_main.cpp                                               |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Startet die unveränderte Firmware (src/) als Linux-Prozess: setup() einmal,  |
+//| danach loop() im "loopTask" wie auf dem Gerät. Der Webserver lauscht auf     |
+//| 127.0.0.1, das Dateisystem ist ein Verzeichnis (Standard: Kopie von data/).  |
+//|                                                                              |
+//| AUFRUF: host_firmware [--port N] [--fs DIR] [--quiet]                        |
+//================================================================================
+
+#include <Arduino.h>
+#include "shim/HostShim.h"
+#include <signal.h>
+
+void setup();
+void loop();
+
+static volatile sig_atomic_t s_stop = 0;
+
+static void onSignal(int) {
+    s_stop = 1;
+}
+
+static void usage(const char* name) {
+    fprintf(stderr, "Aufruf: %s [--port N] [--fs DIR] [--quiet]\n", name);
+}
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            hostConfig.httpPort = (uint16_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--fs") == 0 && i + 1 < argc) {
+            hostConfig.fsRoot = argv[++i];
+        } else if (strcmp(argv[i], "--quiet") == 0) {
+            hostConfig.quiet = true;
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    setvbuf(stdout, nullptr, _IOLBF, 0);    // Serial-Zeilen sofort, auch in eine Datei
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+    signal(SIGPIPE, SIG_IGN);
+
+    // Der Hauptthread wird beim ersten FreeRTOS-Aufruf als "loopTask" übernommen.
+    setup();
+    while (!s_stop) {
+        loop();
+        delay(1);
+    }
+    fprintf(stderr, "[host] beendet\n");
+    return 0;
+}
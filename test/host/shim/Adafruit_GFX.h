@@ -0,0 +1,31 @@
+//================================================================================
+//| DATEI: test/host/shim/Adafruit_GFX.h                                         |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Zeichenfunktionen ohne Bildschirm. Text landet im Nichts.                    |
+//================================================================================
+
+#pragma once
+
+#include <Arduino.h>
+
+class Adafruit_GFX : public Print {
+public:
+    Adafruit_GFX(int16_t w, int16_t h) : _width(w), _height(h) {}
+
+    size_t write(const uint8_t*, size_t len) override { return len; }
+    using Print::write;
+
+    void setRotation(uint8_t) {}
+    void setCursor(int16_t, int16_t) {}
+    void setTextSize(uint8_t) {}
+    void setTextColor(uint16_t) {}
+    void fillCircle(int16_t, int16_t, int16_t, uint16_t) {}
+    void drawPixel(int16_t, int16_t, uint16_t) {}
+
+protected:
+    int16_t _width;
+    int16_t _height;
+};
@@ -0,0 +1,27 @@
+//================================================================================
+//| DATEI: test/host/shim/Adafruit_SSD1306.h                                     |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| OLED-Treiber ohne Display: begin() scheitert wie bei fehlendem Modul, die    |
+//| Augen-Animation des BalanceDrivers wird dadurch übersprungen.                |
+//================================================================================
+
+#pragma once
+
+#include "Adafruit_GFX.h"
+#include "Wire.h"
+
+#define BLACK 0
+#define WHITE 1
+#define SSD1306_SWITCHCAPVCC 0x02
+
+class Adafruit_SSD1306 : public Adafruit_GFX {
+public:
+    Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire* twi, int8_t rstPin = -1) : Adafruit_GFX(w, h) {}
+
+    bool begin(uint8_t switchVcc = SSD1306_SWITCHCAPVCC, uint8_t i2cAddr = 0) { return false; }
+    void clearDisplay() {}
+    void display() {}
+};
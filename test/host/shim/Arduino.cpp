@@ -0,0 +1,130 @@
+//================================================================================
+//| DATEI: test/host/shim/Arduino.cpp                                            |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Zeit, Serial, GPIO und ESP-Klasse des Host-Shims. Dazu operator new/delete   |
+//| über malloc/free: Auf dem Gerät landet new im selben (per --wrap             |
+//| umgeleiteten) malloc, auf dem Host sonst in der libstdc++ daran vorbei.      |
+//================================================================================
+
+#include "Arduino.h"
+#include "HostShim.h"
+#include "esp_heap_caps.h"
+#include <malloc.h>
+#include <new>
+#include <chrono>
+#include <thread>
+
+HostConfig hostConfig = {8080, "data", false};
+HardwareSerial Serial;
+EspClass ESP;
+
+unsigned long millis() {
+    return (unsigned long)(uint32_t)(hostMicros() / 1000);
+}
+
+unsigned long micros() {
+    return (unsigned long)(uint32_t)hostMicros();
+}
+
+void delay(uint32_t ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(uint32_t us) {
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+void yield() {
+    std::this_thread::yield();
+}
+
+void pinMode(uint8_t, uint8_t) {}
+void digitalWrite(uint8_t, uint8_t) {}
+int digitalRead(uint8_t) { return LOW; }
+void analogWrite(uint8_t, int) {}
+float temperatureRead() { return 42.0f; }
+
+void configTime(long, int, const char*, const char*, const char*) {}
+
+bool getLocalTime(struct tm* info, uint32_t) {
+    time_t now = time(nullptr);
+    localtime_r(&now, info);
+    return info->tm_year > (2016 - 1900);
+}
+
+size_t Print::printf(const char* format, ...) {
+    char buf[256];
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+    if (len < 0) return 0;
+    if ((size_t)len < sizeof(buf)) return write((const uint8_t*)buf, (size_t)len);
+
+    char* big = (char*)malloc((size_t)len + 1);
+    if (!big) return 0;
+    va_start(args, format);
+    vsnprintf(big, (size_t)len + 1, format, args);
+    va_end(args);
+    size_t written = write((const uint8_t*)big, (size_t)len);
+    free(big);
+    return written;
+}
+
+size_t HardwareSerial::write(const uint8_t* data, size_t len) {
+    if (hostConfig.quiet) return len;
+    return fwrite(data, 1, len, stdout);
+}
+
+void EspClass::restart() {
+    // Ein Neustart würde den Lasttest abbrechen; Zustand (NVS, Partitionen) bleibt ohnehin im RAM.
+    Serial.println("[host] ESP.restart() ignoriert");
+}
+
+uint32_t EspClass::getHeapSize() {
+    return HOST_HEAP_SIZE;
+}
+
+uint32_t EspClass::getFreeHeap() {
+    return (uint32_t)heap_caps_get_free_size(MALLOC_CAP_8BIT);
+}
+
+uint32_t EspClass::getMinFreeHeap() {
+    return (uint32_t)heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+}
+
+uint32_t EspClass::getMaxAllocHeap() {
+    return (uint32_t)heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+}
+
+uint32_t EspClass::getCycleCount() {
+    return (uint32_t)(hostMicros() * 240);
+}
+
+// --- new/delete über malloc (siehe Kopf) ---
+
+void* operator new(size_t size) {
+    void* ptr = malloc(size ? size : 1);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return malloc(size ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return malloc(size ? size : 1);
+}
+
+void operator delete(void* ptr) noexcept { free(ptr); }
+void operator delete[](void* ptr) noexcept { free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { free(ptr); }
@@ -0,0 +1,142 @@
+//================================================================================
+//| DATEI: test/host/shim/Arduino.h                                              |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Host-Ersatz für den Arduino-Core des ESP32: String, Serial (stdout), Zeit,   |
+//| GPIO (ohne Wirkung) und die ESP-Klasse. Nur der Teil, den src/ benutzt.      |
+//================================================================================
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <time.h>
+#include <math.h>
+#include <ctype.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#include "WString.h"
+#include "esp_err.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+using std::abs;
+using std::min;
+using std::max;
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define IRAM_ATTR
+#define RTC_NOINIT_ATTR
+#define RTC_DATA_ATTR
+
+#define HIGH    1
+#define LOW     0
+#define INPUT   0x01
+#define OUTPUT  0x03
+#define DEC     10
+#define HEX     16
+#define OCT     8
+#define BIN     2
+#define PI      3.1415926535897932384626433832795
+
+template <class T, class L, class H>
+inline T constrain(T value, L low, H high) {
+    return value < low ? (T)low : (value > high ? (T)high : value);
+}
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+void analogWrite(uint8_t pin, int value);
+float temperatureRead();
+
+// esp32-hal-time: Der Host läuft bereits mit Systemzeit, NTP entfällt.
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char* server1,
+                const char* server2 = nullptr, const char* server3 = nullptr);
+bool getLocalTime(struct tm* info, uint32_t ms = 5000);
+
+class Print;
+
+class Printable {
+public:
+    virtual ~Printable() {}
+    virtual size_t printTo(Print& out) const = 0;
+};
+
+/**
+ * @class Print
+ * @brief Ausgabe wie im Arduino-Core; write() bestimmt das Ziel.
+ */
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(const uint8_t* data, size_t len) = 0;
+    size_t write(uint8_t c) { return write(&c, 1); }
+
+    size_t print(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+    size_t print(const String& s) { return write((const uint8_t*)s.c_str(), s.length()); }
+    size_t print(const Printable& p) { return p.printTo(*this); }
+    size_t print(char c) { return write((const uint8_t*)&c, 1); }
+    size_t print(int value, int base = DEC) { return print(String(value, (unsigned char)base)); }
+    size_t print(unsigned int value, int base = DEC) { return print(String(value, (unsigned char)base)); }
+    size_t print(long value, int base = DEC) { return print(String(value, (unsigned char)base)); }
+    size_t print(unsigned long value, int base = DEC) { return print(String(value, (unsigned char)base)); }
+    size_t print(unsigned char value, int base = DEC) { return print(String(value, (unsigned char)base)); }
+    size_t print(double value, int digits = 2) { return print(String(value, (unsigned int)digits)); }
+
+    size_t println() { return print("\r\n"); }
+    template <class T> size_t println(const T& value) { return print(value) + println(); }
+    template <class T> size_t println(const T& value, int format) { return print(value, format) + println(); }
+
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class HardwareSerial : public Print {
+public:
+    void begin(unsigned long) {}
+    void flush() { fflush(stdout); }
+    int available() { return 0; }
+    int read() { return -1; }
+    size_t write(const uint8_t* data, size_t len) override;
+    using Print::write;
+};
+
+extern HardwareSerial Serial;
+
+/**
+ * @class EspClass
+ * @brief Heap-Werte kommen aus mallinfo2() des Host-Prozesses, die Grenze ist
+ * der interne RAM eines ESP32 (so bleiben Prozentangaben plausibel).
+ */
+class EspClass {
+public:
+    void restart();
+    uint32_t getHeapSize();
+    uint32_t getFreeHeap();
+    uint32_t getMinFreeHeap();
+    uint32_t getMaxAllocHeap();
+    uint32_t getCycleCount();
+    uint32_t getCpuFreqMHz() { return 240; }
+    const char* getSdkVersion() { return "host"; }
+};
+
+extern EspClass ESP;
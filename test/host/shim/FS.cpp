@@ -0,0 +1,232 @@
+//================================================================================
+//| DATEI: test/host/shim/FS.cpp                                                 |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Dateien und Verzeichnis-Listing des Host-Dateisystems (siehe FS.h).          |
+//================================================================================
+
+#include "FS.h"
+#include "SPIFFS.h"
+#include "HostShim.h"
+#include <dirent.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+SPIFFSFS SPIFFS;
+
+namespace fs {
+
+struct FileImpl {
+    FILE* file;
+    std::string path;                   // Pfad im Dateisystem ("/css/style.css")
+    bool directory;
+    std::vector<std::string> entries;   // bei Verzeichnissen: alle Dateien darunter
+    size_t next;
+    const FS* fs;
+
+    FileImpl() : file(nullptr), directory(false), next(0), fs(nullptr) {}
+    ~FileImpl() {
+        if (file) fclose(file);
+    }
+};
+
+// Sammelt alle Dateien unter dir (rekursiv), Pfade relativ zur Wurzel mit führendem "/".
+static void listFiles(const std::string& hostDir, const std::string& prefix, std::vector<std::string>& out) {
+    DIR* dir = opendir(hostDir.c_str());
+    if (!dir) return;
+    while (struct dirent* e = readdir(dir)) {
+        if (e->d_name[0] == '.') continue;
+        std::string host = hostDir + "/" + e->d_name;
+        std::string path = prefix + "/" + e->d_name;
+        struct stat st;
+        if (stat(host.c_str(), &st) != 0) continue;
+        if (S_ISDIR(st.st_mode)) listFiles(host, path, out);
+        else out.push_back(path);
+    }
+    closedir(dir);
+}
+
+static void makeParents(const std::string& hostFile) {
+    for (size_t pos = hostFile.find('/', 1); pos != std::string::npos; pos = hostFile.find('/', pos + 1)) {
+        mkdir(hostFile.substr(0, pos).c_str(), 0755);
+    }
+}
+
+// ------------------------------------------------------------------ File
+
+File::operator bool() const { return _impl && (_impl->file || _impl->directory); }
+
+size_t File::write(uint8_t c) { return write(&c, 1); }
+
+size_t File::write(const uint8_t* buf, size_t size) {
+    return _impl && _impl->file ? fwrite(buf, 1, size, _impl->file) : 0;
+}
+
+int File::available() {
+    if (!_impl || !_impl->file) return 0;
+    return (int)(size() - position());
+}
+
+int File::read() {
+    return _impl && _impl->file ? fgetc(_impl->file) : -1;
+}
+
+int File::peek() {
+    if (!_impl || !_impl->file) return -1;
+    int c = fgetc(_impl->file);
+    if (c != EOF) ungetc(c, _impl->file);
+    return c;
+}
+
+size_t File::read(uint8_t* buf, size_t size) {
+    return _impl && _impl->file ? fread(buf, 1, size, _impl->file) : 0;
+}
+
+String File::readString() {
+    String out;
+    char buf[256];
+    size_t n;
+    while ((n = read((uint8_t*)buf, sizeof(buf))) > 0) out.concat(buf, (unsigned int)n);
+    return out;
+}
+
+void File::flush() {
+    if (_impl && _impl->file) fflush(_impl->file);
+}
+
+bool File::seek(uint32_t pos, SeekMode mode) {
+    return _impl && _impl->file && fseek(_impl->file, (long)pos, mode) == 0;
+}
+
+size_t File::position() const {
+    return _impl && _impl->file ? (size_t)ftell(_impl->file) : 0;
+}
+
+size_t File::size() const {
+    if (!_impl || !_impl->file) return 0;
+    fflush(_impl->file);
+    struct stat st;
+    return fstat(fileno(_impl->file), &st) == 0 ? (size_t)st.st_size : 0;
+}
+
+void File::close() {
+    _impl.reset();
+}
+
+const char* File::path() const {
+    return _impl ? _impl->path.c_str() : nullptr;
+}
+
+const char* File::name() const {
+    if (!_impl) return nullptr;
+    size_t slash = _impl->path.rfind('/');
+    return _impl->path.c_str() + (slash == std::string::npos ? 0 : slash + 1);
+}
+
+bool File::isDirectory() const {
+    return _impl && _impl->directory;
+}
+
+File File::openNextFile(const char* mode) {
+    if (!_impl || !_impl->directory || _impl->next >= _impl->entries.size()) return File();
+    FS* fs = const_cast<FS*>(_impl->fs);
+    return fs->open(_impl->entries[_impl->next++].c_str(), mode);
+}
+
+void File::rewindDirectory() {
+    if (_impl) _impl->next = 0;
+}
+
+// ------------------------------------------------------------------ FS
+
+const char* FS::root() const {
+    return _root ? _root : hostConfig.fsRoot;
+}
+
+String FS::hostPath(const char* path) const {
+    String out(root());
+    if (path[0] != '/') out += "/";
+    out += path;
+    return out;
+}
+
+File FS::open(const char* path, const char* mode, bool) {
+    if (!path || path[0] != '/') return File();
+    String host = hostPath(path);
+    struct stat st;
+    bool isDir = stat(host.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+
+    FileImplPtr impl = std::make_shared<FileImpl>();
+    impl->path = path;
+    impl->fs = this;
+    if (isDir) {
+        if (mode[0] != 'r') return File();
+        impl->directory = true;
+        std::string prefix = strcmp(path, "/") == 0 ? "" : std::string(path);
+        if (!prefix.empty() && prefix.back() == '/') prefix.pop_back();
+        listFiles(host.c_str(), prefix, impl->entries);
+        std::sort(impl->entries.begin(), impl->entries.end());
+        return File(impl);
+    }
+
+    const char* hostMode = mode[0] == 'w' ? "w+b" : mode[0] == 'a' ? "a+b" : "rb";
+    if (mode[0] != 'r') makeParents(host.c_str());
+    impl->file = fopen(host.c_str(), hostMode);
+    return impl->file ? File(impl) : File();
+}
+
+bool FS::exists(const char* path) {
+    struct stat st;
+    return path && stat(hostPath(path).c_str(), &st) == 0;
+}
+
+bool FS::remove(const char* path) {
+    return path && ::unlink(hostPath(path).c_str()) == 0;
+}
+
+bool FS::rename(const char* from, const char* to) {
+    if (!from || !to) return false;
+    String target = hostPath(to);
+    makeParents(target.c_str());
+    return ::rename(hostPath(from).c_str(), target.c_str()) == 0;
+}
+
+} // namespace fs
+
+// ------------------------------------------------------------------ SPIFFS
+
+static const size_t SPIFFS_HOST_CAPACITY = 0x130000 * 9 / 10;   // spiffs-Partition abzüglich Verwaltung
+
+bool SPIFFSFS::begin(bool formatOnFail, const char*, uint8_t, const char*) {
+    struct stat st;
+    if (stat(root(), &st) == 0 && S_ISDIR(st.st_mode)) return true;
+    return formatOnFail && mkdir(root(), 0755) == 0;
+}
+
+bool SPIFFSFS::format() {
+    std::vector<std::string> files;
+    fs::listFiles(root(), "", files);
+    for (size_t i = 0; i < files.size(); i++) remove(files[i].c_str());
+    return true;
+}
+
+size_t SPIFFSFS::totalBytes() {
+    return SPIFFS_HOST_CAPACITY;
+}
+
+size_t SPIFFSFS::usedBytes() {
+    std::vector<std::string> files;
+    fs::listFiles(root(), "", files);
+    size_t used = 0;
+    for (size_t i = 0; i < files.size(); i++) {
+        struct stat st;
+        if (stat(hostPath(files[i].c_str()).c_str(), &st) == 0) used += (size_t)st.st_size;
+    }
+    return used;
+}
@@ -0,0 +1,86 @@
+//================================================================================
+//| DATEI: test/host/shim/FS.h                                                   |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Dateisystem-API des Arduino-Cores über ein Host-Verzeichnis. Wie SPIFFS ist  |
+//| es flach: "/" listet alle Dateien rekursiv mit vollem Pfad ("/css/x.css"),   |
+//| Verzeichnisse gibt es nicht, beim Schreiben entstehen sie automatisch.       |
+//================================================================================
+
+#pragma once
+
+#include <Arduino.h>
+#include <memory>
+
+#define FILE_READ   "r"
+#define FILE_WRITE  "w"
+#define FILE_APPEND "a"
+
+namespace fs {
+
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+struct FileImpl;
+typedef std::shared_ptr<FileImpl> FileImplPtr;
+
+class File {
+public:
+    File() {}
+    explicit File(FileImplPtr impl) : _impl(impl) {}
+
+    explicit operator bool() const;
+    size_t write(uint8_t c);
+    size_t write(const uint8_t* buf, size_t size);
+    int available();
+    int read();
+    int peek();
+    size_t read(uint8_t* buf, size_t size);
+    size_t readBytes(char* buf, size_t size) { return read((uint8_t*)buf, size); }
+    String readString();
+    void flush();
+    bool seek(uint32_t pos, SeekMode mode = SeekSet);
+    size_t position() const;
+    size_t size() const;
+    void close();
+    const char* path() const;
+    const char* name() const;
+    bool isDirectory() const;
+    File openNextFile(const char* mode = FILE_READ);
+    void rewindDirectory();
+
+private:
+    FileImplPtr _impl;
+};
+
+class FS {
+public:
+    explicit FS(const char* root = nullptr) : _root(root) {}
+
+    File open(const char* path, const char* mode = FILE_READ, bool create = false);
+    File open(const String& path, const char* mode = FILE_READ, bool create = false) {
+        return open(path.c_str(), mode, create);
+    }
+    bool exists(const char* path);
+    bool exists(const String& path) { return exists(path.c_str()); }
+    bool remove(const char* path);
+    bool remove(const String& path) { return remove(path.c_str()); }
+    bool rename(const char* from, const char* to);
+    bool rename(const String& from, const String& to) { return rename(from.c_str(), to.c_str()); }
+
+protected:
+    String hostPath(const char* path) const;
+    const char* root() const;
+
+    const char* _root;          // nullptr = hostConfig.fsRoot
+};
+
+} // namespace fs
+
+using fs::File;
+using fs::FS;
+using fs::SeekMode;
+using fs::SeekSet;
+using fs::SeekCur;
+using fs::SeekEnd;
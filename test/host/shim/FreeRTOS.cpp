@@ -0,0 +1,361 @@
+//================================================================================
+//| DATEI: test/host/shim/FreeRTOS.cpp                                           |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Tasks, Queues, Semaphoren und Notifications über std::thread, Mutex und      |
+//| Condition-Variable. Prioritäten und Kern-Zuordnung werden nur gemerkt. Der   |
+//| Laufzeitzähler eines Tasks ist die CPU-Zeit seines Threads, damit            |
+//| /api/system/tasks auch auf dem Host echte Anteile zeigt.                     |
+//================================================================================
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "HostShim.h"
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <string.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct HostTask {
+    char name[16];
+    UBaseType_t number;
+    UBaseType_t priority;
+    BaseType_t core;
+    uint32_t stackDepth;
+    pthread_t thread;
+    TaskFunction_t fn;
+    void* arg;
+
+    std::mutex lock;
+    std::condition_variable wake;
+    uint32_t notifyValue;
+    bool notifyPending;
+    bool deleted;
+};
+
+struct HostQueue {
+    std::mutex lock;
+    std::condition_variable changed;
+    std::vector<uint8_t> items;     // Ringpuffer, length * itemSize
+    UBaseType_t length;
+    UBaseType_t itemSize;
+    UBaseType_t head;
+    UBaseType_t count;
+};
+
+// Wird geworfen, wenn ein Task sich mit vTaskDelete(nullptr) beendet.
+struct TaskExit {};
+
+static pthread_mutex_t s_critical = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+static std::mutex s_tasksLock;
+static std::vector<HostTask*> s_tasks;
+static UBaseType_t s_nextNumber = 1;
+static thread_local HostTask* t_current = nullptr;
+static thread_local bool t_adopting = false;   // newTask() allokiert, HeapTrace fragt dabei nach dem Task
+
+uint64_t hostMicros() {
+    static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+static HostTask* newTask(const char* name, uint32_t stackDepth, UBaseType_t priority, BaseType_t core) {
+    HostTask* task = new HostTask();
+    strncpy(task->name, name ? name : "", sizeof(task->name) - 1);
+    task->priority = priority;
+    task->core = core;
+    task->stackDepth = stackDepth;
+    task->notifyValue = 0;
+    task->notifyPending = false;
+    task->deleted = false;
+    std::lock_guard<std::mutex> guard(s_tasksLock);
+    task->number = s_nextNumber++;
+    s_tasks.push_back(task);
+    return task;
+}
+
+static void removeTask(HostTask* task) {
+    std::lock_guard<std::mutex> guard(s_tasksLock);
+    for (size_t i = 0; i < s_tasks.size(); i++) {
+        if (s_tasks[i] == task) {
+            s_tasks.erase(s_tasks.begin() + i);
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Aufrufer ohne eigenen Task (main-Thread, fremde Threads) bekommen beim
+ * ersten Zugriff einen, der main-Thread heißt wie unter Arduino "loopTask".
+ * Während der Task angelegt wird, liefert der Thread noch nullptr.
+ */
+static HostTask* currentTask() {
+    if (!t_current && !t_adopting) {
+        t_adopting = true;
+        HostTask* task = newTask(s_nextNumber == 1 ? "loopTask" : "thread", 8192, 1, 1);
+        task->thread = pthread_self();
+        t_current = task;
+        t_adopting = false;
+    }
+    return t_current;
+}
+
+// Wartet bis pred() oder Timeout; ticks == portMAX_DELAY wartet unbegrenzt.
+template <class Pred>
+static bool waitFor(std::unique_lock<std::mutex>& guard, std::condition_variable& cv, TickType_t ticks, Pred pred) {
+    if (pred()) return true;
+    if (ticks == 0) return false;
+    if (ticks == portMAX_DELAY) {
+        cv.wait(guard, pred);
+        return true;
+    }
+    return cv.wait_for(guard, std::chrono::milliseconds(ticks), pred);
+}
+
+// ------------------------------------------------------------------ Kritische Abschnitte
+
+void vPortEnterCritical(portMUX_TYPE* mux) {
+    pthread_mutex_lock(&s_critical);
+    mux->count++;
+}
+
+void vPortExitCritical(portMUX_TYPE* mux) {
+    mux->count--;
+    pthread_mutex_unlock(&s_critical);
+}
+
+BaseType_t xPortGetCoreID() {
+    int cpu = sched_getcpu();
+    return cpu < 0 ? 0 : cpu & 1;
+}
+
+// ------------------------------------------------------------------ Tasks
+
+static void* taskMain(void* arg) {
+    HostTask* task = (HostTask*)arg;
+    t_current = task;
+    try {
+        task->fn(task->arg);
+    } catch (const TaskExit&) {
+    }
+    removeTask(task);
+    delete task;
+    return nullptr;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stackDepth, void* arg,
+                                   UBaseType_t priority, TaskHandle_t* created, BaseType_t core) {
+    HostTask* task = newTask(name, stackDepth, priority, core);
+    task->fn = fn;
+    task->arg = arg;
+    if (created) *created = task;
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    int err = pthread_create(&task->thread, &attr, taskMain, task);
+    pthread_attr_destroy(&attr);
+    if (err != 0) {
+        removeTask(task);
+        delete task;
+        if (created) *created = nullptr;
+        return pdFAIL;
+    }
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stackDepth, void* arg,
+                       UBaseType_t priority, TaskHandle_t* created) {
+    return xTaskCreatePinnedToCore(fn, name, stackDepth, arg, priority, created, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    if (!task || task == t_current) throw TaskExit();
+    // Fremde Threads lassen sich nicht von außen beenden; der Task verschwindet nur aus der Liste.
+    task->deleted = true;
+    removeTask(task);
+}
+
+void vTaskDelay(TickType_t ticks) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+}
+
+TickType_t xTaskGetTickCount() {
+    return (TickType_t)(hostMicros() / 1000);
+}
+
+TickType_t xTaskGetTickCountFromISR() {
+    return xTaskGetTickCount();
+}
+
+void vTaskDelayUntil(TickType_t* previousWake, TickType_t increment) {
+    *previousWake += increment;
+    int32_t wait = (int32_t)(*previousWake - xTaskGetTickCount());
+    if (wait > 0) vTaskDelay((TickType_t)wait);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+    return currentTask();
+}
+
+TaskHandle_t xTaskGetIdleTaskHandleForCPU(UBaseType_t) {
+    return nullptr;     // kein IDLE-Task auf dem Host
+}
+
+const char* pcTaskGetTaskName(TaskHandle_t task) {
+    return (task ? task : currentTask())->name;
+}
+
+// ------------------------------------------------------------------ Notifications
+
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action) {
+    if (!task) return pdFAIL;
+    std::lock_guard<std::mutex> guard(task->lock);
+    switch (action) {
+        case eSetBits: task->notifyValue |= value; break;
+        case eIncrement: task->notifyValue++; break;
+        case eSetValueWithOverwrite: task->notifyValue = value; break;
+        case eSetValueWithoutOverwrite:
+            if (task->notifyPending) return pdFAIL;
+            task->notifyValue = value;
+            break;
+        case eNoAction: break;
+    }
+    task->notifyPending = true;
+    task->wake.notify_all();
+    return pdPASS;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    return xTaskNotify(task, 0, eIncrement);
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks) {
+    HostTask* task = currentTask();
+    std::unique_lock<std::mutex> guard(task->lock);
+    waitFor(guard, task->wake, ticks, [task] { return task->notifyValue > 0; });
+    uint32_t value = task->notifyValue;
+    if (value > 0) task->notifyValue = clearOnExit ? 0 : value - 1;
+    task->notifyPending = false;
+    return value;
+}
+
+BaseType_t xTaskNotifyWait(uint32_t clearOnEntry, uint32_t clearOnExit, uint32_t* value, TickType_t ticks) {
+    HostTask* task = currentTask();
+    std::unique_lock<std::mutex> guard(task->lock);
+    if (!task->notifyPending) task->notifyValue &= ~clearOnEntry;
+    bool notified = waitFor(guard, task->wake, ticks, [task] { return task->notifyPending; });
+    if (value) *value = task->notifyValue;
+    if (notified) task->notifyValue &= ~clearOnExit;
+    task->notifyPending = false;
+    return notified ? pdTRUE : pdFALSE;
+}
+
+// ------------------------------------------------------------------ Task-Liste
+
+static uint32_t threadCpuMicros(pthread_t thread) {
+    clockid_t clock;
+    struct timespec ts;
+    if (pthread_getcpuclockid(thread, &clock) != 0 || clock_gettime(clock, &ts) != 0) return 0;
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000);
+}
+
+UBaseType_t uxTaskGetSystemState(TaskStatus_t* status, UBaseType_t count, uint32_t* totalRunTime) {
+    std::lock_guard<std::mutex> guard(s_tasksLock);
+    if (s_tasks.size() > count) return 0;   // wie FreeRTOS: Array zu klein -> nichts
+    for (size_t i = 0; i < s_tasks.size(); i++) {
+        HostTask* task = s_tasks[i];
+        TaskStatus_t& s = status[i];
+        s.xHandle = task;
+        s.pcTaskName = task->name;
+        s.xTaskNumber = task->number;
+        s.eCurrentState = task == t_current ? eRunning : eBlocked;
+        s.uxCurrentPriority = task->priority;
+        s.uxBasePriority = task->priority;
+        s.ulRunTimeCounter = threadCpuMicros(task->thread);
+        s.pxStackBase = nullptr;
+        s.usStackHighWaterMark = task->stackDepth;  // Verbrauch ist auf dem Host unbekannt
+        s.xCoreID = task->core;
+    }
+    if (totalRunTime) *totalRunTime = (uint32_t)hostMicros();
+    return (UBaseType_t)s_tasks.size();
+}
+
+// ------------------------------------------------------------------ Queues
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+    HostQueue* queue = new HostQueue();
+    queue->items.resize((size_t)length * itemSize);
+    queue->length = length;
+    queue->itemSize = itemSize;
+    queue->head = 0;
+    queue->count = 0;
+    return queue;
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+    delete queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticks) {
+    std::unique_lock<std::mutex> guard(queue->lock);
+    if (!waitFor(guard, queue->changed, ticks, [queue] { return queue->count < queue->length; })) return errQUEUE_FULL;
+    if (queue->itemSize) {
+        UBaseType_t tail = (queue->head + queue->count) % queue->length;
+        memcpy(&queue->items[(size_t)tail * queue->itemSize], item, queue->itemSize);
+    }
+    queue->count++;
+    queue->changed.notify_all();
+    return pdPASS;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticks) {
+    std::unique_lock<std::mutex> guard(queue->lock);
+    if (!waitFor(guard, queue->changed, ticks, [queue] { return queue->count > 0; })) return pdFALSE;
+    if (queue->itemSize) memcpy(item, &queue->items[(size_t)queue->head * queue->itemSize], queue->itemSize);
+    queue->head = (queue->head + 1) % queue->length;
+    queue->count--;
+    queue->changed.notify_all();
+    return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    std::lock_guard<std::mutex> guard(queue->lock);
+    return queue->count;
+}
+
+// ------------------------------------------------------------------ Semaphoren
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t maxCount, UBaseType_t initialCount) {
+    HostQueue* sem = xQueueCreate(maxCount, 0);
+    sem->count = initialCount;
+    return sem;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary() {
+    return xSemaphoreCreateCounting(1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+    return xSemaphoreCreateCounting(1, 1);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks) {
+    return xQueueReceive(sem, nullptr, ticks);
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
+    return xQueueSend(sem, nullptr, 0);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem) {
+    vQueueDelete(sem);
+}
@@ -0,0 +1,30 @@
+//================================================================================
+//| DATEI: test/host/shim/HostShim.h                                             |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Gemeinsame Hilfen der Host-Umgebung (nicht Teil der ESP32-API): Zeitbasis    |
+//| für millis()/Ticks/esp_timer und die Einstellungen aus der Kommandozeile von |
+//| host_main.cpp (Port, Wurzelverzeichnis des Dateisystems).                    |
+//================================================================================
+
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * @brief Einstellungen der Host-Umgebung (werden vor setup() gesetzt).
+ */
+struct HostConfig {
+    uint16_t httpPort;      // ersetzt Port 80 der Firmware (0 = Port aus httpd_config_t)
+    const char* fsRoot;     // Verzeichnis, das als SPIFFS-Wurzel dient
+    bool quiet;             // Serial-Ausgaben unterdrücken (Benchmarks)
+};
+
+extern HostConfig hostConfig;
+
+/**
+ * @brief Mikrosekunden seit Programmstart (monoton, Basis für millis() und Ticks).
+ */
+uint64_t hostMicros();
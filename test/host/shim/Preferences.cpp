@@ -0,0 +1,102 @@
+//================================================================================
+//| DATEI: test/host/shim/Preferences.cpp                                        |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| NVS im RAM (siehe Preferences.h). Strings werden wie im NVS mit Nullbyte     |
+//| abgelegt; ein Namensraum, der nur gelesen wird, muss schon existieren.       |
+//================================================================================
+
+#include "Preferences.h"
+#include <map>
+#include <mutex>
+#include <string>
+
+static std::mutex s_nvsLock;
+static std::map<std::string, std::string> s_nvs;        // "namensraum/schlüssel" -> Bytes
+static std::map<std::string, bool> s_namespaces;
+
+static std::string nvsKey(const char* ns, const char* key) {
+    return std::string(ns) + "/" + key;
+}
+
+bool Preferences::begin(const char* name, bool readOnly, const char*) {
+    if (_open || !name || strlen(name) >= sizeof(_ns)) return false;
+    std::lock_guard<std::mutex> guard(s_nvsLock);
+    if (readOnly && !s_namespaces.count(name)) return false;
+    s_namespaces[name] = true;
+    strcpy(_ns, name);
+    _readOnly = readOnly;
+    _open = true;
+    return true;
+}
+
+void Preferences::end() {
+    _open = false;
+}
+
+bool Preferences::clear() {
+    if (!_open || _readOnly) return false;
+    std::lock_guard<std::mutex> guard(s_nvsLock);
+    std::string prefix = nvsKey(_ns, "");
+    for (auto it = s_nvs.lower_bound(prefix); it != s_nvs.end() && it->first.compare(0, prefix.size(), prefix) == 0;) {
+        it = s_nvs.erase(it);
+    }
+    return true;
+}
+
+bool Preferences::remove(const char* key) {
+    if (!_open || _readOnly) return false;
+    std::lock_guard<std::mutex> guard(s_nvsLock);
+    return s_nvs.erase(nvsKey(_ns, key)) > 0;
+}
+
+bool Preferences::isKey(const char* key) {
+    if (!_open) return false;
+    std::lock_guard<std::mutex> guard(s_nvsLock);
+    return s_nvs.count(nvsKey(_ns, key)) > 0;
+}
+
+size_t Preferences::putBytes(const char* key, const void* value, size_t len) {
+    if (!_open || _readOnly || !key || (!value && len)) return 0;
+    std::lock_guard<std::mutex> guard(s_nvsLock);
+    s_nvs[nvsKey(_ns, key)] = std::string((const char*)value, len);
+    return len;
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+    if (!_open) return 0;
+    std::lock_guard<std::mutex> guard(s_nvsLock);
+    auto it = s_nvs.find(nvsKey(_ns, key));
+    return it == s_nvs.end() ? 0 : it->second.size();
+}
+
+size_t Preferences::getBytes(const char* key, void* buf, size_t maxLen) {
+    if (!_open) return 0;
+    std::lock_guard<std::mutex> guard(s_nvsLock);
+    auto it = s_nvs.find(nvsKey(_ns, key));
+    if (it == s_nvs.end() || it->second.size() > maxLen) return 0;
+    memcpy(buf, it->second.data(), it->second.size());
+    return it->second.size();
+}
+
+size_t Preferences::putString(const char* key, const char* value) {
+    if (!value) return 0;
+    return putBytes(key, value, strlen(value) + 1) ? strlen(value) : 0;
+}
+
+size_t Preferences::getString(const char* key, char* value, size_t maxLen) {
+    size_t len = getBytes(key, value, maxLen);
+    return len;
+}
+
+String Preferences::getString(const char* key, const String& defaultValue) {
+    size_t len = getBytesLength(key);
+    if (!len) return defaultValue;
+    char* buf = (char*)malloc(len);
+    if (!buf) return defaultValue;
+    String out = getBytes(key, buf, len) == len ? String(buf) : defaultValue;
+    free(buf);
+    return out;
+}
@@ -0,0 +1,25 @@
+//================================================================================
+//| DATEI: test/host/shim/SPIFFS.h                                               |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| SPIFFS des Host-Shims: das Verzeichnis aus hostConfig.fsRoot (Standard       |
+//| data/, host_main.cpp --fs). Kapazität wie die spiffs-Partition.              |
+//================================================================================
+
+#pragma once
+
+#include "FS.h"
+
+class SPIFFSFS : public fs::FS {
+public:
+    bool begin(bool formatOnFail = false, const char* basePath = "/spiffs", uint8_t maxOpenFiles = 10,
+               const char* partitionLabel = nullptr);
+    void end() {}
+    bool format();
+    size_t totalBytes();
+    size_t usedBytes();
+};
+
+extern SPIFFSFS SPIFFS;
@@ -0,0 +1,125 @@
+//================================================================================
+//| DATEI: test/host/shim/Update.cpp                                             |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Update über die Partitions-Attrappe (siehe Update.h). Dazu die Instanzen     |
+//| von Wire, die sonst der Arduino-Core liefert.                                |
+//================================================================================
+
+#include "Update.h"
+#include "Wire.h"
+#include <esp_ota_ops.h>
+
+UpdateClass Update;
+TwoWire Wire(0);
+
+static const char* const s_errorStrings[] = {
+    "No Error", "Flash Write Failed", "Flash Erase Failed", "Flash Read Failed", "Not Enough Space",
+    "Bad Size Given", "Stream Read Timeout", "MD5 Check Failed", "Wrong Magic Byte",
+    "Could Not Activate The Firmware", "Partition Could Not be Found", "Bad Argument", "Aborted"
+};
+
+UpdateClass::UpdateClass() : _error(UPDATE_ERROR_OK) {
+    reset();
+}
+
+void UpdateClass::reset() {
+    _partition = nullptr;
+    _command = U_FLASH;
+    _size = 0;
+    _progress = 0;
+    _erased = 0;
+}
+
+bool UpdateClass::begin(size_t size, int command) {
+    if (_partition) return false;
+    _error = UPDATE_ERROR_OK;
+    if (size == 0) {
+        _error = UPDATE_ERROR_SIZE;
+        return false;
+    }
+
+    const esp_partition_t* partition = nullptr;
+    if (command == U_FLASH) {
+        partition = esp_ota_get_next_update_partition(nullptr);
+    } else if (command == U_SPIFFS) {
+        partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_SPIFFS, nullptr);
+    } else {
+        _error = UPDATE_ERROR_BAD_ARGUMENT;
+        return false;
+    }
+    if (!partition) {
+        _error = UPDATE_ERROR_NO_PARTITION;
+        return false;
+    }
+    if (size == UPDATE_SIZE_UNKNOWN) size = partition->size;
+    if (size > partition->size) {
+        _error = UPDATE_ERROR_SIZE;
+        return false;
+    }
+
+    _partition = partition;
+    _command = command;
+    _size = size;
+    _progress = 0;
+    _erased = 0;
+    return true;
+}
+
+size_t UpdateClass::write(uint8_t* data, size_t len) {
+    if (!_partition || hasError()) return 0;
+    if (len > _size - _progress) {
+        _error = UPDATE_ERROR_SPACE;
+        return 0;
+    }
+    if (_command == U_FLASH && _progress == 0 && len > 0 && data[0] != 0xE9) {
+        _error = UPDATE_ERROR_MAGIC_BYTE;
+        return 0;
+    }
+
+    size_t end = _progress + len;
+    while (_erased < end) {
+        if (esp_partition_erase_range(_partition, _erased, SPI_FLASH_SEC_SIZE) != ESP_OK) {
+            _error = UPDATE_ERROR_ERASE;
+            return 0;
+        }
+        _erased += SPI_FLASH_SEC_SIZE;
+    }
+    if (esp_partition_write(_partition, _progress, data, len) != ESP_OK) {
+        _error = UPDATE_ERROR_WRITE;
+        return 0;
+    }
+    _progress = end;
+    return len;
+}
+
+bool UpdateClass::end(bool evenIfRemaining) {
+    if (!_partition || hasError()) return false;
+    if (_progress < _size && !evenIfRemaining) {
+        _error = UPDATE_ERROR_ABORT;
+        reset();
+        return false;
+    }
+    if (_command == U_FLASH && esp_ota_set_boot_partition(_partition) != ESP_OK) {
+        _error = UPDATE_ERROR_ACTIVATE;
+        reset();
+        return false;
+    }
+    reset();
+    return true;
+}
+
+void UpdateClass::abort() {
+    reset();
+    _error = UPDATE_ERROR_ABORT;
+}
+
+const char* UpdateClass::errorString() {
+    return _error < sizeof(s_errorStrings) / sizeof(s_errorStrings[0]) ? s_errorStrings[_error] : "UNKNOWN";
+}
+
+void UpdateClass::printError(Print& out) {
+    out.println(errorString());
+}
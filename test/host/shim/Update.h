@@ -0,0 +1,65 @@
+//================================================================================
+//| DATEI: test/host/shim/Update.h                                               |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Update-Bibliothek des Arduino-Cores über die Partitions-Attrappe: Firmware   |
+//| geht in die nächste OTA-Partition, U_SPIFFS in die spiffs-Partition. Wie am  |
+//| Gerät wird sektorweise vor dem Schreiben gelöscht und das Magic-Byte 0xE9    |
+//| eines App-Images geprüft.                                                    |
+//================================================================================
+
+#pragma once
+
+#include <Arduino.h>
+#include <esp_partition.h>
+
+#define U_FLASH  0
+#define U_SPIFFS 100
+#define UPDATE_SIZE_UNKNOWN 0xFFFFFFFF
+
+#define UPDATE_ERROR_OK           0
+#define UPDATE_ERROR_WRITE        1
+#define UPDATE_ERROR_ERASE        2
+#define UPDATE_ERROR_READ         3
+#define UPDATE_ERROR_SPACE        4
+#define UPDATE_ERROR_SIZE         5
+#define UPDATE_ERROR_STREAM       6
+#define UPDATE_ERROR_MD5          7
+#define UPDATE_ERROR_MAGIC_BYTE   8
+#define UPDATE_ERROR_ACTIVATE     9
+#define UPDATE_ERROR_NO_PARTITION 10
+#define UPDATE_ERROR_BAD_ARGUMENT 11
+#define UPDATE_ERROR_ABORT        12
+
+class UpdateClass {
+public:
+    UpdateClass();
+
+    bool begin(size_t size = UPDATE_SIZE_UNKNOWN, int command = U_FLASH);
+    size_t write(uint8_t* data, size_t len);
+    bool end(bool evenIfRemaining = false);
+    void abort();
+
+    bool isRunning() { return _partition != nullptr; }
+    bool hasError() { return _error != UPDATE_ERROR_OK; }
+    uint8_t getError() { return _error; }
+    const char* errorString();
+    void printError(Print& out);
+    size_t size() { return _size; }
+    size_t progress() { return _progress; }
+    size_t remaining() { return _size - _progress; }
+
+private:
+    void reset();
+
+    const esp_partition_t* _partition;
+    int _command;
+    size_t _size;
+    size_t _progress;
+    size_t _erased;     // Ende des bereits gelöschten Bereichs
+    uint8_t _error;
+};
+
+extern UpdateClass Update;
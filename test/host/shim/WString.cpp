@@ -0,0 +1,248 @@
+//================================================================================
+//| DATEI: test/host/shim/WString.cpp                                            |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Implementierung des Host-Strings (siehe WString.h). Speicher kommt direkt    |
+//| aus malloc/realloc, damit die HeapTrace-Wrapper jede Allokation sehen.       |
+//================================================================================
+
+#include "WString.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void formatInteger(char* out, size_t size, unsigned long value, unsigned char base, bool negative) {
+    char tmp[68];
+    size_t n = 0;
+    if (base < 2 || base > 36) base = 10;
+    do {
+        unsigned digit = (unsigned)(value % base);
+        tmp[n++] = (char)(digit < 10 ? '0' + digit : 'A' + digit - 10);
+        value /= base;
+    } while (value && n < sizeof(tmp));
+    size_t pos = 0;
+    if (negative && pos + 1 < size) out[pos++] = '-';
+    while (n && pos + 1 < size) out[pos++] = tmp[--n];
+    out[pos] = '\0';
+}
+
+String::String(const char* cstr) : _heap(nullptr), _capacity(SSO_CAPACITY), _len(0) {
+    _sso[0] = '\0';
+    if (cstr) assign(cstr, (unsigned int)strlen(cstr));
+}
+
+String::String(const String& other) : _heap(nullptr), _capacity(SSO_CAPACITY), _len(0) {
+    _sso[0] = '\0';
+    assign(other.c_str(), other._len);
+}
+
+String::String(char c) : _heap(nullptr), _capacity(SSO_CAPACITY), _len(0) {
+    char buf[2] = {c, '\0'};
+    _sso[0] = '\0';
+    assign(buf, 1);
+}
+
+#define STRING_FROM_INTEGER(type, negative, magnitude)                       \
+    String::String(type value, unsigned char base)                          \
+        : _heap(nullptr), _capacity(SSO_CAPACITY), _len(0) {                \
+        char buf[68];                                                       \
+        formatInteger(buf, sizeof(buf), magnitude, base, negative);         \
+        assign(buf, (unsigned int)strlen(buf));                             \
+    }
+
+STRING_FROM_INTEGER(unsigned char, false, (unsigned long)value)
+STRING_FROM_INTEGER(int, value < 0 && base == 10, value < 0 && base == 10 ? 0UL - (unsigned long)value : (unsigned long)(unsigned int)value)
+STRING_FROM_INTEGER(unsigned int, false, (unsigned long)value)
+STRING_FROM_INTEGER(long, value < 0 && base == 10, value < 0 && base == 10 ? 0UL - (unsigned long)value : (unsigned long)value)
+STRING_FROM_INTEGER(unsigned long, false, value)
+#undef STRING_FROM_INTEGER
+
+String::String(float value, unsigned int decimalPlaces) : _heap(nullptr), _capacity(SSO_CAPACITY), _len(0) {
+    char buf[48];
+    snprintf(buf, sizeof(buf), "%.*f", (int)decimalPlaces, (double)value);
+    assign(buf, (unsigned int)strlen(buf));
+}
+
+String::String(double value, unsigned int decimalPlaces) : _heap(nullptr), _capacity(SSO_CAPACITY), _len(0) {
+    char buf[48];
+    snprintf(buf, sizeof(buf), "%.*f", (int)decimalPlaces, value);
+    assign(buf, (unsigned int)strlen(buf));
+}
+
+String::~String() {
+    free(_heap);
+}
+
+String& String::operator=(const String& other) {
+    if (this != &other) assign(other.c_str(), other._len);
+    return *this;
+}
+
+String& String::operator=(const char* cstr) {
+    if (cstr) assign(cstr, (unsigned int)strlen(cstr));
+    else assign("", 0);
+    return *this;
+}
+
+/**
+ * @brief Wie WString::changeBuffer(): genau die angefragte Größe, keine Reserve.
+ */
+bool String::reserve(unsigned int size) {
+    if (size <= _capacity) return true;
+    char* grown = (char*)realloc(_heap, size + 1);
+    if (!grown) return false;
+    if (!_heap) memcpy(grown, _sso, _len + 1);
+    _heap = grown;
+    _capacity = size;
+    return true;
+}
+
+bool String::assign(const char* cstr, unsigned int length) {
+    if (!reserve(length)) return false;
+    memmove(buffer(), cstr, length);
+    _len = length;
+    buffer()[_len] = '\0';
+    return true;
+}
+
+bool String::concat(const char* cstr, unsigned int length) {
+    if (!cstr || !length) return true;
+    // Quelle kann im eigenen Puffer liegen (s += s), realloc verschiebt ihn evtl.
+    if (cstr >= buffer() && cstr < buffer() + _len + 1) {
+        unsigned int offset = (unsigned int)(cstr - buffer());
+        if (!reserve(_len + length)) return false;
+        cstr = buffer() + offset;
+    } else if (!reserve(_len + length)) {
+        return false;
+    }
+    memmove(buffer() + _len, cstr, length);
+    _len += length;
+    buffer()[_len] = '\0';
+    return true;
+}
+
+bool String::concat(const String& other) { return concat(other.c_str(), other._len); }
+bool String::concat(const char* cstr) { return cstr ? concat(cstr, (unsigned int)strlen(cstr)) : false; }
+bool String::concat(char c) { return concat(&c, 1); }
+bool String::concat(int value) { return concat(String(value)); }
+bool String::concat(unsigned int value) { return concat(String(value)); }
+bool String::concat(long value) { return concat(String(value)); }
+bool String::concat(unsigned long value) { return concat(String(value)); }
+bool String::concat(float value) { return concat(String(value)); }
+bool String::concat(double value) { return concat(String(value)); }
+
+int String::compareTo(const String& other) const { return strcmp(c_str(), other.c_str()); }
+bool String::equals(const String& other) const { return _len == other._len && compareTo(other) == 0; }
+bool String::equals(const char* cstr) const { return strcmp(c_str(), cstr ? cstr : "") == 0; }
+bool String::equalsIgnoreCase(const String& other) const {
+    return _len == other._len && strcasecmp(c_str(), other.c_str()) == 0;
+}
+
+bool String::startsWith(const String& prefix) const {
+    return prefix._len <= _len && strncmp(c_str(), prefix.c_str(), prefix._len) == 0;
+}
+
+bool String::endsWith(const String& suffix) const {
+    return suffix._len <= _len && strcmp(c_str() + _len - suffix._len, suffix.c_str()) == 0;
+}
+
+char String::charAt(unsigned int index) const { return index < _len ? c_str()[index] : '\0'; }
+
+int String::indexOf(char c, unsigned int from) const {
+    if (from >= _len) return -1;
+    const char* hit = strchr(c_str() + from, c);
+    return hit ? (int)(hit - c_str()) : -1;
+}
+
+int String::indexOf(const String& str, unsigned int from) const {
+    if (from >= _len) return -1;
+    const char* hit = strstr(c_str() + from, str.c_str());
+    return hit ? (int)(hit - c_str()) : -1;
+}
+
+int String::lastIndexOf(char c) const {
+    const char* hit = strrchr(c_str(), c);
+    return hit ? (int)(hit - c_str()) : -1;
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+    if (from > to) {
+        unsigned int tmp = from;
+        from = to;
+        to = tmp;
+    }
+    String out;
+    if (from >= _len) return out;
+    if (to > _len) to = _len;
+    out.assign(c_str() + from, to - from);
+    return out;
+}
+
+void String::replace(const String& find, const String& replacement) {
+    if (!find._len) return;
+    String out;
+    const char* pos = c_str();
+    const char* hit;
+    while ((hit = strstr(pos, find.c_str())) != nullptr) {
+        out.concat(pos, (unsigned int)(hit - pos));
+        out.concat(replacement);
+        pos = hit + find._len;
+    }
+    out.concat(pos);
+    *this = out;
+}
+
+void String::remove(unsigned int index, unsigned int count) {
+    if (index >= _len) return;
+    if (count > _len - index) count = _len - index;
+    memmove(buffer() + index, buffer() + index + count, _len - index - count + 1);
+    _len -= count;
+}
+
+void String::toLowerCase() {
+    for (char* p = buffer(); *p; p++) *p = (char)tolower((unsigned char)*p);
+}
+
+void String::toUpperCase() {
+    for (char* p = buffer(); *p; p++) *p = (char)toupper((unsigned char)*p);
+}
+
+void String::trim() {
+    unsigned int start = 0, end = _len;
+    while (start < end && isspace((unsigned char)c_str()[start])) start++;
+    while (end > start && isspace((unsigned char)c_str()[end - 1])) end--;
+    memmove(buffer(), c_str() + start, end - start);
+    _len = end - start;
+    buffer()[_len] = '\0';
+}
+
+long String::toInt() const { return atol(c_str()); }
+float String::toFloat() const { return (float)atof(c_str()); }
+double String::toDouble() const { return atof(c_str()); }
+
+String operator+(const String& lhs, const String& rhs) {
+    String out(lhs);
+    out.concat(rhs);
+    return out;
+}
+
+String operator+(const String& lhs, const char* rhs) {
+    String out(lhs);
+    out.concat(rhs);
+    return out;
+}
+
+String operator+(const char* lhs, const String& rhs) {
+    String out(lhs);
+    out.concat(rhs);
+    return out;
+}
+
+String operator+(const String& lhs, char rhs) {
+    String out(lhs);
+    out.concat(rhs);
+    return out;
+}
@@ -0,0 +1,102 @@
+//================================================================================
+//| DATEI: test/host/shim/WString.h                                              |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Arduino-String für den Host. Verhält sich beim Speicher wie der WString des  |
+//| ESP32-Cores: bis 11 Zeichen im Objekt (SSO), darüber ein Heap-Block, der bei |
+//| jedem Anhängen per realloc auf genau die neue Länge wächst. Damit zählt der  |
+//| Host-Benchmark dieselben Allokationen wie das Gerät.                         |
+//================================================================================
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+class String {
+public:
+    String(const char* cstr = "");
+    String(const String& other);
+    explicit String(char c);
+    explicit String(unsigned char value, unsigned char base = 10);
+    explicit String(int value, unsigned char base = 10);
+    explicit String(unsigned int value, unsigned char base = 10);
+    explicit String(long value, unsigned char base = 10);
+    explicit String(unsigned long value, unsigned char base = 10);
+    explicit String(float value, unsigned int decimalPlaces = 2);
+    explicit String(double value, unsigned int decimalPlaces = 2);
+    ~String();
+
+    String& operator=(const String& other);
+    String& operator=(const char* cstr);
+
+    bool reserve(unsigned int size);
+    unsigned int length() const { return _len; }
+    bool isEmpty() const { return _len == 0; }
+    const char* c_str() const { return buffer(); }
+
+    bool concat(const String& other);
+    bool concat(const char* cstr);
+    bool concat(const char* cstr, unsigned int length);
+    bool concat(char c);
+    bool concat(int value);
+    bool concat(unsigned int value);
+    bool concat(long value);
+    bool concat(unsigned long value);
+    bool concat(float value);
+    bool concat(double value);
+
+    template <class T> String& operator+=(const T& value) {
+        concat(value);
+        return *this;
+    }
+
+    int compareTo(const String& other) const;
+    bool equals(const String& other) const;
+    bool equals(const char* cstr) const;
+    bool equalsIgnoreCase(const String& other) const;
+    bool operator==(const String& other) const { return equals(other); }
+    bool operator==(const char* cstr) const { return equals(cstr); }
+    bool operator!=(const String& other) const { return !equals(other); }
+    bool operator!=(const char* cstr) const { return !equals(cstr); }
+    bool operator<(const String& other) const { return compareTo(other) < 0; }
+    bool startsWith(const String& prefix) const;
+    bool endsWith(const String& suffix) const;
+
+    char charAt(unsigned int index) const;
+    char operator[](unsigned int index) const { return charAt(index); }
+    int indexOf(char c, unsigned int from = 0) const;
+    int indexOf(const String& str, unsigned int from = 0) const;
+    int lastIndexOf(char c) const;
+    String substring(unsigned int from) const { return substring(from, _len); }
+    String substring(unsigned int from, unsigned int to) const;
+
+    void replace(const String& find, const String& replace);
+    void remove(unsigned int index, unsigned int count = (unsigned int)-1);
+    void toLowerCase();
+    void toUpperCase();
+    void trim();
+
+    long toInt() const;
+    float toFloat() const;
+    double toDouble() const;
+
+private:
+    enum { SSO_CAPACITY = 11 };     // wie der ESP32-Core (12 Byte inkl. Nullbyte)
+
+    char* buffer() { return _heap ? _heap : _sso; }
+    const char* buffer() const { return _heap ? _heap : _sso; }
+    bool assign(const char* cstr, unsigned int length);
+
+    char _sso[SSO_CAPACITY + 1];
+    char* _heap;
+    unsigned int _capacity;
+    unsigned int _len;
+};
+
+String operator+(const String& lhs, const String& rhs);
+String operator+(const String& lhs, const char* rhs);
+String operator+(const char* lhs, const String& rhs);
+String operator+(const String& lhs, char rhs);
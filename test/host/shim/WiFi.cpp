@@ -0,0 +1,125 @@
+//================================================================================
+//| DATEI: test/host/shim/WiFi.cpp                                               |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| WLAN-Attrappe (siehe WiFi.h). Die Callbacks laufen wie auf dem Gerät in      |
+//| einem eigenen Task, nie im Aufrufer von begin().                             |
+//================================================================================
+
+#include "WiFi.h"
+
+WiFiClass WiFi;
+
+// Verzögerung bis STA_GOT_IP, grob wie ein schneller Verbindungsaufbau am Gerät.
+#define HOST_WIFI_CONNECT_MS 150
+
+struct ConnectJob {
+    WiFiClass* wifi;
+    uint32_t attempt;
+};
+
+String IPAddress::toString() const {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%u.%u.%u.%u", (*this)[0], (*this)[1], (*this)[2], (*this)[3]);
+    return String(buf);
+}
+
+WiFiClass::WiFiClass()
+    : _mode(WIFI_OFF), _status(WL_IDLE_STATUS), _attempt(0),
+      _ip(127, 0, 0, 1), _gateway(127, 0, 0, 1), _mask(255, 0, 0, 0), _dns(127, 0, 0, 1) {
+    static const uint8_t bssid[6] = {0x02, 0x48, 0x53, 0x41, 0x50, 0x01};
+    memcpy(_bssid, bssid, sizeof(_bssid));
+    memset(_callbacks, 0, sizeof(_callbacks));
+}
+
+bool WiFiClass::mode(wifi_mode_t mode) {
+    _mode = mode;
+    return true;
+}
+
+int WiFiClass::onEvent(WiFiEventSysCb cb) {
+    for (size_t i = 0; i < sizeof(_callbacks) / sizeof(_callbacks[0]); i++) {
+        if (!_callbacks[i]) {
+            _callbacks[i] = cb;
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+void WiFiClass::fire(arduino_event_id_t event, uint8_t reason) {
+    arduino_event_info_t info;
+    memset(&info, 0, sizeof(info));
+    info.wifi_sta_disconnected.reason = reason;
+    for (size_t i = 0; i < sizeof(_callbacks) / sizeof(_callbacks[0]); i++) {
+        if (_callbacks[i]) _callbacks[i](event, info);
+    }
+}
+
+bool WiFiClass::config(IPAddress localIp, IPAddress gateway, IPAddress subnet, IPAddress dns1) {
+    // Eine statische Adresse wird übernommen, DHCP (alles 0) liefert Loopback.
+    if ((uint32_t)localIp != 0) {
+        _ip = localIp;
+        _gateway = gateway;
+        _mask = subnet;
+        _dns = dns1;
+    } else {
+        _ip = IPAddress(127, 0, 0, 1);
+        _gateway = IPAddress(127, 0, 0, 1);
+        _mask = IPAddress(255, 0, 0, 0);
+        _dns = IPAddress(127, 0, 0, 1);
+    }
+    return true;
+}
+
+wl_status_t WiFiClass::begin(const char* ssid, const char*, int32_t, const uint8_t*, bool connect) {
+    if (!(_mode & WIFI_STA)) _mode = (wifi_mode_t)(_mode | WIFI_STA);
+    _ssid = ssid ? ssid : "";
+    _status = WL_DISCONNECTED;
+    if (!connect) return _status;
+
+    ConnectJob* job = new ConnectJob{this, ++_attempt};
+    xTaskCreate(connectTask, "wifiHost", 4096, job, 1, nullptr);
+    return _status;
+}
+
+void WiFiClass::connectTask(void* arg) {
+    ConnectJob* job = (ConnectJob*)arg;
+    vTaskDelay(pdMS_TO_TICKS(HOST_WIFI_CONNECT_MS));
+    WiFiClass* self = job->wifi;
+    if (job->attempt == self->_attempt && self->_status == WL_DISCONNECTED) {
+        self->fire(ARDUINO_EVENT_WIFI_STA_CONNECTED);
+        self->_status = WL_CONNECTED;
+        self->fire(ARDUINO_EVENT_WIFI_STA_GOT_IP);
+    }
+    delete job;
+    vTaskDelete(nullptr);
+}
+
+bool WiFiClass::disconnect(bool, bool) {
+    _attempt++;
+    bool wasConnected = _status == WL_CONNECTED;
+    _status = WL_DISCONNECTED;
+    if (wasConnected) fire(ARDUINO_EVENT_WIFI_STA_DISCONNECTED, 8);     // WIFI_REASON_ASSOC_LEAVE
+    return true;
+}
+
+String WiFiClass::macAddress() {
+    uint8_t mac[6];
+    esp_read_mac(mac, ESP_MAC_WIFI_STA);
+    char buf[18];
+    snprintf(buf, sizeof(buf), "%02X:%02X:%02X:%02X:%02X:%02X", mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+    return String(buf);
+}
+
+bool WiFiClass::softAP(const char*, const char*) {
+    _mode = (wifi_mode_t)(_mode | WIFI_AP);
+    return true;
+}
+
+bool WiFiClass::softAPdisconnect(bool) {
+    _mode = (wifi_mode_t)(_mode & ~WIFI_AP);
+    return true;
+}
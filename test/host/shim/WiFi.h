@@ -0,0 +1,116 @@
+//================================================================================
+//| DATEI: test/host/shim/WiFi.h                                                 |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| WLAN-Stack des Arduino-Cores als Attrappe: begin() "verbindet" nach kurzer   |
+//| Zeit mit jedem Netz und meldet STA_CONNECTED/STA_GOT_IP über die             |
+//| registrierten Callbacks, genau wie der Event-Task auf dem Gerät. Die lokale  |
+//| IP ist 127.0.0.1, dort lauscht auch der Host-httpd.                          |
+//================================================================================
+
+#pragma once
+
+#include <Arduino.h>
+#include <functional>
+
+class IPAddress : public Printable {
+public:
+    IPAddress() : _addr(0) {}
+    IPAddress(uint32_t addr) : _addr(addr) {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+        : _addr((uint32_t)a | ((uint32_t)b << 8) | ((uint32_t)c << 16) | ((uint32_t)d << 24)) {}
+
+    operator uint32_t() const { return _addr; }
+    uint8_t operator[](int index) const { return (uint8_t)(_addr >> (index * 8)); }
+    bool operator==(const IPAddress& other) const { return _addr == other._addr; }
+    bool operator!=(const IPAddress& other) const { return _addr != other._addr; }
+    String toString() const;
+    size_t printTo(Print& out) const override { return out.print(toString()); }
+
+private:
+    uint32_t _addr;     // Netzwerk-Byte-Reihenfolge wie lwIP
+};
+
+typedef enum { WIFI_OFF = 0, WIFI_STA = 1, WIFI_AP = 2, WIFI_AP_STA = 3 } wifi_mode_t;
+
+typedef enum {
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_CONNECTION_LOST = 5,
+    WL_DISCONNECTED = 6
+} wl_status_t;
+
+typedef enum {
+    ARDUINO_EVENT_WIFI_READY = 0,
+    ARDUINO_EVENT_WIFI_STA_START = 2,
+    ARDUINO_EVENT_WIFI_STA_STOP = 3,
+    ARDUINO_EVENT_WIFI_STA_CONNECTED = 4,
+    ARDUINO_EVENT_WIFI_STA_DISCONNECTED = 5,
+    ARDUINO_EVENT_WIFI_STA_GOT_IP = 7,
+    ARDUINO_EVENT_WIFI_STA_LOST_IP = 9,
+    ARDUINO_EVENT_WIFI_AP_START = 10,
+    ARDUINO_EVENT_WIFI_AP_STOP = 11
+} arduino_event_id_t;
+
+typedef struct {
+    uint8_t ssid[32];
+    uint8_t ssid_len;
+    uint8_t bssid[6];
+    uint8_t reason;
+} wifi_event_sta_disconnected_t;
+
+typedef union {
+    wifi_event_sta_disconnected_t wifi_sta_disconnected;
+} arduino_event_info_t;
+
+typedef void (*WiFiEventSysCb)(arduino_event_id_t event, arduino_event_info_t info);
+
+class WiFiClass {
+public:
+    WiFiClass();
+
+    void persistent(bool) {}
+    bool setAutoReconnect(bool) { return true; }
+    bool setHostname(const char*) { return true; }
+    bool mode(wifi_mode_t mode);
+    wifi_mode_t getMode() { return _mode; }
+    int onEvent(WiFiEventSysCb cb);
+
+    bool config(IPAddress localIp, IPAddress gateway, IPAddress subnet, IPAddress dns1 = IPAddress());
+    wl_status_t begin(const char* ssid, const char* password = nullptr, int32_t channel = 0,
+                      const uint8_t* bssid = nullptr, bool connect = true);
+    bool disconnect(bool wifiOff = false, bool eraseAp = false);
+    wl_status_t status() { return _status; }
+
+    IPAddress localIP() { return _status == WL_CONNECTED ? _ip : IPAddress(); }
+    IPAddress gatewayIP() { return _status == WL_CONNECTED ? _gateway : IPAddress(); }
+    IPAddress subnetMask() { return _status == WL_CONNECTED ? _mask : IPAddress(); }
+    IPAddress dnsIP(uint8_t = 0) { return _status == WL_CONNECTED ? _dns : IPAddress(); }
+    String SSID() { return _status == WL_CONNECTED ? _ssid : String(); }
+    uint8_t* BSSID() { return _status == WL_CONNECTED ? _bssid : nullptr; }
+    int32_t channel() { return _status == WL_CONNECTED ? 6 : 0; }
+    int8_t RSSI() { return _status == WL_CONNECTED ? -55 : 0; }
+    String macAddress();
+
+    bool softAP(const char* ssid, const char* password = nullptr);
+    bool softAPdisconnect(bool wifiOff = false);
+    IPAddress softAPIP() { return (_mode & WIFI_AP) ? IPAddress(192, 168, 4, 1) : IPAddress(); }
+
+private:
+    void fire(arduino_event_id_t event, uint8_t reason = 0);
+    static void connectTask(void* arg);
+
+    wifi_mode_t _mode;
+    volatile wl_status_t _status;
+    volatile uint32_t _attempt;     // verwirft verspätete Verbindungen nach disconnect()
+    String _ssid;
+    uint8_t _bssid[6];
+    IPAddress _ip, _gateway, _mask, _dns;
+    WiFiEventSysCb _callbacks[4];
+};
+
+extern WiFiClass WiFi;
@@ -0,0 +1,34 @@
+//================================================================================
+//| DATEI: test/host/shim/Wire.h                                                 |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| I2C ohne Teilnehmer: Jede Übertragung endet mit NACK auf die Adresse         |
+//| (Fehler 2), der BalanceDriver findet also keine MPU und bleibt im            |
+//| Ruhezustand - auf dem Host dreht sich kein Motor.                            |
+//================================================================================
+
+#pragma once
+
+#include <Arduino.h>
+
+class TwoWire {
+public:
+    explicit TwoWire(uint8_t busNum = 0) : _busNum(busNum) {}
+
+    bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0) { return true; }
+    bool setClock(uint32_t) { return true; }
+    void beginTransmission(uint16_t) {}
+    uint8_t endTransmission(bool = true) { return 2; }
+    size_t write(uint8_t) { return 1; }
+    size_t write(const uint8_t*, size_t len) { return len; }
+    size_t requestFrom(uint16_t, size_t, bool = true) { return 0; }
+    int available() { return 0; }
+    int read() { return -1; }
+
+private:
+    uint8_t _busNum;
+};
+
+extern TwoWire Wire;
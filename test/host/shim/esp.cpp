@@ -0,0 +1,219 @@
+//================================================================================
+//| DATEI: test/host/shim/esp.cpp                                                |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| ESP-IDF-Funktionen des Host-Shims: Zeit, Heap-Abfragen, Partitionen im RAM   |
+//| (Layout aus partitions.csv), OTA-Boot-Auswahl, Hooks und Systeminfos.        |
+//================================================================================
+
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "esp_partition.h"
+#include "esp_ota_ops.h"
+#include "esp_freertos_hooks.h"
+#include "hal/cpu_hal.h"
+#include "HostShim.h"
+#include <malloc.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <mutex>
+
+#ifdef HEAP_TRACKING
+// Wie auf dem Gerät: heap_caps_malloc() läuft am --wrap=malloc vorbei.
+extern "C" void* __real_malloc(size_t size);
+extern "C" void __real_free(void* ptr);
+#define HEAP_CAPS_MALLOC(size) __real_malloc(size)
+#define HEAP_CAPS_FREE(ptr)    __real_free(ptr)
+#else
+#define HEAP_CAPS_MALLOC(size) malloc(size)
+#define HEAP_CAPS_FREE(ptr)    free(ptr)
+#endif
+
+// ------------------------------------------------------------------ System
+
+int64_t esp_timer_get_time() {
+    return (int64_t)hostMicros();
+}
+
+uint32_t cpu_hal_get_cycle_count() {
+    return (uint32_t)(hostMicros() * 240);
+}
+
+esp_reset_reason_t esp_reset_reason() {
+    return ESP_RST_POWERON;
+}
+
+esp_err_t esp_read_mac(uint8_t* mac, esp_mac_type_t type) {
+    static const uint8_t base[6] = {0x02, 0x48, 0x53, 0x44, 0x00, 0x01};  // lokal verwaltet
+    memcpy(mac, base, 6);
+    mac[5] += (uint8_t)type;
+    return ESP_OK;
+}
+
+uint32_t esp_get_free_heap_size() {
+    return (uint32_t)heap_caps_get_free_size(MALLOC_CAP_8BIT);
+}
+
+// ------------------------------------------------------------------ Heap
+
+static std::atomic<size_t> s_minFree(HOST_HEAP_SIZE);
+
+void* heap_caps_malloc(size_t size, uint32_t) {
+    return HEAP_CAPS_MALLOC(size);
+}
+
+void heap_caps_free(void* ptr) {
+    HEAP_CAPS_FREE(ptr);
+}
+
+size_t heap_caps_get_allocated_size(void* ptr) {
+    return malloc_usable_size(ptr);
+}
+
+/**
+ * @brief Freier Speicher = ESP32-RAM minus das, was der Prozess gerade belegt.
+ * Die glibc zerfällt anders als der ESP32-Heap, daher gilt der ganze freie Rest
+ * als ein Block (Fragmentierung 0 auf dem Host).
+ */
+void heap_caps_get_info(multi_heap_info_t* info, uint32_t) {
+    struct mallinfo2 mi = mallinfo2();
+    size_t used = mi.uordblks + mi.hblkhd;
+    size_t total = HOST_HEAP_SIZE > used ? HOST_HEAP_SIZE - used : 0;
+    memset(info, 0, sizeof(*info));
+    info->total_free_bytes = total;
+    info->total_allocated_bytes = used;
+    info->largest_free_block = total;
+    info->allocated_blocks = mi.ordblks + mi.hblks;
+    info->free_blocks = mi.ordblks ? mi.ordblks : 1;
+    info->total_blocks = info->allocated_blocks + info->free_blocks;
+
+    size_t min = s_minFree.load();
+    while (total < min && !s_minFree.compare_exchange_weak(min, total)) {}
+    info->minimum_free_bytes = s_minFree.load();
+}
+
+size_t heap_caps_get_free_size(uint32_t caps) {
+    multi_heap_info_t info;
+    heap_caps_get_info(&info, caps);
+    return info.total_free_bytes;
+}
+
+size_t heap_caps_get_minimum_free_size(uint32_t caps) {
+    multi_heap_info_t info;
+    heap_caps_get_info(&info, caps);
+    return info.minimum_free_bytes;
+}
+
+size_t heap_caps_get_largest_free_block(uint32_t caps) {
+    multi_heap_info_t info;
+    heap_caps_get_info(&info, caps);
+    return info.largest_free_block;
+}
+
+// ------------------------------------------------------------------ Partitionen
+
+static esp_partition_t s_partitions[] = {
+    {nullptr, ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_NVS, 0x9000, 0x5000, "nvs", false},
+    {nullptr, ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_OTA, 0xe000, 0x2000, "otadata", false},
+    {nullptr, ESP_PARTITION_TYPE_APP, ESP_PARTITION_SUBTYPE_APP_OTA_0, 0x10000, 0x140000, "app0", false},
+    {nullptr, ESP_PARTITION_TYPE_APP, ESP_PARTITION_SUBTYPE_APP_OTA_1, 0x150000, 0x140000, "app1", false},
+    {nullptr, ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_SPIFFS, 0x290000, 0x130000, "spiffs", false},
+    {nullptr, ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_NVS, 0x3C0000, 0x40000, "nvs2", false},
+};
+static const size_t PARTITION_COUNT = sizeof(s_partitions) / sizeof(s_partitions[0]);
+static uint8_t* s_flash[PARTITION_COUNT];
+static std::mutex s_flashLock;
+static const esp_partition_t* s_boot = &s_partitions[2];
+
+uint8_t* host_partition_data(const esp_partition_t* partition) {
+    size_t index = (size_t)(partition - s_partitions);
+    if (index >= PARTITION_COUNT) return nullptr;
+    std::lock_guard<std::mutex> guard(s_flashLock);
+    if (!s_flash[index]) {
+        // Gelöschter Flash liest 0xFF. Direkt vom System, damit es nicht im Heap-Report auftaucht.
+        s_flash[index] = (uint8_t*)HEAP_CAPS_MALLOC(partition->size);
+        memset(s_flash[index], 0xFF, partition->size);
+    }
+    return s_flash[index];
+}
+
+const esp_partition_t* esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype,
+                                                const char* label) {
+    for (size_t i = 0; i < PARTITION_COUNT; i++) {
+        const esp_partition_t& p = s_partitions[i];
+        if (p.type != type) continue;
+        if (subtype != ESP_PARTITION_SUBTYPE_ANY && p.subtype != subtype) continue;
+        if (label && strcmp(label, p.label) != 0) continue;
+        return &p;
+    }
+    return nullptr;
+}
+
+static bool inRange(const esp_partition_t* partition, size_t offset, size_t size) {
+    return partition && offset <= partition->size && size <= partition->size - offset;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t* partition, size_t offset, void* dst, size_t size) {
+    if (!inRange(partition, offset, size)) return ESP_ERR_INVALID_SIZE;
+    memcpy(dst, host_partition_data(partition) + offset, size);
+    return ESP_OK;
+}
+
+/**
+ * @brief Wie NOR-Flash: Schreiben kann Bits nur von 1 auf 0 setzen.
+ */
+esp_err_t esp_partition_write(const esp_partition_t* partition, size_t offset, const void* src, size_t size) {
+    if (!inRange(partition, offset, size)) return ESP_ERR_INVALID_SIZE;
+    uint8_t* flash = host_partition_data(partition) + offset;
+    const uint8_t* data = (const uint8_t*)src;
+    for (size_t i = 0; i < size; i++) flash[i] &= data[i];
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t* partition, size_t offset, size_t size) {
+    if (!inRange(partition, offset, size)) return ESP_ERR_INVALID_SIZE;
+    if (offset % SPI_FLASH_SEC_SIZE || size % SPI_FLASH_SEC_SIZE) return ESP_ERR_INVALID_ARG;
+    memset(host_partition_data(partition) + offset, 0xFF, size);
+    return ESP_OK;
+}
+
+// ------------------------------------------------------------------ OTA
+
+const esp_partition_t* esp_ota_get_running_partition() {
+    return &s_partitions[2];
+}
+
+const esp_partition_t* esp_ota_get_boot_partition() {
+    return s_boot;
+}
+
+const esp_partition_t* esp_ota_get_next_update_partition(const esp_partition_t* start) {
+    const esp_partition_t* from = start ? start : esp_ota_get_running_partition();
+    return from == &s_partitions[2] ? &s_partitions[3] : &s_partitions[2];
+}
+
+esp_err_t esp_ota_set_boot_partition(const esp_partition_t* partition) {
+    if (!partition || partition->type != ESP_PARTITION_TYPE_APP) return ESP_ERR_INVALID_ARG;
+    s_boot = partition;
+    return ESP_OK;
+}
+
+int esp_ota_get_app_elf_sha256(char* dst, size_t size) {
+    static const char hostSha[] = "0000000000000000000000000000000000000000000000000000000000000000";
+    if (!dst || !size) return 0;
+    size_t n = size - 1 < sizeof(hostSha) - 1 ? size - 1 : sizeof(hostSha) - 1;
+    memcpy(dst, hostSha, n);
+    dst[n] = '\0';
+    return (int)n;
+}
+
+// ------------------------------------------------------------------ Hooks
+
+esp_err_t esp_register_freertos_idle_hook_for_cpu(esp_freertos_idle_cb_t, UBaseType_t) { return ESP_OK; }
+esp_err_t esp_register_freertos_tick_hook_for_cpu(esp_freertos_tick_cb_t, UBaseType_t) { return ESP_OK; }
+void esp_deregister_freertos_idle_hook_for_cpu(esp_freertos_idle_cb_t, UBaseType_t) {}
+void esp_deregister_freertos_tick_hook_for_cpu(esp_freertos_tick_cb_t, UBaseType_t) {}
@@ -0,0 +1,17 @@
+//================================================================================
+//| DATEI: test/host/shim/esp_cpu.h                                              |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Rückgabeadresse -> Aufrufstelle (Xtensa: obere zwei Bits = Fenstergröße).    |
+//================================================================================
+
+#pragma once
+
+#include <stdint.h>
+
+static inline uint32_t esp_cpu_process_stack_pc(uint32_t pc) {
+    if (pc & 0x80000000) pc = (pc & 0x3fffffff) | 0x40000000;
+    return pc - 3;
+}
@@ -0,0 +1,21 @@
+//================================================================================
+//| DATEI: test/host/shim/esp_debug_helpers.h                                    |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Backtrace-Schritt des Xtensa-Ports. Auf dem Host gibt es keinen Frame.       |
+//================================================================================
+
+#pragma once
+
+#include <stdint.h>
+
+typedef struct {
+    uint32_t pc;
+    uint32_t sp;
+    uint32_t next_pc;
+    const void* exc_frame;
+} esp_backtrace_frame_t;
+
+static inline bool esp_backtrace_get_next_frame(esp_backtrace_frame_t*) { return false; }
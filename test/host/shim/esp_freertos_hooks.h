@@ -0,0 +1,22 @@
+//================================================================================
+//| DATEI: test/host/shim/esp_freertos_hooks.h                                   |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Idle- und Tick-Hooks. Die Anmeldung gelingt, aufgerufen werden sie auf dem   |
+//| Host nie (kein IDLE-Task, kein Tick-Interrupt mit Ausnahme-Frame).           |
+//================================================================================
+
+#pragma once
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+typedef bool (*esp_freertos_idle_cb_t)();
+typedef void (*esp_freertos_tick_cb_t)();
+
+esp_err_t esp_register_freertos_idle_hook_for_cpu(esp_freertos_idle_cb_t cb, UBaseType_t cpu);
+esp_err_t esp_register_freertos_tick_hook_for_cpu(esp_freertos_tick_cb_t cb, UBaseType_t cpu);
+void esp_deregister_freertos_idle_hook_for_cpu(esp_freertos_idle_cb_t cb, UBaseType_t cpu);
+void esp_deregister_freertos_tick_hook_for_cpu(esp_freertos_tick_cb_t cb, UBaseType_t cpu);
@@ -0,0 +1,20 @@
+//================================================================================
+//| DATEI: test/host/shim/esp_idf_version.h                                      |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| ESP-IDF-Version. Standard ist die des Arduino-Cores 2.x (4.4); mit           |
+//| -DHOST_IDF_VERSION=ESP_IDF_VERSION_VAL(5, 1, 0) läuft der Host mit dem       |
+//| Worker-Offload des AsyncWebServers (httpd_req_async_handler_*).              |
+//================================================================================
+
+#pragma once
+
+#define ESP_IDF_VERSION_VAL(major, minor, patch) (((major) << 16) | ((minor) << 8) | (patch))
+
+#ifdef HOST_IDF_VERSION
+#define ESP_IDF_VERSION HOST_IDF_VERSION
+#else
+#define ESP_IDF_VERSION ESP_IDF_VERSION_VAL(4, 4, 5)
+#endif
@@ -0,0 +1,18 @@
+//================================================================================
+//| DATEI: test/host/shim/esp_ota_ops.h                                          |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| OTA-Partitionen des Host-Shims: läuft aus app0, schreibt nach app1.          |
+//================================================================================
+
+#pragma once
+
+#include "esp_partition.h"
+
+const esp_partition_t* esp_ota_get_running_partition();
+const esp_partition_t* esp_ota_get_next_update_partition(const esp_partition_t* start);
+const esp_partition_t* esp_ota_get_boot_partition();
+esp_err_t esp_ota_set_boot_partition(const esp_partition_t* partition);
+int esp_ota_get_app_elf_sha256(char* dst, size_t size);
@@ -0,0 +1,18 @@
+//================================================================================
+//| DATEI: test/host/shim/esp_rom_crc.h                                          |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| CRC-32 aus dem ROM. Die zlib rechnet dasselbe Polynom mit derselben          |
+//| Vor- und Nachinvertierung (esp_rom_crc32_le(0, ...) == crc32(0, ...)).       |
+//================================================================================
+
+#pragma once
+
+#include <stdint.h>
+#include <zlib.h>
+
+static inline uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t* buf, uint32_t len) {
+    return (uint32_t)crc32(crc, buf, len);
+}
@@ -0,0 +1,15 @@
+//================================================================================
+//| DATEI: test/host/shim/esp_task_wdt.h                                         |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Task-Watchdog (auf dem Host ohne Funktion).                                  |
+//================================================================================
+
+#pragma once
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+static inline esp_err_t esp_task_wdt_reset() { return ESP_OK; }
@@ -0,0 +1,14 @@
+//================================================================================
+//| DATEI: test/host/shim/esp_timer.h                                            |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Mikrosekunden seit dem Start (gleiche Zeitbasis wie millis()).               |
+//================================================================================
+
+#pragma once
+
+#include <stdint.h>
+
+int64_t esp_timer_get_time();
@@ -0,0 +1,16 @@
+//================================================================================
+//| DATEI: test/host/shim/esp_wifi.h                                             |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Low-Level-WLAN-API (src/ nutzt nur die Arduino-Klasse, siehe WiFi.h).        |
+//================================================================================
+
+#pragma once
+
+#include "esp_err.h"
+
+typedef enum { WIFI_PS_NONE = 0, WIFI_PS_MIN_MODEM, WIFI_PS_MAX_MODEM } wifi_ps_type_t;
+
+static inline esp_err_t esp_wifi_set_ps(wifi_ps_type_t) { return ESP_OK; }
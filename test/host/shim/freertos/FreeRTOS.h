@@ -0,0 +1,60 @@
+//================================================================================
+//| DATEI: test/host/shim/freertos/FreeRTOS.h                                    |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Host-Ersatz für die FreeRTOS-Grundtypen. Tasks sind std::threads, ein Tick   |
+//| ist eine Millisekunde. Alle portMUX-Spinlocks teilen sich einen rekursiven   |
+//| Mutex - wie auf dem ESP32 darf darin nicht blockiert werden.                 |
+//| Implementierung: test/host/shim/FreeRTOS.cpp                                 |
+//================================================================================
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+typedef uint32_t TickType_t;
+typedef uint8_t StackType_t;
+
+struct HostTask;
+struct HostQueue;
+typedef HostTask* TaskHandle_t;
+typedef HostQueue* QueueHandle_t;
+typedef HostQueue* SemaphoreHandle_t;
+
+#define pdTRUE                        1
+#define pdFALSE                       0
+#define pdPASS                        1
+#define pdFAIL                        0
+#define errQUEUE_FULL                 0
+#define portMAX_DELAY                 ((TickType_t)0xffffffffUL)
+#define configTICK_RATE_HZ            1000
+#define portTICK_PERIOD_MS            1
+#define pdMS_TO_TICKS(ms)             ((TickType_t)(ms))
+#define tskNO_AFFINITY                0x7FFFFFFF
+#define configMAX_PRIORITIES          25
+
+// Task-Liste und Laufzeitzähler (CPU-Zeit des Threads) gibt es auf dem Host immer.
+#define configUSE_TRACE_FACILITY      1
+#define configGENERATE_RUN_TIME_STATS 1
+
+typedef struct {
+    uint32_t owner;
+    uint32_t count;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED  {0, 0}
+
+void vPortEnterCritical(portMUX_TYPE* mux);
+void vPortExitCritical(portMUX_TYPE* mux);
+BaseType_t xPortGetCoreID();
+
+#define portENTER_CRITICAL(mux)       vPortEnterCritical(mux)
+#define portEXIT_CRITICAL(mux)        vPortExitCritical(mux)
+#define portENTER_CRITICAL_ISR(mux)   vPortEnterCritical(mux)
+#define portEXIT_CRITICAL_ISR(mux)    vPortExitCritical(mux)
+#define portYIELD_FROM_ISR()
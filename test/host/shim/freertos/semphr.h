@@ -0,0 +1,22 @@
+//================================================================================
+//| DATEI: test/host/shim/freertos/semphr.h                                      |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Semaphoren des Host-Shims. Wie unter FreeRTOS sind es Queues ohne Nutzdaten, |
+//| ein Mutex ist eine binäre Semaphore mit Startwert 1.                         |
+//================================================================================
+
+#pragma once
+
+#include "FreeRTOS.h"
+#include "queue.h"
+#include "task.h"
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t maxCount, UBaseType_t initialCount);
+SemaphoreHandle_t xSemaphoreCreateBinary();
+SemaphoreHandle_t xSemaphoreCreateMutex();
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem);
+void vSemaphoreDelete(SemaphoreHandle_t sem);
@@ -0,0 +1,21 @@
+//================================================================================
+//| DATEI: test/host/shim/freertos/xtensa_context.h                              |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Ausnahme-Frame des Xtensa-Kerns (nur die Felder, die der SamplingProfiler    |
+//| liest). Auf dem Host laufen keine Tick-Hooks, der Frame wird nie gefüllt.    |
+//================================================================================
+
+#pragma once
+
+#include <stdint.h>
+
+typedef struct {
+    long exit;
+    long pc;
+    long ps;
+    long a0;
+    long a1;
+} XtExcFrame;
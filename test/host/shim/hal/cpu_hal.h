@@ -0,0 +1,14 @@
+//================================================================================
+//| DATEI: test/host/shim/hal/cpu_hal.h                                          |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Zyklenzähler der CPU (240 MHz aus der Host-Uhr abgeleitet).                  |
+//================================================================================
+
+#pragma once
+
+#include <stdint.h>
+
+uint32_t cpu_hal_get_cycle_count();
@@ -0,0 +1,725 @@
+//================================================================================
+//| DATEI: test/host/shim/httpd.cpp                                              |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| POSIX-Implementierung von esp_http_server (siehe esp_http_server.h).         |
+//| Der httpd-Task wartet per select() auf den Listen-Socket, alle freien        |
+//| Sessions und eine Steuer-Pipe (httpd_queue_work, Abschluss asynchroner       |
+//| Requests, httpd_stop). Requests werden im Task selbst geparst und            |
+//| bearbeitet; ein asynchron übernommener Request sperrt seine Session, bis     |
+//| httpd_req_async_handler_complete() sie zurückgibt.                           |
+//================================================================================
+
+#include "esp_http_server.h"
+#include "HostShim.h"
+#include "freertos/task.h"
+#include <Arduino.h>
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <strings.h>
+#include <sys/select.h>
+#include <unistd.h>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Obergrenze für Request-Zeile plus Header; das Gerät bricht pro Zeile bei 512 ab.
+#define HOST_HTTPD_MAX_HEAD 8192
+
+namespace {
+
+struct Session {
+    int fd;
+    void* ctx;
+    httpd_free_ctx_fn_t freeCtx;
+    std::string pending;        // empfangen, aber noch nicht verarbeitet
+    uint64_t lastUse;           // für den LRU-Purge
+    bool busy;                  // asynchroner Request läuft
+    bool closeAfter;            // "Connection: close" oder Fehlerantwort
+};
+
+struct Server;
+
+struct ReqAux {
+    Session* sess;
+    Server* server;
+    std::vector<std::pair<std::string, std::string>> headers;
+    size_t bodyLeft;            // noch nicht gelesene Body-Bytes
+    const char* status;
+    const char* type;
+    std::vector<std::pair<const char*, const char*>> respHeaders;
+    bool headSent;
+    bool chunked;
+    bool failed;
+};
+
+struct Work {
+    httpd_work_fn_t fn;
+    void* arg;
+    int closeFd;                // >= 0: Session schließen statt fn aufzurufen
+};
+
+struct Server {
+    httpd_config_t config;
+    int listenFd;
+    int ctrl[2];
+    std::vector<httpd_uri_t> handlers;
+    std::vector<Session*> sessions;
+    std::mutex workLock;
+    std::deque<Work> work;
+    std::deque<Session*> released;  // von async_handler_complete zurückgegebene Sessions
+    volatile bool running;
+    SemaphoreHandle_t stopped;
+    uint64_t lruClock;
+};
+
+Server* serverOf(httpd_handle_t hd) {
+    return (Server*)hd;
+}
+
+void wake(Server* server) {
+    char c = 1;
+    ssize_t ignored = write(server->ctrl[1], &c, 1);
+    (void)ignored;
+}
+
+// --- Socket-Hilfen -------------------------------------------------------------
+
+/**
+ * @brief Sendet alles oder scheitert nach send_wait_timeout (wie httpd_send_all).
+ */
+bool sendAll(Server* server, int fd, const char* data, size_t len) {
+    int timeoutMs = server->config.send_wait_timeout * 1000;
+    while (len > 0) {
+        ssize_t ret = send(fd, data, len, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (ret > 0) {
+            data += ret;
+            len -= (size_t)ret;
+            continue;
+        }
+        if (ret < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+            struct pollfd pfd = {fd, POLLOUT, 0};
+            if (poll(&pfd, 1, timeoutMs) <= 0) return false;
+            continue;
+        }
+        return false;
+    }
+    return true;
+}
+
+void closeSession(Server* server, Session* sess) {
+    for (size_t i = 0; i < server->sessions.size(); i++) {
+        if (server->sessions[i] == sess) {
+            server->sessions.erase(server->sessions.begin() + i);
+            break;
+        }
+    }
+    if (sess->ctx) {
+        if (sess->freeCtx) sess->freeCtx(sess->ctx);
+        else free(sess->ctx);
+    }
+    if (server->config.close_fn) server->config.close_fn(server, sess->fd);
+    else close(sess->fd);
+    delete sess;
+}
+
+Session* findSession(Server* server, int fd) {
+    for (Session* sess : server->sessions) {
+        if (sess->fd == fd) return sess;
+    }
+    return nullptr;
+}
+
+// --- Antworten -----------------------------------------------------------------
+
+bool sendHead(httpd_req_t* r, const char* lengthHeader) {
+    ReqAux* aux = (ReqAux*)r->aux;
+    std::string head = "HTTP/1.1 ";
+    head += aux->status;
+    head += "\r\nContent-Type: ";
+    head += aux->type;
+    head += "\r\n";
+    head += lengthHeader;
+    for (auto& h : aux->respHeaders) {
+        head += h.first;
+        head += ": ";
+        head += h.second;
+        head += "\r\n";
+    }
+    head += "\r\n";
+    aux->headSent = true;
+    return sendAll(aux->server, aux->sess->fd, head.data(), head.size());
+}
+
+void sendError(Server* server, Session* sess, const char* status, const char* body) {
+    char head[160];
+    int len = snprintf(head, sizeof(head), "HTTP/1.1 %s\r\nContent-Type: text/html\r\nContent-Length: %u\r\n\r\n",
+                       status, (unsigned)strlen(body));
+    if (sendAll(server, sess->fd, head, (size_t)len)) sendAll(server, sess->fd, body, strlen(body));
+    sess->closeAfter = true;
+}
+
+// --- Request-Verarbeitung -----------------------------------------------------
+
+int parseMethod(const std::string& name) {
+    for (int i = HTTP_DELETE; i <= HTTP_OPTIONS; i++) {
+        if (name == http_method_str((enum http_method)i)) return i;
+    }
+    return -1;
+}
+
+/**
+ * @brief Räumt nach einem Request auf: Rest-Body verwerfen, Speicher freigeben.
+ * @return false, wenn die Session geschlossen werden muss.
+ */
+bool finishRequest(httpd_req_t* r, bool handlerOk) {
+    ReqAux* aux = (ReqAux*)r->aux;
+    Session* sess = aux->sess;
+    char sink[512];
+    while (aux->bodyLeft > 0) {
+        int ret = httpd_req_recv(r, sink, sizeof(sink));
+        if (ret <= 0) {
+            sess->closeAfter = true;
+            break;
+        }
+    }
+    // Der Handler darf den Session-Kontext setzen (EventStream); er gilt ab jetzt.
+    sess->ctx = r->sess_ctx;
+    sess->freeCtx = r->free_ctx;
+    bool keep = handlerOk && !aux->failed && !sess->closeAfter;
+    delete aux;
+    free(r);
+    return keep;
+}
+
+/**
+ * @brief Verarbeitet einen vollständigen Request-Kopf aus sess->pending.
+ * @return false, wenn die Session geschlossen werden muss.
+ */
+bool handleRequest(Server* server, Session* sess, size_t headLen) {
+    std::string head = sess->pending.substr(0, headLen);
+    sess->pending.erase(0, headLen + 4);
+    sess->lastUse = ++server->lruClock;
+
+    size_t lineEnd = head.find("\r\n");
+    std::string line = head.substr(0, lineEnd);
+    size_t sp1 = line.find(' ');
+    size_t sp2 = line.rfind(' ');
+    if (sp1 == std::string::npos || sp2 == sp1) {
+        sendError(server, sess, "400 Bad Request", "Bad request syntax");
+        return false;
+    }
+    std::string uri = line.substr(sp1 + 1, sp2 - sp1 - 1);
+    int method = parseMethod(line.substr(0, sp1));
+    if (uri.size() > HTTPD_MAX_URI_LEN) {
+        sendError(server, sess, "414 URI Too Long", "URI is too long");
+        return false;
+    }
+    if (method < 0) {
+        sendError(server, sess, "501 Not Implemented", "Request method is not supported by server");
+        return false;
+    }
+
+    ReqAux* aux = new ReqAux();
+    aux->sess = sess;
+    aux->server = server;
+    aux->bodyLeft = 0;
+    aux->status = "200 OK";
+    aux->type = HTTPD_TYPE_TEXT;
+    aux->headSent = false;
+    aux->chunked = false;
+    aux->failed = false;
+
+    size_t pos = lineEnd == std::string::npos ? head.size() : lineEnd + 2;
+    while (pos < head.size()) {
+        size_t end = head.find("\r\n", pos);
+        if (end == std::string::npos) end = head.size();
+        std::string field = head.substr(pos, end - pos);
+        pos = end + 2;
+        if (field.size() > HTTPD_MAX_REQ_HDR_LEN) {
+            delete aux;
+            sendError(server, sess, "431 Request Header Fields Too Large", "Header fields are too long");
+            return false;
+        }
+        size_t colon = field.find(':');
+        if (colon == std::string::npos) continue;
+        size_t valueStart = field.find_first_not_of(" \t", colon + 1);
+        std::string value = valueStart == std::string::npos ? "" : field.substr(valueStart);
+        aux->headers.push_back(std::make_pair(field.substr(0, colon), value));
+    }
+
+    httpd_req_t* r = (httpd_req_t*)calloc(1, sizeof(httpd_req_t));
+    r->handle = server;
+    r->method = method;
+    memcpy((char*)r->uri, uri.c_str(), uri.size() + 1);
+    r->aux = aux;
+    r->sess_ctx = sess->ctx;
+    r->free_ctx = sess->freeCtx;
+
+    for (auto& h : aux->headers) {
+        if (strcasecmp(h.first.c_str(), "Content-Length") == 0) r->content_len = strtoul(h.second.c_str(), nullptr, 10);
+        if (strcasecmp(h.first.c_str(), "Connection") == 0 && strcasecmp(h.second.c_str(), "close") == 0) {
+            sess->closeAfter = true;
+        }
+    }
+    aux->bodyLeft = r->content_len;
+
+    // Suche wie httpd_find_uri_handler: erste passende URI mit passender Methode gewinnt.
+    size_t matchLen = strcspn(r->uri, "?");
+    const httpd_uri_t* handler = nullptr;
+    bool uriKnown = false;
+    for (const httpd_uri_t& h : server->handlers) {
+        bool match = server->config.uri_match_fn ? server->config.uri_match_fn(h.uri, r->uri, matchLen)
+                                                 : (strlen(h.uri) == matchLen && strncmp(h.uri, r->uri, matchLen) == 0);
+        if (!match) continue;
+        uriKnown = true;
+        if ((int)h.method == method) {
+            handler = &h;
+            break;
+        }
+    }
+    if (!handler) {
+        if (uriKnown) sendError(server, sess, "405 Method Not Allowed", "Request method for this URI is not handled by server");
+        else sendError(server, sess, "404 Not Found", "This URI does not exist");
+        finishRequest(r, false);
+        return false;
+    }
+
+    r->user_ctx = handler->user_ctx;
+    esp_err_t err = handler->handler(r);
+    if (sess->busy) return true;    // Request gehört jetzt einer asynchronen Kopie
+    if (err != ESP_OK && !aux->headSent) {
+        sendError(server, sess, "500 Internal Server Error", "Server has encountered an unexpected error");
+    }
+    return finishRequest(r, err == ESP_OK);
+}
+
+/**
+ * @brief Liest verfügbare Daten einer Session und bearbeitet vollständige Requests.
+ * @return false, wenn die Session geschlossen werden muss.
+ */
+bool serviceSession(Server* server, Session* sess) {
+    char buf[4096];
+    ssize_t ret = recv(sess->fd, buf, sizeof(buf), MSG_DONTWAIT);
+    if (ret == 0) return false;
+    if (ret < 0) return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    sess->pending.append(buf, (size_t)ret);
+
+    while (!sess->busy) {
+        size_t headEnd = sess->pending.find("\r\n\r\n");
+        if (headEnd == std::string::npos) {
+            if (sess->pending.size() > HOST_HTTPD_MAX_HEAD) {
+                sendError(server, sess, "431 Request Header Fields Too Large", "Header fields are too long");
+                return false;
+            }
+            return true;
+        }
+        if (!handleRequest(server, sess, headEnd)) return false;
+    }
+    return true;
+}
+
+void acceptSession(Server* server) {
+    int fd = accept(server->listenFd, nullptr, nullptr);
+    if (fd < 0) return;
+
+    if (server->sessions.size() >= server->config.max_open_sockets) {
+        Session* oldest = nullptr;
+        if (server->config.lru_purge_enable) {
+            for (Session* sess : server->sessions) {
+                if (!sess->busy && (!oldest || sess->lastUse < oldest->lastUse)) oldest = sess;
+            }
+        }
+        if (!oldest) {
+            close(fd);
+            return;
+        }
+        closeSession(server, oldest);
+    }
+
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    if (server->config.open_fn && server->config.open_fn(server, fd) != ESP_OK) {
+        close(fd);
+        return;
+    }
+    Session* sess = new Session();
+    sess->fd = fd;
+    sess->ctx = nullptr;
+    sess->freeCtx = nullptr;
+    sess->lastUse = ++server->lruClock;
+    sess->busy = false;
+    sess->closeAfter = false;
+    server->sessions.push_back(sess);
+}
+
+void runWork(Server* server) {
+    char drain[64];
+    while (read(server->ctrl[0], drain, sizeof(drain)) > 0) {}
+
+    std::deque<Work> work;
+    std::deque<Session*> released;
+    {
+        std::lock_guard<std::mutex> guard(server->workLock);
+        work.swap(server->work);
+        released.swap(server->released);
+    }
+    for (Session* sess : released) {
+        sess->busy = false;
+        if (sess->closeAfter) closeSession(server, sess);
+        else if (!sess->pending.empty() && sess->pending.find("\r\n\r\n") != std::string::npos) {
+            // Bereits gepufferte Folge-Requests sofort bearbeiten, select() meldet sie nicht mehr.
+            size_t headEnd = sess->pending.find("\r\n\r\n");
+            if (!handleRequest(server, sess, headEnd)) closeSession(server, sess);
+        }
+    }
+    for (const Work& w : work) {
+        if (w.closeFd >= 0) {
+            Session* sess = findSession(server, w.closeFd);
+            if (sess && !sess->busy) closeSession(server, sess);
+            else if (sess) sess->closeAfter = true;
+        } else {
+            w.fn(w.arg);
+        }
+    }
+}
+
+void serverTask(void* arg) {
+    Server* server = (Server*)arg;
+    while (server->running) {
+        fd_set readable;
+        FD_ZERO(&readable);
+        FD_SET(server->listenFd, &readable);
+        FD_SET(server->ctrl[0], &readable);
+        int maxFd = std::max(server->listenFd, server->ctrl[0]);
+        for (Session* sess : server->sessions) {
+            if (sess->busy) continue;
+            FD_SET(sess->fd, &readable);
+            maxFd = std::max(maxFd, sess->fd);
+        }
+        if (select(maxFd + 1, &readable, nullptr, nullptr, nullptr) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (!server->running) break;
+
+        if (FD_ISSET(server->ctrl[0], &readable)) runWork(server);
+        // Kopie, weil closeSession() die Liste verändert.
+        std::vector<Session*> ready;
+        for (Session* sess : server->sessions) {
+            if (!sess->busy && FD_ISSET(sess->fd, &readable)) ready.push_back(sess);
+        }
+        for (Session* sess : ready) {
+            if (!findSession(server, sess->fd)) continue;   // zwischenzeitlich gepurgt
+            if (!serviceSession(server, sess)) closeSession(server, sess);
+        }
+        if (FD_ISSET(server->listenFd, &readable)) acceptSession(server);
+    }
+
+    while (!server->sessions.empty()) closeSession(server, server->sessions.back());
+    xSemaphoreGive(server->stopped);
+    vTaskDelete(nullptr);
+}
+
+}  // namespace
+
+// --- Öffentliche API ----------------------------------------------------------
+
+const char* http_method_str(enum http_method m) {
+    static const char* const names[] = {"DELETE", "GET", "HEAD", "POST", "PUT", "CONNECT", "OPTIONS"};
+    return (unsigned)m < sizeof(names) / sizeof(names[0]) ? names[m] : "<unknown>";
+}
+
+esp_err_t httpd_start(httpd_handle_t* handle, const httpd_config_t* config) {
+    if (!handle || !config) return ESP_ERR_INVALID_ARG;
+    Server* server = new Server();
+    server->config = *config;
+    if (hostConfig.httpPort) server->config.server_port = hostConfig.httpPort;
+    server->running = true;
+    server->lruClock = 0;
+
+    server->listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(server->listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(server->config.server_port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (server->listenFd < 0 || bind(server->listenFd, (struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+        listen(server->listenFd, server->config.backlog_conn) != 0 || pipe(server->ctrl) != 0) {
+        fprintf(stderr, "[host] httpd: Port %u nicht verfügbar: %s\n", server->config.server_port, strerror(errno));
+        if (server->listenFd >= 0) close(server->listenFd);
+        delete server;
+        return ESP_FAIL;
+    }
+    fcntl(server->ctrl[0], F_SETFL, O_NONBLOCK);
+    server->stopped = xSemaphoreCreateBinary();
+
+    if (xTaskCreate(serverTask, "httpd", server->config.stack_size, server, server->config.task_priority, nullptr) != pdPASS) {
+        close(server->listenFd);
+        delete server;
+        return ESP_ERR_HTTPD_TASK;
+    }
+    fprintf(stderr, "[host] httpd lauscht auf http://127.0.0.1:%u\n", server->config.server_port);
+    *handle = server;
+    return ESP_OK;
+}
+
+esp_err_t httpd_stop(httpd_handle_t handle) {
+    Server* server = serverOf(handle);
+    if (!server) return ESP_ERR_INVALID_ARG;
+    server->running = false;
+    wake(server);
+    xSemaphoreTake(server->stopped, portMAX_DELAY);
+    close(server->listenFd);
+    close(server->ctrl[0]);
+    close(server->ctrl[1]);
+    if (server->config.global_user_ctx) {
+        if (server->config.global_user_ctx_free_fn) server->config.global_user_ctx_free_fn(server->config.global_user_ctx);
+        else free(server->config.global_user_ctx);
+    }
+    for (httpd_uri_t& h : server->handlers) free((void*)h.uri);
+    vSemaphoreDelete(server->stopped);
+    delete server;
+    return ESP_OK;
+}
+
+esp_err_t httpd_register_uri_handler(httpd_handle_t handle, const httpd_uri_t* uri_handler) {
+    Server* server = serverOf(handle);
+    if (!server || !uri_handler || !uri_handler->uri) return ESP_ERR_INVALID_ARG;
+    for (const httpd_uri_t& h : server->handlers) {
+        if (h.method == uri_handler->method && strcmp(h.uri, uri_handler->uri) == 0) return ESP_ERR_HTTPD_HANDLER_EXISTS;
+    }
+    if (server->handlers.size() >= server->config.max_uri_handlers) return ESP_ERR_HTTPD_HANDLERS_FULL;
+    httpd_uri_t copy = *uri_handler;
+    copy.uri = strdup(uri_handler->uri);     // wie am Gerät: der Server hält eine eigene Kopie
+    server->handlers.push_back(copy);
+    return ESP_OK;
+}
+
+bool httpd_uri_match_wildcard(const char* uri_template, const char* uri_to_match, size_t match_upto) {
+    const size_t tplLen = strlen(uri_template);
+    size_t exactChars = tplLen;
+    const char last = tplLen > 0 ? uri_template[tplLen - 1] : 0;
+    const char prevLast = tplLen > 1 ? uri_template[tplLen - 2] : 0;
+    const bool asterisk = last == '*' || (prevLast == '*' && last == '?');
+    const bool quest = last == '?' || (prevLast == '?' && last == '*');
+    if (asterisk) exactChars--;
+    if (quest) exactChars--;
+    if (match_upto < exactChars) return false;
+
+    if (!quest) {
+        if (!asterisk && match_upto != exactChars) return false;
+        return strncmp(uri_template, uri_to_match, exactChars) == 0;
+    }
+    if (match_upto > exactChars && uri_template[exactChars] != uri_to_match[exactChars]) return false;
+    if (strncmp(uri_template, uri_to_match, exactChars) != 0) return false;
+    return asterisk || match_upto <= exactChars + 1;
+}
+
+void* httpd_get_global_user_ctx(httpd_handle_t handle) {
+    Server* server = serverOf(handle);
+    return server ? server->config.global_user_ctx : nullptr;
+}
+
+int httpd_req_recv(httpd_req_t* r, char* buf, size_t buf_len) {
+    if (!r || !r->aux || !buf) return HTTPD_SOCK_ERR_INVALID;
+    ReqAux* aux = (ReqAux*)r->aux;
+    Session* sess = aux->sess;
+    if (buf_len > aux->bodyLeft) buf_len = aux->bodyLeft;
+    if (buf_len == 0) return 0;
+
+    // Zuerst, was mit dem Kopf schon gekommen ist.
+    if (!sess->pending.empty()) {
+        size_t n = std::min(buf_len, sess->pending.size());
+        memcpy(buf, sess->pending.data(), n);
+        sess->pending.erase(0, n);
+        aux->bodyLeft -= n;
+        return (int)n;
+    }
+
+    struct pollfd pfd = {sess->fd, POLLIN, 0};
+    int ready = poll(&pfd, 1, aux->server->config.recv_wait_timeout * 1000);
+    if (ready == 0) return HTTPD_SOCK_ERR_TIMEOUT;
+    if (ready < 0) return errno == EINTR ? HTTPD_SOCK_ERR_TIMEOUT : HTTPD_SOCK_ERR_FAIL;
+    ssize_t ret = recv(sess->fd, buf, buf_len, MSG_DONTWAIT);
+    if (ret < 0) return (errno == EAGAIN || errno == EINTR) ? HTTPD_SOCK_ERR_TIMEOUT : HTTPD_SOCK_ERR_FAIL;
+    if (ret == 0) {
+        sess->closeAfter = true;
+        return 0;
+    }
+    aux->bodyLeft -= (size_t)ret;
+    return (int)ret;
+}
+
+int httpd_req_to_sockfd(httpd_req_t* r) {
+    if (!r || !r->aux) return -1;
+    return ((ReqAux*)r->aux)->sess->fd;
+}
+
+size_t httpd_req_get_url_query_len(httpd_req_t* r) {
+    if (!r) return 0;
+    const char* q = strchr(r->uri, '?');
+    return q ? strlen(q + 1) : 0;
+}
+
+esp_err_t httpd_req_get_url_query_str(httpd_req_t* r, char* buf, size_t buf_len) {
+    if (!r || !buf || buf_len == 0) return ESP_ERR_INVALID_ARG;
+    const char* q = strchr(r->uri, '?');
+    if (!q) return ESP_ERR_NOT_FOUND;
+    q++;
+    size_t len = strlen(q);
+    size_t n = len < buf_len - 1 ? len : buf_len - 1;
+    memcpy(buf, q, n);
+    buf[n] = '\0';
+    return n < len ? ESP_ERR_HTTPD_RESULT_TRUNC : ESP_OK;
+}
+
+static const std::string* findHeader(httpd_req_t* r, const char* field) {
+    if (!r || !r->aux || !field) return nullptr;
+    for (auto& h : ((ReqAux*)r->aux)->headers) {
+        if (strcasecmp(h.first.c_str(), field) == 0) return &h.second;
+    }
+    return nullptr;
+}
+
+size_t httpd_req_get_hdr_value_len(httpd_req_t* r, const char* field) {
+    const std::string* value = findHeader(r, field);
+    return value ? value->size() : 0;
+}
+
+esp_err_t httpd_req_get_hdr_value_str(httpd_req_t* r, const char* field, char* val, size_t val_size) {
+    if (!r || !r->aux) return ESP_ERR_HTTPD_INVALID_REQ;
+    if (!field || !val || val_size == 0) return ESP_ERR_INVALID_ARG;
+    const std::string* value = findHeader(r, field);
+    if (!value) return ESP_ERR_NOT_FOUND;
+    size_t n = value->size() < val_size - 1 ? value->size() : val_size - 1;
+    memcpy(val, value->data(), n);
+    val[n] = '\0';
+    return n < value->size() ? ESP_ERR_HTTPD_RESULT_TRUNC : ESP_OK;
+}
+
+esp_err_t httpd_resp_set_status(httpd_req_t* r, const char* status) {
+    if (!r || !r->aux || !status) return ESP_ERR_INVALID_ARG;
+    ((ReqAux*)r->aux)->status = status;
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_type(httpd_req_t* r, const char* type) {
+    if (!r || !r->aux || !type) return ESP_ERR_INVALID_ARG;
+    ((ReqAux*)r->aux)->type = type;
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_hdr(httpd_req_t* r, const char* field, const char* value) {
+    if (!r || !r->aux || !field || !value) return ESP_ERR_INVALID_ARG;
+    ReqAux* aux = (ReqAux*)r->aux;
+    if (aux->respHeaders.size() >= aux->server->config.max_resp_headers) return ESP_ERR_HTTPD_RESP_HDR;
+    aux->respHeaders.push_back(std::make_pair(field, value));
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_send(httpd_req_t* r, const char* buf, ssize_t buf_len) {
+    if (!r || !r->aux) return ESP_ERR_HTTPD_INVALID_REQ;
+    ReqAux* aux = (ReqAux*)r->aux;
+    if (buf_len == HTTPD_RESP_USE_STRLEN) buf_len = buf ? (ssize_t)strlen(buf) : 0;
+    if (!buf) buf_len = 0;
+    char length[48];
+    snprintf(length, sizeof(length), "Content-Length: %d\r\n", (int)buf_len);
+    if (!sendHead(r, length) || !sendAll(aux->server, aux->sess->fd, buf, (size_t)buf_len)) {
+        aux->failed = true;
+        return ESP_ERR_HTTPD_RESP_SEND;
+    }
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_send_chunk(httpd_req_t* r, const char* buf, ssize_t buf_len) {
+    if (!r || !r->aux) return ESP_ERR_HTTPD_INVALID_REQ;
+    ReqAux* aux = (ReqAux*)r->aux;
+    if (buf_len == HTTPD_RESP_USE_STRLEN) buf_len = buf ? (ssize_t)strlen(buf) : 0;
+    if (!buf) buf_len = 0;
+    if (!aux->headSent) {
+        aux->chunked = true;
+        if (!sendHead(r, "Transfer-Encoding: chunked\r\n")) {
+            aux->failed = true;
+            return ESP_ERR_HTTPD_RESP_SEND;
+        }
+    }
+    char size[16];
+    int sizeLen = snprintf(size, sizeof(size), "%x\r\n", (unsigned)buf_len);
+    bool ok = sendAll(aux->server, aux->sess->fd, size, (size_t)sizeLen) &&
+              sendAll(aux->server, aux->sess->fd, buf, (size_t)buf_len) &&
+              sendAll(aux->server, aux->sess->fd, "\r\n", 2);
+    if (!ok) {
+        aux->failed = true;
+        return ESP_ERR_HTTPD_RESP_SEND;
+    }
+    return ESP_OK;
+}
+
+esp_err_t httpd_req_async_handler_begin(httpd_req_t* r, httpd_req_t** out) {
+    if (!r || !r->aux || !out) return ESP_ERR_INVALID_ARG;
+    // Die Kopie übernimmt den Zustand; das Original wird vom Aufrufer nicht mehr benutzt.
+    httpd_req_t* copy = (httpd_req_t*)malloc(sizeof(httpd_req_t));
+    if (!copy) return ESP_ERR_NO_MEM;
+    memcpy((void*)copy, r, sizeof(httpd_req_t));
+    ReqAux* aux = (ReqAux*)r->aux;
+    aux->sess->busy = true;
+    r->aux = nullptr;
+    free(r);
+    *out = copy;
+    return ESP_OK;
+}
+
+esp_err_t httpd_req_async_handler_complete(httpd_req_t* r) {
+    if (!r || !r->aux) return ESP_ERR_INVALID_ARG;
+    ReqAux* aux = (ReqAux*)r->aux;
+    Server* server = aux->server;
+    Session* sess = aux->sess;
+    if (!finishRequest(r, true)) sess->closeAfter = true;
+    {
+        std::lock_guard<std::mutex> guard(server->workLock);
+        server->released.push_back(sess);
+    }
+    wake(server);
+    return ESP_OK;
+}
+
+esp_err_t httpd_queue_work(httpd_handle_t handle, httpd_work_fn_t work, void* arg) {
+    Server* server = serverOf(handle);
+    if (!server || !work || !server->running) return ESP_FAIL;
+    {
+        std::lock_guard<std::mutex> guard(server->workLock);
+        server->work.push_back(Work{work, arg, -1});
+    }
+    wake(server);
+    return ESP_OK;
+}
+
+int httpd_socket_send(httpd_handle_t hd, int sockfd, const char* buf, size_t buf_len, int flags) {
+    if (!hd || sockfd < 0 || (!buf && buf_len)) return HTTPD_SOCK_ERR_INVALID;
+    ssize_t ret = send(sockfd, buf, buf_len, flags | MSG_NOSIGNAL);
+    if (ret < 0) {
+        return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ? HTTPD_SOCK_ERR_TIMEOUT : HTTPD_SOCK_ERR_FAIL;
+    }
+    return (int)ret;
+}
+
+esp_err_t httpd_sess_trigger_close(httpd_handle_t handle, int sockfd) {
+    Server* server = serverOf(handle);
+    if (!server || !server->running) return ESP_ERR_INVALID_STATE;
+    {
+        std::lock_guard<std::mutex> guard(server->workLock);
+        server->work.push_back(Work{nullptr, nullptr, sockfd});
+    }
+    wake(server);
+    return ESP_OK;
+}
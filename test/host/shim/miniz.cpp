@@ -0,0 +1,76 @@
+//================================================================================
+//| DATEI: test/host/shim/miniz.cpp                                              |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| tinfl_decompress() über zlib (siehe rom/miniz.h). Die Statuswerte folgen dem |
+//| ROM: DONE am Ende des Deflate-Blocks (Rest der Eingabe bleibt unverbraucht), |
+//| HAS_MORE_OUTPUT bei vollem Ausgabepuffer, sonst NEEDS_MORE_INPUT.            |
+//================================================================================
+
+#include "rom/miniz.h"
+#include <string.h>
+#include <zlib.h>
+
+static_assert(sizeof(z_stream) <= sizeof(((tinfl_decompressor*)0)->stream), "z_stream passt nicht");
+
+// zlib holt sich ihren Zustand aus der Arena im Dekompressor (kein eigener Heap).
+static voidpf arenaAlloc(voidpf opaque, uInt items, uInt size) {
+    tinfl_decompressor* r = (tinfl_decompressor*)opaque;
+    size_t bytes = ((size_t)items * size + 15) & ~(size_t)15;
+    if (r->arenaUsed + bytes > sizeof(r->arena)) return Z_NULL;
+    void* ptr = r->arena + r->arenaUsed;
+    r->arenaUsed += bytes;
+    return ptr;
+}
+
+static void arenaFree(voidpf, voidpf) {}
+
+tinfl_status tinfl_decompress(tinfl_decompressor* r, const uint8_t* in, size_t* inSize, uint8_t* outStart,
+                              uint8_t* outNext, size_t* outSize, uint32_t flags) {
+    size_t window = (size_t)(outNext - outStart) + *outSize;
+    bool wrapping = !(flags & TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF);
+    if (wrapping && (window & (window - 1))) {
+        *inSize = 0;
+        *outSize = 0;
+        return TINFL_STATUS_BAD_PARAM;
+    }
+
+    z_stream* zs = (z_stream*)r->stream;
+    if (r->m_state == 0) {
+        memset(zs, 0, sizeof(*zs));
+        zs->zalloc = arenaAlloc;
+        zs->zfree = arenaFree;
+        zs->opaque = r;
+        r->arenaUsed = 0;
+        int windowBits = (flags & TINFL_FLAG_PARSE_ZLIB_HEADER) ? 15 : -15;
+        if (inflateInit2(zs, windowBits) != Z_OK) return TINFL_STATUS_FAILED;
+        r->m_state = 1;
+    } else if (r->m_state == 2) {
+        *inSize = 0;
+        *outSize = 0;
+        return TINFL_STATUS_DONE;
+    }
+
+    zs->next_in = (Bytef*)in;
+    zs->avail_in = (uInt)*inSize;
+    zs->next_out = outNext;
+    zs->avail_out = (uInt)*outSize;
+    int ret = inflate(zs, Z_NO_FLUSH);
+    *inSize -= zs->avail_in;
+    *outSize -= zs->avail_out;
+
+    if (ret == Z_STREAM_END) {
+        r->m_state = 2;
+        return TINFL_STATUS_DONE;
+    }
+    if (ret != Z_OK && ret != Z_BUF_ERROR) {
+        r->m_state = 3;
+        return TINFL_STATUS_FAILED;
+    }
+    if (r->m_state == 3) return TINFL_STATUS_FAILED;
+    if (zs->avail_out == 0) return TINFL_STATUS_HAS_MORE_OUTPUT;
+    if (zs->avail_in == 0 && !(flags & TINFL_FLAG_HAS_MORE_INPUT)) return TINFL_STATUS_FAILED;
+    return TINFL_STATUS_NEEDS_MORE_INPUT;
+}
@@ -0,0 +1,20 @@
+//================================================================================
+//| DATEI: test/host/shim/nvs_flash.h                                            |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Initialisierung einer NVS-Partition. Auf dem Host liegt der NVS im RAM       |
+//| (siehe Preferences.h), es gibt nichts vorzubereiten.                         |
+//================================================================================
+
+#pragma once
+
+#include "esp_err.h"
+
+#define ESP_ERR_NVS_BASE               0x1100
+#define ESP_ERR_NVS_NO_FREE_PAGES      (ESP_ERR_NVS_BASE + 0x0d)
+#define ESP_ERR_NVS_NEW_VERSION_FOUND  (ESP_ERR_NVS_BASE + 0x10)
+
+static inline esp_err_t nvs_flash_init_partition(const char*) { return ESP_OK; }
+static inline esp_err_t nvs_flash_erase_partition(const char*) { return ESP_OK; }
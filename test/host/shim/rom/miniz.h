@@ -0,0 +1,48 @@
+//================================================================================
+//| DATEI: test/host/shim/rom/miniz.h                                            |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Host-Ersatz für den tinfl-Dekompressor im ROM des ESP32: gleiche Typen,      |
+//| Flags und Statuswerte, intern zlib (raw inflate). Der ganze Zustand der zlib |
+//| liegt im tinfl_decompressor selbst, daher genügt wie im ROM ein free() ohne  |
+//| Abmelden. Geprüft wird damit der gzip-Rahmen von GzipInflater, nicht der     |
+//| ROM-Code.                                                                    |
+//================================================================================
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+    TINFL_STATUS_BAD_PARAM = -3,
+    TINFL_STATUS_ADLER32_MISMATCH = -2,
+    TINFL_STATUS_FAILED = -1,
+    TINFL_STATUS_DONE = 0,
+    TINFL_STATUS_NEEDS_MORE_INPUT = 1,
+    TINFL_STATUS_HAS_MORE_OUTPUT = 2
+} tinfl_status;
+
+enum {
+    TINFL_FLAG_PARSE_ZLIB_HEADER = 1,
+    TINFL_FLAG_HAS_MORE_INPUT = 2,
+    TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF = 4,
+    TINFL_FLAG_COMPUTE_ADLER32 = 8
+};
+
+#define TINFL_HOST_ARENA_SIZE  (48 * 1024)   // inflate_state + 32-KB-Fenster der zlib
+
+struct tinfl_decompressor_tag {
+    uint32_t m_state;               // 0 = nach tinfl_init(), zlib noch nicht gestartet
+    size_t arenaUsed;
+    uint8_t stream[128];            // z_stream (nicht öffentlich, damit zlib.h nicht durchsickert)
+    uint8_t arena[TINFL_HOST_ARENA_SIZE];
+};
+typedef struct tinfl_decompressor_tag tinfl_decompressor;
+
+#define tinfl_init(r) do { (r)->m_state = 0; } while (0)
+
+tinfl_status tinfl_decompress(tinfl_decompressor* r, const uint8_t* in, size_t* inSize, uint8_t* outStart,
+                              uint8_t* outNext, size_t* outSize, uint32_t flags);
@@ -0,0 +1,132 @@
+#!/usr/bin/env python3
+# ================================================================================
+# | DATEI: test/host/test_events.py                                              |
+# | AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+# | LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+# |------------------------------------------------------------------------------|
+# | ZWECK:                                                                       |
+# | Prüft am Host-Build, dass Einträge im Ereignis-Log live auf /api/events      |
+# | ankommen: SSE-Verbindung öffnen, Ereignisse auslösen (Log löschen, Motoren   |
+# | aus) und auf die passenden "log"-Events warten.                              |
+# |                                                                              |
+# | AUFRUF: python3 test_events.py build/host_firmware   (oder: make test)       |
+# ================================================================================
+
+import http.client
+import os
+import shutil
+import socket
+import subprocess
+import sys
+import tempfile
+import time
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+DATA = os.path.join(HERE, "..", "..", "data")
+TIMEOUT_S = 5.0
+
+
+def free_port():
+    with socket.socket() as s:
+        s.bind(("127.0.0.1", 0))
+        return s.getsockname()[1]
+
+
+def wait_for_server(port, proc):
+    deadline = time.monotonic() + 15.0
+    while time.monotonic() < deadline:
+        if proc.poll() is not None:
+            raise RuntimeError("host_firmware beendet mit Code %d" % proc.returncode)
+        try:
+            with socket.create_connection(("127.0.0.1", port), timeout=0.2):
+                return
+        except OSError:
+            time.sleep(0.1)
+    raise RuntimeError("Server auf Port %d antwortet nicht" % port)
+
+
+def post(port, path, body=""):
+    conn = http.client.HTTPConnection("127.0.0.1", port, timeout=TIMEOUT_S)
+    conn.request("POST", path, body, {"Content-Type": "application/x-www-form-urlencoded"})
+    resp = conn.getresponse()
+    resp.read()
+    conn.close()
+    return resp.status
+
+
+class EventReader:
+    """Minimaler SSE-Client über einen rohen Socket (liefert (event, data)-Paare)."""
+
+    def __init__(self, port):
+        self.sock = socket.create_connection(("127.0.0.1", port), timeout=TIMEOUT_S)
+        self.sock.sendall(b"GET /api/events HTTP/1.1\r\nHost: test\r\nAccept: text/event-stream\r\n\r\n")
+        self.buf = b""
+        head = self._read_until(b"\r\n\r\n")
+        if not head.startswith(b"HTTP/1.1 200"):
+            raise RuntimeError("SSE-Antwort: %r" % head[:60])
+
+    def _read_until(self, marker):
+        while marker not in self.buf:
+            chunk = self.sock.recv(4096)
+            if not chunk:
+                raise RuntimeError("SSE-Verbindung geschlossen")
+            self.buf += chunk
+        head, self.buf = self.buf.split(marker, 1)
+        return head
+
+    def next_event(self):
+        block = self._read_until(b"\n\n").decode("utf-8")
+        event, data = "message", []
+        for line in block.split("\n"):
+            if line.startswith("event: "):
+                event = line[7:]
+            elif line.startswith("data: "):
+                data.append(line[6:])
+        return event, "\n".join(data)
+
+    def wait_for_log(self, needle):
+        deadline = time.monotonic() + TIMEOUT_S
+        while time.monotonic() < deadline:
+            event, data = self.next_event()
+            if event == "log" and needle in data:
+                return data
+        raise AssertionError("kein log-Event mit '%s' auf /api/events" % needle)
+
+    def close(self):
+        self.sock.close()
+
+
+def main():
+    binary = sys.argv[1] if len(sys.argv) > 1 else os.path.join(HERE, "build", "host_firmware")
+    port = free_port()
+    fs = tempfile.mkdtemp(prefix="host_fs_")
+    shutil.rmtree(fs)
+    shutil.copytree(DATA, fs)
+    proc = subprocess.Popen([binary, "--port", str(port), "--fs", fs, "--quiet"])
+    failures = 0
+    try:
+        wait_for_server(port, proc)
+        events = EventReader(port)
+
+        checks = [
+            ("POST /api/logs/clear", lambda: post(port, "/api/logs/clear"), "log_cleared"),
+            ("Motoren aus (toggleMotors)", lambda: post(port, "/api/robot/move", "cmd=disable"), "motors: Motoren 0"),
+        ]
+        for name, trigger, needle in checks:
+            status = trigger()
+            try:
+                line = events.wait_for_log(needle)
+                print("OK    %-28s -> %s" % (name, line))
+            except (AssertionError, RuntimeError, socket.timeout) as e:
+                print("FEHLER %-27s (HTTP %d): %s" % (name, status, e))
+                failures += 1
+        events.close()
+    finally:
+        proc.terminate()
+        proc.wait(timeout=5)
+        shutil.rmtree(fs, ignore_errors=True)
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,271 @@
+//================================================================================
+//| DATEI: test/host/test_gzip.cpp                                               |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Füttert GzipInflater mit gzip-Streams in zufälligen Stückelungen (wie sie    |
+//| von httpd_req_recv kommen): Fenster 2^9..2^15 mit "WB"-Feld, normale .gz,    |
+//| alle Header-Flags, leere und unkomprimierbare Daten. Dazu kaputte Streams:   |
+//| abgeschnitten, verfälschte Deflate-Bytes, falsche CRC/Länge, falsches Magic, |
+//| abbrechender Output-Handler.                                                 |
+//|                                                                              |
+//| HINWEIS: tinfl ist am Host durch zlib ersetzt (shim/miniz.cpp). Ein zu klein |
+//| angegebenes Fenster fällt deshalb hier nicht auf, nur am Gerät (CRC).        |
+//================================================================================
+
+#include "HostTest.h"
+#include "../../src/modules/Server/GzipInflater.h"
+#include <zlib.h>
+
+typedef std::vector<uint8_t> Bytes;
+
+// gzip-Header-Flags (RFC 1952)
+static const uint8_t FHCRC = 0x02;
+static const uint8_t FEXTRA = 0x04;
+static const uint8_t FNAME = 0x08;
+static const uint8_t FCOMMENT = 0x10;
+
+/**
+ * @brief Aufbau eines Test-Streams (entspricht tools/ota_compress.py, wenn wb > 0).
+ */
+struct GzipSpec {
+    int windowBits;     // Fenster des Kompressors (9..15)
+    int level;          // 0 = nur "stored"-Blöcke
+    int wb;             // Wert im "WB"-Subfeld, 0 = kein Extra-Feld
+    uint8_t flags;      // zusätzlich FNAME/FCOMMENT/FHCRC
+};
+
+static void putLe32(Bytes& out, uint32_t v) {
+    for (int i = 0; i < 4; i++) out.push_back((uint8_t)(v >> (8 * i)));
+}
+
+static Bytes gzipStream(const Bytes& data, const GzipSpec& spec) {
+    Bytes out = {0x1F, 0x8B, 8, 0, 0, 0, 0, 0, 0, 255};
+    uint8_t flags = spec.flags;
+    if (spec.wb) {
+        flags |= FEXTRA;
+        const uint8_t extra[] = {5, 0, 'W', 'B', 1, 0, (uint8_t)spec.wb};
+        out.insert(out.end(), extra, extra + sizeof(extra));
+    }
+    out[3] = flags;
+    if (flags & FNAME) {
+        const char* name = "firmware.bin";
+        out.insert(out.end(), name, name + strlen(name) + 1);
+    }
+    if (flags & FCOMMENT) {
+        const char* comment = "host test";
+        out.insert(out.end(), comment, comment + strlen(comment) + 1);
+    }
+    if (flags & FHCRC) {
+        uint32_t hcrc = crc32(0, out.data(), (uInt)out.size());
+        out.push_back((uint8_t)hcrc);
+        out.push_back((uint8_t)(hcrc >> 8));
+    }
+
+    z_stream zs = {};
+    deflateInit2(&zs, spec.level, Z_DEFLATED, -spec.windowBits, 8, Z_DEFAULT_STRATEGY);
+    size_t head = out.size();
+    out.resize(head + deflateBound(&zs, (uLong)data.size()));
+    zs.next_in = (Bytef*)data.data();
+    zs.avail_in = (uInt)data.size();
+    zs.next_out = out.data() + head;
+    zs.avail_out = (uInt)(out.size() - head);
+    deflate(&zs, Z_FINISH);
+    out.resize(out.size() - zs.avail_out);
+    deflateEnd(&zs);
+
+    putLe32(out, crc32(0, data.data(), (uInt)data.size()));
+    putLe32(out, (uint32_t)data.size());
+    return out;
+}
+
+/**
+ * @brief Ergebnis eines Durchlaufs durch GzipInflater.
+ */
+struct InflateResult {
+    bool ok;            // alle write() und finish() erfolgreich
+    const char* error;
+    Bytes output;
+    size_t window;
+};
+
+static InflateResult inflateChunks(const Bytes& stream, const std::vector<size_t>& chunks, size_t abortAfter = 0) {
+    InflateResult r;
+    r.ok = true;
+    GzipInflater gz;
+    gz.begin([&](const uint8_t* data, size_t len) {
+        r.output.insert(r.output.end(), data, data + len);
+        return abortAfter == 0 || r.output.size() < abortAfter;
+    });
+    size_t pos = 0;
+    for (size_t n : chunks) {
+        if (!gz.write(stream.data() + pos, n)) {
+            r.ok = false;
+            break;
+        }
+        pos += n;
+    }
+    r.window = gz.windowSize();
+    if (r.ok) r.ok = gz.finish();
+    r.error = gz.error();
+    if (!r.ok) CHECK(r.error != nullptr, "Fehlschlag ohne error()");
+    return r;
+}
+
+// Gut komprimierbar mit Wiederholungen über große Distanzen (nutzt das ganze Fenster).
+static Bytes textData(TestRandom& rnd, size_t len) {
+    static const char* words[] = {"motor", "pid ", "balance", "\n", "{\"kp\":", "0.25", "imu ", "wifi", " = "};
+    Bytes block;
+    while (block.size() < 20000) {
+        const char* w = words[rnd.range(0, 8)];
+        block.insert(block.end(), w, w + strlen(w));
+    }
+    Bytes data;
+    while (data.size() < len) {
+        size_t n = std::min(len - data.size(), (size_t)rnd.range(16, 400));
+        size_t from = rnd.range(0, (uint32_t)(block.size() - n));
+        data.insert(data.end(), block.begin() + from, block.begin() + from + n);
+    }
+    return data;
+}
+
+static Bytes randomData(TestRandom& rnd, size_t len) {
+    Bytes data(len);
+    rnd.fill(data.data(), len);
+    return data;
+}
+
+static void testValidStreams(TestRandom& rnd) {
+    const GzipSpec specs[] = {
+        {9, 9, 9, 0},           // kleinstes Fenster
+        {12, 9, 12, 0},         // Standard von ota_compress.py
+        {15, 9, 15, 0},
+        {15, 9, 0, 0},          // gzip -9 ohne "WB": 32 KB
+        {12, 6, 12, FNAME | FCOMMENT | FHCRC},
+        {15, 0, 0, FNAME},      // nur stored-Blöcke
+    };
+    const size_t maxChunks[] = {1, 7, 64, 1500, 1 << 20};
+    std::vector<Bytes> payloads = {Bytes(), Bytes(1, 'x'), textData(rnd, 120000), randomData(rnd, 20000)};
+
+    int runs = 0;
+    for (const GzipSpec& spec : specs) {
+        for (const Bytes& data : payloads) {
+            Bytes stream = gzipStream(data, spec);
+            for (size_t maxChunk : maxChunks) {
+                InflateResult r = inflateChunks(stream, rnd.splits(stream.size(), maxChunk));
+                runs++;
+                CHECK(r.ok, "wb=%d level=%d flags=%02x len=%zu chunk<=%zu: %s", spec.wb, spec.level, spec.flags,
+                      data.size(), maxChunk, r.error ? r.error : "");
+                CHECK(r.output == data, "wb=%d len=%zu chunk<=%zu: Ausgabe weicht ab (%zu Bytes)", spec.wb,
+                      data.size(), maxChunk, r.output.size());
+                size_t window = (size_t)1 << (spec.wb ? spec.wb : GZIP_MAX_WINDOW_BITS);
+                CHECK(r.window == window, "wb=%d: Fenster %zu statt %zu", spec.wb, r.window, window);
+            }
+        }
+    }
+    printf("gültige Streams:       %d Durchläufe\n", runs);
+}
+
+static void testTruncated(TestRandom& rnd) {
+    Bytes data = textData(rnd, 30000);
+    Bytes stream = gzipStream(data, {12, 9, 12, FNAME | FHCRC});
+    // Schnitte im Header, im Extra-Feld, in den Deflate-Daten und im Trailer
+    std::vector<size_t> cuts = {0, 1, 5, 10, 13, 16, 20, stream.size() / 2, stream.size() - 9, stream.size() - 8,
+                                stream.size() - 4, stream.size() - 1};
+    for (int i = 0; i < 50; i++) cuts.push_back(rnd.range(0, (uint32_t)stream.size() - 1));
+
+    for (size_t cut : cuts) {
+        Bytes part(stream.begin(), stream.begin() + cut);
+        InflateResult r = inflateChunks(part, rnd.splits(part.size(), 512));
+        CHECK(!r.ok, "abgeschnitten bei %zu von %zu: trotzdem ok", cut, stream.size());
+    }
+    printf("abgeschnittene Streams: %zu Schnitte\n", cuts.size());
+}
+
+static void testCorrupt(TestRandom& rnd) {
+    Bytes data = textData(rnd, 30000);
+    GzipSpec spec = {12, 9, 12, 0};
+    Bytes stream = gzipStream(data, spec);
+    size_t head = 10 + 2 + 5;
+    int detected = 0, runs = 400;
+    for (int i = 0; i < runs; i++) {
+        Bytes bad = stream;
+        size_t pos = rnd.range((uint32_t)head, (uint32_t)(stream.size() - 9));
+        bad[pos] ^= (uint8_t)(1 << rnd.range(0, 7));
+        InflateResult r = inflateChunks(bad, rnd.splits(bad.size(), 700));
+        // Ein gekipptes Füllbit im letzten Deflate-Byte ändert nichts - das ist in Ordnung.
+        CHECK(!r.ok || r.output == data, "Byte %zu verfälscht: ok, aber falsche Ausgabe", pos);
+        if (!r.ok) detected++;
+    }
+    CHECK(detected > runs * 9 / 10, "nur %d von %d verfälschten Streams erkannt", detected, runs);
+    printf("verfälschte Streams:   %d von %d erkannt\n", detected, runs);
+}
+
+static void testTrailerAndHeader(TestRandom& rnd) {
+    Bytes data = textData(rnd, 5000);
+    Bytes stream = gzipStream(data, {12, 9, 12, 0});
+
+    Bytes badCrc = stream;
+    badCrc[badCrc.size() - 8] ^= 0x01;
+    InflateResult r = inflateChunks(badCrc, rnd.splits(badCrc.size(), 300));
+    CHECK(!r.ok && r.error && !strcmp(r.error, "gzip crc mismatch"), "falsche CRC: %s", r.error ? r.error : "ok");
+
+    Bytes badSize = stream;
+    badSize[badSize.size() - 4] ^= 0x01;
+    r = inflateChunks(badSize, rnd.splits(badSize.size(), 300));
+    CHECK(!r.ok && r.error && !strcmp(r.error, "gzip size mismatch"), "falsche Länge: %s", r.error ? r.error : "ok");
+
+    Bytes badMagic = stream;
+    badMagic[1] = 0x8C;
+    r = inflateChunks(badMagic, rnd.splits(badMagic.size(), 3));
+    CHECK(!r.ok && r.error && !strcmp(r.error, "not a gzip stream"), "falsches Magic: %s", r.error ? r.error : "ok");
+
+    for (int wb : {8, 16}) {
+        Bytes badWindow = gzipStream(data, {15, 9, wb, 0});
+        r = inflateChunks(badWindow, rnd.splits(badWindow.size(), 5));
+        CHECK(!r.ok && r.error && !strcmp(r.error, "unsupported window size"), "WB=%d: %s", wb,
+              r.error ? r.error : "ok");
+    }
+
+    r = inflateChunks(stream, rnd.splits(stream.size(), 100), 1000);
+    CHECK(!r.ok && r.error && !strcmp(r.error, "output aborted"), "Handler-Abbruch: %s", r.error ? r.error : "ok");
+
+    // Zweites gzip-Member wird ignoriert, der erste Stream bleibt gültig.
+    Bytes twoMembers = stream;
+    twoMembers.insert(twoMembers.end(), stream.begin(), stream.end());
+    r = inflateChunks(twoMembers, rnd.splits(twoMembers.size(), 300));
+    CHECK(r.ok && r.output == data, "zwei Member: %s", r.error ? r.error : "Ausgabe weicht ab");
+
+    // Dasselbe Objekt nach einem Fehler wiederverwenden
+    GzipInflater gz;
+    Bytes out;
+    gz.begin([&](const uint8_t* d, size_t n) { out.insert(out.end(), d, d + n); return true; });
+    CHECK(!gz.write(badMagic.data(), badMagic.size()), "falsches Magic: write() ok");
+    out.clear();
+    gz.begin([&](const uint8_t* d, size_t n) { out.insert(out.end(), d, d + n); return true; });
+    CHECK(gz.write(stream.data(), stream.size()) && gz.finish() && out == data, "Wiederverwendung nach Fehler: %s",
+          gz.error() ? gz.error() : "Ausgabe weicht ab");
+}
+
+static void testThroughput(TestRandom& rnd) {
+    Bytes data = textData(rnd, 1 << 20);
+    Bytes stream = gzipStream(data, {12, 9, 12, 0});
+    std::vector<size_t> chunks = rnd.splits(stream.size(), 1436);
+    double t0 = testMicros();
+    InflateResult r = inflateChunks(stream, chunks);
+    double us = testMicros() - t0;
+    CHECK(r.ok && r.output == data, "Durchsatz-Lauf: %s", r.error ? r.error : "Ausgabe weicht ab");
+    printf("Durchsatz (Host):      %.1f MB/s entpackt, %zu -> %zu Bytes\n", data.size() / us, stream.size(),
+           data.size());
+}
+
+int main() {
+    TestRandom rnd(0x6A09E667);
+    testValidStreams(rnd);
+    testTruncated(rnd);
+    testCorrupt(rnd);
+    testTrailerAndHeader(rnd);
+    testThroughput(rnd);
+    return testSummary("test_gzip");
+}
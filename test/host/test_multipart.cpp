@@ -0,0 +1,338 @@
+//================================================================================
+//| DATEI: test/host/test_multipart.cpp                                          |
+//| AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+//| LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+//|------------------------------------------------------------------------------|
+//| ZWECK:                                                                       |
+//| Fuzz- und Durchsatztest für MultipartParser: zufällige Bodies mit mehreren   |
+//| Teilen, Boundaries von 1..70 Zeichen und Inhalten voller Beinahe-Trenner     |
+//| ("\r", "\r\n--", Boundary ohne letztes Zeichen). Jeder Body wird in          |
+//| zufälligen Stückelungen und mit Schnitten an jeder Stelle eines Trenners     |
+//| gefüttert; Teile, Namen und Inhalte müssen exakt wieder herauskommen.        |
+//| Dazu Fehlerfälle und der Durchsatz bei großen Uploads.                       |
+//================================================================================
+
+#include "HostTest.h"
+#include "../../src/modules/Server/MultipartParser.h"
+#include <algorithm>
+
+typedef std::vector<uint8_t> Bytes;
+
+/**
+ * @brief Ein Teil, wie er im Body steht bzw. vom Parser gemeldet wird.
+ */
+struct Part {
+    std::string name;
+    std::string filename;
+    std::string type;
+    Bytes data;
+
+    bool operator==(const Part& o) const {
+        return name == o.name && filename == o.filename && type == o.type && data == o.data;
+    }
+};
+
+/**
+ * @brief Ergebnis eines Durchlaufs durch den Parser.
+ */
+struct ParseResult {
+    bool ok;            // kein feed() mit false
+    bool done;
+    bool inPart;
+    int ended;          // Anzahl onPartEnd
+    std::vector<Part> parts;
+};
+
+static const char BOUNDARY_CHARS[] = "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ'()+_,-./:=?";
+
+static std::string randomBoundary(TestRandom& rnd, size_t len) {
+    std::string b;
+    for (size_t i = 0; i < len; i++) b += BOUNDARY_CHARS[rnd.range(0, sizeof(BOUNDARY_CHARS) - 2)];
+    return b;
+}
+
+static bool contains(const Bytes& data, const std::string& needle) {
+    return std::search(data.begin(), data.end(), needle.begin(), needle.end()) != data.end();
+}
+
+/**
+ * @brief Inhalt voller Trenner-Anfänge, der den vollständigen Trenner aber nie enthält.
+ */
+static Bytes hostilePayload(TestRandom& rnd, const std::string& boundary, size_t len) {
+    std::string delim = "\r\n--" + boundary;
+    while (true) {
+        Bytes data;
+        while (data.size() < len) {
+            switch (rnd.range(0, 5)) {
+                case 0: {
+                    size_t n = rnd.range(1, 200);
+                    for (size_t i = 0; i < n; i++) data.push_back((uint8_t)rnd.next());
+                    break;
+                }
+                case 1:
+                    data.push_back('\r');
+                    break;
+                case 2:
+                    data.push_back('\r');
+                    data.push_back('\n');
+                    break;
+                default: {
+                    // Trenner bis kurz vor Schluss, danach ein abweichendes Zeichen
+                    size_t n = rnd.range(1, (uint32_t)delim.size() - 1);
+                    data.insert(data.end(), delim.begin(), delim.begin() + n);
+                    break;
+                }
+            }
+        }
+        data.resize(len);
+        // Zufällig zusammengesetzte Stücke können den Trenner doch ergeben - dann neu würfeln.
+        // Das CRLF vor dem Inhalt (Ende der Header) zählt mit.
+        Bytes framed = {'\r', '\n'};
+        framed.insert(framed.end(), data.begin(), data.end());
+        if (!contains(framed, delim)) return data;
+    }
+}
+
+/**
+ * @brief Baut einen Body wie ein Browser bzw. curl -F (mit optionalem Prolog/Epilog).
+ * @param delimOffsets erhält die Position jedes Trenners ("\r\n--boundary") im Body
+ */
+static Bytes buildBody(const std::string& boundary, const std::vector<Part>& parts, bool preamble, bool epilogue,
+                       std::vector<size_t>* delimOffsets = nullptr) {
+    std::string out;
+    if (preamble) out += "This is a multi-part message in MIME format.\r\n";
+    for (size_t i = 0; i < parts.size(); i++) {
+        if (delimOffsets) delimOffsets->push_back(out.size());
+        if (i > 0 || preamble) out += "\r\n";
+        out += "--" + boundary + "\r\n";
+        out += "Content-Disposition: form-data; name=\"" + parts[i].name + "\"";
+        if (!parts[i].filename.empty()) out += "; filename=\"" + parts[i].filename + "\"";
+        out += "\r\n";
+        if (!parts[i].type.empty()) out += "Content-Type: " + parts[i].type + "\r\n";
+        out += "\r\n";
+        out.append(parts[i].data.begin(), parts[i].data.end());
+    }
+    if (delimOffsets) delimOffsets->push_back(out.size());
+    out += "\r\n--" + boundary + "--";
+    if (epilogue) out += "\r\nepilogue \r\n--" + boundary + "\r\n";
+    return Bytes(out.begin(), out.end());
+}
+
+static ParseResult parseChunks(const std::string& contentType, const Bytes& body, const std::vector<size_t>& chunks) {
+    ParseResult r;
+    r.ok = true;
+    r.ended = 0;
+    MultipartParser parser;
+    parser.onPartBegin([&](const char* name, const char* filename, const char* type) {
+        Part p;
+        p.name = name;
+        p.filename = filename;
+        p.type = type;
+        r.parts.push_back(p);
+    });
+    parser.onPartData([&](const uint8_t* data, size_t len) {
+        CHECK(!r.parts.empty(), "Daten vor onPartBegin");
+        CHECK(len > 0, "onPartData mit 0 Bytes");
+        if (!r.parts.empty()) r.parts.back().data.insert(r.parts.back().data.end(), data, data + len);
+    });
+    parser.onPartEnd([&]() { r.ended++; });
+
+    if (!parser.begin(contentType.c_str())) {
+        r.ok = r.done = r.inPart = false;
+        return r;
+    }
+    size_t pos = 0;
+    for (size_t n : chunks) {
+        if (!parser.feed(body.data() + pos, n)) r.ok = false;
+        pos += n;
+    }
+    r.done = parser.isDone();
+    r.inPart = parser.inPart();
+    CHECK(r.ok == !parser.hasError(), "feed() und hasError() widersprechen sich");
+    return r;
+}
+
+static void expectParts(const ParseResult& r, const std::vector<Part>& parts, const char* what) {
+    CHECK(r.ok && r.done && !r.inPart, "%s: ok=%d done=%d inPart=%d", what, r.ok, r.done, r.inPart);
+    CHECK(r.ended == (int)parts.size(), "%s: %d x onPartEnd statt %zu", what, r.ended, parts.size());
+    CHECK(r.parts.size() == parts.size(), "%s: %zu Teile statt %zu", what, r.parts.size(), parts.size());
+    for (size_t i = 0; i < parts.size() && i < r.parts.size(); i++) {
+        CHECK(r.parts[i] == parts[i], "%s: Teil %zu (\"%s\", %zu Bytes) weicht ab (\"%s\", %zu Bytes)", what, i,
+              parts[i].name.c_str(), parts[i].data.size(), r.parts[i].name.c_str(), r.parts[i].data.size());
+    }
+}
+
+static std::vector<Part> randomParts(TestRandom& rnd, const std::string& boundary) {
+    static const char* types[] = {"", "application/octet-stream", "text/plain", "application/gzip"};
+    std::vector<Part> parts(rnd.range(1, 5));
+    for (size_t i = 0; i < parts.size(); i++) {
+        parts[i].name = "field" + std::to_string(i);
+        if (rnd.range(0, 1)) parts[i].filename = "file" + std::to_string(i) + ".bin";
+        parts[i].type = types[rnd.range(0, 3)];
+        size_t len = rnd.range(0, 3) == 0 ? rnd.range(0, 3) : rnd.range(1, 6000);
+        parts[i].data = hostilePayload(rnd, boundary, len);
+    }
+    return parts;
+}
+
+static void testRandomBodies(TestRandom& rnd) {
+    int runs = 0;
+    for (int iter = 0; iter < 300; iter++) {
+        std::string boundary = randomBoundary(rnd, rnd.range(1, MULTIPART_MAX_BOUNDARY));
+        std::vector<Part> parts = randomParts(rnd, boundary);
+        Bytes body = buildBody(boundary, parts, rnd.range(0, 1), rnd.range(0, 1));
+        std::string contentType = "multipart/form-data; boundary=" + boundary;
+        if (rnd.range(0, 3) == 0) contentType = "multipart/form-data; boundary=\"" + boundary + "\"; charset=utf-8";
+
+        const size_t maxChunks[] = {1, 2, 5, 17, 100, 1436, body.size()};
+        for (size_t maxChunk : maxChunks) {
+            char what[96];
+            snprintf(what, sizeof(what), "Body %d (Boundary %zu, Stücke <= %zu)", iter, boundary.size(), maxChunk);
+            expectParts(parseChunks(contentType, body, rnd.splits(body.size(), maxChunk)), parts, what);
+            runs++;
+        }
+    }
+    printf("zufällige Bodies:      %d Durchläufe\n", runs);
+}
+
+/**
+ * @brief Schnitt an jeder Stelle jedes Trenners (auch zweimal im selben Trenner).
+ */
+static void testSplitDelimiters(TestRandom& rnd) {
+    int runs = 0;
+    const size_t boundaryLens[] = {1, 2, 16, 40, MULTIPART_MAX_BOUNDARY};
+    for (size_t blen : boundaryLens) {
+        std::string boundary = randomBoundary(rnd, blen);
+        std::vector<Part> parts(3);
+        parts[0].name = "a";
+        parts[0].data = hostilePayload(rnd, boundary, 300);
+        parts[1].name = "firmware";
+        parts[1].filename = "fw.bin";
+        parts[1].type = "application/octet-stream";
+        parts[1].data = hostilePayload(rnd, boundary, 50);
+        parts[2].name = "leer";
+        std::vector<size_t> offsets;
+        Bytes body = buildBody(boundary, parts, false, false, &offsets);
+        std::string contentType = "multipart/form-data; boundary=" + boundary;
+
+        for (size_t d : offsets) {
+            size_t end = std::min(body.size(), d + boundary.size() + 6);
+            for (size_t a = d; a <= end; a++) {
+                for (size_t b = a; b <= end; b += 3) {
+                    std::vector<size_t> chunks;
+                    if (a > 0) chunks.push_back(a);
+                    if (b > a) chunks.push_back(b - a);
+                    if (body.size() > b) chunks.push_back(body.size() - b);
+                    char what[96];
+                    snprintf(what, sizeof(what), "Boundary %zu, Schnitte bei %zu/%zu", blen, a, b);
+                    expectParts(parseChunks(contentType, body, chunks), parts, what);
+                    runs++;
+                }
+            }
+        }
+    }
+    printf("geteilte Trenner:      %d Durchläufe\n", runs);
+}
+
+static void testHeadersAndErrors(TestRandom& rnd) {
+    std::string boundary = "----WebKitFormBoundary7MA4YWxkTrZu0gW";
+    std::string contentType = "multipart/form-data; boundary=" + boundary;
+    std::string body =
+        "--" + boundary + "\r\n"
+        "content-disposition: form-data; filename=\"C:\\\\Users\\\\hsd\\\\firmware.bin\"; name=\"update\"\r\n"
+        "X-Long: " + std::string(400, 'x') + "\r\n"
+        "Content-Type: application/octet-stream\r\n"
+        "\r\n"
+        "DATA\r\n--" + boundary + "--\r\n";
+    Bytes bytes(body.begin(), body.end());
+    ParseResult r = parseChunks(contentType, bytes, rnd.splits(bytes.size(), 9));
+    Part expected;
+    expected.name = "update";
+    expected.filename = "firmware.bin";
+    expected.type = "application/octet-stream";
+    expected.data = Bytes({'D', 'A', 'T', 'A'});
+    expectParts(r, {expected}, "Browser-Header");
+
+    MultipartParser parser;
+    CHECK(!parser.begin("application/x-www-form-urlencoded"), "falscher Content-Type akzeptiert");
+    CHECK(!parser.begin("multipart/form-data"), "fehlende Boundary akzeptiert");
+    CHECK(!parser.begin("multipart/form-data; boundary="), "leere Boundary akzeptiert");
+    CHECK(!parser.begin(("multipart/form-data; boundary=" + std::string(71, 'b')).c_str()),
+          "Boundary mit 71 Zeichen akzeptiert");
+    CHECK(parser.begin(("multipart/form-data; boundary=" + std::string(70, 'b')).c_str()),
+          "Boundary mit 70 Zeichen abgelehnt");
+
+    // Nach dem Trenner weder CRLF noch "--"
+    std::string bad = "--b\r\nContent-Disposition: form-data; name=\"x\"\r\n\r\nabc\r\n--bX\r\n";
+    r = parseChunks("multipart/form-data; boundary=b", Bytes(bad.begin(), bad.end()), {bad.size()});
+    CHECK(!r.ok && !r.done, "Müll nach Trenner: ok=%d", r.ok);
+
+    // Header-Zeile ohne LF
+    bad = "--b\r\nContent-Disposition: form-data\rX\r\n\r\nabc\r\n--b--";
+    r = parseChunks("multipart/form-data; boundary=b", Bytes(bad.begin(), bad.end()), {bad.size()});
+    CHECK(!r.ok, "CR ohne LF im Header akzeptiert");
+
+    // Abgebrochener Upload: Teil offen, nicht fertig
+    std::vector<Part> parts = randomParts(rnd, boundary);
+    Bytes full = buildBody(boundary, parts, false, false);
+    for (int i = 0; i < 50; i++) {
+        size_t cut = rnd.range(0, (uint32_t)full.size() - 3);
+        Bytes part(full.begin(), full.begin() + cut);
+        r = parseChunks(contentType, part, rnd.splits(part.size(), 200));
+        CHECK(!r.done, "abgeschnitten bei %zu von %zu: trotzdem fertig", cut, full.size());
+        CHECK(r.ok, "abgeschnitten bei %zu: Formatfehler gemeldet", cut);
+        CHECK(r.inPart == (r.parts.size() > (size_t)r.ended), "abgeschnitten bei %zu: inPart falsch", cut);
+    }
+}
+
+static void measure(const char* label, const std::string& boundary, const Bytes& payload, size_t chunk) {
+    Part p;
+    p.name = "firmware";
+    p.filename = "firmware.bin";
+    p.type = "application/octet-stream";
+    Bytes body = buildBody(boundary, {p}, false, false);
+    // Inhalt einsetzen, ohne ihn für den Vergleich zu kopieren
+    size_t at = body.size() - boundary.size() - 6;
+    body.insert(body.begin() + at, payload.begin(), payload.end());
+
+    MultipartParser parser;
+    size_t received = 0;
+    parser.onPartData([&](const uint8_t*, size_t len) { received += len; });
+    parser.begin(("multipart/form-data; boundary=" + boundary).c_str());
+
+    const int rounds = 5;
+    double best = 1e30;
+    for (int round = 0; round < rounds; round++) {
+        parser.begin(("multipart/form-data; boundary=" + boundary).c_str());
+        received = 0;
+        double t0 = testMicros();
+        for (size_t pos = 0; pos < body.size(); pos += chunk) {
+            parser.feed(body.data() + pos, std::min(chunk, body.size() - pos));
+        }
+        best = std::min(best, testMicros() - t0);
+        CHECK(parser.isDone() && received == payload.size(), "%s: %zu von %zu Bytes", label, received,
+              payload.size());
+    }
+    printf("Durchsatz %-24s %7.1f MB/s (Stücke %zu Bytes, Host)\n", label, payload.size() / best, chunk);
+}
+
+static void testThroughput(TestRandom& rnd) {
+    std::string boundary = "----WebKitFormBoundary7MA4YWxkTrZu0gW";
+    Bytes binary(4 << 20);
+    rnd.fill(binary.data(), binary.size());
+    // Schlimmster Fall: jedes vierte Byte '\r', oft mit "\r\n--" dahinter
+    Bytes hostile = hostilePayload(rnd, boundary, 4 << 20);
+
+    measure("Binärdaten:", boundary, binary, 1436);
+    measure("Binärdaten:", boundary, binary, 4096);
+    measure("Beinahe-Trenner:", boundary, hostile, 1436);
+}
+
+int main() {
+    TestRandom rnd(0xBB67AE85);
+    testRandomBodies(rnd);
+    testSplitDelimiters(rnd);
+    testHeadersAndErrors(rnd);
+    testThroughput(rnd);
+    return testSummary("test_multipart");
+}
@@ -0,0 +1,270 @@
+#!/usr/bin/env python3
+# ================================================================================
+# | DATEI: tools/api_formats.py                                                  |
+# | AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+# | LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+# |------------------------------------------------------------------------------|
+# | ZWECK:                                                                       |
+# | Vergleicht die Antwortformate der API (JSON, CBOR, MessagePack). Jede Route  |
+# | wird pro Format mehrfach abgefragt; ausgegeben werden Bytes pro Antwort,     |
+# | Latenz (enthält die Encode-Zeit auf dem ESP32) und die Decode-Zeit auf dem   |
+# | Host. Zusätzlich wird geprüft, dass alle Formate dieselben Werte liefern.    |
+# |                                                                              |
+# | BEISPIEL:                                                                    |
+# |   python tools/api_formats.py 192.168.4.1                                    |
+# |   python tools/api_formats.py 192.168.4.1 -r /api/robot/status -n 200        |
+# |                                                                              |
+# | Nur Python-Standardbibliothek (eigene Mini-Decoder für CBOR/MessagePack).    |
+# ================================================================================
+
+import argparse
+import http.client
+import json
+import struct
+import sys
+import time
+
+DEFAULT_ROUTES = ["/api/robot/status", "/api/system/health"]
+
+FORMATS = [
+    ("json", "application/json"),
+    ("cbor", "application/cbor"),
+    ("msgpack", "application/msgpack"),
+]
+
+
+class Reader:
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def take(self, n):
+        if self.pos + n > len(self.data):
+            raise ValueError("Daten zu kurz")
+        chunk = self.data[self.pos:self.pos + n]
+        self.pos += n
+        return chunk
+
+    def byte(self):
+        return self.take(1)[0]
+
+    def uint(self, n):
+        return int.from_bytes(self.take(n), "big")
+
+
+def decode_cbor(data):
+    """Dekodiert die vom CborWriter genutzte Teilmenge von CBOR."""
+    r = Reader(data)
+
+    def item():
+        head = r.byte()
+        major, info = head >> 5, head & 0x1F
+        if major == 7:
+            if info == 20:
+                return False
+            if info == 21:
+                return True
+            if info == 22:
+                return None
+            if info == 26:
+                return struct.unpack(">f", r.take(4))[0]
+            if info == 27:
+                return struct.unpack(">d", r.take(8))[0]
+            raise ValueError("Unbekannter Simple-Wert %d" % info)
+        if info == 31:
+            if major == 4:
+                out = []
+                while r.data[r.pos] != 0xFF:
+                    out.append(item())
+                r.pos += 1
+                return out
+            if major == 5:
+                out = {}
+                while r.data[r.pos] != 0xFF:
+                    k = item()
+                    out[k] = item()
+                r.pos += 1
+                return out
+            raise ValueError("Indefinite Length nur für Array/Map unterstützt")
+        value = info if info < 24 else r.uint(1 << (info - 24))
+        if major == 0:
+            return value
+        if major == 1:
+            return -1 - value
+        if major == 2:
+            return r.take(value)
+        if major == 3:
+            return r.take(value).decode("utf-8")
+        if major == 4:
+            return [item() for _ in range(value)]
+        if major == 5:
+            out = {}
+            for _ in range(value):
+                k = item()
+                out[k] = item()
+            return out
+        raise ValueError("Major-Type %d nicht unterstützt" % major)
+
+    result = item()
+    if r.pos != len(data):
+        raise ValueError("%d Bytes nach dem Ende" % (len(data) - r.pos))
+    return result
+
+
+def decode_msgpack(data):
+    """Dekodiert die vom MsgPackWriter genutzte Teilmenge von MessagePack."""
+    r = Reader(data)
+
+    def items(n):
+        return [item() for _ in range(n)]
+
+    def pairs(n):
+        out = {}
+        for _ in range(n):
+            k = item()
+            out[k] = item()
+        return out
+
+    def item():
+        b = r.byte()
+        if b <= 0x7F:
+            return b
+        if b >= 0xE0:
+            return b - 0x100
+        if 0x80 <= b <= 0x8F:
+            return pairs(b & 0x0F)
+        if 0x90 <= b <= 0x9F:
+            return items(b & 0x0F)
+        if 0xA0 <= b <= 0xBF:
+            return r.take(b & 0x1F).decode("utf-8")
+        simple = {0xC0: None, 0xC2: False, 0xC3: True}
+        if b in simple:
+            return simple[b]
+        if b == 0xCA:
+            return struct.unpack(">f", r.take(4))[0]
+        if b == 0xCB:
+            return struct.unpack(">d", r.take(8))[0]
+        unsigned = {0xCC: 1, 0xCD: 2, 0xCE: 4, 0xCF: 8}
+        if b in unsigned:
+            return r.uint(unsigned[b])
+        signed = {0xD0: 1, 0xD1: 2, 0xD2: 4, 0xD3: 8}
+        if b in signed:
+            return int.from_bytes(r.take(signed[b]), "big", signed=True)
+        strings = {0xD9: 1, 0xDA: 2, 0xDB: 4}
+        if b in strings:
+            return r.take(r.uint(strings[b])).decode("utf-8")
+        if b in (0xDC, 0xDD):
+            return items(r.uint(2 if b == 0xDC else 4))
+        if b in (0xDE, 0xDF):
+            return pairs(r.uint(2 if b == 0xDE else 4))
+        raise ValueError("Typ 0x%02X nicht unterstützt" % b)
+
+    result = item()
+    if r.pos != len(data):
+        raise ValueError("%d Bytes nach dem Ende" % (len(data) - r.pos))
+    return result
+
+
+DECODERS = {"json": json.loads, "cbor": decode_cbor, "msgpack": decode_msgpack}
+
+
+def same_values(a, b, tolerance=0.01):
+    """Vergleicht zwei dekodierte Werte. JSON-Zahlen sind gerundet, daher mit Toleranz."""
+    if isinstance(a, dict) and isinstance(b, dict):
+        return a.keys() == b.keys() and all(same_values(a[k], b[k], tolerance) for k in a)
+    if isinstance(a, list) and isinstance(b, list):
+        return len(a) == len(b) and all(same_values(x, y, tolerance) for x, y in zip(a, b))
+    if isinstance(a, bool) or isinstance(b, bool):
+        return a == b
+    if isinstance(a, (int, float)) and isinstance(b, (int, float)):
+        return abs(a - b) <= tolerance * max(1.0, abs(a))
+    return a == b
+
+
+# Felder, die sich zwischen zwei Abfragen ändern dürfen (Messwerte, Zeit).
+VOLATILE_KEYS = {"angle", "error", "gyro", "motor", "uptime_seconds", "heap_free", "heap_min_free",
+                 "wifi_rssi", "cpu_temp", "last_time_sync"}
+
+
+def stable(value):
+    if isinstance(value, dict):
+        return {k: stable(v) for k, v in value.items() if k not in VOLATILE_KEYS}
+    return value
+
+
+def measure(host, port, route, fmt, accept, count, timeout):
+    conn = http.client.HTTPConnection(host, port, timeout=timeout)
+    latencies, decode_times, sizes = [], [], []
+    content_type, sample = None, None
+    try:
+        for _ in range(count):
+            t0 = time.perf_counter()
+            conn.request("GET", route, headers={"Accept": accept})
+            resp = conn.getresponse()
+            body = resp.read()
+            latencies.append(time.perf_counter() - t0)
+            if resp.status != 200:
+                raise RuntimeError("%s %s: HTTP %d" % (route, fmt, resp.status))
+            content_type = resp.getheader("Content-Type", "")
+            sizes.append(len(body))
+            t1 = time.perf_counter()
+            sample = DECODERS[fmt](body)
+            decode_times.append(time.perf_counter() - t1)
+    finally:
+        conn.close()
+    latencies.sort()
+    return {
+        "format": fmt,
+        "content_type": content_type,
+        "bytes": sum(sizes) / len(sizes),
+        "p50_ms": latencies[len(latencies) // 2] * 1000.0,
+        "p99_ms": latencies[min(len(latencies) - 1, int(len(latencies) * 0.99))] * 1000.0,
+        "decode_us": sum(decode_times) / len(decode_times) * 1e6,
+        "sample": sample,
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Vergleich JSON / CBOR / MessagePack der API-Antworten.")
+    parser.add_argument("host", help="IP-Adresse oder Hostname des Geräts")
+    parser.add_argument("-p", "--port", type=int, default=80)
+    parser.add_argument("-r", "--route", dest="routes", action="append",
+                        help="Route (mehrfach angeben). Standard: %s" % ", ".join(DEFAULT_ROUTES))
+    parser.add_argument("-n", "--requests", type=int, default=50, help="Requests pro Route und Format")
+    parser.add_argument("--timeout", type=float, default=5.0)
+    parser.add_argument("--json", action="store_true", help="Ergebnis als JSON ausgeben")
+    args = parser.parse_args()
+    routes = args.routes or list(DEFAULT_ROUTES)
+
+    report, mismatches = {}, []
+    for route in routes:
+        results = [measure(args.host, args.port, route, fmt, accept, args.requests, args.timeout)
+                   for fmt, accept in FORMATS]
+        reference = stable(results[0]["sample"])
+        for res in results[1:]:
+            if not same_values(reference, stable(res["sample"])):
+                mismatches.append("%s: %s weicht von JSON ab" % (route, res["format"]))
+        for res in results:
+            del res["sample"]
+        report[route] = results
+
+    if args.json:
+        json.dump({"routes": report, "mismatches": mismatches}, sys.stdout, indent=2)
+        print()
+    else:
+        for route, results in report.items():
+            print(route)
+            base = results[0]["bytes"] or 1
+            print("  %-8s %-22s %8s %7s %9s %9s %10s" %
+                  ("Format", "Content-Type", "Bytes", "rel.", "p50 ms", "p99 ms", "Decode µs"))
+            for res in results:
+                print("  %-8s %-22s %8.0f %6.0f%% %9.2f %9.2f %10.1f" %
+                      (res["format"], res["content_type"], res["bytes"], res["bytes"] / base * 100,
+                       res["p50_ms"], res["p99_ms"], res["decode_us"]))
+        for line in mismatches:
+            print("ABWEICHUNG: " + line)
+    return 1 if mismatches else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,350 @@
+#!/usr/bin/env python3
+# ================================================================================
+# | DATEI: tools/http_loadtest.py                                                |
+# | AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+# | LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+# |------------------------------------------------------------------------------|
+# | ZWECK:                                                                       |
+# | Lastgenerator für den Webserver. Mehrere Clients rufen parallel die          |
+# | angegebenen Routen auf (Keep-Alive). Pro Route werden req/s, p50/p99-Latenz, |
+# | Fehler und die Allokationen pro Request ausgegeben. Letztere kommen aus den  |
+# | Heap-Scopes der Routen (/api/system/heap, nur im Build mit HEAP_TRACKING:    |
+# | env:esp32dev-heaptrace oder test/host), nicht aus globalen Zählern - so      |
+# | verfälschen weder andere Routen noch Hintergrund-Tasks das Ergebnis.         |
+# |                                                                              |
+# | Die Standard-Routen lesen nur. Routen, die Aktoren bewegen (/api/robot/move, |
+# | /api/batch), gehören nicht in einen Lasttest am Roboter.                     |
+# |                                                                              |
+# | BEISPIEL:                                                                    |
+# |   python tools/http_loadtest.py 192.168.4.1 -c 4 -d 20                       |
+# |   python tools/http_loadtest.py 192.168.4.1 --json > messung.json            |
+# |   python tools/http_loadtest.py 192.168.4.1 --baseline messung.json          |
+# |   make -C test/host loadtest        (Firmware als Linux-Prozess, Port 8080)  |
+# |                                                                              |
+# | Nur Python-Standardbibliothek, damit das Skript überall direkt läuft.        |
+# ================================================================================
+
+import argparse
+import http.client
+import json
+import sys
+import threading
+import time
+from collections import defaultdict
+
+DEFAULT_ROUTES = [
+    "/api/robot/status",
+    "/api/system/health",
+    "/index.html",
+]
+
+STATS_ROUTE = "/api/server/stats"
+HEAP_ROUTE = "/api/system/heap"
+
+
+def percentile(sorted_values, p):
+    """Perzentil per nächstem Rang (sorted_values muss sortiert sein)."""
+    if not sorted_values:
+        return 0.0
+    index = int(round(p / 100.0 * (len(sorted_values) - 1)))
+    return sorted_values[index]
+
+
+def fetch_json(host, port, timeout, route):
+    """Liest einen JSON-Endpunkt des Geräts. Gibt None zurück, wenn nicht verfügbar."""
+    try:
+        conn = http.client.HTTPConnection(host, port, timeout=timeout)
+        conn.request("GET", route)
+        resp = conn.getresponse()
+        body = resp.read()
+        conn.close()
+        if resp.status != 200:
+            return None
+        return json.loads(body)
+    except (OSError, ValueError, http.client.HTTPException):
+        return None
+
+
+def route_scopes(heap):
+    """Heap-Scopes der Routen aus /api/system/heap als {(uri, methode): scope}.
+    Leer, wenn die Firmware ohne HEAP_TRACKING gebaut ist."""
+    if not heap or not heap.get("tracking"):
+        return {}
+    return {(s["name"], s["method"]): s for s in heap.get("scopes", []) if "method" in s}
+
+
+def scope_for(route, method, scopes):
+    """Ordnet eine aufgerufene Route ihrem Scope zu: exakte URI zuerst, sonst das
+    längste passende Wildcard-Muster (z.B. "/*" für statische Dateien)."""
+    path = route.split("?")[0]
+    if (path, method) in scopes:
+        return path
+    best = None
+    for name, scope_method in scopes:
+        if scope_method != method or not name.endswith("*"):
+            continue
+        if path.startswith(name[:-1]) and (best is None or len(name) > len(best)):
+            best = name
+    return best
+
+
+class RouteResult:
+    def __init__(self):
+        self.sent = 0
+        self.latencies = []
+        self.errors = 0
+        self.bytes = 0
+        self.status = defaultdict(int)
+
+
+class Worker(threading.Thread):
+    """Ein Client: hält eine Keep-Alive-Verbindung und ruft die Routen reihum auf."""
+
+    def __init__(self, host, port, routes, deadline, max_requests, timeout, method_for):
+        super().__init__(daemon=True)
+        self.host = host
+        self.port = port
+        self.routes = routes
+        self.deadline = deadline
+        self.max_requests = max_requests
+        self.timeout = timeout
+        self.method_for = method_for
+        self.results = defaultdict(RouteResult)
+
+    def _connect(self):
+        return http.client.HTTPConnection(self.host, self.port, timeout=self.timeout)
+
+    def run(self):
+        conn = self._connect()
+        count = 0
+        while time.monotonic() < self.deadline and (self.max_requests <= 0 or count < self.max_requests):
+            route = self.routes[count % len(self.routes)]
+            result = self.results[route]
+            count += 1
+            result.sent += 1
+            start = time.perf_counter()
+            try:
+                conn.request(self.method_for(route), route)
+                resp = conn.getresponse()
+                body = resp.read()
+                elapsed = time.perf_counter() - start
+                result.latencies.append(elapsed)
+                result.bytes += len(body)
+                result.status[resp.status] += 1
+                if resp.status >= 400:
+                    result.errors += 1
+                if resp.getheader("Connection", "").lower() == "close":
+                    conn.close()
+                    conn = self._connect()
+            except (OSError, http.client.HTTPException):
+                result.errors += 1
+                conn.close()
+                conn = self._connect()
+        conn.close()
+
+
+def merge(workers):
+    merged = defaultdict(RouteResult)
+    for w in workers:
+        for route, r in w.results.items():
+            m = merged[route]
+            m.sent += r.sent
+            m.latencies.extend(r.latencies)
+            m.errors += r.errors
+            m.bytes += r.bytes
+            for code, n in r.status.items():
+                m.status[code] += n
+    return merged
+
+
+def stats_delta(before, after, key):
+    if not before or not after or key not in before or key not in after:
+        return None
+    return after[key] - before[key]
+
+
+def build_report(args, merged, duration, before, after, method_for):
+    total_requests = sum(len(r.latencies) for r in merged.values())
+    scopes_before = route_scopes(before["heap"])
+    scopes_after = route_scopes(after["heap"])
+
+    # Requests je Scope: Routen, die sich einen Scope teilen (z.B. "/*"), teilen
+    # sich auch die Allokationen.
+    sent_per_scope = defaultdict(int)
+    for route in args.routes:
+        scope = scope_for(route, method_for(route), scopes_after)
+        if scope:
+            sent_per_scope[(scope, method_for(route))] += merged.get(route, RouteResult()).sent
+
+    routes = {}
+    for route in args.routes:
+        r = merged.get(route, RouteResult())
+        lat = sorted(r.latencies)
+        routes[route] = {
+            "requests": len(lat),
+            "errors": r.errors,
+            "req_per_s": round(len(lat) / duration, 1) if duration > 0 else 0.0,
+            "p50_ms": round(percentile(lat, 50) * 1000, 2),
+            "p99_ms": round(percentile(lat, 99) * 1000, 2),
+            "max_ms": round(lat[-1] * 1000, 2) if lat else 0.0,
+            "bytes": r.bytes,
+            "status": {str(k): v for k, v in sorted(r.status.items())},
+        }
+        key = (scope_for(route, method_for(route), scopes_after), method_for(route))
+        if key[0] and sent_per_scope[key]:
+            old = scopes_before.get(key, {})
+            new = scopes_after[key]
+            allocs = new["allocs"] - old.get("allocs", 0)
+            alloc_bytes = new["alloc_bytes"] - old.get("alloc_bytes", 0)
+            routes[route]["heap"] = {
+                "scope": key[0],
+                "allocs": allocs,
+                "alloc_bytes": alloc_bytes,
+                "allocs_per_request": round(allocs / float(sent_per_scope[key]), 3),
+                "bytes_per_request": round(alloc_bytes / float(sent_per_scope[key]), 1),
+            }
+
+    # Globale Zähler des Parsers: enthalten jeden Request an das Gerät, daher nur
+    # als Rohdifferenz (nicht pro Request der Messung).
+    device = {}
+    parser = {}
+    for key in ("requests", "params", "heap_allocs", "heap_bytes", "string_args", "overflows", "timeouts"):
+        delta = stats_delta(before["stats"], after["stats"], key)
+        if delta is not None:
+            parser[key] = delta
+    if parser:
+        device["parser"] = parser
+    device["heap_tracking"] = bool(scopes_after)
+    if after["stats"] and "workers" in after["stats"]:
+        device["workers"] = after["stats"]["workers"]
+
+    return {
+        "target": "%s:%d" % (args.host, args.port),
+        "concurrency": args.concurrency,
+        "duration_s": round(duration, 2),
+        "total_requests": total_requests,
+        "req_per_s": round(total_requests / duration, 1) if duration > 0 else 0.0,
+        "routes": routes,
+        "device": device,
+    }
+
+
+def print_report(report):
+    print("Ziel: %s  Clients: %d  Dauer: %.1f s  Gesamt: %d Requests (%.1f req/s)" % (
+        report["target"], report["concurrency"], report["duration_s"],
+        report["total_requests"], report["req_per_s"]))
+    print()
+    header = "%-32s %8s %8s %9s %9s %9s %7s %9s %9s" % (
+        "Route", "Anzahl", "req/s", "p50 ms", "p99 ms", "max ms", "Fehler", "alloc/req", "B/req")
+    print(header)
+    print("-" * len(header))
+    for route, r in report["routes"].items():
+        heap = r.get("heap")
+        print("%-32s %8d %8.1f %9.2f %9.2f %9.2f %7d %9s %9s" % (
+            route[:32], r["requests"], r["req_per_s"], r["p50_ms"], r["p99_ms"], r["max_ms"], r["errors"],
+            heap["allocs_per_request"] if heap else "-", heap["bytes_per_request"] if heap else "-"))
+
+    device = report["device"]
+    print()
+    if device.get("heap_tracking"):
+        print("alloc/req, B/req: Heap-Scope der Route (%s) / gesendete Requests." % HEAP_ROUTE)
+    else:
+        print("Hinweis: Firmware ohne HEAP_TRACKING - keine Allokationen pro Route.")
+    parser = device.get("parser")
+    if parser:
+        print("Parser-Zähler (%s, Differenz über alle Requests am Gerät):" % STATS_ROUTE)
+        for key in ("requests", "params", "heap_allocs", "heap_bytes", "string_args", "overflows", "timeouts"):
+            if key in parser:
+                print("  %-24s %s" % (key, parser[key]))
+    workers = device.get("workers")
+    if workers:
+        for prio in ("control", "bulk"):
+            q = workers.get(prio)
+            if q:
+                print("  queue %-8s max_depth=%s wait_avg_us=%s wait_max_us=%s rejected=%s" % (
+                    prio, q.get("max_depth"), q.get("wait_avg_us"), q.get("wait_max_us"), q.get("rejected")))
+
+
+def compare_baseline(report, baseline, tolerance):
+    """Meldet Routen, deren p99 oder Durchsatz schlechter als die Toleranz geworden ist."""
+    regressions = []
+    for route, now in report["routes"].items():
+        old = baseline.get("routes", {}).get(route)
+        if not old or not now["requests"]:
+            continue
+        if old["p99_ms"] > 0 and now["p99_ms"] > old["p99_ms"] * (1 + tolerance):
+            regressions.append("%s: p99 %.2f ms -> %.2f ms" % (route, old["p99_ms"], now["p99_ms"]))
+        if old["req_per_s"] > 0 and now["req_per_s"] < old["req_per_s"] * (1 - tolerance):
+            regressions.append("%s: %.1f req/s -> %.1f req/s" % (route, old["req_per_s"], now["req_per_s"]))
+        old_heap = old.get("heap")
+        new_heap = now.get("heap")
+        if old_heap and new_heap and new_heap["allocs_per_request"] > old_heap["allocs_per_request"]:
+            regressions.append("%s: allocs/request %s -> %s" % (
+                route, old_heap["allocs_per_request"], new_heap["allocs_per_request"]))
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description="HTTP-Lasttest für den ESP32-Webserver.")
+    parser.add_argument("host", help="IP-Adresse oder Hostname des Geräts")
+    parser.add_argument("-p", "--port", type=int, default=80)
+    parser.add_argument("-c", "--concurrency", type=int, default=2,
+                        help="Anzahl paralleler Clients (httpd erlaubt standardmäßig 7 Sockets)")
+    parser.add_argument("-d", "--duration", type=float, default=10.0, help="Messdauer in Sekunden")
+    parser.add_argument("-n", "--requests", type=int, default=0,
+                        help="Maximale Requests pro Client (0 = nur Dauer begrenzt)")
+    parser.add_argument("-r", "--route", dest="routes", action="append",
+                        help="Route (mehrfach angeben). Standard: %s" % ", ".join(DEFAULT_ROUTES))
+    parser.add_argument("--post", action="append", default=[],
+                        help="Routen, die per POST aufgerufen werden (nur bewusst: kann Aktoren bewegen)")
+    parser.add_argument("--timeout", type=float, default=5.0)
+    parser.add_argument("--json", action="store_true", help="Ergebnis als JSON ausgeben")
+    parser.add_argument("--baseline", help="Früheres JSON-Ergebnis zum Vergleich")
+    parser.add_argument("--tolerance", type=float, default=0.2,
+                        help="Erlaubte Verschlechterung gegenüber der Baseline (0.2 = 20 %%)")
+    args = parser.parse_args()
+    if not args.routes:
+        args.routes = list(DEFAULT_ROUTES)
+
+    post_routes = set(args.post)
+    method_for = lambda route: "POST" if route.split("?")[0] in post_routes else "GET"
+
+    def snapshot():
+        return {"stats": fetch_json(args.host, args.port, args.timeout, STATS_ROUTE),
+                "heap": fetch_json(args.host, args.port, args.timeout, HEAP_ROUTE)}
+
+    before = snapshot()
+    start = time.monotonic()
+    deadline = start + args.duration
+    workers = [Worker(args.host, args.port, args.routes[i % len(args.routes):] + args.routes[:i % len(args.routes)],
+                      deadline, args.requests, args.timeout, method_for)
+               for i in range(args.concurrency)]
+    for w in workers:
+        w.start()
+    for w in workers:
+        w.join()
+    duration = time.monotonic() - start
+    after = snapshot()
+
+    report = build_report(args, merge(workers), duration, before, after, method_for)
+    if args.json:
+        json.dump(report, sys.stdout, indent=2)
+        print()
+    else:
+        print_report(report)
+
+    if args.baseline:
+        with open(args.baseline) as f:
+            baseline = json.load(f)
+        regressions = compare_baseline(report, baseline, args.tolerance)
+        if regressions:
+            print("\nREGRESSION gegenüber %s:" % args.baseline, file=sys.stderr)
+            for line in regressions:
+                print("  " + line, file=sys.stderr)
+            return 1
+        print("\nKeine Regression gegenüber %s." % args.baseline, file=sys.stderr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
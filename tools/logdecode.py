@@ -0,0 +1,178 @@
+#!/usr/bin/env python3
+# ================================================================================
+# | DATEI: tools/logdecode.py                                                    |
+# | AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+# | LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+# |------------------------------------------------------------------------------|
+# | ZWECK:                                                                       |
+# | Holt das Ereignis-Log des Geräts als Rohdaten (/api/logs?format=bin) und     |
+# | dekodiert es auf dem PC (siehe src/modules/System/EventLog.h). Namen und     |
+# | Texte der Ereignisse werden direkt aus EventLog.h gelesen.                   |
+# |                                                                              |
+# | BEISPIEL:                                                                    |
+# |   python tools/logdecode.py 192.168.4.1                (alles Vorhandene)    |
+# |   python tools/logdecode.py 192.168.4.1 --cursor 1200  (ab Eintrag 1200)     |
+# |   python tools/logdecode.py 192.168.4.1 --follow       (neue Einträge)       |
+# |   python tools/logdecode.py 192.168.4.1 --save log.bin                       |
+# |   python tools/logdecode.py --file log.bin                                   |
+# |                                                                              |
+# | Nur Python-Standardbibliothek.                                               |
+# ================================================================================
+
+import argparse
+import http.client
+import json
+import os
+import re
+import struct
+import sys
+import time
+
+EVENT_LOG_H = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "src", "modules", "System", "EventLog.h")
+LEVELS = "DIWE"
+RESET_REASONS = {1: "Power on", 2: "External pin", 3: "Software reset", 4: "Panic", 5: "Interrupt watchdog", 6: "Task watchdog",
+                 7: "Other watchdog", 8: "Deep sleep", 9: "Brownout", 10: "SDIO"}
+
+
+def load_events(path):
+    """Liest die X-Makro-Tabelle EVENT_LOG_EVENTS: Liste von (name, text)."""
+    with open(path, encoding="utf-8") as f:
+        source = f.read()
+    return [(m.group(2), m.group(3)) for m in re.finditer(r'X\((\w+),\s*"([^"]*)",\s*"([^"]*)"\)', source)]
+
+
+def varint(data, pos, end):
+    value, shift = 0, 0
+    while pos < end:
+        b = data[pos]
+        pos += 1
+        value |= (b & 0x7F) << shift
+        shift += 7
+        if not b & 0x80:
+            break
+    return value, pos
+
+
+def decode_records(data, first_seq, events):
+    """Zerlegt aneinandergereihte Datensätze in dicts."""
+    pos, seq = 0, first_seq
+    while pos < len(data):
+        length, head = data[pos], data[pos + 1]
+        end = pos + length
+        if length < 4 or end > len(data):
+            raise ValueError("Datensatz %d beschädigt" % seq)
+        event_id, p = varint(data, pos + 2, end)
+        ms, p = varint(data, p, end)
+        entry = {"seq": seq, "ms": ms, "level": LEVELS[head >> 6], "id": event_id}
+        if head & 0x20:
+            entry["text"] = data[p:end].decode("utf-8", "replace")
+            entry["args"] = []
+        else:
+            args = []
+            for _ in range(head & 0x0F):
+                v, p = varint(data, p, end)
+                args.append((v >> 1) ^ -(v & 1))
+            entry["args"] = args
+        name, text = events[event_id] if event_id < len(events) else ("?", " ".join(["%d"] * len(entry["args"])))
+        entry["event"] = name
+        entry["message"] = render(text, entry)
+        yield entry
+        pos, seq = end, seq + 1
+
+
+def render(text, entry):
+    args = list(entry["args"])
+    out = text.replace("%s", entry.get("text", ""))
+    out = re.sub(r"%d", lambda m: str(args.pop(0)) if args else "?", out)
+    if entry["event"] == "boot" and entry["args"]:
+        out += " (%s)" % RESET_REASONS.get(entry["args"][0], "?")
+    return out
+
+
+def parse_page(body):
+    if len(body) < 12 or body[:4] != b"EVL1":
+        raise ValueError("Keine EVL1-Daten")
+    first_seq, next_cursor = struct.unpack_from("<II", body, 4)
+    return first_seq, next_cursor, body[12:]
+
+
+def fetch(conn, cursor, limit):
+    conn.request("GET", "/api/logs?format=bin&limit=%d&cursor=%d" % (limit, cursor))
+    resp = conn.getresponse()
+    body = resp.read()
+    if resp.status != 200:
+        raise RuntimeError("HTTP %d" % resp.status)
+    return parse_page(body)
+
+
+def print_entry(entry, as_json):
+    if as_json:
+        print(json.dumps(entry, ensure_ascii=False))
+        return
+    if entry["event"] == "boot":
+        print("-" * 60)
+    print("%7d %9.3f s %s %-16s %s" % (entry["seq"], entry["ms"] / 1000.0, entry["level"], entry["event"], entry["message"]))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Ereignis-Log des Geräts holen und dekodieren.")
+    parser.add_argument("host", nargs="?", help="IP-Adresse oder Hostname des Geräts")
+    parser.add_argument("-p", "--port", type=int, default=80)
+    parser.add_argument("--cursor", type=int, default=0, help="Ab dieser Eintragsnummer (Standard: ältester)")
+    parser.add_argument("--limit", type=int, default=200, help="Einträge pro Anfrage")
+    parser.add_argument("--follow", action="store_true", help="Weiter auf neue Einträge warten")
+    parser.add_argument("--interval", type=float, default=2.0)
+    parser.add_argument("--save", help="Rohdaten zusätzlich in diese Datei schreiben")
+    parser.add_argument("--file", help="Gespeicherte Rohdaten dekodieren statt abzurufen")
+    parser.add_argument("--json", action="store_true", help="Eine JSON-Zeile pro Eintrag")
+    parser.add_argument("--header", default=EVENT_LOG_H, help="Pfad zu EventLog.h (Ereignis-Tabelle)")
+    args = parser.parse_args()
+
+    try:
+        events = load_events(args.header)
+        if args.file:
+            with open(args.file, "rb") as f:
+                data = f.read()
+            # Datei = aneinandergehängte EVL1-Seiten, wie mit --save geschrieben
+            pos = 0
+            while pos < len(data):
+                length = struct.unpack_from("<I", data, pos)[0]
+                first_seq, _, records = parse_page(data[pos + 4:pos + 4 + length])
+                for entry in decode_records(records, first_seq, events):
+                    print_entry(entry, args.json)
+                pos += 4 + length
+            return 0
+        if not args.host:
+            parser.error("host oder --file angeben")
+
+        save = open(args.save, "wb") if args.save else None
+        conn = http.client.HTTPConnection(args.host, args.port, timeout=10)
+        cursor = args.cursor
+        while True:
+            first_seq, next_cursor, records = fetch(conn, cursor, args.limit)
+            if records and first_seq > cursor:
+                print("... %d Einträge nicht mehr vorhanden (verdrängt) ..." % (first_seq - cursor), file=sys.stderr)
+            if save and records:
+                page = b"EVL1" + struct.pack("<II", first_seq, next_cursor) + records
+                save.write(struct.pack("<I", len(page)) + page)
+            for entry in decode_records(records, first_seq, events):
+                print_entry(entry, args.json)
+            cursor = next_cursor
+            if not records:
+                if not args.follow:
+                    break
+                sys.stdout.flush()
+                time.sleep(args.interval)
+        conn.close()
+        if save:
+            save.close()
+        return 0
+    except KeyboardInterrupt:
+        return 0
+    except (OSError, ValueError, RuntimeError, http.client.HTTPException) as e:
+        print("Fehler: %s" % e, file=sys.stderr)
+        return 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
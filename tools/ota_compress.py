@@ -0,0 +1,148 @@
+#!/usr/bin/env python3
+# ================================================================================
+# | DATEI: tools/ota_compress.py                                                 |
+# | AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+# | LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+# |------------------------------------------------------------------------------|
+# | ZWECK:                                                                       |
+# | Packt OTA-Images (Firmware, spiffs.bin, Delta-Patch) als gzip für den        |
+# | Upload. Anders als "gzip -9" wird ein kleines Deflate-Fenster benutzt und    |
+# | im Extra-Feld des Headers vermerkt ("WB" = Window Bits, siehe                |
+# | GzipInflater.h). Das Gerät braucht zum Entpacken dann nur einen Ringpuffer   |
+# | in Fenstergröße statt 32 KB.                                                 |
+# |                                                                              |
+# | BEISPIEL:                                                                    |
+# |   python tools/ota_compress.py .pio/build/esp32dev/firmware.bin              |
+# |   python tools/ota_compress.py spiffs.bin -w 13 -o spiffs.bin.gz             |
+# |   python tools/ota_compress.py firmware.bin --upload 192.168.4.1             |
+# |                                                                              |
+# | Nur Python-Standardbibliothek.                                               |
+# ================================================================================
+
+import argparse
+import gzip
+import hashlib
+import http.client
+import os
+import struct
+import sys
+import time
+import zlib
+
+MIN_WINDOW_BITS = 9
+MAX_WINDOW_BITS = 15
+DEFAULT_WINDOW_BITS = 12   # 4 KB Ringpuffer auf dem Gerät
+
+ROUTES = {"firmware": "/update", "spiffs": "/update_spiffs", "delta": "/update_delta"}
+
+
+def compress(data, window_bits=DEFAULT_WINDOW_BITS, name=None):
+    """gzip-Stream mit Extra-Feld "WB" (Subfeld-Länge 1, Wert = Fensterbits)."""
+    flags = 0x04  # FEXTRA
+    header = bytearray(b"\x1f\x8b\x08")
+    name_field = b""
+    if name:
+        flags |= 0x08  # FNAME
+        name_field = name.encode("latin-1", "replace") + b"\x00"
+    header.append(flags)
+    header += struct.pack("<IBB", 0, 2, 255)   # MTIME 0 (reproduzierbar), XFL, OS unbekannt
+    extra = b"WB" + struct.pack("<HB", 1, window_bits)
+    header += struct.pack("<H", len(extra)) + extra + name_field
+
+    # Negative wbits = Raw-Deflate ohne zlib-Header
+    comp = zlib.compressobj(9, zlib.DEFLATED, -window_bits, 9)
+    body = comp.compress(data) + comp.flush()
+    trailer = struct.pack("<II", zlib.crc32(data) & 0xFFFFFFFF, len(data) & 0xFFFFFFFF)
+    return bytes(header) + body + trailer
+
+
+def window_bits_of(packed):
+    """Liest das "WB"-Subfeld (oder None, wenn keins vorhanden ist)."""
+    if len(packed) < 12 or packed[:2] != b"\x1f\x8b" or not packed[3] & 0x04:
+        return None
+    xlen = struct.unpack_from("<H", packed, 10)[0]
+    extra = packed[12:12 + xlen]
+    pos = 0
+    while pos + 4 <= len(extra):
+        sub_id, sub_len = extra[pos:pos + 2], struct.unpack_from("<H", extra, pos + 2)[0]
+        if sub_id == b"WB" and sub_len == 1:
+            return extra[pos + 4]
+        pos += 4 + sub_len
+    return None
+
+
+def guess_kind(path):
+    base = os.path.basename(path).lower()
+    if base.endswith(".bbdp"):
+        return "delta"
+    if "spiffs" in base or "littlefs" in base:
+        return "spiffs"
+    return "firmware"
+
+
+def upload(host, port, route, filename, payload, sha256=None):
+    """
+    Sendet die Datei als multipart/form-data. Mit sha256 (Hash des entpackten Images)
+    prüft das Gerät das Ergebnis vor dem Aktivieren.
+    """
+    boundary = "----ota%d" % int(time.time() * 1000)
+    head = ("--%s\r\nContent-Disposition: form-data; name=\"file\"; filename=\"%s\"\r\n"
+            "Content-Type: application/gzip\r\n\r\n" % (boundary, filename)).encode("utf-8")
+    tail = ("\r\n--%s--\r\n" % boundary).encode("ascii")
+    conn = http.client.HTTPConnection(host, port, timeout=180)
+    start = time.monotonic()
+    headers = {"Content-Type": "multipart/form-data; boundary=" + boundary}
+    if sha256:
+        headers["X-Image-SHA256"] = sha256
+    conn.request("POST", route, body=head + payload + tail, headers=headers)
+    resp = conn.getresponse()
+    print("HTTP %d nach %.1f s: %s" % (resp.status, time.monotonic() - start,
+                                      resp.read().decode("utf-8", "replace")))
+    return 0 if resp.status == 200 else 1
+
+
+def main():
+    parser = argparse.ArgumentParser(description="OTA-Images für den Upload mit gzip packen.")
+    parser.add_argument("input", help="Firmware, spiffs.bin oder .bbdp-Patch")
+    parser.add_argument("-o", "--output", help="Zieldatei (Standard: <input>.gz)")
+    parser.add_argument("-w", "--window-bits", type=int, default=DEFAULT_WINDOW_BITS,
+                        help="Deflate-Fenster 2^N Bytes, %d..%d (Standard %d = 4 KB)" %
+                             (MIN_WINDOW_BITS, MAX_WINDOW_BITS, DEFAULT_WINDOW_BITS))
+    parser.add_argument("--upload", metavar="HOST", help="Gepackte Datei direkt an das Gerät senden")
+    parser.add_argument("-p", "--port", type=int, default=80)
+    parser.add_argument("--kind", choices=sorted(ROUTES), help="Ziel-Route (Standard: nach Dateiname)")
+    args = parser.parse_args()
+
+    if not MIN_WINDOW_BITS <= args.window_bits <= MAX_WINDOW_BITS:
+        parser.error("--window-bits muss zwischen %d und %d liegen" % (MIN_WINDOW_BITS, MAX_WINDOW_BITS))
+
+    try:
+        with open(args.input, "rb") as f:
+            data = f.read()
+        name = os.path.basename(args.input)
+        start = time.monotonic()
+        packed = compress(data, args.window_bits, name)
+        # Selbsttest: muss sich mit einem normalen gzip-Decoder wieder entpacken lassen
+        if gzip.decompress(packed) != data or window_bits_of(packed) != args.window_bits:
+            raise ValueError("Selbsttest fehlgeschlagen")
+
+        output = args.output or args.input + ".gz"
+        with open(output, "wb") as f:
+            f.write(packed)
+        print("%s: %d -> %d Bytes (%.1f %% gespart), Fenster %d Bytes, %.1f s" %
+              (output, len(data), len(packed), 100.0 - 100.0 * len(packed) / max(1, len(data)),
+               1 << args.window_bits, time.monotonic() - start))
+
+        if args.upload:
+            kind = args.kind or guess_kind(args.input)
+            # Delta-Patches enthalten ihren Ziel-Hash bereits selbst
+            sha256 = hashlib.sha256(data).hexdigest() if kind != "delta" else None
+            return upload(args.upload, args.port, ROUTES[kind], os.path.basename(output), packed, sha256)
+        return 0
+    except (OSError, ValueError, http.client.HTTPException) as e:
+        print("Fehler: %s" % e, file=sys.stderr)
+        return 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
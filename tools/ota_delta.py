@@ -0,0 +1,319 @@
+#!/usr/bin/env python3
+# ================================================================================
+# | DATEI: tools/ota_delta.py                                                    |
+# | AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+# | LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+# |------------------------------------------------------------------------------|
+# | ZWECK:                                                                       |
+# | Erzeugt Delta-Patches für das OTA-Update (/update_delta, siehe               |
+# | DeltaPatcher.h für das Format). Der Patch enthält nur die Unterschiede       |
+# | zwischen der Firmware, die auf dem Gerät läuft, und der neuen Firmware.      |
+# |                                                                              |
+# | BEISPIEL:                                                                    |
+# |   python tools/ota_delta.py create alt.bin neu.bin -o update.bbdp            |
+# |   python tools/ota_delta.py apply alt.bin update.bbdp -o test.bin            |
+# |   python tools/ota_delta.py info update.bbdp                                 |
+# |   python tools/ota_delta.py upload 192.168.4.1 update.bbdp                   |
+# |                                                                              |
+# | "alt.bin" muss exakt das Image sein, das gerade läuft (z.B. aus              |
+# | .pio/build/esp32dev/firmware.bin des letzten Uploads aufheben).              |
+# | Nur Python-Standardbibliothek.                                               |
+# ================================================================================
+
+import argparse
+import hashlib
+import http.client
+import struct
+import sys
+import time
+
+MAGIC = b"BBDP"
+VERSION = 1
+HEADER = struct.Struct("<4sBBHII32s32s")   # 80 Bytes
+
+OP_END = 0x00
+OP_ADD = 0x01
+OP_COPY = 0x02
+
+BLOCK = 16          # Länge der Suchblöcke
+INDEX_STEP = 4      # Jeder 4. Offset des alten Images wird indiziert
+MAX_CANDIDATES = 8  # Kandidaten pro Block (häufige Muster wie 0xFF-Füllung)
+MIN_MATCH = 24      # Kürzere Treffer lohnen keinen COPY-Befehl
+MIN_GAP = 3         # Kürzere unveränderte Stücke werden in die Korrektur übernommen
+
+
+def varint(value):
+    out = bytearray()
+    while True:
+        byte = value & 0x7F
+        value >>= 7
+        if value:
+            out.append(byte | 0x80)
+        else:
+            out.append(byte)
+            return bytes(out)
+
+
+def read_varint(data, pos):
+    value, shift = 0, 0
+    while True:
+        byte = data[pos]
+        pos += 1
+        value |= (byte & 0x7F) << shift
+        shift += 7
+        if not byte & 0x80:
+            return value, pos
+
+
+def build_index(old):
+    index = {}
+    for j in range(0, len(old) - BLOCK + 1, INDEX_STEP):
+        positions = index.setdefault(old[j:j + BLOCK], [])
+        if len(positions) < MAX_CANDIDATES:
+            positions.append(j)
+    return index
+
+
+def exact_length(old, new, j, i):
+    """Länge der exakten Übereinstimmung ab old[j] / new[i] (blockweise, dann byteweise)."""
+    n = 0
+    limit = min(len(old) - j, len(new) - i)
+    step = 256
+    while n + step <= limit and old[j + n:j + n + step] == new[i + n:i + n + step]:
+        n += step
+    while n < limit and old[j + n] == new[i + n]:
+        n += 1
+    return n
+
+
+def approximate_length(old, new, j, i):
+    """
+    Verlängert einen Treffer über einzelne abweichende Bytes hinweg (wie bsdiff):
+    Es zählt, wo "2 * Treffer - Länge" maximal ist. Typisch für verschobenen Code,
+    bei dem sich nur Adressen geändert haben.
+    """
+    best_len, score, best_score = 0, 0, 0
+    limit = min(len(old) - j, len(new) - i)
+    k = 0
+    while k < limit:
+        if old[j + k] == new[i + k]:
+            score += 1
+            if score > best_score:
+                best_score, best_len = score, k + 1
+        else:
+            score -= 1
+            if best_score - score > 32:
+                break
+        k += 1
+    return best_len
+
+
+def encode_copy(old, new, j, i, length):
+    """COPY mit Korrekturen: abwechselnd gap (unverändert) und n + neue Bytes."""
+    out = bytearray([OP_COPY])
+    out += varint(j)
+    out += varint(length)
+    pos = 0
+    while True:
+        gap = 0
+        while pos + gap < length and old[j + pos + gap] == new[i + pos + gap]:
+            gap += 1
+        out += varint(gap)
+        pos += gap
+        if pos == length:
+            return bytes(out)
+        # Abweichende Bytes sammeln; kurze gleiche Stücke dazwischen mitnehmen
+        end = pos
+        while end < length:
+            if old[j + end] != new[i + end]:
+                end += 1
+                continue
+            run = 0
+            while end + run < length and old[j + end + run] == new[i + end + run] and run < MIN_GAP:
+                run += 1
+            if run >= MIN_GAP or end + run == length:
+                break
+            end += run
+        out += varint(end - pos)
+        out += new[i + pos:i + end]
+        pos = end
+        if pos == length:
+            return bytes(out)
+
+
+def create_patch(old, new):
+    index = build_index(old)
+    ops = bytearray()
+    literal_start = 0
+    i = 0
+    stats = {"copy_ops": 0, "copy_bytes": 0, "fix_bytes": 0, "add_ops": 0, "add_bytes": 0}
+
+    def flush_literal(end):
+        if end > literal_start:
+            ops.extend(bytes([OP_ADD]) + varint(end - literal_start) + new[literal_start:end])
+            stats["add_ops"] += 1
+            stats["add_bytes"] += end - literal_start
+
+    while i + BLOCK <= len(new):
+        best_j, best_len = -1, 0
+        for j in index.get(new[i:i + BLOCK], ()):
+            n = exact_length(old, new, j, i)
+            if n > best_len:
+                best_j, best_len = j, n
+        if best_len < MIN_MATCH:
+            i += 1
+            continue
+
+        # Rückwärts in die noch offenen neuen Bytes verlängern
+        j = best_j
+        while i > literal_start and j > 0 and old[j - 1] == new[i - 1]:
+            i -= 1
+            j -= 1
+            best_len += 1
+        length = best_len + approximate_length(old, new, j + best_len, i + best_len)
+
+        flush_literal(i)
+        copy = encode_copy(old, new, j, i, length)
+        ops.extend(copy)
+        stats["copy_ops"] += 1
+        stats["copy_bytes"] += length
+        stats["fix_bytes"] += len(copy) - 1 - len(varint(j)) - len(varint(length))
+        i += length
+        literal_start = i
+
+    flush_literal(len(new))
+    ops.append(OP_END)
+
+    header = HEADER.pack(MAGIC, VERSION, 0, 0, len(old), len(new),
+                         hashlib.sha256(old).digest(), hashlib.sha256(new).digest())
+    return header + bytes(ops), stats
+
+
+def apply_patch(old, patch):
+    """Referenz-Implementierung des DeltaPatcher (zum Prüfen eines Patches auf dem Host)."""
+    magic, version, flags, _, old_size, new_size, old_sha, new_sha = HEADER.unpack_from(patch)
+    if magic != MAGIC or version != VERSION or flags != 0:
+        raise ValueError("Kein unterstützter Delta-Patch")
+    if len(old) < old_size or hashlib.sha256(old[:old_size]).digest() != old_sha:
+        raise ValueError("Patch passt nicht zur angegebenen Basis")
+    out = bytearray()
+    pos = HEADER.size
+    while True:
+        op = patch[pos]
+        pos += 1
+        if op == OP_END:
+            break
+        if op == OP_ADD:
+            n, pos = read_varint(patch, pos)
+            out += patch[pos:pos + n]
+            pos += n
+        elif op == OP_COPY:
+            offset, pos = read_varint(patch, pos)
+            left, pos = read_varint(patch, pos)
+            while True:
+                gap, pos = read_varint(patch, pos)
+                out += old[offset:offset + gap]
+                offset += gap
+                left -= gap
+                if left == 0:
+                    break
+                n, pos = read_varint(patch, pos)
+                out += patch[pos:pos + n]
+                pos += n
+                offset += n
+                left -= n
+                if left == 0:
+                    break
+        else:
+            raise ValueError("Unbekannte Operation 0x%02X" % op)
+    if pos != len(patch):
+        raise ValueError("Daten nach dem Ende des Patches")
+    if len(out) != new_size or hashlib.sha256(out).digest() != new_sha:
+        raise ValueError("Ergebnis stimmt nicht mit dem Ziel-Hash überein")
+    return bytes(out)
+
+
+def read_file(path):
+    with open(path, "rb") as f:
+        return f.read()
+
+
+def cmd_create(args):
+    old, new = read_file(args.old), read_file(args.new)
+    start = time.monotonic()
+    patch, stats = create_patch(old, new)
+    apply_patch(old, patch)  # Selbsttest: der Patch muss exakt das neue Image ergeben
+    with open(args.output, "wb") as f:
+        f.write(patch)
+    print("Patch: %d Bytes (%.1f %% von %d Bytes), %.1f s" %
+          (len(patch), 100.0 * len(patch) / max(1, len(new)), len(new), time.monotonic() - start))
+    print("  COPY: %d Ops, %d Bytes (davon %d Korrektur-Bytes)" %
+          (stats["copy_ops"], stats["copy_bytes"], stats["fix_bytes"]))
+    print("  ADD:  %d Ops, %d Bytes" % (stats["add_ops"], stats["add_bytes"]))
+    return 0
+
+
+def cmd_apply(args):
+    result = apply_patch(read_file(args.old), read_file(args.patch))
+    with open(args.output, "wb") as f:
+        f.write(result)
+    print("OK: %d Bytes, SHA-256 %s" % (len(result), hashlib.sha256(result).hexdigest()))
+    return 0
+
+
+def cmd_info(args):
+    patch = read_file(args.patch)
+    magic, version, flags, _, old_size, new_size, old_sha, new_sha = HEADER.unpack_from(patch)
+    print("Format:  %s v%d (Flags 0x%02X)" % (magic.decode("ascii", "replace"), version, flags))
+    print("Basis:   %d Bytes, SHA-256 %s" % (old_size, old_sha.hex()))
+    print("Ziel:    %d Bytes, SHA-256 %s" % (new_size, new_sha.hex()))
+    print("Patch:   %d Bytes" % len(patch))
+    return 0
+
+
+def cmd_upload(args):
+    patch = read_file(args.patch)
+    conn = http.client.HTTPConnection(args.host, args.port, timeout=120)
+    conn.request("POST", "/update_delta", body=patch, headers={"Content-Type": "application/octet-stream"})
+    resp = conn.getresponse()
+    print("HTTP %d: %s" % (resp.status, resp.read().decode("utf-8", "replace")))
+    return 0 if resp.status == 200 else 1
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Delta-Patches für das OTA-Update erzeugen und prüfen.")
+    sub = parser.add_subparsers(dest="command")
+    sub.required = True
+
+    p = sub.add_parser("create", help="Patch zwischen zwei Firmware-Images erzeugen")
+    p.add_argument("old", help="Image, das auf dem Gerät läuft")
+    p.add_argument("new", help="Neues Image")
+    p.add_argument("-o", "--output", required=True)
+    p.set_defaults(func=cmd_create)
+
+    p = sub.add_parser("apply", help="Patch auf dem Host anwenden (Test)")
+    p.add_argument("old")
+    p.add_argument("patch")
+    p.add_argument("-o", "--output", required=True)
+    p.set_defaults(func=cmd_apply)
+
+    p = sub.add_parser("info", help="Header eines Patches anzeigen")
+    p.add_argument("patch")
+    p.set_defaults(func=cmd_info)
+
+    p = sub.add_parser("upload", help="Patch an /update_delta senden")
+    p.add_argument("host")
+    p.add_argument("patch")
+    p.add_argument("-p", "--port", type=int, default=80)
+    p.set_defaults(func=cmd_upload)
+
+    args = parser.parse_args()
+    try:
+        return args.func(args)
+    except (OSError, ValueError, http.client.HTTPException) as e:
+        print("Fehler: %s" % e, file=sys.stderr)
+        return 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
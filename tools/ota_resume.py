@@ -0,0 +1,108 @@
+#!/usr/bin/env python3
+# ================================================================================
+# | DATEI: tools/ota_resume.py                                                   |
+# | AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+# | LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+# |------------------------------------------------------------------------------|
+# | ZWECK:                                                                       |
+# | Fortsetzbares OTA-Update über /update_resume (siehe ResumableUpdate.h).      |
+# | Fragt den Stand der Sitzung ab (/api/ota/session) und sendet nur die Bytes   |
+# | ab dem übernommenen Offset. Bricht die Verbindung ab, wird nach einer Pause  |
+# | automatisch weitergemacht.                                                   |
+# |                                                                              |
+# | BEISPIEL:                                                                    |
+# |   python tools/ota_resume.py 192.168.4.1 .pio/build/esp32dev/firmware.bin    |
+# |   python tools/ota_resume.py 192.168.4.1 spiffs.bin --target spiffs          |
+# |                                                                              |
+# | Nur Python-Standardbibliothek.                                               |
+# ================================================================================
+
+import argparse
+import hashlib
+import http.client
+import json
+import sys
+import time
+import urllib.parse
+
+CHUNK = 4096
+
+
+def session(host, port, timeout):
+    conn = http.client.HTTPConnection(host, port, timeout=timeout)
+    conn.request("GET", "/api/ota/session")
+    resp = conn.getresponse()
+    data = json.loads(resp.read().decode("utf-8"))
+    conn.close()
+    return data
+
+
+def send(host, port, timeout, image, offset, target, sha):
+    """Sendet image[offset:] und liefert die JSON-Antwort des Geräts."""
+    query = urllib.parse.urlencode({"offset": offset, "total": len(image), "target": target, "sha256": sha})
+    conn = http.client.HTTPConnection(host, port, timeout=timeout)
+    conn.putrequest("POST", "/update_resume?" + query)
+    conn.putheader("Content-Type", "application/octet-stream")
+    conn.putheader("Content-Length", str(len(image) - offset))
+    conn.endheaders()
+    pos = offset
+    while pos < len(image):
+        conn.send(image[pos:pos + CHUNK])
+        pos += CHUNK
+        print("\r  %7d / %d Bytes (%3d %%)" % (min(pos, len(image)), len(image), min(pos, len(image)) * 100 // len(image)),
+              end="", flush=True)
+    print()
+    resp = conn.getresponse()
+    text = resp.read().decode("utf-8", "replace")
+    conn.close()
+    try:
+        return json.loads(text)
+    except ValueError:
+        return {"ok": False, "error": text}
+
+
+def main():
+    parser = argparse.ArgumentParser(description="OTA-Update mit Fortsetzung nach Verbindungsabbruch.")
+    parser.add_argument("host", help="IP-Adresse oder Hostname des Geräts")
+    parser.add_argument("image", help="firmware.bin oder spiffs.bin (unkomprimiert)")
+    parser.add_argument("-p", "--port", type=int, default=80)
+    parser.add_argument("--target", choices=("firmware", "spiffs"), default="firmware")
+    parser.add_argument("--retries", type=int, default=20, help="Versuche nach Abbrüchen")
+    parser.add_argument("--pause", type=float, default=3.0, help="Wartezeit vor einem neuen Versuch (s)")
+    parser.add_argument("--restart", action="store_true", help="Offene Sitzung verwerfen und bei 0 beginnen")
+    parser.add_argument("--timeout", type=float, default=30.0)
+    args = parser.parse_args()
+
+    with open(args.image, "rb") as f:
+        image = f.read()
+    sha = hashlib.sha256(image).hexdigest()
+    print("%s: %d Bytes, SHA-256 %s" % (args.image, len(image), sha))
+
+    for attempt in range(args.retries + 1):
+        try:
+            state = session(args.host, args.port, args.timeout)
+            offset = 0
+            if (not args.restart and state.get("active") and state.get("sha256") == sha
+                    and state.get("total") == len(image) and state.get("target") == args.target):
+                offset = state["committed"]
+                print("Setze fort ab Byte %d" % offset)
+            args.restart = False
+
+            result = send(args.host, args.port, args.timeout, image, offset, args.target, sha)
+            if result.get("complete"):
+                print("Update abgeschlossen, Gerät startet neu.")
+                return 0
+            if not result.get("ok"):
+                print("Gerät meldet: %s" % result.get("error"), file=sys.stderr)
+                if result.get("committed", 0) == 0 and offset == 0:
+                    return 1   # Fehler schon beim Start (z.B. Image zu groß): Wiederholen hilft nicht
+        except (OSError, ValueError, http.client.HTTPException) as e:
+            print("\nVerbindung unterbrochen: %s" % e, file=sys.stderr)
+        if attempt < args.retries:
+            time.sleep(args.pause)
+    print("Aufgegeben nach %d Versuchen." % (args.retries + 1), file=sys.stderr)
+    return 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,223 @@
+#!/usr/bin/env python3
+# ================================================================================
+# | DATEI: tools/profile_symbolize.py                                            |
+# | AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+# | LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+# |------------------------------------------------------------------------------|
+# | ZWECK:                                                                       |
+# | Holt ein Profil des Sampling-Profilers (/api/system/profiler/data, siehe     |
+# | src/modules/System/SamplingProfiler.h) und löst die Adressen mit addr2line   |
+# | gegen die firmware.elf auf. Ausgabe: flache Liste (eigene und inklusive      |
+# | Samples je Funktion) und optional "collapsed stacks" (eine Zeile je Stack,   |
+# | Task als unterste Ebene) für flamegraph.pl oder speedscope.                  |
+# |                                                                              |
+# | BEISPIEL:                                                                    |
+# |   python tools/profile_symbolize.py 192.168.4.1 --start --seconds 10         |
+# |   python tools/profile_symbolize.py 192.168.4.1 --collapsed stacks.txt       |
+# |   python tools/profile_symbolize.py --file profile.bin --by-task             |
+# |   flamegraph.pl stacks.txt > profile.svg                                     |
+# |                                                                              |
+# | Benötigt addr2line aus der Xtensa-Toolchain (PlatformIO bringt sie mit).     |
+# | Sonst nur Python-Standardbibliothek.                                         |
+# ================================================================================
+
+import argparse
+import collections
+import glob
+import hashlib
+import http.client
+import json
+import os
+import shutil
+import struct
+import subprocess
+import sys
+import time
+import urllib.parse
+
+HEADER = struct.Struct("<4sBBHHHIIII16s")
+TASK_NAME = 16
+NO_TASK = 0xFF
+DEFAULT_ELF = os.path.join(".pio", "build", "esp32dev", "firmware.elf")
+
+
+def request(host, port, method, path, params=None, timeout=30):
+    conn = http.client.HTTPConnection(host, port, timeout=timeout)
+    body = urllib.parse.urlencode(params) if params else None
+    headers = {"Content-Type": "application/x-www-form-urlencoded"} if body else {}
+    conn.request(method, path, body=body, headers=headers)
+    resp = conn.getresponse()
+    data = resp.read()
+    conn.close()
+    if resp.status != 200:
+        sys.exit(f"{method} {path}: HTTP {resp.status} {data.decode('utf-8', 'replace')}")
+    return data
+
+
+def parse_profile(data):
+    """Zerlegt die Binärdatei: (Kopf als dict, Tasknamen, Liste von (Kern, Task, [Adressen]))."""
+    if len(data) < HEADER.size or data[:4] != b"PRF1":
+        sys.exit("Keine Profil-Datei (Kennung PRF1 fehlt).")
+    magic, depth, _, tick_hz, divider, task_count, samples, dropped, duration_ms, data_bytes, sha = HEADER.unpack_from(data)
+    head = {"depth": depth, "tick_hz": tick_hz, "divider": divider, "samples": samples, "dropped": dropped,
+            "duration_ms": duration_ms, "elf_sha256": sha.rstrip(b"\0").decode("ascii", "replace")}
+    pos = HEADER.size
+    tasks = []
+    for _ in range(task_count):
+        tasks.append(data[pos:pos + TASK_NAME].split(b"\0")[0].decode("utf-8", "replace"))
+        pos += TASK_NAME
+    end = min(len(data), pos + data_bytes)
+    records = []
+    while pos + 2 <= end:
+        core, count = data[pos] >> 7, data[pos] & 0x7F
+        task = data[pos + 1]
+        pos += 2
+        if pos + 4 * count > end:
+            break
+        pcs = list(struct.unpack_from(f"<{count}I", data, pos))
+        pos += 4 * count
+        name = tasks[task] if task != NO_TASK and task < len(tasks) else "?"
+        records.append((core, name, pcs))
+    return head, tasks, records
+
+
+def find_addr2line(explicit):
+    if explicit:
+        return explicit
+    tool = shutil.which("xtensa-esp32-elf-addr2line")
+    if tool:
+        return tool
+    pattern = os.path.join(os.path.expanduser("~"), ".platformio", "packages", "toolchain-xtensa*", "bin",
+                           "xtensa-esp32-elf-addr2line*")
+    found = sorted(glob.glob(pattern))
+    if found:
+        return found[0]
+    sys.exit("xtensa-esp32-elf-addr2line nicht gefunden (--addr2line angeben).")
+
+
+def symbolize(addr2line, elf, addresses):
+    """Liefert je Adresse die Funktionskette (äußerste zuerst, mit eingebetteten Inline-Funktionen)."""
+    lookup = sorted(addresses)
+    if not lookup:
+        return {}
+    out = subprocess.run([addr2line, "-e", elf, "-a", "-f", "-C", "-i"],
+                         input="\n".join(f"0x{a:08x}" for a in lookup) + "\n",
+                         capture_output=True, text=True, check=True).stdout.splitlines()
+    # Je Adresse: Zeile mit der Adresse (-a), dann Paare aus Funktion und Datei:Zeile.
+    # Der Beginn des nächsten Blocks ist die nächste angefragte Adresse.
+    result, index = {}, -1
+    for line in out:
+        line = line.strip()
+        if index + 1 < len(lookup) and line.startswith("0x") and int(line, 16) == lookup[index + 1]:
+            index += 1
+            result[lookup[index]] = []
+            pairs = 0
+        elif index >= 0:
+            if pairs % 2 == 0:
+                result[lookup[index]].append(line)
+            pairs += 1
+    # addr2line -i liefert die innerste Inline-Funktion zuerst
+    return {a: [n if n != "??" else f"0x{a:08x}" for n in reversed(names)] for a, names in result.items()}
+
+
+def build_stacks(records, symbols, by_core):
+    """Zählt identische Stacks: Schlüssel (Task, äußerster ... innerster Funktionsname)."""
+    stacks = collections.Counter()
+    for core, task, pcs in records:
+        frames = []
+        for pc in pcs:
+            frames.extend(reversed(symbols.get(pc, [f"0x{pc:08x}"])))
+        frames.reverse()
+        root = f"{task} (core {core})" if by_core else task
+        stacks[tuple([root] + frames)] += 1
+    return stacks
+
+
+def print_flat(stacks, total, top, by_task):
+    self_count = collections.Counter()
+    incl_count = collections.Counter()
+    for stack, count in stacks.items():
+        task, frames = stack[0], stack[1:]
+        prefix = f"{task}: " if by_task else ""
+        if frames:
+            self_count[prefix + frames[-1]] += count
+        for name in set(frames):
+            incl_count[prefix + name] += count
+    print(f"{'eigen':>7} {'%':>6} {'inkl.':>7} {'%':>6}  Funktion")
+    for name, count in self_count.most_common(top):
+        print(f"{count:7d} {100.0 * count / total:6.2f} {incl_count[name]:7d} {100.0 * incl_count[name] / total:6.2f}  {name}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Sampling-Profil des ESP32 symbolisieren")
+    parser.add_argument("host", nargs="?", help="IP-Adresse oder Hostname des Geräts")
+    parser.add_argument("--port", type=int, default=80)
+    parser.add_argument("--file", help="gespeichertes Profil statt Gerät")
+    parser.add_argument("--save", help="Rohdaten zusätzlich speichern")
+    parser.add_argument("--start", action="store_true", help="Profiler starten, warten, dann abholen")
+    parser.add_argument("--seconds", type=float, default=10, help="Messdauer mit --start")
+    parser.add_argument("--kb", type=int, help="Puffergröße (Standard am Gerät 32)")
+    parser.add_argument("--divider", type=int, help="nur jeden n-ten Tick (Standard am Gerät 4)")
+    parser.add_argument("--depth", type=int, help="Adressen je Sample (Standard am Gerät 8)")
+    parser.add_argument("--elf", default=DEFAULT_ELF)
+    parser.add_argument("--addr2line", help="Pfad zu xtensa-esp32-elf-addr2line")
+    parser.add_argument("--collapsed", help="collapsed stacks in diese Datei schreiben ('-' = stdout)")
+    parser.add_argument("--top", type=int, default=30, help="Zeilen der flachen Liste")
+    parser.add_argument("--by-task", action="store_true", help="flache Liste je Task getrennt")
+    parser.add_argument("--by-core", action="store_true", help="Kern in den collapsed stacks angeben")
+    args = parser.parse_args()
+
+    if args.file:
+        with open(args.file, "rb") as f:
+            data = f.read()
+    elif args.host:
+        if args.start:
+            params = {"action": "start"}
+            for name in ("kb", "divider", "depth"):
+                if getattr(args, name):
+                    params[name] = getattr(args, name)
+            status = json.loads(request(args.host, args.port, "POST", "/api/system/profiler", params))
+            print(f"Profiler läuft: {status['rate_hz']} Hz je Kern, {status['buffer_bytes']} Bytes Puffer", file=sys.stderr)
+            time.sleep(args.seconds)
+        data = request(args.host, args.port, "GET", "/api/system/profiler/data")
+    else:
+        parser.error("host oder --file angeben")
+    if args.save:
+        with open(args.save, "wb") as f:
+            f.write(data)
+
+    head, tasks, records = parse_profile(data)
+    print(f"{head['samples']} Samples in {head['duration_ms'] / 1000:.1f} s, "
+          f"{head['tick_hz'] // max(head['divider'], 1)} Hz je Kern, {len(tasks)} Tasks"
+          + (f", {head['dropped']} verworfen (Puffer voll)" if head["dropped"] else ""), file=sys.stderr)
+    if not records:
+        sys.exit("Das Profil ist leer.")
+
+    if not os.path.exists(args.elf):
+        sys.exit(f"{args.elf} nicht gefunden (--elf angeben).")
+    with open(args.elf, "rb") as f:
+        elf_sha = hashlib.sha256(f.read()).hexdigest()
+    if head["elf_sha256"] and not elf_sha.startswith(head["elf_sha256"]):
+        print(f"WARNUNG: {args.elf} passt nicht zur Firmware auf dem Gerät "
+              f"(ELF-SHA-256 {elf_sha[:16]} statt {head['elf_sha256']}).", file=sys.stderr)
+
+    # Das Gerät liefert schon die Adressen der call-Befehle, nicht die Rücksprungadressen
+    addresses = set()
+    for _, _, pcs in records:
+        addresses.update(pcs)
+    symbols = symbolize(find_addr2line(args.addr2line), args.elf, addresses)
+    stacks = build_stacks(records, symbols, args.by_core)
+
+    print_flat(stacks, len(records), args.top, args.by_task)
+    if args.collapsed:
+        lines = [";".join(stack) + f" {count}" for stack, count in sorted(stacks.items())]
+        if args.collapsed == "-":
+            print("\n".join(lines))
+        else:
+            with open(args.collapsed, "w", encoding="utf-8") as f:
+                f.write("\n".join(lines) + "\n")
+            print(f"{len(lines)} Stacks nach {args.collapsed} geschrieben.", file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,112 @@
+#!/usr/bin/env python3
+# ================================================================================
+# | DATEI: tools/spiffs_sync.py                                                  |
+# | AUTOR: M.Sc. Christian Kitzel, Hochschule Düsseldorf (HSD)                   |
+# | LIZENZ: Proprietär - Siehe LICENSE.md für Details                            |
+# |------------------------------------------------------------------------------|
+# | ZWECK:                                                                       |
+# | Gleicht den Ordner data/ mit dem SPIFFS des Geräts ab (siehe                 |
+# | FileSyncApiHandler.h). Übertragen werden nur geänderte Dateien, ohne         |
+# | spiffs.bin und ohne Neustart.                                                |
+# |                                                                              |
+# | BEISPIEL:                                                                    |
+# |   python tools/spiffs_sync.py 192.168.4.1                                    |
+# |   python tools/spiffs_sync.py 192.168.4.1 --dry-run                          |
+# |   python tools/spiffs_sync.py 192.168.4.1 --prune   (Überzählige löschen)    |
+# |                                                                              |
+# | Nur Python-Standardbibliothek.                                               |
+# ================================================================================
+
+import argparse
+import hashlib
+import http.client
+import json
+import os
+import sys
+import time
+import urllib.parse
+
+DEFAULT_DATA_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "data")
+MAX_PATH = 31   # SPIFFS-Grenze (FS_SYNC_MAX_PATH)
+
+
+def build_manifest(data_dir):
+    """Liefert {"/pfad": (sha256, inhalt)} für alle Dateien unter data_dir."""
+    files = {}
+    for folder, _, names in os.walk(data_dir):
+        for name in sorted(names):
+            full = os.path.join(folder, name)
+            rel = "/" + os.path.relpath(full, data_dir).replace(os.sep, "/")
+            if len(rel) > MAX_PATH:
+                raise ValueError("Pfad zu lang für SPIFFS (max. %d Zeichen): %s" % (MAX_PATH, rel))
+            with open(full, "rb") as f:
+                content = f.read()
+            files[rel] = (hashlib.sha256(content).hexdigest(), content)
+    return files
+
+
+def request(conn, method, path, body=None, headers=None):
+    conn.request(method, path, body=body, headers=headers or {})
+    resp = conn.getresponse()
+    text = resp.read().decode("utf-8", "replace")
+    try:
+        data = json.loads(text)
+    except ValueError:
+        data = {"ok": False, "error": text}
+    if resp.status != 200:
+        raise RuntimeError("%s %s: HTTP %d %s" % (method, path.split("?")[0], resp.status, data.get("error", text)))
+    return data
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Geänderte Dateien aus data/ ins SPIFFS übertragen.")
+    parser.add_argument("host", help="IP-Adresse oder Hostname des Geräts")
+    parser.add_argument("-p", "--port", type=int, default=80)
+    parser.add_argument("-d", "--data", default=DEFAULT_DATA_DIR, help="Quellordner (Standard: data/)")
+    parser.add_argument("--dry-run", action="store_true", help="Nur anzeigen, was übertragen würde")
+    parser.add_argument("--prune", action="store_true", help="Dateien löschen, die nicht in data/ liegen")
+    parser.add_argument("--timeout", type=float, default=30.0)
+    args = parser.parse_args()
+
+    try:
+        files = build_manifest(args.data)
+        manifest = "".join("%s %d %s\n" % (sha, len(content), path)
+                           for path, (sha, content) in sorted(files.items()))
+        conn = http.client.HTTPConnection(args.host, args.port, timeout=args.timeout)
+        diff = request(conn, "POST", "/api/fs/manifest", manifest.encode("utf-8"),
+                       {"Content-Type": "text/plain"})
+
+        total = sum(len(content) for _, content in files.values())
+        print("%d Dateien, %d geändert (%d von %d Bytes), Gerät: %d ms für %d Hashes, %d Bytes frei" %
+              (diff["files"], diff["changed_files"], diff["changed_bytes"], total,
+               diff["hash_ms"], diff["hashed"], diff["free_bytes"]))
+
+        start = time.monotonic()
+        for path in diff["changed"]:
+            sha, content = files[path]
+            print("  -> %-32s %7d Bytes" % (path, len(content)))
+            if args.dry_run:
+                continue
+            query = urllib.parse.urlencode({"path": path, "sha256": sha})
+            request(conn, "POST", "/api/fs/file?" + query, content,
+                    {"Content-Type": "application/octet-stream"})
+
+        for path in diff["extra"]:
+            if args.prune:
+                print("  x  %s" % path)
+                if not args.dry_run:
+                    request(conn, "POST", "/api/fs/delete?" + urllib.parse.urlencode({"path": path}))
+            else:
+                print("  ?  %s (nur auf dem Gerät, löschen mit --prune)" % path)
+
+        if diff["changed"] and not args.dry_run:
+            print("Fertig in %.1f s, kein Neustart nötig." % (time.monotonic() - start))
+        conn.close()
+        return 0
+    except (OSError, ValueError, RuntimeError, http.client.HTTPException) as e:
+        print("Fehler: %s" % e, file=sys.stderr)
+        return 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())